@@ -0,0 +1,336 @@
+/*
+ * async_log.h - Asynchronous logging through a lock-free MPSC ring
+ *
+ * Worker threads never make the write syscall themselves:
+ *
+ *   - Producers claim a slot of a bounded ring with one CAS on the head,
+ *     write "[ HH:MM:SS:mmm.uuu ] " (timestamp.h) and memcpy the message
+ *     into it, then publish the slot through its sequence number
+ *   - One consumer thread collects up to ASYNC_LOG_BATCH consecutive
+ *     published slots and hands them to a single writev, then releases them
+ *   - The head, the tail and every slot sit on their own cache lines, so
+ *     producers only contend on the head and never on the consumer's tail
+ *
+ * The ring is Vyukov's bounded queue: slot i of lap n holds sequence
+ * i + n * capacity while free and that plus one once written, so neither
+ * side needs a lock or a separate "count" field.
+ *
+ * Usage:
+ *   async_log *log = async_log_create(fd, 4096, ASYNC_LOG_BLOCK);
+ *   async_log_write(log, "started\n", 8);       // from any thread
+ *   async_log_write_raw(log, record, len);      // already formatted
+ *   async_log_flush(log);                        // wait until written
+ *   async_log_destroy(log);                      // flushes, joins, frees
+ *
+ * A full ring either makes the producer wait for the consumer
+ * (ASYNC_LOG_BLOCK, counted in full_waits) or drops the record
+ * (ASYNC_LOG_DROP, counted in dropped). Records longer than
+ * ASYNC_LOG_RECORD_MAX are truncated. The consumer polls: it yields while
+ * the ring is empty and sleeps ASYNC_LOG_IDLE_NS after ASYNC_LOG_SPINS
+ * empty polls, which bounds the latency of a quiet log at that sleep.
+ *
+ * Link with -pthread.
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "timestamp.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#ifndef ASYNC_LOG_CACHE_LINE
+#define ASYNC_LOG_CACHE_LINE 64
+#endif
+
+// Bytes per slot, sequence number and length included (multiple of the
+// cache line)
+#ifndef ASYNC_LOG_SLOT_SIZE
+#define ASYNC_LOG_SLOT_SIZE 128
+#endif
+
+// Records per writev (at most IOV_MAX, 1024 on Linux)
+#ifndef ASYNC_LOG_BATCH
+#define ASYNC_LOG_BATCH 256
+#endif
+
+#ifndef ASYNC_LOG_SPINS
+#define ASYNC_LOG_SPINS 64
+#endif
+
+#ifndef ASYNC_LOG_IDLE_NS
+#define ASYNC_LOG_IDLE_NS 100000L
+#endif
+
+#if defined(__SSE2__)
+#define ASYNC_LOG_CPU_RELAX() _mm_pause()
+#else
+#define ASYNC_LOG_CPU_RELAX() ((void)0)
+#endif
+
+#define ASYNC_LOG_RECORD_MAX (ASYNC_LOG_SLOT_SIZE - sizeof(_Atomic uint64_t) - sizeof(uint32_t))
+
+typedef enum {
+    ASYNC_LOG_BLOCK,   // wait for a free slot
+    ASYNC_LOG_DROP,    // give up and count the record
+} async_log_policy;
+
+typedef struct {
+    _Alignas(ASYNC_LOG_CACHE_LINE) _Atomic uint64_t seq;
+    uint32_t len;
+    char data[ASYNC_LOG_RECORD_MAX];
+} async_log_slot;
+
+_Static_assert(sizeof(async_log_slot) == ASYNC_LOG_SLOT_SIZE, "ASYNC_LOG_SLOT_SIZE must be a multiple of the cache line");
+
+typedef struct {
+    // Claimed by producers
+    _Alignas(ASYNC_LOG_CACHE_LINE) _Atomic uint64_t head;
+    // Next slot the consumer releases; producers only read it in flush
+    _Alignas(ASYNC_LOG_CACHE_LINE) _Atomic uint64_t tail;
+
+    // Producer-side counters, off the head's line
+    _Alignas(ASYNC_LOG_CACHE_LINE) _Atomic uint64_t dropped;
+    _Atomic uint64_t full_waits;
+
+    // Consumer-side counters
+    _Alignas(ASYNC_LOG_CACHE_LINE) _Atomic uint64_t records;
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t batches;     // writev calls
+    _Atomic uint64_t errors;      // failed writev (the batch is dropped)
+
+    async_log_slot *slots;
+    uint64_t mask;
+    int fd;
+    async_log_policy policy;
+    atomic_bool stop;
+    pthread_t consumer;
+} async_log;
+
+// ============================================================================
+// Consumer
+// ============================================================================
+
+// Writes iov[0..count) completely, resuming after short writes
+static inline bool async_log_writev_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return true;
+}
+
+// Writes the published slots from the tail on (up to ASYNC_LOG_BATCH);
+// returns how many
+static inline size_t async_log_drain(async_log *log) {
+    struct iovec iov[ASYNC_LOG_BATCH];
+    uint64_t tail = atomic_load_explicit(&log->tail, memory_order_relaxed);
+    int count = 0;
+    size_t bytes = 0;
+    while (count < ASYNC_LOG_BATCH) {
+        async_log_slot *slot = &log->slots[(tail + (uint64_t)count) & log->mask];
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + (uint64_t)count + 1) break;
+        iov[count].iov_base = slot->data;
+        iov[count].iov_len = slot->len;
+        bytes += slot->len;
+        count++;
+    }
+    if (count == 0) return 0;
+
+    if (async_log_writev_all(log->fd, iov, count)) {
+        atomic_fetch_add_explicit(&log->records, (uint64_t)count, memory_order_relaxed);
+        atomic_fetch_add_explicit(&log->bytes, bytes, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&log->errors, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&log->batches, 1, memory_order_relaxed);
+
+    // Hand the slots to the next lap
+    for (int i = 0; i < count; i++) {
+        async_log_slot *slot = &log->slots[(tail + (uint64_t)i) & log->mask];
+        atomic_store_explicit(&slot->seq, tail + (uint64_t)i + log->mask + 1, memory_order_release);
+    }
+    atomic_store_explicit(&log->tail, tail + (uint64_t)count, memory_order_release);
+    return (size_t)count;
+}
+
+static inline void* async_log_consumer_main(void *arg) {
+    async_log *log = arg;
+    int idle = 0;
+    for (;;) {
+        if (async_log_drain(log) > 0) {
+            idle = 0;
+            continue;
+        }
+        // Everything claimed before stop was seen is published by now or
+        // soon: finish once the tail has caught up with the head
+        if (atomic_load_explicit(&log->stop, memory_order_acquire) &&
+            atomic_load_explicit(&log->tail, memory_order_relaxed) ==
+            atomic_load_explicit(&log->head, memory_order_acquire))
+            break;
+        if (++idle < ASYNC_LOG_SPINS) {
+            sched_yield();
+        } else {
+            struct timespec pause = {0, ASYNC_LOG_IDLE_NS};
+            nanosleep(&pause, NULL);
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+// capacity is rounded up to a power of two; returns NULL on failure. The fd
+// stays owned by the caller.
+static inline async_log* async_log_create(int fd, size_t capacity, async_log_policy policy) {
+    size_t cap = 2;
+    while (cap < capacity) cap <<= 1;
+    async_log *log = (async_log*)aligned_alloc(ASYNC_LOG_CACHE_LINE, sizeof(async_log));
+    if (!log) return NULL;
+    memset(log, 0, sizeof(*log));
+    log->slots = (async_log_slot*)aligned_alloc(ASYNC_LOG_CACHE_LINE, cap * sizeof(async_log_slot));
+    if (!log->slots) {
+        free(log);
+        return NULL;
+    }
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&log->slots[i].seq, (uint64_t)i);
+        log->slots[i].len = 0;
+    }
+    log->mask = cap - 1;
+    log->fd = fd;
+    log->policy = policy;
+    atomic_init(&log->stop, false);
+    if (pthread_create(&log->consumer, NULL, async_log_consumer_main, log) != 0) {
+        free(log->slots);
+        free(log);
+        return NULL;
+    }
+    return log;
+}
+
+// Returns once every record written before the call has reached the fd
+static inline void async_log_flush(async_log *log) {
+    uint64_t target = atomic_load_explicit(&log->head, memory_order_acquire);
+    while (atomic_load_explicit(&log->tail, memory_order_acquire) < target) sched_yield();
+}
+
+// Writes the remaining records, stops the consumer and frees the ring; no
+// producer may still be running
+static inline void async_log_destroy(async_log *log) {
+    atomic_store_explicit(&log->stop, true, memory_order_release);
+    pthread_join(log->consumer, NULL);
+    free(log->slots);
+    free(log);
+}
+
+// ============================================================================
+// Producers
+// ============================================================================
+
+// Claims the next slot; NULL if the ring is full and the policy drops
+static inline async_log_slot* async_log_claim(async_log *log, uint64_t *pos_out) {
+    uint64_t pos = atomic_load_explicit(&log->head, memory_order_relaxed);
+    bool waited = false;
+    for (;;) {
+        async_log_slot *slot = &log->slots[pos & log->mask];
+        uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&log->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *pos_out = pos;
+                return slot;
+            }
+            ASYNC_LOG_CPU_RELAX();
+        } else if (diff < 0) {
+            // The slot still holds the previous lap's record
+            if (log->policy == ASYNC_LOG_DROP) {
+                atomic_fetch_add_explicit(&log->dropped, 1, memory_order_relaxed);
+                return NULL;
+            }
+            if (!waited) {
+                atomic_fetch_add_explicit(&log->full_waits, 1, memory_order_relaxed);
+                waited = true;
+            }
+            sched_yield();
+            pos = atomic_load_explicit(&log->head, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&log->head, memory_order_relaxed);
+        }
+    }
+}
+
+static inline void async_log_publish(async_log_slot *slot, uint64_t pos, size_t len) {
+    slot->len = (uint32_t)len;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+}
+
+// Queues an already formatted record; false if it was dropped
+static inline bool async_log_write_raw(async_log *log, const char *record, size_t len) {
+    uint64_t pos;
+    async_log_slot *slot = async_log_claim(log, &pos);
+    if (!slot) return false;
+    if (len > ASYNC_LOG_RECORD_MAX) len = ASYNC_LOG_RECORD_MAX;
+    memcpy(slot->data, record, len);
+    async_log_publish(slot, pos, len);
+    return true;
+}
+
+// Queues "[ HH:MM:SS:mmm.uuu ] " + msg, the timestamp taken now
+static inline bool async_log_write(async_log *log, const char *msg, size_t len) {
+    uint64_t pos;
+    async_log_slot *slot = async_log_claim(log, &pos);
+    if (!slot) return false;
+    // ts_format writes a NUL after the stamp: the separator replaces it
+    ts_format(slot->data);
+    slot->data[TS_FORMAT_LEN] = ' ';
+    if (len > ASYNC_LOG_RECORD_MAX - TS_FORMAT_LEN - 1) len = ASYNC_LOG_RECORD_MAX - TS_FORMAT_LEN - 1;
+    memcpy(slot->data + TS_FORMAT_LEN + 1, msg, len);
+    async_log_publish(slot, pos, TS_FORMAT_LEN + 1 + len);
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASYNC_LOG_H
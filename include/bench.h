@@ -0,0 +1,586 @@
+/*
+ * bench.h - Shared benchmark harness: trials, sampled per-op latency, pinning
+ *
+ * Replaces the single `get_nanos(); loop; get_nanos()` mean with:
+ *
+ *   - Repeated trials: every timed loop runs BENCH_TRIALS times and reports
+ *     the median ns/op with the standard deviation across trials
+ *   - Sampled per-op latency: one op in BENCH_SAMPLE is timed on its own
+ *     with rdtscp (clock_gettime off x86) into an HDR-style log-linear
+ *     histogram, so p50 / p99 / p99.9 / max are visible next to the mean
+ *   - CPU pinning: the process is pinned with sched_setaffinity to BENCH_CPU
+ *     (default: the CPU it starts on; -1 = not pinned)
+ *
+ * The sampling cost is calibrated at startup and subtracted, both from the
+ * samples and from the trial's mean.
+ *
+ * Usage:
+ *   bench_init(5);                       // default trials; env overrides
+ *   bench_print_config(stdout);
+ *   bench_timer t;
+ *   bench_timer_init(&t);
+ *   for (int trial = 0; trial < bench_cfg.trials; trial++) {
+ *       ... untimed setup ...
+ *       bench_trial_begin(&t);
+ *       for (int i = 0; i < n; i++) {
+ *           bench_op_begin(&t, i);
+ *           op(i);
+ *           bench_op_end(&t);
+ *       }
+ *       bench_trial_end(&t, n);
+ *   }
+ *   bench_report_row("op", &t);
+ *   bench_report_print(stdout, "Results");
+ *
+ * Environment: BENCH_TRIALS (1-32), BENCH_SAMPLE (period, rounded down to a
+ * power of two; 1 = every op), BENCH_CPU, and BENCH_OUTPUT=results.json or
+ * results.csv to also write every row, with host and build metadata, in a
+ * machine-readable form (compare two such files with bin/bench_compare).
+ * Needs _GNU_SOURCE (sched_setaffinity, sched_getcpu, program_invocation_short_name).
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <errno.h>
+#include <sys/utsname.h>
+#endif
+
+// Set by the Makefile; only used for the BENCH_OUTPUT metadata
+#ifndef BENCH_CFLAGS
+#define BENCH_CFLAGS "unknown"
+#endif
+#ifndef BENCH_GIT
+#define BENCH_GIT "unknown"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Clock
+// ============================================================================
+
+static inline uint64_t bench_nanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// rdtscp waits for the earlier instructions to finish, so the op being
+// timed cannot leak past the first read
+static inline uint64_t bench_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtscp" : "=a"(lo), "=d"(hi) : : "rcx", "memory");
+    return (uint64_t)hi << 32 | lo;
+#else
+    return bench_nanos();
+#endif
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define BENCH_MAX_TRIALS 32
+#define BENCH_DEFAULT_SAMPLE 16
+
+typedef struct {
+    int trials;             // timed repetitions of every loop
+    size_t sample_mask;     // op i is sampled when (i & sample_mask) == 0
+    int cpu;                // pinned CPU, -1 = not pinned
+    double ticks_per_ns;
+    uint64_t overhead;      // ticks of an empty bench_op_begin / bench_op_end
+    const char *clock;
+#ifdef __linux__
+    bool saved;
+    cpu_set_t saved_mask;   // affinity before bench_pin, for bench_unpin
+#endif
+} bench_config;
+
+static bench_config bench_cfg = {
+    .trials = 1, .sample_mask = BENCH_DEFAULT_SAMPLE - 1, .cpu = -1, .ticks_per_ns = 1.0, .clock = "clock_gettime"
+};
+
+static inline int bench_env_int(const char *name, int def) {
+    const char *v = getenv(name);
+    return v && *v ? atoi(v) : def;
+}
+
+// Pins the calling thread (and the threads it creates later) to one CPU
+static inline bool bench_pin(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    if (!bench_cfg.saved)
+        bench_cfg.saved = sched_getaffinity(0, sizeof(bench_cfg.saved_mask), &bench_cfg.saved_mask) == 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) return false;
+    bench_cfg.cpu = cpu;
+    return true;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Restores the affinity from before bench_pin, for multi-threaded sections
+static inline void bench_unpin(void) {
+#ifdef __linux__
+    if (bench_cfg.saved && bench_cfg.cpu >= 0)
+        sched_setaffinity(0, sizeof(bench_cfg.saved_mask), &bench_cfg.saved_mask);
+#endif
+}
+
+// Re-applies bench_pin after bench_unpin
+static inline void bench_repin(void) {
+    if (bench_cfg.cpu >= 0) bench_pin(bench_cfg.cpu);
+}
+
+static inline void bench_calibrate(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    bench_cfg.clock = "rdtscp";
+    uint64_t ns0 = bench_nanos(), t0 = bench_ticks();
+    while (bench_nanos() - ns0 < 20000000) {}
+    uint64_t ns1 = bench_nanos(), t1 = bench_ticks();
+    bench_cfg.ticks_per_ns = (double)(t1 - t0) / (double)(ns1 - ns0);
+#endif
+    // Cheapest of many back-to-back reads: what a sample costs by itself
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t a = bench_ticks();
+        uint64_t b = bench_ticks();
+        if (b - a < best) best = b - a;
+    }
+    bench_cfg.overhead = best;
+}
+
+static inline void bench_output_open(void);
+
+// Reads the environment, pins, calibrates and opens BENCH_OUTPUT; call once
+// before any timing
+static inline void bench_init(int default_trials) {
+    int trials = bench_env_int("BENCH_TRIALS", default_trials);
+    bench_cfg.trials = trials < 1 ? 1 : trials > BENCH_MAX_TRIALS ? BENCH_MAX_TRIALS : trials;
+
+    int sample = bench_env_int("BENCH_SAMPLE", BENCH_DEFAULT_SAMPLE);
+    size_t period = 1;
+    while (sample > 1 && period * 2 <= (size_t)sample) period *= 2;
+    bench_cfg.sample_mask = period - 1;
+
+#ifdef __linux__
+    int cpu = bench_env_int("BENCH_CPU", sched_getcpu());
+    if (cpu >= 0) bench_pin(cpu);
+#endif
+    bench_calibrate();
+    bench_output_open();
+}
+
+static inline void bench_print_config(FILE *out) {
+    fprintf(out, "Trials: %d (median reported)\n", bench_cfg.trials);
+    if (bench_cfg.cpu >= 0)
+        fprintf(out, "Pinned: CPU %d\n", bench_cfg.cpu);
+    else
+        fprintf(out, "Pinned: no\n");
+    fprintf(out, "Latency: 1 in %zu ops timed with %s (%.2f ticks/ns, %.1f ns subtracted per sample)\n",
+            bench_cfg.sample_mask + 1, bench_cfg.clock, bench_cfg.ticks_per_ns,
+            (double)bench_cfg.overhead / bench_cfg.ticks_per_ns);
+}
+
+// ============================================================================
+// Histogram (HDR-style: 32 linear sub-buckets per power of two, <= 3% error)
+// ============================================================================
+
+#define BENCH_HIST_SUB_BITS 5
+#define BENCH_HIST_SUB (1u << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS ((64 - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_SUB)
+
+typedef struct {
+    uint32_t counts[BENCH_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+} bench_hist;
+
+static inline void bench_hist_reset(bench_hist *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+// Values below 2 * BENCH_HIST_SUB get their own bucket; above, the top
+// BENCH_HIST_SUB_BITS + 1 bits select it
+static inline size_t bench_hist_index(uint64_t v) {
+    if (v < 2 * BENCH_HIST_SUB) return (size_t)v;
+    unsigned shift = 63 - (unsigned)__builtin_clzll(v) - BENCH_HIST_SUB_BITS;
+    return (size_t)shift * BENCH_HIST_SUB + (size_t)(v >> shift);
+}
+
+// Largest value that lands in bucket i
+static inline uint64_t bench_hist_upper(size_t i) {
+    if (i < 2 * BENCH_HIST_SUB) return i;
+    unsigned shift = (unsigned)(i / BENCH_HIST_SUB) - 1;
+    uint64_t mantissa = i - (size_t)shift * BENCH_HIST_SUB;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+static inline void bench_hist_record(bench_hist *h, uint64_t v) {
+    h->counts[bench_hist_index(v)]++;
+    h->total++;
+    if (v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+}
+
+// Adds src's samples to dst (e.g. per-thread histograms into one row)
+static inline void bench_hist_merge(bench_hist *dst, const bench_hist *src) {
+    for (size_t i = 0; i < BENCH_HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+// Value at percentile p (0-100), as the bucket's upper bound capped at max
+static inline uint64_t bench_hist_percentile(const bench_hist *h, double p) {
+    if (h->total == 0) return 0;
+    uint64_t rank = (uint64_t)ceil(p / 100.0 * (double)h->total);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t v = bench_hist_upper(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+// ============================================================================
+// Timer: trials of one loop plus its latency samples
+// ============================================================================
+
+typedef struct {
+    bench_hist hist;
+    double trial_ns[BENCH_MAX_TRIALS];  // ns/op of each trial
+    int trial_count;
+    uint64_t trial_start;
+    uint64_t trial_samples;
+    uint64_t op_start;
+    bool sampling;
+} bench_timer;
+
+static inline void bench_timer_init(bench_timer *t) {
+    memset(t, 0, sizeof(*t));
+    bench_hist_reset(&t->hist);
+}
+
+static inline void bench_timers_init(bench_timer *t, size_t count) {
+    for (size_t i = 0; i < count; i++) bench_timer_init(&t[i]);
+}
+
+static inline void bench_trial_begin(bench_timer *t) {
+    t->trial_samples = 0;
+    t->sampling = false;
+    t->trial_start = bench_nanos();
+}
+
+static inline void bench_op_begin(bench_timer *t, size_t i) {
+    if ((i & bench_cfg.sample_mask) == 0) {
+        t->sampling = true;
+        t->op_start = bench_ticks();
+    }
+}
+
+static inline void bench_op_end(bench_timer *t) {
+    if (t->sampling) {
+        uint64_t d = bench_ticks() - t->op_start;
+        bench_hist_record(&t->hist, d > bench_cfg.overhead ? d - bench_cfg.overhead : 0);
+        t->trial_samples++;
+        t->sampling = false;
+    }
+}
+
+// Closes a trial of ops operations; returns its ns/op
+static inline double bench_trial_end(bench_timer *t, size_t ops) {
+    double ns = (double)(bench_nanos() - t->trial_start);
+    ns -= (double)t->trial_samples * (double)bench_cfg.overhead / bench_cfg.ticks_per_ns;
+    double per_op = ops > 0 && ns > 0 ? ns / (double)ops : 0;
+    if (t->trial_count < BENCH_MAX_TRIALS) t->trial_ns[t->trial_count++] = per_op;
+    return per_op;
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+typedef struct {
+    double median;   // ns/op, median of the trials
+    double stddev;   // ns/op, across trials
+    double min;      // ns/op, fastest trial
+    double p50;      // ns, sampled single ops from here on
+    double p99;
+    double p999;
+    double max;
+    uint64_t samples;
+    int trials;
+} bench_stats;
+
+static inline int bench_cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static inline bench_stats bench_timer_stats(const bench_timer *t) {
+    bench_stats s;
+    memset(&s, 0, sizeof(s));
+    s.trials = t->trial_count;
+    if (t->trial_count > 0) {
+        double sorted[BENCH_MAX_TRIALS];
+        memcpy(sorted, t->trial_ns, (size_t)t->trial_count * sizeof(double));
+        qsort(sorted, (size_t)t->trial_count, sizeof(double), bench_cmp_double);
+        int n = t->trial_count;
+        s.median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+        s.min = sorted[0];
+        double mean = 0;
+        for (int i = 0; i < n; i++) mean += sorted[i];
+        mean /= n;
+        double var = 0;
+        for (int i = 0; i < n; i++) var += (sorted[i] - mean) * (sorted[i] - mean);
+        s.stddev = n > 1 ? sqrt(var / (n - 1)) : 0;
+    }
+    s.samples = t->hist.total;
+    s.p50 = (double)bench_hist_percentile(&t->hist, 50.0) / bench_cfg.ticks_per_ns;
+    s.p99 = (double)bench_hist_percentile(&t->hist, 99.0) / bench_cfg.ticks_per_ns;
+    s.p999 = (double)bench_hist_percentile(&t->hist, 99.9) / bench_cfg.ticks_per_ns;
+    s.max = (double)t->hist.max / bench_cfg.ticks_per_ns;
+    return s;
+}
+
+// ============================================================================
+// Machine-readable output (BENCH_OUTPUT)
+// ============================================================================
+
+typedef struct {
+    FILE *file;
+    bool csv;
+    size_t rows;
+    const char *section;
+} bench_output;
+
+static bench_output bench_out = {NULL, false, 0, ""};
+
+static inline void bench_json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static inline void bench_csv_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"') fputc('"', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static inline void bench_cpu_model(char *buf, size_t size) {
+    snprintf(buf, size, "unknown");
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char *colon = strchr(line, ':');
+        if (strncmp(line, "model name", 10) == 0 && colon) {
+            colon += colon[1] == ' ' ? 2 : 1;
+            colon[strcspn(colon, "\n")] = '\0';
+            snprintf(buf, size, "%s", colon);
+            break;
+        }
+    }
+    fclose(f);
+}
+
+// One "key: value" pair of the metadata, in the file's format
+static inline void bench_output_meta(const char *key, const char *value, bool last) {
+    FILE *f = bench_out.file;
+    if (bench_out.csv) {
+        fprintf(f, "# %s: %s\n", key, value);
+        return;
+    }
+    fprintf(f, "  ");
+    bench_json_string(f, key);
+    fprintf(f, ": ");
+    bench_json_string(f, value);
+    fprintf(f, last ? "\n" : ",\n");
+}
+
+static inline void bench_output_close(void) {
+    if (!bench_out.file) return;
+    if (!bench_out.csv) fprintf(bench_out.file, "%s  ]\n}\n", bench_out.rows ? "\n" : "");
+    fclose(bench_out.file);
+    bench_out.file = NULL;
+}
+
+static inline void bench_output_open(void) {
+    const char *path = getenv("BENCH_OUTPUT");
+    if (!path || !*path || bench_out.file) return;
+    bench_out.file = fopen(path, "w");
+    if (!bench_out.file) {
+        perror(path);
+        return;
+    }
+    size_t len = strlen(path);
+    bench_out.csv = len >= 4 && strcmp(path + len - 4, ".csv") == 0;
+
+    char cpu[128], kernel[256] = "unknown", when[32], config[160];
+#ifdef __linux__
+    struct utsname u;
+    if (uname(&u) == 0) snprintf(kernel, sizeof(kernel), "%s %s %s", u.sysname, u.release, u.machine);
+    const char *program = program_invocation_short_name;
+#else
+    const char *program = "unknown";
+#endif
+    bench_cpu_model(cpu, sizeof(cpu));
+    time_t now = time(NULL);
+    struct tm tm_utc;
+    gmtime_r(&now, &tm_utc);
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", &tm_utc);
+    snprintf(config, sizeof(config), "trials=%d sample=%zu cpu=%d clock=%s ticks_per_ns=%.3f",
+             bench_cfg.trials, bench_cfg.sample_mask + 1, bench_cfg.cpu, bench_cfg.clock,
+             bench_cfg.ticks_per_ns);
+#if defined(__clang__)
+    const char *compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    const char *compiler = "gcc " __VERSION__;
+#else
+    const char *compiler = "unknown";
+#endif
+
+    if (!bench_out.csv) fprintf(bench_out.file, "{\n");
+    bench_output_meta("program", program, false);
+    bench_output_meta("timestamp", when, false);
+    bench_output_meta("cpu", cpu, false);
+    bench_output_meta("kernel", kernel, false);
+    bench_output_meta("compiler", compiler, false);
+    bench_output_meta("cflags", BENCH_CFLAGS, false);
+    bench_output_meta("git", BENCH_GIT, false);
+    bench_output_meta("config", config, false);
+    if (bench_out.csv)
+        fprintf(bench_out.file, "section,name,median_ns,stddev_ns,min_ns,p50_ns,p99_ns,p999_ns,max_ns,samples,trials\n");
+    else
+        fprintf(bench_out.file, "  \"results\": [");
+    atexit(bench_output_close);
+}
+
+// Section for the rows emitted next (bench_report_print sets its title)
+static inline void bench_section(const char *name) {
+    bench_out.section = name;
+}
+
+// Writes one row to BENCH_OUTPUT, if set; one JSON object per line
+static inline void bench_emit(const char *label, const bench_stats *s) {
+    FILE *f = bench_out.file;
+    if (!f) return;
+    if (bench_out.csv) {
+        bench_csv_string(f, bench_out.section);
+        fputc(',', f);
+        bench_csv_string(f, label);
+        fprintf(f, ",%.3f,%.3f,%.3f,%.1f,%.1f,%.1f,%.1f,%llu,%d\n",
+                s->median, s->stddev, s->min, s->p50, s->p99, s->p999, s->max,
+                (unsigned long long)s->samples, s->trials);
+        return;
+    }
+    fprintf(f, "%s\n    {\"section\": ", bench_out.rows ? "," : "");
+    bench_json_string(f, bench_out.section);
+    fprintf(f, ", \"name\": ");
+    bench_json_string(f, label);
+    fprintf(f, ", \"median_ns\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, \"p50_ns\": %.1f, "
+            "\"p99_ns\": %.1f, \"p999_ns\": %.1f, \"max_ns\": %.1f, \"samples\": %llu, \"trials\": %d}",
+            s->median, s->stddev, s->min, s->p50, s->p99, s->p999, s->max,
+            (unsigned long long)s->samples, s->trials);
+    bench_out.rows++;
+}
+
+// ============================================================================
+// Latency tables
+// ============================================================================
+
+#define BENCH_REPORT_MAX_ROWS 256
+
+typedef struct {
+    char label[48];
+    bench_stats stats;
+} bench_report_entry;
+
+typedef struct {
+    bench_report_entry rows[BENCH_REPORT_MAX_ROWS];
+    size_t count;
+} bench_report;
+
+static bench_report bench_rows;
+
+static inline void bench_report_row(const char *label, const bench_timer *t) {
+    if (bench_rows.count >= BENCH_REPORT_MAX_ROWS) return;
+    bench_report_entry *row = &bench_rows.rows[bench_rows.count++];
+    snprintf(row->label, sizeof(row->label), "%s", label);
+    row->stats = bench_timer_stats(t);
+}
+
+static inline void bench_stats_header(FILE *out, const char *first) {
+    fprintf(out, "| %s | Median (ns) | Stddev | p50 | p99 | p99.9 | Max |\n", first);
+    fprintf(out, "|------|------------:|-------:|----:|----:|------:|----:|\n");
+}
+
+static inline void bench_stats_row(FILE *out, const char *label, const bench_stats *s) {
+    fprintf(out, "| %s | %.2f | %.2f | %.0f | %.0f | %.0f | %.0f |\n",
+            label, s->median, s->stddev, s->p50, s->p99, s->p999, s->max);
+}
+
+static inline void bench_timer_print_row(FILE *out, const char *label, const bench_timer *t) {
+    bench_stats s = bench_timer_stats(t);
+    bench_stats_row(out, label, &s);
+    bench_emit(label, &s);
+}
+
+// Prints the recorded rows as a Markdown table (and to BENCH_OUTPUT under
+// section title) and clears them
+static inline void bench_report_print(FILE *out, const char *title) {
+    if (bench_rows.count == 0) return;
+    fprintf(out, "\n#### Latency: %s\n\n", title);
+    bench_stats_header(out, "Row");
+    bench_section(title);
+    for (size_t r = 0; r < bench_rows.count; r++) {
+        bench_stats_row(out, bench_rows.rows[r].label, &bench_rows.rows[r].stats);
+        bench_emit(bench_rows.rows[r].label, &bench_rows.rows[r].stats);
+    }
+    fprintf(out, "\n*Median and stddev of ns/op over %d trials; percentiles and max are single "
+            "sampled ops*\n", bench_cfg.trials);
+    bench_rows.count = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_H
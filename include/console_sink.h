@@ -0,0 +1,716 @@
+/*
+ * console_sink.h - Output sinks and write engines for the console benchmarks
+ *
+ * A sink is where the bytes go, an engine is how they get there:
+ *
+ *   Sinks:   null (/dev/null), pipe (with a reader thread), tmpfs (a file in
+ *            /dev/shm), file (a file in BENCH_SINK_DIR, default /var/tmp),
+ *            direct (the same with O_DIRECT) and pty (a pseudo-terminal in
+ *            raw mode, read by a reader thread)
+ *   Engines: write (one syscall per line), stdio (a FILE with its default
+ *            buffering), stdio_1m (1 MiB buffer, flushed when full),
+ *            stdio_1m_flush64 (1 MiB buffer, fflush every 64 lines),
+ *            buffer_1m (own aligned 1 MiB buffer + write), io_uring (256 KiB
+ *            buffers queued as IORING_OP_WRITE, no liburing needed),
+ *            vmsplice (pages spliced into the pipe, or through a pipe into
+ *            the fd) and mmap (file appends through a mapped window)
+ *
+ * Usage:
+ *   console_sink sink;
+ *   console_writer w;
+ *   if (console_sink_open(&sink, CONSOLE_SINK_PIPE) &&
+ *       console_engine_supports(CONSOLE_ENGINE_URING, &sink) &&
+ *       console_writer_open(&w, CONSOLE_ENGINE_URING, &sink)) {
+ *       console_writer_line(&w, line, len);       // buffered or queued
+ *       console_writer_flush(&w);                 // all of it reached the fd
+ *       console_sink_drain(&sink, bytes);         // and the reader took it
+ *       console_writer_close(&w);
+ *   }
+ *   console_sink_close(&sink);
+ *
+ * Files are created unlinked; console_sink_rewind truncates them between
+ * runs. O_DIRECT needs block-aligned writes, so only buffer_1m and io_uring
+ * run on the direct sink (an unaligned tail is written with O_DIRECT
+ * cleared). Needs _GNU_SOURCE; link with -pthread.
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef CONSOLE_SINK_H
+#define CONSOLE_SINK_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <termios.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define CONSOLE_HAVE_URING 1
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define CONSOLE_SINK_ALIGN 4096              // O_DIRECT buffer and size alignment
+#define CONSOLE_SINK_PIPE_SIZE (1 << 20)     // F_SETPIPE_SZ (pipe-max-size default)
+#define CONSOLE_SINK_READ_SIZE (1 << 20)
+#define CONSOLE_BUFFER_SIZE (1 << 20)        // buffer_1m, stdio_1m
+#define CONSOLE_FLUSH_LINES 64               // stdio_1m_flush64
+#define CONSOLE_URING_DEPTH 8
+#define CONSOLE_URING_BUF (256 << 10)
+#define CONSOLE_SPLICE_CHUNK (64 << 10)
+#define CONSOLE_MMAP_WINDOW (8 << 20)
+
+// ============================================================================
+// Sinks
+// ============================================================================
+
+typedef enum {
+    CONSOLE_SINK_NULL,
+    CONSOLE_SINK_PIPE,
+    CONSOLE_SINK_TMPFS,
+    CONSOLE_SINK_FILE,
+    CONSOLE_SINK_DIRECT,
+    CONSOLE_SINK_PTY,
+    CONSOLE_SINK_COUNT
+} console_sink_kind;
+
+static const char *const console_sink_names[CONSOLE_SINK_COUNT] = {
+    "null", "pipe", "tmpfs", "file", "direct", "pty"
+};
+
+typedef struct {
+    console_sink_kind kind;
+    int fd;                        // written to
+    int reader_fd;                 // pipe read end / pty master, -1 if none
+    pthread_t reader;
+    _Atomic uint64_t consumed;     // bytes the reader took
+    uint64_t expected;             // bytes console_sink_drain waited for
+    bool regular;                  // a file: truncatable, mmap-able
+    bool direct;                   // O_DIRECT is set
+} console_sink;
+
+// Returns CONSOLE_SINK_COUNT for an unknown name
+static inline console_sink_kind console_sink_parse(const char *name) {
+    for (int i = 0; i < CONSOLE_SINK_COUNT; i++) {
+        if (strcmp(name, console_sink_names[i]) == 0) return (console_sink_kind)i;
+    }
+    return CONSOLE_SINK_COUNT;
+}
+
+static inline void* console_sink_reader_main(void *arg) {
+    console_sink *s = arg;
+    char *buf = malloc(CONSOLE_SINK_READ_SIZE);
+    if (!buf) return NULL;
+    for (;;) {
+        ssize_t n = read(s->reader_fd, buf, CONSOLE_SINK_READ_SIZE);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;   // EOF, or EIO once the pty slave is closed
+        atomic_fetch_add_explicit(&s->consumed, (uint64_t)n, memory_order_release);
+    }
+    free(buf);
+    return NULL;
+}
+
+static inline int console_sink_tempfile(const char *dir) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/console_sink_XXXXXX", dir);
+    int fd = mkstemp(path);
+    if (fd != -1) unlink(path);
+    return fd;
+}
+
+static inline int console_sink_pty(int *master) {
+    *master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (*master == -1) return -1;
+    const char *name = grantpt(*master) == 0 && unlockpt(*master) == 0 ? ptsname(*master) : NULL;
+    int fd = name ? open(name, O_WRONLY | O_NOCTTY) : -1;
+    if (fd == -1) {
+        close(*master);
+        *master = -1;
+        return -1;
+    }
+    // No "\n" -> "\r\n" translation, so the reader sees exactly the bytes written
+    struct termios t;
+    if (tcgetattr(fd, &t) == 0) {
+        cfmakeraw(&t);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    return fd;
+}
+
+// false (errno set) if the sink is not available here
+static inline bool console_sink_open(console_sink *s, console_sink_kind kind) {
+    memset(s, 0, sizeof(*s));
+    s->kind = kind;
+    s->fd = -1;
+    s->reader_fd = -1;
+    const char *dir = getenv("BENCH_SINK_DIR");
+    if (!dir) dir = "/var/tmp";
+    switch (kind) {
+    case CONSOLE_SINK_NULL:
+        s->fd = open("/dev/null", O_WRONLY);
+        break;
+    case CONSOLE_SINK_PIPE: {
+        int p[2];
+        if (pipe(p) == -1) return false;
+        fcntl(p[1], F_SETPIPE_SZ, CONSOLE_SINK_PIPE_SIZE);
+        s->reader_fd = p[0];
+        s->fd = p[1];
+        break;
+    }
+    case CONSOLE_SINK_TMPFS:
+        s->fd = console_sink_tempfile("/dev/shm");
+        s->regular = true;
+        break;
+    case CONSOLE_SINK_FILE:
+    case CONSOLE_SINK_DIRECT:
+        s->fd = console_sink_tempfile(dir);
+        s->regular = true;
+        if (s->fd != -1 && kind == CONSOLE_SINK_DIRECT) {
+            int flags = fcntl(s->fd, F_GETFL);
+            if (fcntl(s->fd, F_SETFL, flags | O_DIRECT) == -1) {
+                close(s->fd);
+                s->fd = -1;
+            }
+            s->direct = true;
+        }
+        break;
+    case CONSOLE_SINK_PTY:
+        s->fd = console_sink_pty(&s->reader_fd);
+        break;
+    default:
+        errno = EINVAL;
+        break;
+    }
+    if (s->fd == -1) return false;
+    if (s->reader_fd != -1 && pthread_create(&s->reader, NULL, console_sink_reader_main, s) != 0) {
+        close(s->fd);
+        close(s->reader_fd);
+        s->fd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Empties a file sink and moves its offset back to 0
+static inline void console_sink_rewind(console_sink *s) {
+    if (!s->regular) return;
+    if (ftruncate(s->fd, 0) == -1) perror("ftruncate");
+    lseek(s->fd, 0, SEEK_SET);
+}
+
+// Waits until the reader has taken bytes more bytes (no-op without one)
+static inline void console_sink_drain(console_sink *s, uint64_t bytes) {
+    if (s->reader_fd == -1) return;
+    s->expected += bytes;
+    while (atomic_load_explicit(&s->consumed, memory_order_acquire) < s->expected) sched_yield();
+}
+
+static inline void console_sink_close(console_sink *s) {
+    if (s->fd == -1) return;
+    close(s->fd);
+    if (s->reader_fd != -1) {
+        pthread_join(s->reader, NULL);
+        close(s->reader_fd);
+    }
+    s->fd = -1;
+}
+
+// ============================================================================
+// io_uring without liburing
+// ============================================================================
+
+#ifdef CONSOLE_HAVE_URING
+
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+} console_uring;
+
+static inline bool console_uring_open(console_uring *r, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) return false;
+
+    r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && r->cq_ring_size > r->sq_ring_size) r->sq_ring_size = r->cq_ring_size;
+    r->sq_ring = mmap(NULL, r->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd,
+                      IORING_OFF_SQ_RING);
+    r->cq_ring = single ? r->sq_ring
+                        : mmap(NULL, r->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                               r->fd, IORING_OFF_CQ_RING);
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd,
+                   IORING_OFF_SQES);
+    if (r->sq_ring == MAP_FAILED || r->cq_ring == MAP_FAILED || r->sqes == MAP_FAILED) {
+        close(r->fd);
+        r->fd = -1;
+        return false;
+    }
+    char *sq = r->sq_ring, *cq = r->cq_ring;
+    r->sq_head = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return true;
+}
+
+static inline void console_uring_close(console_uring *r) {
+    if (r->fd < 0) return;
+    munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring != r->sq_ring) munmap(r->cq_ring, r->cq_ring_size);
+    munmap(r->sq_ring, r->sq_ring_size);
+    close(r->fd);
+    r->fd = -1;
+}
+
+// Queues and submits one write; off (uint64_t)-1 = the file position
+static inline bool console_uring_write(console_uring *r, int fd, const void *buf, unsigned len, uint64_t off,
+                                       uint64_t user_data) {
+    unsigned tail = *r->sq_tail;
+    unsigned index = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = off;
+    sqe->user_data = user_data;
+    r->sq_array[index] = index;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0) == 1;
+}
+
+// Blocks until a completion is available and pops it
+static inline bool console_uring_wait(console_uring *r, struct io_uring_cqe *out) {
+    for (;;) {
+        unsigned head = *r->cq_head;
+        if (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+            *out = r->cqes[head & *r->cq_mask];
+            __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+        if (syscall(__NR_io_uring_enter, r->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+            return false;
+    }
+}
+
+#endif // CONSOLE_HAVE_URING
+
+// ============================================================================
+// Engines
+// ============================================================================
+
+typedef enum {
+    CONSOLE_ENGINE_WRITE,
+    CONSOLE_ENGINE_STDIO,
+    CONSOLE_ENGINE_STDIO_1M,
+    CONSOLE_ENGINE_STDIO_FLUSH,
+    CONSOLE_ENGINE_BUFFER,
+    CONSOLE_ENGINE_URING,
+    CONSOLE_ENGINE_VMSPLICE,
+    CONSOLE_ENGINE_MMAP,
+    CONSOLE_ENGINE_COUNT
+} console_engine_kind;
+
+static const char *const console_engine_names[CONSOLE_ENGINE_COUNT] = {
+    "write", "stdio", "stdio_1m", "stdio_1m_flush64", "buffer_1m", "io_uring", "vmsplice", "mmap"
+};
+
+typedef struct {
+    console_engine_kind engine;
+    console_sink *sink;
+    FILE *file;              // stdio engines, on a dup of the sink fd
+    char *buf;               // current buffer / chunk / mapped window
+    size_t used;
+    size_t cap;
+    uint64_t offset;         // file offset of buf[0] (io_uring, mmap)
+    uint64_t lines;
+    bool failed;
+
+    // io_uring: CONSOLE_URING_DEPTH buffers, one being filled
+    char *buffers;
+#ifdef CONSOLE_HAVE_URING
+    console_uring ring;
+#endif
+    int current;
+    int in_flight;
+    int max_in_flight;       // 1 on streams, where writes must stay ordered
+    bool busy[CONSOLE_URING_DEPTH];
+    unsigned pending_len[CONSOLE_URING_DEPTH];
+    uint64_t pending_off[CONSOLE_URING_DEPTH];
+
+    // vmsplice: a region of 2x the pipe size, so a chunk is reused only
+    // after the pipe has passed it on
+    int pipe_r, pipe_w;      // own pipe when the sink is not one
+    size_t chunks;
+    size_t chunk;
+} console_writer;
+
+static inline bool console_engine_supports(console_engine_kind engine, const console_sink *s) {
+    switch (engine) {
+    case CONSOLE_ENGINE_BUFFER:
+        return true;
+    case CONSOLE_ENGINE_URING:
+#ifdef CONSOLE_HAVE_URING
+        return true;
+#else
+        return false;
+#endif
+    case CONSOLE_ENGINE_VMSPLICE:
+        return s->kind != CONSOLE_SINK_DIRECT && s->kind != CONSOLE_SINK_PTY;
+    case CONSOLE_ENGINE_MMAP:
+        return s->regular && !s->direct;
+    default:
+        return !s->direct;   // unaligned writes
+    }
+}
+
+static inline void console_write_all(console_writer *w, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t k = write(w->sink->fd, p, n);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            w->failed = true;
+            return;
+        }
+        p += k;
+        n -= (size_t)k;
+    }
+}
+
+static inline void console_pwrite_all(console_writer *w, const char *p, size_t n, uint64_t off) {
+    while (n > 0) {
+        ssize_t k = pwrite(w->sink->fd, p, n, (off_t)off);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            w->failed = true;
+            return;
+        }
+        p += k;
+        n -= (size_t)k;
+        off += (uint64_t)k;
+    }
+}
+
+// O_DIRECT rejects a tail that is not a multiple of the block size
+static inline void console_write_tail(console_writer *w, const char *p, size_t n, uint64_t off, bool positioned) {
+    bool unaligned = w->sink->direct && n % CONSOLE_SINK_ALIGN != 0;
+    int flags = unaligned ? fcntl(w->sink->fd, F_GETFL) : 0;
+    if (unaligned) fcntl(w->sink->fd, F_SETFL, flags & ~O_DIRECT);
+    if (positioned) console_pwrite_all(w, p, n, off);
+    else console_write_all(w, p, n);
+    if (unaligned) fcntl(w->sink->fd, F_SETFL, flags);
+}
+
+#ifdef CONSOLE_HAVE_URING
+
+// Retires one completion; a short write is finished synchronously
+static inline void console_uring_reap(console_writer *w) {
+    struct io_uring_cqe cqe;
+    if (!console_uring_wait(&w->ring, &cqe)) {
+        w->failed = true;
+        w->in_flight = 0;
+        memset(w->busy, 0, sizeof(w->busy));
+        return;
+    }
+    int i = (int)cqe.user_data;
+    if (cqe.res < 0) {
+        w->failed = true;
+    } else if ((unsigned)cqe.res < w->pending_len[i]) {
+        const char *rest = w->buffers + (size_t)i * CONSOLE_URING_BUF + cqe.res;
+        console_write_tail(w, rest, w->pending_len[i] - (unsigned)cqe.res,
+                           w->pending_off[i] + (uint64_t)cqe.res, w->sink->regular);
+    }
+    w->busy[i] = false;
+    w->in_flight--;
+}
+
+static inline void console_uring_submit(console_writer *w) {
+    while (w->in_flight >= w->max_in_flight) console_uring_reap(w);
+    int i = w->current;
+    if (w->used > 0) {
+        uint64_t off = w->sink->regular ? w->offset : (uint64_t)-1;
+        w->pending_len[i] = (unsigned)w->used;
+        w->pending_off[i] = w->offset;
+        if (console_uring_write(&w->ring, w->sink->fd, w->buf, (unsigned)w->used, off, (uint64_t)i)) {
+            w->busy[i] = true;
+            w->in_flight++;
+        } else {
+            w->failed = true;
+        }
+        w->offset += w->used;
+    }
+    w->current = (i + 1) % CONSOLE_URING_DEPTH;
+    while (w->busy[w->current]) console_uring_reap(w);
+    w->buf = w->buffers + (size_t)w->current * CONSOLE_URING_BUF;
+    w->used = 0;
+}
+
+#endif // CONSOLE_HAVE_URING
+
+static inline void console_vmsplice_emit(console_writer *w) {
+    bool own_pipe = w->pipe_w != -1;
+    int target = own_pipe ? w->pipe_w : w->sink->fd;
+    const char *p = w->buf;
+    size_t n = w->used;
+    while (n > 0 && !w->failed) {
+        struct iovec iov = {(void*)p, n};
+        ssize_t k = vmsplice(target, &iov, 1, 0);
+        if (k < 0) {
+            if (errno != EINTR) w->failed = true;
+            continue;
+        }
+        // Through our pipe: move it on into the fd before the chunk is reused
+        for (ssize_t moved = 0; own_pipe && moved < k;) {
+            ssize_t m = splice(w->pipe_r, NULL, w->sink->fd, NULL, (size_t)(k - moved), SPLICE_F_MOVE);
+            if (m <= 0) {
+                if (m < 0 && errno == EINTR) continue;
+                w->failed = true;
+                break;
+            }
+            moved += m;
+        }
+        p += k;
+        n -= (size_t)k;
+    }
+    w->chunk = (w->chunk + 1) % w->chunks;
+    w->buf = w->buffers + w->chunk * CONSOLE_SPLICE_CHUNK;
+    w->used = 0;
+}
+
+static inline void console_mmap_emit(console_writer *w) {
+    if (w->buf) {
+        munmap(w->buf, CONSOLE_MMAP_WINDOW);
+        w->offset += w->used;
+    }
+    w->buf = NULL;
+    w->used = 0;
+    w->cap = 0;
+    if (ftruncate(w->sink->fd, (off_t)(w->offset + CONSOLE_MMAP_WINDOW)) == -1) {
+        w->failed = true;
+        return;
+    }
+    void *map = mmap(NULL, CONSOLE_MMAP_WINDOW, PROT_READ | PROT_WRITE, MAP_SHARED, w->sink->fd, (off_t)w->offset);
+    if (map == MAP_FAILED) {
+        w->failed = true;
+        return;
+    }
+    w->buf = map;
+    w->cap = CONSOLE_MMAP_WINDOW;
+}
+
+// Hands a full buffer on
+static inline void console_writer_emit(console_writer *w) {
+    switch (w->engine) {
+    case CONSOLE_ENGINE_BUFFER:
+        console_write_all(w, w->buf, w->used);
+        w->used = 0;
+        break;
+#ifdef CONSOLE_HAVE_URING
+    case CONSOLE_ENGINE_URING:
+        console_uring_submit(w);
+        break;
+#endif
+    case CONSOLE_ENGINE_VMSPLICE:
+        console_vmsplice_emit(w);
+        break;
+    case CONSOLE_ENGINE_MMAP:
+        console_mmap_emit(w);
+        break;
+    default:
+        break;
+    }
+}
+
+static inline bool console_writer_open(console_writer *w, console_engine_kind engine, console_sink *s) {
+    memset(w, 0, sizeof(*w));
+    w->engine = engine;
+    w->sink = s;
+    w->pipe_r = w->pipe_w = -1;
+#ifdef CONSOLE_HAVE_URING
+    w->ring.fd = -1;
+#endif
+    if (!console_engine_supports(engine, s)) return false;
+    switch (engine) {
+    case CONSOLE_ENGINE_STDIO:
+    case CONSOLE_ENGINE_STDIO_1M:
+    case CONSOLE_ENGINE_STDIO_FLUSH: {
+        int fd = dup(s->fd);
+        w->file = fd == -1 ? NULL : fdopen(fd, "w");
+        if (!w->file) return false;
+        if (engine != CONSOLE_ENGINE_STDIO) setvbuf(w->file, NULL, _IOFBF, CONSOLE_BUFFER_SIZE);
+        return true;
+    }
+    case CONSOLE_ENGINE_BUFFER:
+        w->buffers = aligned_alloc(CONSOLE_SINK_ALIGN, CONSOLE_BUFFER_SIZE);
+        w->buf = w->buffers;
+        w->cap = CONSOLE_BUFFER_SIZE;
+        return w->buf != NULL;
+#ifdef CONSOLE_HAVE_URING
+    case CONSOLE_ENGINE_URING:
+        w->buffers = aligned_alloc(CONSOLE_SINK_ALIGN, (size_t)CONSOLE_URING_DEPTH * CONSOLE_URING_BUF);
+        if (!w->buffers || !console_uring_open(&w->ring, CONSOLE_URING_DEPTH)) return false;
+        w->buf = w->buffers;
+        w->cap = CONSOLE_URING_BUF;
+        w->max_in_flight = s->regular ? CONSOLE_URING_DEPTH : 1;
+        return true;
+#endif
+    case CONSOLE_ENGINE_VMSPLICE: {
+        int pipe_size;
+        if (s->kind == CONSOLE_SINK_PIPE) {
+            pipe_size = fcntl(s->fd, F_GETPIPE_SZ);
+        } else {
+            int p[2];
+            if (pipe(p) == -1) return false;
+            w->pipe_r = p[0];
+            w->pipe_w = p[1];
+            pipe_size = fcntl(w->pipe_w, F_SETPIPE_SZ, CONSOLE_SINK_PIPE_SIZE);
+        }
+        if (pipe_size <= 0) return false;
+        w->chunks = 2 * (size_t)pipe_size / CONSOLE_SPLICE_CHUNK;
+        if (w->chunks < 2) w->chunks = 2;
+        w->buffers = aligned_alloc(CONSOLE_SINK_ALIGN, w->chunks * CONSOLE_SPLICE_CHUNK);
+        w->buf = w->buffers;
+        w->cap = CONSOLE_SPLICE_CHUNK;
+        return w->buf != NULL;
+    }
+    case CONSOLE_ENGINE_MMAP:
+        return true;   // the first line maps the first window
+    default:
+        return true;
+    }
+}
+
+static inline void console_writer_line(console_writer *w, const char *line, size_t len) {
+    w->lines++;
+    switch (w->engine) {
+    case CONSOLE_ENGINE_WRITE:
+        console_write_all(w, line, len);
+        return;
+    case CONSOLE_ENGINE_STDIO:
+    case CONSOLE_ENGINE_STDIO_1M:
+        fwrite(line, 1, len, w->file);
+        return;
+    case CONSOLE_ENGINE_STDIO_FLUSH:
+        fwrite(line, 1, len, w->file);
+        if (w->lines % CONSOLE_FLUSH_LINES == 0) fflush(w->file);
+        return;
+    default:
+        // Buffer engines; a line may straddle two buffers
+        while (len > 0 && !w->failed) {
+            if (w->used == w->cap) console_writer_emit(w);
+            size_t n = w->cap - w->used < len ? w->cap - w->used : len;
+            memcpy(w->buf + w->used, line, n);
+            w->used += n;
+            line += n;
+            len -= n;
+        }
+        return;
+    }
+}
+
+// Pushes everything written so far into the fd; false if a write failed
+static inline bool console_writer_flush(console_writer *w) {
+    switch (w->engine) {
+    case CONSOLE_ENGINE_STDIO:
+    case CONSOLE_ENGINE_STDIO_1M:
+    case CONSOLE_ENGINE_STDIO_FLUSH:
+        if (fflush(w->file) != 0) w->failed = true;
+        break;
+    case CONSOLE_ENGINE_BUFFER:
+        console_write_tail(w, w->buf, w->used, 0, false);
+        w->used = 0;
+        break;
+#ifdef CONSOLE_HAVE_URING
+    case CONSOLE_ENGINE_URING:
+        if (w->sink->direct && w->used % CONSOLE_SINK_ALIGN != 0) {
+            while (w->in_flight > 0) console_uring_reap(w);
+            console_write_tail(w, w->buf, w->used, w->offset, true);
+            w->offset += w->used;
+            w->used = 0;
+        } else {
+            console_uring_submit(w);
+        }
+        while (w->in_flight > 0) console_uring_reap(w);
+        break;
+#endif
+    case CONSOLE_ENGINE_VMSPLICE:
+        if (w->used > 0) console_vmsplice_emit(w);
+        break;
+    case CONSOLE_ENGINE_MMAP:
+        if (w->buf) {
+            munmap(w->buf, CONSOLE_MMAP_WINDOW);
+            w->offset += w->used;
+            w->buf = NULL;
+            w->used = w->cap = 0;
+        }
+        if (ftruncate(w->sink->fd, (off_t)w->offset) == -1) w->failed = true;
+        break;
+    default:
+        break;
+    }
+    return !w->failed;
+}
+
+// After console_sink_rewind: the next line goes to offset 0
+static inline void console_writer_rewind(console_writer *w) {
+    w->offset = 0;
+    w->lines = 0;
+}
+
+static inline void console_writer_close(console_writer *w) {
+    if (w->file) fclose(w->file);
+#ifdef CONSOLE_HAVE_URING
+    if (w->engine == CONSOLE_ENGINE_URING) {
+        while (w->in_flight > 0) console_uring_reap(w);
+        console_uring_close(&w->ring);
+    }
+#endif
+    if (w->engine == CONSOLE_ENGINE_MMAP && w->buf) munmap(w->buf, CONSOLE_MMAP_WINDOW);
+    if (w->pipe_r != -1) close(w->pipe_r);
+    if (w->pipe_w != -1) close(w->pipe_w);
+    free(w->buffers);
+    memset(w, 0, sizeof(*w));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONSOLE_SINK_H
@@ -11,6 +11,36 @@
  *   // Or custom types:
  *   DICT_DEFINE(MyDict, char*, double, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
  *   
+ *   // Keys bump-allocated in a per-dict arena (no per-key malloc/free):
+ *   DICT_DEFINE_ARENA_STR_INT(MyArenaDict)
+ *   
+ *   // Length-carrying string keys (wyhash, no strlen/strcmp on lookup):
+ *   DICT_DEFINE_STRLEN_INT(TagDict)
+ *   TagDict_set(dict, dict_strlen("session_id"), 1);
+ *   
+ *   // Small-string keys (<= 23 bytes inline in the entry, longer on the heap):
+ *   DICT_DEFINE_SSO_INT(NameDict)
+ *   NameDict_set(dict, dict_sso("user:1234"), 1);
+ *   
+ *   // Insertion-ordered compact variant (dense entries + sparse index):
+ *   DICT_DEFINE_ORDERED_STR_INT(Metrics)
+ *   
+ *   // Key-only set with bulk union_into/intersect/difference:
+ *   DICT_DEFINE_SET_UINT64(IdSet)
+ *   IdSet *common = IdSet_intersect(a, b);
+ *   
+ *   // Perfect hash table for a fixed key set (one hash, one compare):
+ *   DICT_DEFINE_STATIC(Commands, int)
+ *   Commands *cmds = Commands_create(names, ids, n);
+ *   
+ *   // Swiss table variant (same API, SIMD control-byte probing):
+ *   DICT_DEFINE_SWISS(MySwiss, char*, int, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+ *   
+ *   // Robin Hood with a packed 8-bit distance + 24-bit hash tag per slot,
+ *   // as {key, meta, value} entries or as split keys[]/values[]/meta[]:
+ *   DICT_DEFINE_PACKED_INT_INT(Compact)
+ *   DICT_DEFINE_LAYOUT(Columns, SPLIT, char*, double, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+ *   
  *   // Use it
  *   StrIntDict *dict = StrIntDict_create();
  *   StrIntDict_set(dict, "key", 42);
@@ -33,6 +63,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -49,6 +83,62 @@ extern "C" {
 #define DICT_LOAD_FACTOR 0.75
 #endif
 
+// Keys hashed and prefetched together by the _get_many/_contains_many/_set_many calls
+#ifndef DICT_BATCH_SIZE
+#define DICT_BATCH_SIZE 32
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DICT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define DICT_PREFETCH(addr) ((void)(addr))
+#endif
+
+// Suggested value for NAME##_set_rehash_step (slots moved per operation)
+#ifndef DICT_REHASH_STEP
+#define DICT_REHASH_STEP 64
+#endif
+
+// Allocator hooks for the handles and entry arrays of DICT_DEFINE (and its
+// ARENA/SNAPSHOT/PACKED/SPLIT forms) and DICT_DEFINE_SET tables, and for key
+// arena chunks. Define all three before including dict.h; ctx is
+// DICT_ALLOC_CTX, and DICT_FREE also receives the size that was allocated.
+// The other variants and per-key copies still call malloc/free, see
+// DICT_USAGE.md.
+#ifndef DICT_MALLOC
+#define DICT_MALLOC(size, ctx) ((void)(ctx), malloc(size))
+#define DICT_CALLOC(count, size, ctx) ((void)(ctx), calloc(count, size))
+#define DICT_FREE(ptr, size, ctx) ((void)(ctx), (void)(size), free(ptr))
+#endif
+
+#ifndef DICT_ALLOC_CTX
+#define DICT_ALLOC_CTX NULL
+#endif
+
+// Entry arrays at least this large are mmap'ed on 2 MB pages by tables that
+// opted in with NAME##_set_huge_pages
+#ifndef DICT_HUGE_PAGE_MIN
+#define DICT_HUGE_PAGE_MIN ((size_t)4 << 20)
+#endif
+
+// Worker threads for NAME##_build_from; on by default when compiling with
+// -pthread, otherwise build_from partitions the input on the calling thread
+#ifndef DICT_THREADS
+#ifdef _REENTRANT
+#define DICT_THREADS 1
+#else
+#define DICT_THREADS 0
+#endif
+#endif
+#if DICT_THREADS
+#include <pthread.h>
+#endif
+
+// Target entry-array bytes per build_from partition (about an L2 cache)
+#ifndef DICT_BUILD_PART_BYTES
+#define DICT_BUILD_PART_BYTES (512 * 1024)
+#endif
+
 // ============================================================================
 // Hash Functions
 // ============================================================================
@@ -95,6 +185,250 @@ static inline uint32_t dict_hash_ptr(const void *ptr) {
     return dict_hash_uint64((uint64_t)(uintptr_t)ptr);
 }
 
+// wyhash (final4) for byte strings: 16 bytes per step, 48 in the bulk loop
+static const uint64_t dict_wyhash_secret[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+    0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+static inline void dict_wymum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = *a;
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t dict_wymix(uint64_t a, uint64_t b) {
+    dict_wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t dict_wyr8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t dict_wyr4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t dict_wyhash(const void *key, size_t len, uint64_t seed) {
+    const uint64_t *secret = dict_wyhash_secret;
+    const uint8_t *p = (const uint8_t*)key;
+    uint64_t a, b;
+    seed ^= dict_wymix(seed ^ secret[0], secret[1]);
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (dict_wyr4(p) << 32) | dict_wyr4(p + ((len >> 3) << 2));
+            b = (dict_wyr4(p + len - 4) << 32) | dict_wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = dict_wymix(dict_wyr8(p) ^ secret[1], dict_wyr8(p + 8) ^ seed);
+                see1 = dict_wymix(dict_wyr8(p + 16) ^ secret[2], dict_wyr8(p + 24) ^ see1);
+                see2 = dict_wymix(dict_wyr8(p + 32) ^ secret[3], dict_wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = dict_wymix(dict_wyr8(p) ^ secret[1], dict_wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = dict_wyr8(p + i - 16);
+        b = dict_wyr8(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    dict_wymum(&a, &b);
+    return dict_wymix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+// ============================================================================
+// Length-carrying string keys
+// ============================================================================
+//
+// dict_strlen_t carries the length and a precomputed 64-bit wyhash, so the
+// dict never rescans the bytes: hashing is a field read and equality checks
+// length and hash before falling back to memcmp. Build lookup keys with
+// dict_strlen()/dict_strn(); the dict stores its own NUL-terminated copy.
+
+typedef struct {
+    const char *ptr;
+    size_t len;
+    uint64_t hash;
+} dict_strlen_t;
+
+static inline dict_strlen_t dict_strn(const char *s, size_t len) {
+    dict_strlen_t k = {s, len, dict_wyhash(s, len, 0)};
+    return k;
+}
+
+static inline dict_strlen_t dict_strlen(const char *s) {
+    return dict_strn(s, strlen(s));
+}
+
+static inline uint32_t dict_hash_strlen(dict_strlen_t k) {
+    return (uint32_t)(k.hash ^ (k.hash >> 32));
+}
+
+static inline bool dict_eq_strlen(dict_strlen_t a, dict_strlen_t b) {
+    return a.len == b.len && a.hash == b.hash && memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static inline dict_strlen_t dict_copy_strlen(dict_strlen_t k) {
+    char *copy = (char*)malloc(k.len + 1);
+    if (copy) {
+        memcpy(copy, k.ptr, k.len);
+        copy[k.len] = '\0';
+    }
+    k.ptr = copy;
+    return k;
+}
+
+static inline void dict_free_strlen(dict_strlen_t k) {
+    free((void*)k.ptr);
+}
+
+// ============================================================================
+// Small-string keys
+// ============================================================================
+//
+// dict_sso_t keeps strings of up to DICT_SSO_MAX bytes inline (24-byte key,
+// 40-byte entry with an int value), so a lookup compares the key stored in
+// the entry without chasing a pointer. Longer strings fall back to a pointer
+// plus length. The last byte is a tag: DICT_SSO_MAX - len for inline keys (a
+// full-length inline key is still NUL-terminated), DICT_SSO_HEAP for pointer
+// keys. Build lookup keys with dict_sso()/dict_sson(); the dict copies long
+// keys it stores.
+
+#define DICT_SSO_MAX 23
+#define DICT_SSO_HEAP 0xFF
+
+typedef union {
+    char buf[DICT_SSO_MAX + 1];
+    struct {
+        const char *ptr;
+        uint32_t len;
+    } heap;
+} dict_sso_t;
+
+static inline bool dict_sso_is_heap(const dict_sso_t *k) {
+    return (unsigned char)k->buf[DICT_SSO_MAX] == DICT_SSO_HEAP;
+}
+
+static inline size_t dict_sso_len(const dict_sso_t *k) {
+    return dict_sso_is_heap(k) ? k->heap.len : DICT_SSO_MAX - (size_t)(unsigned char)k->buf[DICT_SSO_MAX];
+}
+
+static inline const char* dict_sso_str(const dict_sso_t *k) {
+    return dict_sso_is_heap(k) ? k->heap.ptr : k->buf;
+}
+
+// Inline bytes past the string are zeroed so equality is a three-word compare
+static inline dict_sso_t dict_sson(const char *s, size_t len) {
+    dict_sso_t k;
+    memset(&k, 0, sizeof(k));
+    if (len <= DICT_SSO_MAX) {
+        memcpy(k.buf, s, len);
+        k.buf[DICT_SSO_MAX] = (char)(DICT_SSO_MAX - len);
+    } else {
+        k.heap.ptr = s;
+        k.heap.len = (uint32_t)len;
+        k.buf[DICT_SSO_MAX] = (char)DICT_SSO_HEAP;
+    }
+    return k;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define DICT_SSO_SHIFT(i) ((7 - ((i) & 7)) * 8)
+#else
+#define DICT_SSO_SHIFT(i) (((i) & 7) * 8)
+#endif
+
+// Assembles the inline bytes in three registers while scanning for the NUL
+// and stores them as whole words, so the hash and compare that read the key
+// back get store-to-load forwarding instead of stalling behind byte stores
+static inline dict_sso_t dict_sso(const char *s) {
+    uint64_t lo = 0, mid = 0, hi = 0;
+    size_t len = 0;
+    for (; len < 8 && s[len]; len++) lo |= (uint64_t)(unsigned char)s[len] << DICT_SSO_SHIFT(len);
+    if (len == 8)
+        for (; len < 16 && s[len]; len++) mid |= (uint64_t)(unsigned char)s[len] << DICT_SSO_SHIFT(len);
+    if (len == 16)
+        for (; len <= DICT_SSO_MAX && s[len]; len++) hi |= (uint64_t)(unsigned char)s[len] << DICT_SSO_SHIFT(len);
+    if (len > DICT_SSO_MAX) return dict_sson(s, len + strlen(s + len));
+    hi |= (uint64_t)(DICT_SSO_MAX - len) << DICT_SSO_SHIFT(DICT_SSO_MAX);
+    dict_sso_t k;
+    memcpy(k.buf, &lo, 8);
+    memcpy(k.buf + 8, &mid, 8);
+    memcpy(k.buf + 16, &hi, 8);
+    return k;
+}
+
+// Inline keys are canonical (zero padded, length in the tag), so they hash
+// as fixed-size words; pointer keys go through wyhash
+static inline uint32_t dict_hash_sso(dict_sso_t k) {
+    uint64_t h;
+    if (dict_sso_is_heap(&k))
+        h = dict_wyhash(k.heap.ptr, k.heap.len, 0);
+    else
+        h = dict_wymix(dict_wyr8((const uint8_t*)k.buf) ^ dict_wyhash_secret[1],
+                       dict_wyr8((const uint8_t*)k.buf + 8) ^ dict_wymix(
+                           dict_wyr8((const uint8_t*)k.buf + 16) ^ dict_wyhash_secret[2],
+                           dict_wyhash_secret[0]));
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+static inline bool dict_eq_sso(dict_sso_t a, dict_sso_t b) {
+    if (!dict_sso_is_heap(&a)) {
+        const uint8_t *pa = (const uint8_t*)a.buf, *pb = (const uint8_t*)b.buf;
+        return ((dict_wyr8(pa) ^ dict_wyr8(pb)) | (dict_wyr8(pa + 8) ^ dict_wyr8(pb + 8)) |
+                (dict_wyr8(pa + 16) ^ dict_wyr8(pb + 16))) == 0;
+    }
+    return dict_sso_is_heap(&b) && a.heap.len == b.heap.len &&
+           memcmp(a.heap.ptr, b.heap.ptr, a.heap.len) == 0;
+}
+
+static inline dict_sso_t dict_copy_sso(dict_sso_t k) {
+    if (dict_sso_is_heap(&k)) {
+        char *copy = (char*)malloc(k.heap.len + 1);
+        if (copy) {
+            memcpy(copy, k.heap.ptr, k.heap.len);
+            copy[k.heap.len] = '\0';
+        }
+        k.heap.ptr = copy;
+    }
+    return k;
+}
+
+static inline void dict_free_sso(dict_sso_t k) {
+    if (dict_sso_is_heap(&k)) free((void*)k.heap.ptr);
+}
+
 // ============================================================================
 // Key Comparison Functions
 // ============================================================================
@@ -135,39 +469,419 @@ static inline void dict_free_str(char *s) {
 #define dict_copy_val(x) (x)
 #define dict_free_val(x) ((void)0)
 
+// Bytes owned by a copied key, for NAME##_memory_usage (0 for value keys)
+static inline size_t dict_owned_str_bytes(char *const *key) {
+    return *key ? strlen(*key) + 1 : 0;
+}
+
+static inline size_t dict_owned_strlen_bytes(const dict_strlen_t *key) {
+    return key->ptr ? key->len + 1 : 0;
+}
+
+static inline size_t dict_owned_sso_bytes(const dict_sso_t *key) {
+    return dict_sso_is_heap(key) && key->heap.ptr ? key->heap.len + 1 : 0;
+}
+
+static inline size_t dict_owned_no_bytes(const void *key) {
+    (void)key;
+    return 0;
+}
+
+#define dict_owned_key_bytes(key_ptr) _Generic(*(key_ptr), \
+    char*: dict_owned_str_bytes, \
+    dict_strlen_t: dict_owned_strlen_bytes, \
+    dict_sso_t: dict_owned_sso_bytes, \
+    default: dict_owned_no_bytes)(key_ptr)
+
+// ============================================================================
+// Key Arena - bump allocator for dictionary-owned keys
+// ============================================================================
+//
+// Keys are packed into large chunks instead of one malloc block each, so
+// they stay close together in memory and the whole arena is released in
+// one pass over the chunk list. Removed keys are not reclaimed until the
+// arena is released (_clear/_destroy).
+
+#ifndef DICT_ARENA_CHUNK_SIZE
+#define DICT_ARENA_CHUNK_SIZE (256 * 1024)
+#endif
+
+typedef struct dict_arena_chunk {
+    struct dict_arena_chunk *next;
+    size_t used;
+    size_t size;
+    char data[];
+} dict_arena_chunk;
+
+typedef struct {
+    dict_arena_chunk *head;
+    size_t bytes;  // total chunk bytes allocated
+} dict_arena;
+
+static inline void* dict_arena_alloc(dict_arena *arena, size_t n) {
+    dict_arena_chunk *chunk = arena->head;
+    if (!chunk || chunk->size - chunk->used < n) {
+        size_t size = n > DICT_ARENA_CHUNK_SIZE ? n : DICT_ARENA_CHUNK_SIZE;
+        chunk = (dict_arena_chunk*)DICT_MALLOC(sizeof(dict_arena_chunk) + size, DICT_ALLOC_CTX);
+        if (!chunk) return NULL;
+        chunk->next = arena->head;
+        chunk->used = 0;
+        chunk->size = size;
+        arena->head = chunk;
+        arena->bytes += size;
+    }
+    void *p = chunk->data + chunk->used;
+    chunk->used += n;
+    return p;
+}
+
+static inline void dict_arena_release(dict_arena *arena) {
+    dict_arena_chunk *chunk = arena->head;
+    while (chunk) {
+        dict_arena_chunk *next = chunk->next;
+        DICT_FREE(chunk, sizeof(dict_arena_chunk) + chunk->size, DICT_ALLOC_CTX);
+        chunk = next;
+    }
+    arena->head = NULL;
+    arena->bytes = 0;
+}
+
+static inline char* dict_arena_copy_str(dict_arena *arena, const char *s) {
+    size_t n = strlen(s) + 1;
+    char *copy = (char*)dict_arena_alloc(arena, n);
+    if (copy) memcpy(copy, s, n);
+    return copy;
+}
+
+static inline dict_strlen_t dict_arena_copy_strlen(dict_arena *arena, dict_strlen_t k) {
+    char *copy = (char*)dict_arena_alloc(arena, k.len + 1);
+    if (copy) {
+        memcpy(copy, k.ptr, k.len);
+        copy[k.len] = '\0';
+    }
+    k.ptr = copy;
+    return k;
+}
+
+// ============================================================================
+// Snapshots - flat on-disk tables that can be mmap'ed and queried directly
+// ============================================================================
+//
+// Layout: a 64-byte header followed by the raw entries array. Only valid for
+// key/value types without pointers, with a hash that is stable across runs,
+// on the same architecture (native endianness and struct layout).
+
+#define DICT_SNAPSHOT_VERSION 1
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DICT_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+
+typedef struct {
+    char magic[8];          // "DICTSNAP"
+    uint32_t version;
+    uint32_t entry_size;
+    uint64_t type_hash;     // key/value/hash function names, see DICT_DEFINE_SNAPSHOT
+    uint64_t capacity;
+    uint64_t size;
+    uint8_t reserved[24];
+} dict_snapshot_header;
+
+static inline bool dict_snapshot_valid(const dict_snapshot_header *h, size_t entry_size,
+                                       uint64_t type_hash, uint64_t file_size) {
+    return memcmp(h->magic, "DICTSNAP", 8) == 0 &&
+           h->version == DICT_SNAPSHOT_VERSION &&
+           h->entry_size == entry_size &&
+           h->type_hash == type_hash &&
+           h->capacity > 0 && h->size <= h->capacity &&
+           h->capacity <= (file_size - sizeof(*h)) / entry_size &&
+           file_size == sizeof(*h) + h->capacity * entry_size;
+}
+
+#ifdef DICT_HAVE_MMAP
+#define DICT_OPEN_MAPPED_BODY_(NAME) \
+    int fd = open(path, O_RDONLY); \
+    if (fd < 0) return NULL; \
+    struct stat st; \
+    void *map = MAP_FAILED; \
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(dict_snapshot_header)) \
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0); \
+    close(fd); \
+    if (map == MAP_FAILED) return NULL; \
+    const dict_snapshot_header *h = (const dict_snapshot_header*)map; \
+    NAME *dict = NULL; \
+    if (dict_snapshot_valid(h, sizeof(NAME##_Entry), NAME##_type_hash(), (uint64_t)st.st_size)) \
+        dict = (NAME*)DICT_MALLOC(sizeof(NAME), DICT_ALLOC_CTX); \
+    if (!dict) { \
+        munmap(map, (size_t)st.st_size); \
+        return NULL; \
+    } \
+    memset(dict, 0, sizeof(NAME)); \
+    dict->entries = (NAME##_Entry*)((char*)map + sizeof(dict_snapshot_header)); \
+    dict->capacity = (size_t)h->capacity; \
+    dict->size = (size_t)h->size; \
+    dict->mapping = map; \
+    dict->mapping_size = (size_t)st.st_size; \
+    return dict;
+#define DICT_UNMAP_BODY_(NAME) \
+    munmap(dict->mapping, dict->mapping_size); \
+    DICT_FREE(dict, sizeof(NAME), DICT_ALLOC_CTX);
+#else
+#define DICT_OPEN_MAPPED_BODY_(NAME) \
+    (void)path; \
+    return NULL;
+#define DICT_UNMAP_BODY_(NAME) \
+    DICT_FREE(dict, sizeof(NAME), DICT_ALLOC_CTX);
+#endif
+
+// ============================================================================
+// Entry array allocation
+// ============================================================================
+//
+// Arrays come back zeroed, which is an empty table for every variant here,
+// so there is no initialisation pass. With huge set, arrays of at least
+// DICT_HUGE_PAGE_MIN bytes are private anonymous mappings (zero-filled by the
+// kernel, untouched pages cost nothing) aligned to 2 MB and madvise'd for
+// transparent huge pages; define DICT_USE_HUGETLB to try MAP_HUGETLB first
+// (needs pages reserved in /proc/sys/vm/nr_hugepages). Whether an array is
+// mapped depends only on (bytes, huge), so the free call must pass the same.
+
+#define DICT_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+#if defined(DICT_HAVE_MMAP) && !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+static inline bool dict_table_huge(size_t bytes, bool huge) {
+#ifdef DICT_HAVE_MMAP
+    return huge && bytes >= DICT_HUGE_PAGE_MIN;
+#else
+    (void)bytes;
+    (void)huge;
+    return false;
+#endif
+}
+
+static inline void* dict_table_alloc(size_t bytes, bool huge) {
+#ifdef DICT_HAVE_MMAP
+    if (dict_table_huge(bytes, huge)) {
+        size_t len = (bytes + DICT_HUGE_PAGE_SIZE - 1) & ~(DICT_HUGE_PAGE_SIZE - 1);
+#if defined(DICT_USE_HUGETLB) && defined(MAP_HUGETLB)
+        void *direct = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (direct != MAP_FAILED) return direct;
+#endif
+        // Over-map by one huge page and trim, so the array starts 2 MB aligned
+        char *raw = (char*)mmap(NULL, len + DICT_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == (char*)MAP_FAILED) return NULL;
+        char *start = (char*)(((uintptr_t)raw + DICT_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(DICT_HUGE_PAGE_SIZE - 1));
+        if (start > raw) munmap(raw, (size_t)(start - raw));
+        size_t tail = (size_t)(raw + len + DICT_HUGE_PAGE_SIZE - (start + len));
+        if (tail) munmap(start + len, tail);
+#ifdef MADV_HUGEPAGE
+        madvise(start, len, MADV_HUGEPAGE);
+#endif
+        return start;
+    }
+#endif
+    (void)huge;
+    return DICT_CALLOC(1, bytes, DICT_ALLOC_CTX);
+}
+
+static inline void dict_table_free(void *ptr, size_t bytes, bool huge) {
+    if (!ptr) return;
+#ifdef DICT_HAVE_MMAP
+    if (dict_table_huge(bytes, huge)) {
+        munmap(ptr, (bytes + DICT_HUGE_PAGE_SIZE - 1) & ~(DICT_HUGE_PAGE_SIZE - 1));
+        return;
+    }
+#endif
+    (void)huge;
+    DICT_FREE(ptr, bytes, DICT_ALLOC_CTX);
+}
+
+// ============================================================================
+// Parallel bulk construction
+// ============================================================================
+//
+// NAME##_build_from radix-partitions its input by home slot: partition p
+// owns a contiguous range of the entry array, so each worker fills its own
+// ranges with no locking and the random writes stay inside one range at a
+// time. Entries whose probe runs past the end of their range are collected
+// and placed on the calling thread once the workers are done.
+
+#define DICT_BUILD_MAX_THREADS 64
+#define DICT_BUILD_MAX_PARTS 4096
+
+// Partition of a hash whose home slot is hash % capacity, and its first slot
+static inline size_t dict_build_part(uint32_t hash, size_t capacity, size_t parts) {
+    return (size_t)((uint64_t)(hash % capacity) * parts / capacity);
+}
+
+static inline size_t dict_build_part_start(size_t part, size_t capacity, size_t parts) {
+    return (size_t)(((uint64_t)part * capacity + parts - 1) / parts);
+}
+
+// Runs fn on each of the nthreads tasks (task i at args + i * task_size),
+// task 0 on the calling thread; a task whose thread fails to start runs inline
+static inline void dict_run_parallel(void *(*fn)(void*), void *args, size_t task_size, int nthreads) {
+#if DICT_THREADS
+    pthread_t threads[DICT_BUILD_MAX_THREADS];
+    bool started[DICT_BUILD_MAX_THREADS];
+    for (int i = 1; i < nthreads; i++) {
+        started[i] = pthread_create(&threads[i], NULL, fn, (char*)args + i * task_size) == 0;
+        if (!started[i]) fn((char*)args + i * task_size);
+    }
+    fn(args);
+    for (int i = 1; i < nthreads; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+#else
+    for (int i = 0; i < nthreads; i++) fn((char*)args + i * task_size);
+#endif
+}
+
 // ============================================================================
 // DICT_DEFINE macro - generates type-specific dictionary
 // ============================================================================
+//
+// A dictionary is generated from three parts: the types, a key storage
+// policy (how keys are copied into and released from the table) and the
+// Robin Hood operations, which only go through the policy functions.
 
 #define DICT_DEFINE(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+    DICT_DEFINE_TYPES_(NAME, KEY_TYPE, VALUE_TYPE) \
+    DICT_KEYS_HEAP_(NAME, KEY_TYPE, COPY_KEY_FN, FREE_KEY_FN) \
+    DICT_DEFINE_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN)
+
+// Arena-backed key storage: ARENA_COPY_FN(dict_arena*, key) copies the key
+// into the dict's arena (dict_arena_copy_str, dict_arena_copy_strlen).
+// Keys are never freed one by one; _clear and _destroy drop the arena.
+#define DICT_DEFINE_ARENA(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, ARENA_COPY_FN) \
+    DICT_DEFINE_TYPES_(NAME, KEY_TYPE, VALUE_TYPE) \
+    DICT_KEYS_ARENA_(NAME, KEY_TYPE, ARENA_COPY_FN) \
+    DICT_DEFINE_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN)
+
+#define DICT_DEFINE_TYPES_(NAME, KEY_TYPE, VALUE_TYPE) \
+\
+/* Named key/value types, so const applies to the element in batch APIs */ \
+typedef KEY_TYPE NAME##_Key; \
+typedef VALUE_TYPE NAME##_Value; \
+\
+/* Callback for NAME##_upsert */ \
+typedef void (*NAME##_UpsertFn)(VALUE_TYPE *value, bool inserted, void *ctx); \
 \
 typedef struct { \
     KEY_TYPE key; \
     VALUE_TYPE value; \
     uint32_t hash; \
-    int psl; \
+    int dist;  /* probe distance + 1, 0 = empty slot */ \
 } NAME##_Entry; \
 \
 typedef struct { \
     NAME##_Entry *entries; \
     size_t capacity; \
     size_t size; \
+    NAME##_Entry *old_entries;  /* table being drained by an incremental resize */ \
+    size_t old_capacity; \
+    size_t rehash_pos; \
+    size_t rehash_step; \
+    double max_load;  /* grow when size / capacity would exceed this */ \
+    dict_arena arena; \
+    void *mapping;  /* non-NULL for read-only tables from _open_mapped */ \
+    size_t mapping_size; \
+    bool huge_pages;  /* entry arrays allocated with dict_table_alloc(.., true) */ \
 } NAME; \
 \
 typedef struct { \
     NAME *dict; \
     size_t index; \
-} NAME##_Iterator; \
+} NAME##_Iterator;
+
+// Each key policy provides copy/free of a single key, a release hook for
+// all keys at once, and whether keys must be freed individually.
+#define DICT_KEYS_HEAP_(NAME, KEY_TYPE, COPY_KEY_FN, FREE_KEY_FN) \
+\
+static inline KEY_TYPE NAME##_copy_key(NAME *dict, KEY_TYPE key) { \
+    (void)dict; \
+    return COPY_KEY_FN(key); \
+} \
+\
+static inline void NAME##_free_key(NAME *dict, KEY_TYPE key) { \
+    (void)dict; \
+    (void)key; \
+    FREE_KEY_FN(key); \
+} \
+\
+static inline void NAME##_release_keys(NAME *dict) { \
+    (void)dict; \
+} \
+\
+static inline bool NAME##_frees_keys(void) { \
+    return true; \
+} \
+\
+static inline size_t NAME##_key_bytes(NAME *dict) { \
+    size_t bytes = 0; \
+    for (size_t i = 0; i < dict->capacity; i++) { \
+        if (dict->entries[i].dist) bytes += dict_owned_key_bytes(&dict->entries[i].key); \
+    } \
+    for (size_t i = 0; i < dict->old_capacity; i++) { \
+        if (dict->old_entries[i].dist) bytes += dict_owned_key_bytes(&dict->old_entries[i].key); \
+    } \
+    return bytes; \
+}
+
+#define DICT_KEYS_ARENA_(NAME, KEY_TYPE, ARENA_COPY_FN) \
+\
+static inline KEY_TYPE NAME##_copy_key(NAME *dict, KEY_TYPE key) { \
+    return ARENA_COPY_FN(&dict->arena, key); \
+} \
+\
+static inline void NAME##_free_key(NAME *dict, KEY_TYPE key) { \
+    (void)dict; \
+    (void)key; \
+} \
+\
+static inline void NAME##_release_keys(NAME *dict) { \
+    dict_arena_release(&dict->arena); \
+} \
+\
+static inline bool NAME##_frees_keys(void) { \
+    return false; \
+} \
+\
+static inline size_t NAME##_key_bytes(NAME *dict) { \
+    return dict->arena.bytes; \
+}
+
+#define DICT_DEFINE_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN) \
 \
 static inline NAME* NAME##_create_with_capacity(size_t capacity) { \
-    NAME *dict = (NAME*)malloc(sizeof(NAME)); \
+    NAME *dict = (NAME*)DICT_MALLOC(sizeof(NAME), DICT_ALLOC_CTX); \
     if (!dict) return NULL; \
-    dict->entries = (NAME##_Entry*)calloc(capacity, sizeof(NAME##_Entry)); \
-    if (!dict->entries) { free(dict); return NULL; } \
+    /* dist == 0 marks an empty slot, so zeroed memory is an empty table */ \
+    dict->entries = (NAME##_Entry*)dict_table_alloc(capacity * sizeof(NAME##_Entry), false); \
+    if (!dict->entries) { DICT_FREE(dict, sizeof(NAME), DICT_ALLOC_CTX); return NULL; } \
     dict->capacity = capacity; \
     dict->size = 0; \
-    for (size_t i = 0; i < capacity; i++) \
-        dict->entries[i].psl = -1; \
+    dict->old_entries = NULL; \
+    dict->old_capacity = 0; \
+    dict->rehash_pos = 0; \
+    dict->rehash_step = 0; \
+    dict->max_load = DICT_LOAD_FACTOR; \
+    dict->arena.head = NULL; \
+    dict->arena.bytes = 0; \
+    dict->mapping = NULL; \
+    dict->mapping_size = 0; \
+    dict->huge_pages = false; \
     return dict; \
 } \
 \
@@ -175,165 +889,1801 @@ static inline NAME* NAME##_create(void) { \
     return NAME##_create_with_capacity(DICT_INITIAL_CAPACITY); \
 } \
 \
+static inline void NAME##_unmap(NAME *dict); \
+\
+static inline NAME##_Entry* NAME##_alloc_entries(NAME *dict, size_t capacity) { \
+    return (NAME##_Entry*)dict_table_alloc(capacity * sizeof(NAME##_Entry), dict->huge_pages); \
+} \
+\
+static inline void NAME##_free_entries(NAME *dict, NAME##_Entry *entries, size_t capacity) { \
+    dict_table_free(entries, capacity * sizeof(NAME##_Entry), dict->huge_pages); \
+} \
+\
 static inline void NAME##_destroy(NAME *dict) { \
     if (!dict) return; \
-    for (size_t i = 0; i < dict->capacity; i++) { \
-        if (dict->entries[i].psl >= 0) { \
-            FREE_KEY_FN(dict->entries[i].key); \
+    if (dict->mapping) { \
+        NAME##_unmap(dict); \
+        return; \
+    } \
+    if (NAME##_frees_keys()) { \
+        for (size_t i = 0; i < dict->capacity; i++) { \
+            if (dict->entries[i].dist) { \
+                NAME##_free_key(dict, dict->entries[i].key); \
+            } \
+        } \
+        for (size_t i = 0; i < dict->old_capacity; i++) { \
+            if (dict->old_entries[i].dist) { \
+                NAME##_free_key(dict, dict->old_entries[i].key); \
+            } \
         } \
     } \
-    free(dict->entries); \
-    free(dict); \
+    NAME##_release_keys(dict); \
+    NAME##_free_entries(dict, dict->old_entries, dict->old_capacity); \
+    NAME##_free_entries(dict, dict->entries, dict->capacity); \
+    DICT_FREE(dict, sizeof(NAME), DICT_ALLOC_CTX); \
 } \
 \
-static inline void NAME##_resize(NAME *dict, size_t new_capacity) { \
+/* Robin Hood insert of an entry whose key is known to be absent */ \
+static inline void NAME##_place(NAME##_Entry *entries, size_t capacity, NAME##_Entry entry) { \
+    size_t idx = entry.hash % capacity; \
+    entry.dist = 1; \
+    for (size_t j = 0; j < capacity; j++) { \
+        size_t probe = (idx + j) % capacity; \
+        if (!entries[probe].dist) { \
+            entries[probe] = entry; \
+            return; \
+        } \
+        if (entry.dist > entries[probe].dist) { \
+            NAME##_Entry tmp = entries[probe]; \
+            entries[probe] = entry; \
+            entry = tmp; \
+        } \
+        entry.dist++; \
+    } \
+} \
+\
+/* Backward shift deletion of the entry at probe */ \
+static inline void NAME##_erase_at(NAME##_Entry *entries, size_t capacity, size_t probe) { \
+    entries[probe].dist = 0; \
+    size_t empty = probe; \
+    for (size_t j = 1; j < capacity; j++) { \
+        size_t next = (probe + j) % capacity; \
+        if (entries[next].dist <= 1) break; \
+        entries[empty] = entries[next]; \
+        entries[empty].dist--; \
+        entries[next].dist = 0; \
+        empty = next; \
+    } \
+} \
+\
+static inline size_t NAME##_find_in(NAME##_Entry *entries, size_t capacity, KEY_TYPE key, uint32_t hash) { \
+    size_t idx = hash % capacity; \
+    for (int dist = 1; dist <= (int)capacity; dist++) { \
+        size_t probe = (idx + dist - 1) % capacity; \
+        if (entries[probe].dist < dist) \
+            return SIZE_MAX; \
+        if (entries[probe].hash == hash && \
+            EQ_FN(entries[probe].key, key)) \
+            return probe; \
+    } \
+    return SIZE_MAX; \
+} \
+\
+/* Move up to max_work old slots into the new table (incremental resize). */ \
+/* Slots below rehash_pos are empty; draining a slot with backward shift */ \
+/* keeps the rest of the old table a valid Robin Hood table for lookups. */ \
+static inline void NAME##_rehash_some(NAME *dict, size_t max_work) { \
+    if (!dict->old_entries) return; \
+    while (max_work-- > 0 && dict->rehash_pos < dict->old_capacity) { \
+        size_t pos = dict->rehash_pos; \
+        if (dict->old_entries[pos].dist) { \
+            NAME##_place(dict->entries, dict->capacity, dict->old_entries[pos]); \
+            NAME##_erase_at(dict->old_entries, dict->old_capacity, pos); \
+        } else { \
+            dict->rehash_pos++; \
+        } \
+    } \
+    if (dict->rehash_pos >= dict->old_capacity) { \
+        NAME##_free_entries(dict, dict->old_entries, dict->old_capacity); \
+        dict->old_entries = NULL; \
+        dict->old_capacity = 0; \
+        dict->rehash_pos = 0; \
+    } \
+} \
+\
+/* Entries per operation moved while an incremental resize is running; */ \
+/* 0 (the default) resizes the whole table inside the triggering _set. */ \
+static inline void NAME##_set_rehash_step(NAME *dict, size_t step) { \
+    if (dict) dict->rehash_step = step; \
+} \
+\
+static inline bool NAME##_rehashing(NAME *dict) { \
+    return dict && dict->old_entries != NULL; \
+} \
+\
+/* incremental: leave the old table to be drained by later operations */ \
+static inline void NAME##_resize_to(NAME *dict, size_t new_capacity, bool incremental) { \
+    if (dict->mapping || new_capacity <= dict->size) return; \
+    NAME##_rehash_some(dict, SIZE_MAX); \
+    NAME##_Entry *new_entries = NAME##_alloc_entries(dict, new_capacity); \
+    if (!new_entries) return; \
     NAME##_Entry *old_entries = dict->entries; \
     size_t old_capacity = dict->capacity; \
-    dict->entries = (NAME##_Entry*)calloc(new_capacity, sizeof(NAME##_Entry)); \
+    dict->entries = new_entries; \
     dict->capacity = new_capacity; \
-    dict->size = 0; \
-    for (size_t i = 0; i < new_capacity; i++) \
-        dict->entries[i].psl = -1; \
+    if (incremental) { \
+        dict->old_entries = old_entries; \
+        dict->old_capacity = old_capacity; \
+        dict->rehash_pos = 0; \
+        return; \
+    } \
     for (size_t i = 0; i < old_capacity; i++) { \
-        if (old_entries[i].psl >= 0) { \
-            uint32_t hash = old_entries[i].hash; \
-            size_t idx = hash % dict->capacity; \
-            NAME##_Entry entry = old_entries[i]; \
-            entry.psl = 0; \
-            for (size_t j = 0; j < dict->capacity; j++) { \
-                size_t probe = (idx + j) % dict->capacity; \
-                if (dict->entries[probe].psl < 0) { \
-                    dict->entries[probe] = entry; \
-                    dict->size++; \
-                    break; \
-                } \
-                if (entry.psl > dict->entries[probe].psl) { \
-                    NAME##_Entry tmp = dict->entries[probe]; \
-                    dict->entries[probe] = entry; \
-                    entry = tmp; \
-                } \
-                entry.psl++; \
-            } \
-        } \
+        if (old_entries[i].dist) \
+            NAME##_place(dict->entries, dict->capacity, old_entries[i]); \
     } \
-    free(old_entries); \
+    NAME##_free_entries(dict, old_entries, old_capacity); \
 } \
 \
-static inline bool NAME##_set(NAME *dict, KEY_TYPE key, VALUE_TYPE value) { \
-    if (!dict) return false; \
-    if ((double)(dict->size + 1) / dict->capacity > DICT_LOAD_FACTOR) { \
-        NAME##_resize(dict, dict->capacity * 2); \
+static inline void NAME##_resize(NAME *dict, size_t new_capacity) { \
+    if (dict) NAME##_resize_to(dict, new_capacity, false); \
+} \
+\
+/* Moves the entries to huge-page backed arrays (or back); later resizes */ \
+/* keep the mode. Only arrays of at least DICT_HUGE_PAGE_MIN are mapped. */ \
+static inline bool NAME##_set_huge_pages(NAME *dict, bool on) { \
+    if (!dict || dict->mapping) return false; \
+    if (dict->huge_pages == on) return true; \
+    NAME##_rehash_some(dict, SIZE_MAX); \
+    size_t bytes = dict->capacity * sizeof(NAME##_Entry); \
+    NAME##_Entry *entries = (NAME##_Entry*)dict_table_alloc(bytes, on); \
+    if (!entries) return false; \
+    memcpy(entries, dict->entries, bytes); \
+    NAME##_free_entries(dict, dict->entries, dict->capacity); \
+    dict->entries = entries; \
+    dict->huge_pages = on; \
+    return true; \
+} \
+\
+/* Per-instance load factor threshold (default DICT_LOAD_FACTOR) */ \
+static inline void NAME##_set_max_load(NAME *dict, double max_load) { \
+    if (dict && max_load > 0.0 && max_load < 1.0) dict->max_load = max_load; \
+} \
+\
+/* Capacity needed to hold n entries without growing */ \
+static inline size_t NAME##_capacity_for(NAME *dict, size_t n) { \
+    size_t capacity = (size_t)((double)n / dict->max_load) + 1; \
+    return capacity < DICT_INITIAL_CAPACITY ? DICT_INITIAL_CAPACITY : capacity; \
+} \
+\
+/* Grows once so that n entries fit; never shrinks */ \
+static inline void NAME##_reserve(NAME *dict, size_t n) { \
+    if (!dict) return; \
+    size_t capacity = NAME##_capacity_for(dict, n); \
+    if (capacity > dict->capacity) NAME##_resize_to(dict, capacity, false); \
+} \
+\
+/* Reallocates to the smallest capacity that holds the current entries */ \
+static inline void NAME##_shrink_to_fit(NAME *dict) { \
+    if (!dict) return; \
+    NAME##_rehash_some(dict, SIZE_MAX); \
+    size_t capacity = NAME##_capacity_for(dict, dict->size); \
+    if (capacity < dict->capacity) NAME##_resize_to(dict, capacity, false); \
+} \
+\
+/* Handle + entry arrays + bytes owned by copied keys (O(capacity) for */ \
+/* heap-copied keys, which are measured one by one) */ \
+static inline size_t NAME##_memory_usage(NAME *dict) { \
+    if (!dict) return 0; \
+    if (dict->mapping) return sizeof(NAME) + dict->mapping_size; \
+    return sizeof(NAME) + (dict->capacity + dict->old_capacity) * sizeof(NAME##_Entry) + \
+           NAME##_key_bytes(dict); \
+} \
+\
+/* Single probe for insert-or-update: returns the value slot for key, */ \
+/* claiming one initialised to init (and copying the key) if it is new. */ \
+/* The pointer is valid until the next call that may move entries. */ \
+static inline VALUE_TYPE* NAME##_slot_hashed(NAME *dict, KEY_TYPE key, uint32_t hash, \
+                                             VALUE_TYPE init, bool *inserted) { \
+    *inserted = false; \
+    if (dict->mapping) return NULL; \
+    if (dict->old_entries) \
+        NAME##_rehash_some(dict, dict->rehash_step); \
+    /* Grow before looking in the old table: an incremental resize moves */ \
+    /* every entry, this key included, into a new old_entries */ \
+    if ((double)(dict->size + 1) / dict->capacity > dict->max_load) { \
+        NAME##_resize_to(dict, dict->capacity * 2, dict->rehash_step != 0); \
+    } \
+    if (dict->old_entries) { \
+        size_t old = NAME##_find_in(dict->old_entries, dict->old_capacity, key, hash); \
+        if (old != SIZE_MAX) \
+            return &dict->old_entries[old].value; \
     } \
-    uint32_t hash = HASH_FN(key); \
     size_t idx = hash % dict->capacity; \
     NAME##_Entry entry; \
-    entry.key = COPY_KEY_FN(key); \
-    entry.value = value; \
+    entry.key = key; \
+    entry.value = init; \
     entry.hash = hash; \
-    entry.psl = 0; \
+    entry.dist = 1; \
+    /* The caller's key is only copied once it actually gets a slot */ \
+    size_t home = SIZE_MAX; \
     for (size_t i = 0; i < dict->capacity; i++) { \
         size_t probe = (idx + i) % dict->capacity; \
-        if (dict->entries[probe].psl < 0) { \
+        if (!dict->entries[probe].dist) { \
+            if (home == SIZE_MAX) { \
+                entry.key = NAME##_copy_key(dict, key); \
+                home = probe; \
+            } \
             dict->entries[probe] = entry; \
             dict->size++; \
-            return true; \
-        } \
-        if (dict->entries[probe].hash == hash && \
-            EQ_FN(dict->entries[probe].key, key)) { \
-            dict->entries[probe].value = value; \
-            FREE_KEY_FN(entry.key); \
-            return false; \
+            *inserted = true; \
+            return &dict->entries[home].value; \
         } \
-        if (entry.psl > dict->entries[probe].psl) { \
+        if (home == SIZE_MAX && dict->entries[probe].hash == hash && \
+            EQ_FN(dict->entries[probe].key, key)) \
+            return &dict->entries[probe].value; \
+        if (entry.dist > dict->entries[probe].dist) { \
+            if (home == SIZE_MAX) { \
+                entry.key = NAME##_copy_key(dict, key); \
+                home = probe; \
+            } \
             NAME##_Entry tmp = dict->entries[probe]; \
             dict->entries[probe] = entry; \
             entry = tmp; \
         } \
-        entry.psl++; \
+        entry.dist++; \
     } \
-    FREE_KEY_FN(entry.key); \
-    return false; \
+    if (home != SIZE_MAX) NAME##_free_key(dict, entry.key); \
+    return NULL; \
 } \
 \
-static inline VALUE_TYPE NAME##_get(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
-    if (!dict) return default_val; \
-    uint32_t hash = HASH_FN(key); \
-    size_t idx = hash % dict->capacity; \
-    for (int psl = 0; psl < (int)dict->capacity; psl++) { \
-        size_t probe = (idx + psl) % dict->capacity; \
-        if (dict->entries[probe].psl < 0 || dict->entries[probe].psl < psl) \
-            return default_val; \
-        if (dict->entries[probe].hash == hash && \
-            EQ_FN(dict->entries[probe].key, key)) \
-            return dict->entries[probe].value; \
-    } \
-    return default_val; \
+static inline bool NAME##_set_hashed(NAME *dict, KEY_TYPE key, uint32_t hash, VALUE_TYPE value) { \
+    bool inserted; \
+    VALUE_TYPE *slot = NAME##_slot_hashed(dict, key, hash, value, &inserted); \
+    if (slot && !inserted) *slot = value; \
+    return inserted; \
+} \
+\
+static inline bool NAME##_set(NAME *dict, KEY_TYPE key, VALUE_TYPE value) { \
+    if (!dict) return false; \
+    return NAME##_set_hashed(dict, key, HASH_FN(key), value); \
+} \
+\
+/* Returns the value for key, inserting default_val first if it is absent */ \
+static inline VALUE_TYPE* NAME##_get_or_insert(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    if (!dict) return NULL; \
+    bool inserted; \
+    return NAME##_slot_hashed(dict, key, HASH_FN(key), default_val, &inserted); \
+} \
+\
+/* Calls fn on the value for key in place; a new key starts zeroed and */ \
+/* fn sees inserted == true. Returns whether the key was inserted. */ \
+static inline bool NAME##_upsert(NAME *dict, KEY_TYPE key, NAME##_UpsertFn fn, void *ctx) { \
+    if (!dict) return false; \
+    VALUE_TYPE zero; \
+    memset(&zero, 0, sizeof(zero)); \
+    bool inserted; \
+    VALUE_TYPE *slot = NAME##_slot_hashed(dict, key, HASH_FN(key), zero, &inserted); \
+    if (slot) fn(slot, inserted, ctx); \
+    return inserted; \
+} \
+\
+/* The hash stored in NAME##_Entry, for callers using the _hashed variants */ \
+static inline uint32_t NAME##_hash_key(KEY_TYPE key) { \
+    return HASH_FN(key); \
+} \
+\
+static inline VALUE_TYPE* NAME##_lookup(NAME *dict, KEY_TYPE key, uint32_t hash) { \
+    size_t idx = NAME##_find_in(dict->entries, dict->capacity, key, hash); \
+    if (idx != SIZE_MAX) \
+        return &dict->entries[idx].value; \
+    if (dict->old_entries) { \
+        idx = NAME##_find_in(dict->old_entries, dict->old_capacity, key, hash); \
+        if (idx != SIZE_MAX) \
+            return &dict->old_entries[idx].value; \
+    } \
+    return NULL; \
+} \
+\
+static inline VALUE_TYPE* NAME##_get_ptr(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return NULL; \
+    return NAME##_lookup(dict, key, HASH_FN(key)); \
+} \
+\
+static inline VALUE_TYPE NAME##_get(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    if (!dict) return default_val; \
+    if (dict->old_entries) \
+        NAME##_rehash_some(dict, dict->rehash_step); \
+    VALUE_TYPE *value = NAME##_get_ptr(dict, key); \
+    return value ? *value : default_val; \
+} \
+\
+static inline bool NAME##_contains(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return false; \
+    if (dict->old_entries) \
+        NAME##_rehash_some(dict, dict->rehash_step); \
+    return NAME##_get_ptr(dict, key) != NULL; \
+} \
+\
+/* Batched operations: hash a chunk of keys and prefetch every home slot */ \
+/* before resolving any of them, so the cache misses overlap */ \
+static inline void NAME##_prefetch_batch(NAME *dict, const NAME##_Key *keys, uint32_t *hashes, size_t n) { \
+    for (size_t i = 0; i < n; i++) { \
+        hashes[i] = HASH_FN(keys[i]); \
+        DICT_PREFETCH(&dict->entries[hashes[i] % dict->capacity]); \
+        if (dict->old_entries) \
+            DICT_PREFETCH(&dict->old_entries[hashes[i] % dict->old_capacity]); \
+    } \
+} \
+\
+static inline void NAME##_get_many(NAME *dict, const NAME##_Key *keys, size_t n, \
+                                   VALUE_TYPE *out_values, VALUE_TYPE default_val) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    for (size_t base = 0; base < n; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        if (!dict) { \
+            for (size_t i = 0; i < m; i++) out_values[base + i] = default_val; \
+            continue; \
+        } \
+        if (dict->old_entries) \
+            NAME##_rehash_some(dict, dict->rehash_step * m); \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) { \
+            VALUE_TYPE *value = NAME##_lookup(dict, keys[base + i], hashes[i]); \
+            out_values[base + i] = value ? *value : default_val; \
+        } \
+    } \
+} \
+\
+/* Returns the number of keys present; out may be NULL */ \
+static inline size_t NAME##_contains_many(NAME *dict, const NAME##_Key *keys, size_t n, bool *out) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    size_t found = 0; \
+    for (size_t base = 0; base < n && dict; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        if (dict->old_entries) \
+            NAME##_rehash_some(dict, dict->rehash_step * m); \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) { \
+            bool hit = NAME##_lookup(dict, keys[base + i], hashes[i]) != NULL; \
+            if (out) out[base + i] = hit; \
+            found += hit; \
+        } \
+    } \
+    if (!dict && out) memset(out, 0, n * sizeof(bool)); \
+    return found; \
+} \
+\
+/* Returns the number of keys that were newly inserted */ \
+static inline size_t NAME##_set_many(NAME *dict, const NAME##_Key *keys, const NAME##_Value *values, size_t n) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    size_t inserted = 0; \
+    for (size_t base = 0; base < n && dict; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        /* Grow up front so the prefetched slots are the ones written */ \
+        while ((double)(dict->size + m) / dict->capacity > dict->max_load) { \
+            size_t capacity = dict->capacity; \
+            NAME##_resize_to(dict, capacity * 2, dict->rehash_step != 0); \
+            if (dict->capacity == capacity) break; \
+        } \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) \
+            inserted += NAME##_set_hashed(dict, keys[base + i], hashes[i], values[base + i]); \
+    } \
+    return inserted; \
+} \
+\
+/* Worker state for NAME##_build_from */ \
+typedef struct { \
+    NAME *dict; \
+    const NAME##_Key *keys; \
+    const NAME##_Value *values; \
+    size_t lo, hi;            /* input range hashed and scattered by this task */ \
+    size_t part_lo, part_hi;  /* partitions inserted by this task */ \
+    size_t parts; \
+    size_t *counts;           /* per-partition counts, then scatter cursors */ \
+    const size_t *part_offsets; \
+    uint32_t *hashes;         /* hash of every input key */ \
+    NAME##_Entry *items;      /* input rows grouped by partition, keys copied */ \
+    NAME##_Entry *overflow;   /* entries carried past the end of a partition */ \
+    size_t overflow_size; \
+    size_t overflow_capacity; \
+    size_t filled;            /* empty slots claimed */ \
+    int phase; \
+    bool failed; \
+} NAME##_BuildTask; \
+\
+/* Robin Hood insert that stops at end (the partition's end): whatever */ \
+/* entry is carried past it lands in the task's overflow list */ \
+static inline void NAME##_build_insert(NAME##_BuildTask *task, size_t end, NAME##_Entry entry) { \
+    NAME##_Entry *entries = task->dict->entries; \
+    size_t probe = entry.hash % task->dict->capacity; \
+    entry.dist = 1; \
+    bool placed = false;  /* the new key is in the table, entry is a displaced one */ \
+    for (; probe < end; probe++) { \
+        if (!entries[probe].dist) { \
+            entries[probe] = entry; \
+            task->filled++; \
+            return; \
+        } \
+        if (!placed && entries[probe].hash == entry.hash && EQ_FN(entries[probe].key, entry.key)) { \
+            entries[probe].value = entry.value; \
+            NAME##_free_key(task->dict, entry.key); \
+            return; \
+        } \
+        if (entry.dist > entries[probe].dist) { \
+            placed = true; \
+            NAME##_Entry tmp = entries[probe]; \
+            entries[probe] = entry; \
+            entry = tmp; \
+        } \
+        entry.dist++; \
+    } \
+    /* A key still unplaced may also be in the overflow list; the final */ \
+    /* pass deduplicates in input order */ \
+    if (task->overflow_size == task->overflow_capacity) { \
+        size_t cap = task->overflow_capacity ? task->overflow_capacity * 2 : 64; \
+        NAME##_Entry *overflow = (NAME##_Entry*)realloc(task->overflow, cap * sizeof(NAME##_Entry)); \
+        if (!overflow) { \
+            NAME##_free_key(task->dict, entry.key); \
+            task->failed = true; \
+            return; \
+        } \
+        task->overflow = overflow; \
+        task->overflow_capacity = cap; \
+    } \
+    task->overflow[task->overflow_size++] = entry; \
+} \
+\
+static inline void* NAME##_build_worker(void *arg) { \
+    NAME##_BuildTask *task = (NAME##_BuildTask*)arg; \
+    size_t capacity = task->dict->capacity; \
+    if (task->phase == 0) { \
+        for (size_t i = task->lo; i < task->hi; i++) { \
+            task->hashes[i] = HASH_FN(task->keys[i]); \
+            task->counts[dict_build_part(task->hashes[i], capacity, task->parts)]++; \
+        } \
+    } else if (task->phase == 1) { \
+        /* Keys are copied here, while the input is read in order. Each */ \
+        /* task's chunk lands after the earlier chunks, so every partition */ \
+        /* lists its rows in input order. */ \
+        for (size_t i = task->lo; i < task->hi; i++) { \
+            uint32_t hash = task->hashes[i]; \
+            NAME##_Entry *item = &task->items[task->counts[dict_build_part(hash, capacity, task->parts)]++]; \
+            item->key = NAME##_copy_key(task->dict, task->keys[i]); \
+            item->value = task->values[i]; \
+            item->hash = hash; \
+        } \
+    } else { \
+        for (size_t p = task->part_lo; p < task->part_hi; p++) { \
+            size_t end = dict_build_part_start(p + 1, capacity, task->parts); \
+            for (size_t j = task->part_offsets[p]; j < task->part_offsets[p + 1]; j++) \
+                NAME##_build_insert(task, end, task->items[j]); \
+        } \
+    } \
+    return NULL; \
+} \
+\
+/* New table holding keys[i] -> values[i], sized for n entries up front. */ \
+/* A repeated key keeps its last value. Uses up to nthreads threads when */ \
+/* DICT_THREADS is on (arena keys are always copied on one thread). */ \
+static inline NAME* NAME##_build_from(const NAME##_Key *keys, const NAME##_Value *values, \
+                                      size_t n, int nthreads) { \
+    NAME *dict = NAME##_create_with_capacity(1); \
+    if (!dict) return NULL; \
+    size_t capacity = NAME##_capacity_for(dict, n); \
+    NAME##_Entry *entries = NAME##_alloc_entries(dict, capacity); \
+    if (!entries) { NAME##_destroy(dict); return NULL; } \
+    NAME##_free_entries(dict, dict->entries, dict->capacity); \
+    dict->entries = entries; \
+    dict->capacity = capacity; \
+    if (!DICT_THREADS || !NAME##_frees_keys() || nthreads < 1) nthreads = 1; \
+    if (nthreads > DICT_BUILD_MAX_THREADS) nthreads = DICT_BUILD_MAX_THREADS; \
+    size_t parts = capacity * sizeof(NAME##_Entry) / DICT_BUILD_PART_BYTES; \
+    if (parts > DICT_BUILD_MAX_PARTS) parts = DICT_BUILD_MAX_PARTS; \
+    if (parts < (size_t)nthreads) parts = (size_t)nthreads; \
+    if (parts > capacity) parts = capacity; \
+    if ((size_t)nthreads > parts) nthreads = (int)parts; \
+    \
+    NAME##_BuildTask tasks[DICT_BUILD_MAX_THREADS]; \
+    size_t *counts = (size_t*)calloc((size_t)nthreads * parts + parts + 1, sizeof(size_t)); \
+    uint32_t *hashes = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t)); \
+    NAME##_Entry *items = (NAME##_Entry*)malloc((n ? n : 1) * sizeof(NAME##_Entry)); \
+    if (!counts || !hashes || !items) { \
+        free(counts); \
+        free(hashes); \
+        free(items); \
+        NAME##_destroy(dict); \
+        return NULL; \
+    } \
+    size_t *part_offsets = counts + (size_t)nthreads * parts; \
+    for (int t = 0; t < nthreads; t++) { \
+        NAME##_BuildTask *task = &tasks[t]; \
+        memset(task, 0, sizeof(*task)); \
+        task->dict = dict; \
+        task->keys = keys; \
+        task->values = values; \
+        task->lo = n * (size_t)t / (size_t)nthreads; \
+        task->hi = n * (size_t)(t + 1) / (size_t)nthreads; \
+        task->part_lo = parts * (size_t)t / (size_t)nthreads; \
+        task->part_hi = parts * (size_t)(t + 1) / (size_t)nthreads; \
+        task->parts = parts; \
+        task->counts = counts + (size_t)t * parts; \
+        task->part_offsets = part_offsets; \
+        task->hashes = hashes; \
+        task->items = items; \
+    } \
+    /* Count, turn the counts into scatter cursors, scatter, insert */ \
+    dict_run_parallel(NAME##_build_worker, tasks, sizeof(NAME##_BuildTask), nthreads); \
+    size_t offset = 0; \
+    for (size_t p = 0; p < parts; p++) { \
+        part_offsets[p] = offset; \
+        for (int t = 0; t < nthreads; t++) { \
+            size_t count = tasks[t].counts[p]; \
+            tasks[t].counts[p] = offset; \
+            offset += count; \
+        } \
+    } \
+    part_offsets[parts] = offset; \
+    for (int t = 0; t < nthreads; t++) tasks[t].phase = 1; \
+    dict_run_parallel(NAME##_build_worker, tasks, sizeof(NAME##_BuildTask), nthreads); \
+    for (int t = 0; t < nthreads; t++) tasks[t].phase = 2; \
+    dict_run_parallel(NAME##_build_worker, tasks, sizeof(NAME##_BuildTask), nthreads); \
+    free(counts); \
+    free(hashes); \
+    free(items); \
+    \
+    bool failed = false; \
+    for (int t = 0; t < nthreads; t++) { \
+        NAME##_BuildTask *task = &tasks[t]; \
+        dict->size += task->filled; \
+        failed |= task->failed; \
+        for (size_t i = 0; i < task->overflow_size; i++) { \
+            NAME##_Entry *e = &task->overflow[i]; \
+            size_t idx = NAME##_find_in(dict->entries, dict->capacity, e->key, e->hash); \
+            if (idx != SIZE_MAX) { \
+                dict->entries[idx].value = e->value; \
+                NAME##_free_key(dict, e->key); \
+            } else { \
+                NAME##_place(dict->entries, dict->capacity, *e); \
+                dict->size++; \
+            } \
+        } \
+        free(task->overflow); \
+    } \
+    if (failed) { \
+        NAME##_destroy(dict); \
+        return NULL; \
+    } \
+    return dict; \
+} \
+\
+static inline bool NAME##_remove(NAME *dict, KEY_TYPE key) { \
+    if (!dict || dict->mapping) return false; \
+    uint32_t hash = HASH_FN(key); \
+    if (dict->old_entries) { \
+        NAME##_rehash_some(dict, dict->rehash_step); \
+        size_t old = dict->old_entries ? \
+            NAME##_find_in(dict->old_entries, dict->old_capacity, key, hash) : SIZE_MAX; \
+        if (old != SIZE_MAX) { \
+            NAME##_free_key(dict, dict->old_entries[old].key); \
+            NAME##_erase_at(dict->old_entries, dict->old_capacity, old); \
+            dict->size--; \
+            return true; \
+        } \
+    } \
+    size_t idx = NAME##_find_in(dict->entries, dict->capacity, key, hash); \
+    if (idx == SIZE_MAX) return false; \
+    NAME##_free_key(dict, dict->entries[idx].key); \
+    NAME##_erase_at(dict->entries, dict->capacity, idx); \
+    dict->size--; \
+    return true; \
+} \
+\
+static inline size_t NAME##_size(NAME *dict) { \
+    return dict ? dict->size : 0; \
+} \
+\
+static inline size_t NAME##_capacity(NAME *dict) { \
+    return dict ? dict->capacity : 0; \
+} \
+\
+static inline bool NAME##_empty(NAME *dict) { \
+    return !dict || dict->size == 0; \
+} \
+\
+static inline void NAME##_clear(NAME *dict) { \
+    if (!dict || dict->mapping) return; \
+    for (size_t i = 0; i < dict->capacity; i++) { \
+        if (dict->entries[i].dist) { \
+            NAME##_free_key(dict, dict->entries[i].key); \
+            dict->entries[i].dist = 0; \
+        } \
+    } \
+    for (size_t i = 0; i < dict->old_capacity; i++) { \
+        if (dict->old_entries[i].dist) { \
+            NAME##_free_key(dict, dict->old_entries[i].key); \
+        } \
+    } \
+    NAME##_free_entries(dict, dict->old_entries, dict->old_capacity); \
+    dict->old_entries = NULL; \
+    dict->old_capacity = 0; \
+    dict->rehash_pos = 0; \
+    NAME##_release_keys(dict); \
+    dict->size = 0; \
+} \
+\
+/* Iteration walks the new table, then the old one if a resize is running */ \
+static inline NAME##_Iterator NAME##_iter(NAME *dict) { \
+    NAME##_Iterator iter = {dict, 0}; \
+    return iter; \
+} \
+\
+static inline bool NAME##_next(NAME##_Iterator *iter, KEY_TYPE *key, VALUE_TYPE *value) { \
+    if (!iter || !iter->dict) return false; \
+    NAME *dict = iter->dict; \
+    while (iter->index < dict->capacity + dict->old_capacity) { \
+        NAME##_Entry *e = iter->index < dict->capacity ? \
+            &dict->entries[iter->index] : &dict->old_entries[iter->index - dict->capacity]; \
+        iter->index++; \
+        if (e->dist) { \
+            if (key) *key = e->key; \
+            if (value) *value = e->value; \
+            return true; \
+        } \
+    } \
+    return false; \
+} \
+\
+static inline void NAME##_unmap(NAME *dict) { \
+    DICT_UNMAP_BODY_(NAME) \
+}
+
+// ============================================================================
+// DICT_DEFINE_SNAPSHOT macro - DICT_DEFINE plus snapshot save/load/mmap
+// ============================================================================
+//
+// Snapshots write the entries array as is, so they are only generated for
+// tables whose keys and values are plain values: keys are stored by value
+// (no COPY/FREE functions), and a key or value type that holds a pointer
+// (char*, void*, dict_strlen_t, dict_sso_t) fails to compile.
+
+#define DICT_SNAPSHOT_PLAIN_(T) _Generic((T*)0, \
+    char**: 0, const char**: 0, void**: 0, const void**: 0, \
+    dict_strlen_t*: 0, dict_sso_t*: 0, default: 1)
+
+#define DICT_DEFINE_SNAPSHOT(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN) \
+    DICT_DEFINE(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, dict_copy_val, dict_free_val) \
+    DICT_SNAPSHOT_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN)
+
+#define DICT_SNAPSHOT_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN) \
+\
+_Static_assert(DICT_SNAPSHOT_PLAIN_(KEY_TYPE) && DICT_SNAPSHOT_PLAIN_(VALUE_TYPE), \
+               "DICT_DEFINE_SNAPSHOT needs key and value types without pointers"); \
+\
+static inline uint64_t NAME##_type_hash(void) { \
+    static const char desc[] = #KEY_TYPE "," #VALUE_TYPE "," #HASH_FN; \
+    return dict_wyhash(desc, sizeof(desc) - 1, sizeof(NAME##_Entry)); \
+} \
+\
+static inline void NAME##_snapshot_header(NAME *dict, dict_snapshot_header *h) { \
+    memset(h, 0, sizeof(*h)); \
+    memcpy(h->magic, "DICTSNAP", 8); \
+    h->version = DICT_SNAPSHOT_VERSION; \
+    h->entry_size = (uint32_t)sizeof(NAME##_Entry); \
+    h->type_hash = NAME##_type_hash(); \
+    h->capacity = dict->capacity; \
+    h->size = dict->size; \
+} \
+\
+static inline bool NAME##_save(NAME *dict, const char *path) { \
+    if (!dict) return false; \
+    NAME##_rehash_some(dict, SIZE_MAX); \
+    FILE *f = fopen(path, "wb"); \
+    if (!f) return false; \
+    dict_snapshot_header h; \
+    NAME##_snapshot_header(dict, &h); \
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && \
+              fwrite(dict->entries, sizeof(NAME##_Entry), dict->capacity, f) == dict->capacity; \
+    return fclose(f) == 0 && ok; \
+} \
+\
+/* read() + copy into a normal, writable table */ \
+static inline NAME* NAME##_load(const char *path) { \
+    FILE *f = fopen(path, "rb"); \
+    if (!f) return NULL; \
+    dict_snapshot_header h; \
+    NAME *dict = NULL; \
+    if (fread(&h, sizeof(h), 1, f) == 1 && fseek(f, 0, SEEK_END) == 0) { \
+        long file_size = ftell(f); \
+        if (file_size > 0 && (uint64_t)file_size >= sizeof(h) && \
+            dict_snapshot_valid(&h, sizeof(NAME##_Entry), NAME##_type_hash(), (uint64_t)file_size) && \
+            fseek(f, (long)sizeof(h), SEEK_SET) == 0) { \
+            dict = NAME##_create_with_capacity(1); \
+            NAME##_Entry *entries = dict ? NAME##_alloc_entries(dict, (size_t)h.capacity) : NULL; \
+            if (dict && entries && \
+                fread(entries, sizeof(NAME##_Entry), (size_t)h.capacity, f) == h.capacity) { \
+                NAME##_free_entries(dict, dict->entries, dict->capacity); \
+                dict->entries = entries; \
+                dict->capacity = (size_t)h.capacity; \
+                dict->size = (size_t)h.size; \
+            } else { \
+                if (dict) NAME##_free_entries(dict, entries, (size_t)h.capacity); \
+                NAME##_destroy(dict); \
+                dict = NULL; \
+            } \
+        } \
+    } \
+    fclose(f); \
+    return dict; \
+} \
+\
+/* Maps the file read-only; _get/_contains/_get_ptr/iteration work at once, */ \
+/* _set/_remove/_clear are refused. _destroy unmaps. */ \
+static inline NAME* NAME##_open_mapped(const char *path) { \
+    DICT_OPEN_MAPPED_BODY_(NAME) \
+}
+
+// ============================================================================
+// DICT_DEFINE_SWISS macro - Swiss table variant with SIMD group probing
+// ============================================================================
+//
+// Same API as DICT_DEFINE, different layout: a separate array of one-byte
+// control words sits next to the entries. A full slot stores a 7-bit hash
+// fingerprint (H2), so a lookup compares a whole group of slots with one
+// SIMD compare and only touches entries whose fingerprint matches. Groups
+// are 32 slots with AVX2, 16 with SSE2, 16 (byte loop) otherwise.
+// Capacity is always a power of two; max load is 7/8.
+
+#define DICT_SWISS_EMPTY   ((int8_t)-128)
+#define DICT_SWISS_DELETED ((int8_t)-2)
+
+#if defined(__AVX2__)
+
+#define DICT_SWISS_GROUP_WIDTH 32
+
+static inline uint32_t dict_swiss_match(const int8_t *group, int8_t h2) {
+    __m256i ctrl = _mm256_load_si256((const __m256i*)group);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(h2)));
+}
+
+// EMPTY and DELETED both have the sign bit set, full slots never do
+static inline uint32_t dict_swiss_match_free(const int8_t *group) {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_load_si256((const __m256i*)group));
+}
+
+#elif defined(__SSE2__)
+
+#define DICT_SWISS_GROUP_WIDTH 16
+
+static inline uint32_t dict_swiss_match(const int8_t *group, int8_t h2) {
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+}
+
+static inline uint32_t dict_swiss_match_free(const int8_t *group) {
+    return (uint32_t)_mm_movemask_epi8(_mm_load_si128((const __m128i*)group));
+}
+
+#else
+
+#define DICT_SWISS_GROUP_WIDTH 16
+
+static inline uint32_t dict_swiss_match(const int8_t *group, int8_t h2) {
+    uint32_t mask = 0;
+    for (int i = 0; i < DICT_SWISS_GROUP_WIDTH; i++)
+        mask |= (uint32_t)(group[i] == h2) << i;
+    return mask;
+}
+
+static inline uint32_t dict_swiss_match_free(const int8_t *group) {
+    uint32_t mask = 0;
+    for (int i = 0; i < DICT_SWISS_GROUP_WIDTH; i++)
+        mask |= (uint32_t)(group[i] < 0) << i;
+    return mask;
+}
+
+#endif
+
+static inline uint32_t dict_swiss_match_empty(const int8_t *group) {
+    return dict_swiss_match(group, DICT_SWISS_EMPTY);
+}
+
+static inline int dict_ctz32(uint32_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+// Spread a 32-bit hash so that both H1 (group index) and H2 (fingerprint)
+// get well-mixed bits even from weak hashes like DJB2
+static inline uint32_t dict_swiss_mix(uint32_t hash) {
+    return (uint32_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static inline size_t dict_swiss_round_capacity(size_t capacity) {
+    size_t cap = DICT_SWISS_GROUP_WIDTH;
+    while (cap < capacity) cap <<= 1;
+    return cap;
+}
+
+#define DICT_DEFINE_SWISS(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+\
+typedef KEY_TYPE NAME##_Key; \
+typedef VALUE_TYPE NAME##_Value; \
+typedef void (*NAME##_UpsertFn)(VALUE_TYPE *value, bool inserted, void *ctx); \
+\
+typedef struct { \
+    KEY_TYPE key; \
+    VALUE_TYPE value; \
+} NAME##_Entry; \
+\
+typedef struct { \
+    int8_t *ctrl; \
+    NAME##_Entry *entries; \
+    size_t capacity; \
+    size_t size; \
+    size_t growth_left; \
+} NAME; \
+\
+typedef struct { \
+    NAME *dict; \
+    size_t index; \
+} NAME##_Iterator; \
+\
+static inline bool NAME##_alloc_table(NAME *dict, size_t capacity) { \
+    int8_t *ctrl = (int8_t*)aligned_alloc(DICT_SWISS_GROUP_WIDTH, capacity); \
+    if (!ctrl) return false; \
+    NAME##_Entry *entries = (NAME##_Entry*)malloc(capacity * sizeof(NAME##_Entry)); \
+    if (!entries) { free(ctrl); return false; } \
+    memset(ctrl, DICT_SWISS_EMPTY, capacity); \
+    dict->ctrl = ctrl; \
+    dict->entries = entries; \
+    dict->capacity = capacity; \
+    dict->growth_left = capacity - capacity / 8; \
+    return true; \
+} \
+\
+static inline NAME* NAME##_create_with_capacity(size_t capacity) { \
+    NAME *dict = (NAME*)malloc(sizeof(NAME)); \
+    if (!dict) return NULL; \
+    if (!NAME##_alloc_table(dict, dict_swiss_round_capacity(capacity))) { \
+        free(dict); \
+        return NULL; \
+    } \
+    dict->size = 0; \
+    return dict; \
+} \
+\
+static inline NAME* NAME##_create(void) { \
+    return NAME##_create_with_capacity(DICT_INITIAL_CAPACITY); \
+} \
+\
+static inline void NAME##_destroy(NAME *dict) { \
+    if (!dict) return; \
+    for (size_t i = 0; i < dict->capacity; i++) { \
+        if (dict->ctrl[i] >= 0) { \
+            FREE_KEY_FN(dict->entries[i].key); \
+        } \
+    } \
+    free(dict->ctrl); \
+    free(dict->entries); \
+    free(dict); \
+} \
+\
+static inline size_t NAME##_find(NAME *dict, KEY_TYPE key, uint32_t h) { \
+    int8_t h2 = (int8_t)(h & 0x7F); \
+    size_t group_mask = dict->capacity / DICT_SWISS_GROUP_WIDTH - 1; \
+    size_t group = (h >> 7) & group_mask; \
+    for (size_t step = 1; ; step++) { \
+        const int8_t *ctrl = dict->ctrl + group * DICT_SWISS_GROUP_WIDTH; \
+        uint32_t match = dict_swiss_match(ctrl, h2); \
+        while (match) { \
+            size_t idx = group * DICT_SWISS_GROUP_WIDTH + dict_ctz32(match); \
+            if (EQ_FN(dict->entries[idx].key, key)) \
+                return idx; \
+            match &= match - 1; \
+        } \
+        if (dict_swiss_match_empty(ctrl)) \
+            return SIZE_MAX; \
+        group = (group + step) & group_mask; \
+    } \
+} \
+\
+static inline size_t NAME##_find_free(NAME *dict, uint32_t h) { \
+    size_t group_mask = dict->capacity / DICT_SWISS_GROUP_WIDTH - 1; \
+    size_t group = (h >> 7) & group_mask; \
+    for (size_t step = 1; ; step++) { \
+        uint32_t free_mask = dict_swiss_match_free(dict->ctrl + group * DICT_SWISS_GROUP_WIDTH); \
+        if (free_mask) \
+            return group * DICT_SWISS_GROUP_WIDTH + dict_ctz32(free_mask); \
+        group = (group + step) & group_mask; \
+    } \
+} \
+\
+static inline void NAME##_resize(NAME *dict, size_t new_capacity) { \
+    int8_t *old_ctrl = dict->ctrl; \
+    NAME##_Entry *old_entries = dict->entries; \
+    size_t old_capacity = dict->capacity; \
+    if (!NAME##_alloc_table(dict, new_capacity)) return; \
+    for (size_t i = 0; i < old_capacity; i++) { \
+        if (old_ctrl[i] >= 0) { \
+            uint32_t h = dict_swiss_mix(HASH_FN(old_entries[i].key)); \
+            size_t slot = NAME##_find_free(dict, h); \
+            dict->ctrl[slot] = (int8_t)(h & 0x7F); \
+            dict->entries[slot] = old_entries[i]; \
+        } \
+    } \
+    dict->growth_left -= dict->size; \
+    free(old_ctrl); \
+    free(old_entries); \
+} \
+\
+/* Single lookup for insert-or-update, see the Robin Hood version */ \
+static inline VALUE_TYPE* NAME##_slot_hashed(NAME *dict, KEY_TYPE key, uint32_t h, \
+                                             VALUE_TYPE init, bool *inserted) { \
+    *inserted = false; \
+    size_t idx = NAME##_find(dict, key, h); \
+    if (idx != SIZE_MAX) \
+        return &dict->entries[idx].value; \
+    if (dict->growth_left == 0) { \
+        /* Mostly tombstones: rehash in place, otherwise grow */ \
+        if (dict->size < (dict->capacity - dict->capacity / 8) / 2) \
+            NAME##_resize(dict, dict->capacity); \
+        else \
+            NAME##_resize(dict, dict->capacity * 2); \
+        if (dict->growth_left == 0) return NULL; \
+    } \
+    idx = NAME##_find_free(dict, h); \
+    if (dict->ctrl[idx] == DICT_SWISS_EMPTY) \
+        dict->growth_left--; \
+    dict->ctrl[idx] = (int8_t)(h & 0x7F); \
+    dict->entries[idx].key = COPY_KEY_FN(key); \
+    dict->entries[idx].value = init; \
+    dict->size++; \
+    *inserted = true; \
+    return &dict->entries[idx].value; \
+} \
+\
+static inline bool NAME##_set_hashed(NAME *dict, KEY_TYPE key, uint32_t h, VALUE_TYPE value) { \
+    bool inserted; \
+    VALUE_TYPE *slot = NAME##_slot_hashed(dict, key, h, value, &inserted); \
+    if (slot && !inserted) *slot = value; \
+    return inserted; \
+} \
+\
+static inline bool NAME##_set(NAME *dict, KEY_TYPE key, VALUE_TYPE value) { \
+    if (!dict) return false; \
+    return NAME##_set_hashed(dict, key, dict_swiss_mix(HASH_FN(key)), value); \
+} \
+\
+static inline VALUE_TYPE* NAME##_get_or_insert(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    if (!dict) return NULL; \
+    bool inserted; \
+    return NAME##_slot_hashed(dict, key, dict_swiss_mix(HASH_FN(key)), default_val, &inserted); \
+} \
+\
+static inline bool NAME##_upsert(NAME *dict, KEY_TYPE key, NAME##_UpsertFn fn, void *ctx) { \
+    if (!dict) return false; \
+    VALUE_TYPE zero; \
+    memset(&zero, 0, sizeof(zero)); \
+    bool inserted; \
+    VALUE_TYPE *slot = NAME##_slot_hashed(dict, key, dict_swiss_mix(HASH_FN(key)), zero, &inserted); \
+    if (slot) fn(slot, inserted, ctx); \
+    return inserted; \
+} \
+\
+static inline VALUE_TYPE NAME##_get(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    if (!dict) return default_val; \
+    size_t idx = NAME##_find(dict, key, dict_swiss_mix(HASH_FN(key))); \
+    return idx != SIZE_MAX ? dict->entries[idx].value : default_val; \
+} \
+\
+static inline VALUE_TYPE* NAME##_get_ptr(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return NULL; \
+    size_t idx = NAME##_find(dict, key, dict_swiss_mix(HASH_FN(key))); \
+    return idx != SIZE_MAX ? &dict->entries[idx].value : NULL; \
+} \
+\
+static inline bool NAME##_contains(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return false; \
+    return NAME##_find(dict, key, dict_swiss_mix(HASH_FN(key))) != SIZE_MAX; \
+} \
+\
+/* Batched operations: prefetch each key's first control group and */ \
+/* entry group before probing, so the cache misses overlap */ \
+static inline void NAME##_prefetch_batch(NAME *dict, const NAME##_Key *keys, uint32_t *hashes, size_t n) { \
+    size_t group_mask = dict->capacity / DICT_SWISS_GROUP_WIDTH - 1; \
+    for (size_t i = 0; i < n; i++) { \
+        hashes[i] = dict_swiss_mix(HASH_FN(keys[i])); \
+        size_t slot = ((hashes[i] >> 7) & group_mask) * DICT_SWISS_GROUP_WIDTH; \
+        DICT_PREFETCH(dict->ctrl + slot); \
+        DICT_PREFETCH(&dict->entries[slot]); \
+    } \
+} \
+\
+static inline void NAME##_get_many(NAME *dict, const NAME##_Key *keys, size_t n, \
+                                   VALUE_TYPE *out_values, VALUE_TYPE default_val) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    for (size_t base = 0; base < n; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        if (!dict) { \
+            for (size_t i = 0; i < m; i++) out_values[base + i] = default_val; \
+            continue; \
+        } \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) { \
+            size_t idx = NAME##_find(dict, keys[base + i], hashes[i]); \
+            out_values[base + i] = idx != SIZE_MAX ? dict->entries[idx].value : default_val; \
+        } \
+    } \
+} \
+\
+static inline size_t NAME##_contains_many(NAME *dict, const NAME##_Key *keys, size_t n, bool *out) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    size_t found = 0; \
+    for (size_t base = 0; base < n && dict; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) { \
+            bool hit = NAME##_find(dict, keys[base + i], hashes[i]) != SIZE_MAX; \
+            if (out) out[base + i] = hit; \
+            found += hit; \
+        } \
+    } \
+    if (!dict && out) memset(out, 0, n * sizeof(bool)); \
+    return found; \
+} \
+\
+static inline size_t NAME##_set_many(NAME *dict, const NAME##_Key *keys, const NAME##_Value *values, size_t n) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    size_t inserted = 0; \
+    for (size_t base = 0; base < n && dict; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        /* Grow up front so the prefetched groups are the ones written */ \
+        while (dict->growth_left < m) { \
+            size_t growth_left = dict->growth_left; \
+            NAME##_resize(dict, dict->capacity * 2); \
+            if (dict->growth_left == growth_left) break; \
+        } \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) \
+            inserted += NAME##_set_hashed(dict, keys[base + i], hashes[i], values[base + i]); \
+    } \
+    return inserted; \
+} \
+\
+static inline bool NAME##_remove(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return false; \
+    size_t idx = NAME##_find(dict, key, dict_swiss_mix(HASH_FN(key))); \
+    if (idx == SIZE_MAX) return false; \
+    FREE_KEY_FN(dict->entries[idx].key); \
+    /* If the group still has an EMPTY slot no probe sequence continues */ \
+    /* past it, so the slot can go back to EMPTY instead of a tombstone */ \
+    const int8_t *group = dict->ctrl + idx / DICT_SWISS_GROUP_WIDTH * DICT_SWISS_GROUP_WIDTH; \
+    if (dict_swiss_match_empty(group)) { \
+        dict->ctrl[idx] = DICT_SWISS_EMPTY; \
+        dict->growth_left++; \
+    } else { \
+        dict->ctrl[idx] = DICT_SWISS_DELETED; \
+    } \
+    dict->size--; \
+    return true; \
+} \
+\
+static inline size_t NAME##_size(NAME *dict) { \
+    return dict ? dict->size : 0; \
+} \
+\
+static inline size_t NAME##_capacity(NAME *dict) { \
+    return dict ? dict->capacity : 0; \
+} \
+\
+static inline bool NAME##_empty(NAME *dict) { \
+    return !dict || dict->size == 0; \
+} \
+\
+static inline void NAME##_clear(NAME *dict) { \
+    if (!dict) return; \
+    for (size_t i = 0; i < dict->capacity; i++) { \
+        if (dict->ctrl[i] >= 0) { \
+            FREE_KEY_FN(dict->entries[i].key); \
+        } \
+    } \
+    memset(dict->ctrl, DICT_SWISS_EMPTY, dict->capacity); \
+    dict->growth_left = dict->capacity - dict->capacity / 8; \
+    dict->size = 0; \
+} \
+\
+static inline NAME##_Iterator NAME##_iter(NAME *dict) { \
+    NAME##_Iterator iter = {dict, 0}; \
+    return iter; \
+} \
+\
+static inline bool NAME##_next(NAME##_Iterator *iter, KEY_TYPE *key, VALUE_TYPE *value) { \
+    if (!iter || !iter->dict) return false; \
+    while (iter->index < iter->dict->capacity) { \
+        if (iter->dict->ctrl[iter->index] >= 0) { \
+            if (key) *key = iter->dict->entries[iter->index].key; \
+            if (value) *value = iter->dict->entries[iter->index].value; \
+            iter->index++; \
+            return true; \
+        } \
+        iter->index++; \
+    } \
+    return false; \
+}
+
+// ============================================================================
+// DICT_DEFINE_PACKED / DICT_DEFINE_SPLIT - Robin Hood with a packed meta word
+// ============================================================================
+//
+// Same arguments and probing as DICT_DEFINE (home slot hash % capacity,
+// doubling past DICT_LOAD_FACTOR, backward shift deletion), but the 4-byte
+// hash and 4-byte probe distance of NAME##_Entry are packed into a single
+// uint32_t meta word: the probe distance + 1 in the low byte (0 = empty
+// slot) and the top 24 bits of the hash above it as a tag.
+//
+//   DICT_DEFINE_PACKED  one array of {key, meta, value} entries: int -> int
+//                       slots drop from 16 to 12 bytes, char* -> int and
+//                       int -> double from 24 to 16
+//   DICT_DEFINE_SPLIT   separate keys[], values[] and meta[] arrays: probes
+//                       read 4-byte meta words and touch a key only on a tag
+//                       match, a value-only _next never reads the keys, and
+//                       no slot pays struct padding (char* -> double: 20
+//                       bytes instead of 24)
+//
+// HASH_FN is mixed with dict_swiss_mix before it picks the home slot and
+// tag, so weak hashes such as DJB2 on sequential keys still give short
+// probes. A probe compares tag and distance in one word compare. The full
+// hash is not kept, so a resize hashes every key again. Distances are
+// capped at DICT_META_MAX_PSL; an insert that would go further grows the
+// table, and fails (NULL / false) once the table is under 1/8 full, which
+// takes hundreds of keys with colliding hashes.
+//
+// The API is the single-table core of DICT_DEFINE: no arena keys,
+// incremental resize, huge pages, snapshots or build_from.
+// DICT_DEFINE_LAYOUT(NAME, LAYOUT, ...) picks the layout by name: AOS (the
+// DICT_DEFINE entry), PACKED or SPLIT.
+
+#define DICT_META_MAX_PSL 255
+#define DICT_META_PSL(meta) ((meta) & 0xFFu)
+#define DICT_META_TAG(hash) ((hash) & 0xFFFFFF00u)
+
+#define DICT_DEFINE_PACKED(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+    DICT_LAYOUT_PACKED_(NAME, KEY_TYPE, VALUE_TYPE) \
+    DICT_META_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN)
+
+#define DICT_DEFINE_SPLIT(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+    DICT_LAYOUT_SPLIT_(NAME, KEY_TYPE, VALUE_TYPE) \
+    DICT_META_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN)
+
+#define DICT_DEFINE_LAYOUT(NAME, LAYOUT, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+    DICT_DEFINE_LAYOUT_##LAYOUT##_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN)
+
+#define DICT_DEFINE_LAYOUT_AOS_ DICT_DEFINE
+#define DICT_DEFINE_LAYOUT_PACKED_ DICT_DEFINE_PACKED
+#define DICT_DEFINE_LAYOUT_SPLIT_ DICT_DEFINE_SPLIT
+
+// Each layout provides its types, table allocation and per-slot accessors;
+// the operations only go through those.
+#define DICT_LAYOUT_TYPES_(NAME, KEY_TYPE, VALUE_TYPE) \
+\
+typedef KEY_TYPE NAME##_Key; \
+typedef VALUE_TYPE NAME##_Value; \
+typedef void (*NAME##_UpsertFn)(VALUE_TYPE *value, bool inserted, void *ctx);
+
+#define DICT_LAYOUT_PACKED_(NAME, KEY_TYPE, VALUE_TYPE) \
+DICT_LAYOUT_TYPES_(NAME, KEY_TYPE, VALUE_TYPE) \
+\
+/* meta between key and value fills the padding after a 4-byte key */ \
+typedef struct { \
+    KEY_TYPE key; \
+    uint32_t meta; \
+    VALUE_TYPE value; \
+} NAME##_Entry; \
+\
+typedef struct { \
+    NAME##_Entry *entries; \
+    size_t capacity; \
+    size_t size; \
+} NAME; \
+\
+typedef struct { \
+    NAME *dict; \
+    size_t index; \
+} NAME##_Iterator; \
+\
+static inline size_t NAME##_slot_bytes(void) { \
+    return sizeof(NAME##_Entry); \
+} \
+\
+/* Only sets the table fields on success */ \
+static inline bool NAME##_alloc_table(NAME *dict, size_t capacity) { \
+    NAME##_Entry *entries = (NAME##_Entry*)dict_table_alloc(capacity * sizeof(NAME##_Entry), false); \
+    if (!entries) return false; \
+    dict->entries = entries; \
+    dict->capacity = capacity; \
+    return true; \
+} \
+\
+static inline void NAME##_free_table(NAME *dict) { \
+    dict_table_free(dict->entries, dict->capacity * sizeof(NAME##_Entry), false); \
+} \
+\
+static inline uint32_t* NAME##_meta_at(const NAME *dict, size_t i) { \
+    return &dict->entries[i].meta; \
+} \
+\
+static inline KEY_TYPE* NAME##_key_at(const NAME *dict, size_t i) { \
+    return &dict->entries[i].key; \
+} \
+\
+static inline VALUE_TYPE* NAME##_value_at(const NAME *dict, size_t i) { \
+    return &dict->entries[i].value; \
+} \
+\
+static inline void NAME##_move(NAME *dict, size_t dst, size_t src) { \
+    dict->entries[dst] = dict->entries[src]; \
+} \
+\
+static inline void NAME##_prefetch_slot(const NAME *dict, size_t i) { \
+    DICT_PREFETCH(&dict->entries[i]); \
+}
+
+#define DICT_LAYOUT_SPLIT_(NAME, KEY_TYPE, VALUE_TYPE) \
+DICT_LAYOUT_TYPES_(NAME, KEY_TYPE, VALUE_TYPE) \
+\
+typedef struct { \
+    uint32_t *meta; \
+    KEY_TYPE *keys; \
+    VALUE_TYPE *values; \
+    size_t capacity; \
+    size_t size; \
+} NAME; \
+\
+typedef struct { \
+    NAME *dict; \
+    size_t index; \
+} NAME##_Iterator; \
+\
+static inline size_t NAME##_slot_bytes(void) { \
+    return sizeof(uint32_t) + sizeof(KEY_TYPE) + sizeof(VALUE_TYPE); \
+} \
+\
+static inline bool NAME##_alloc_table(NAME *dict, size_t capacity) { \
+    uint32_t *meta = (uint32_t*)dict_table_alloc(capacity * sizeof(uint32_t), false); \
+    KEY_TYPE *keys = (KEY_TYPE*)dict_table_alloc(capacity * sizeof(KEY_TYPE), false); \
+    VALUE_TYPE *values = (VALUE_TYPE*)dict_table_alloc(capacity * sizeof(VALUE_TYPE), false); \
+    if (!meta || !keys || !values) { \
+        dict_table_free(meta, capacity * sizeof(uint32_t), false); \
+        dict_table_free(keys, capacity * sizeof(KEY_TYPE), false); \
+        dict_table_free(values, capacity * sizeof(VALUE_TYPE), false); \
+        return false; \
+    } \
+    dict->meta = meta; \
+    dict->keys = keys; \
+    dict->values = values; \
+    dict->capacity = capacity; \
+    return true; \
+} \
+\
+static inline void NAME##_free_table(NAME *dict) { \
+    dict_table_free(dict->meta, dict->capacity * sizeof(uint32_t), false); \
+    dict_table_free(dict->keys, dict->capacity * sizeof(KEY_TYPE), false); \
+    dict_table_free(dict->values, dict->capacity * sizeof(VALUE_TYPE), false); \
+} \
+\
+static inline uint32_t* NAME##_meta_at(const NAME *dict, size_t i) { \
+    return &dict->meta[i]; \
+} \
+\
+static inline KEY_TYPE* NAME##_key_at(const NAME *dict, size_t i) { \
+    return &dict->keys[i]; \
+} \
+\
+static inline VALUE_TYPE* NAME##_value_at(const NAME *dict, size_t i) { \
+    return &dict->values[i]; \
+} \
+\
+static inline void NAME##_move(NAME *dict, size_t dst, size_t src) { \
+    dict->meta[dst] = dict->meta[src]; \
+    dict->keys[dst] = dict->keys[src]; \
+    dict->values[dst] = dict->values[src]; \
+} \
+\
+/* The key is fetched along with the meta word; values only on a hit */ \
+static inline void NAME##_prefetch_slot(const NAME *dict, size_t i) { \
+    DICT_PREFETCH(&dict->meta[i]); \
+    DICT_PREFETCH(&dict->keys[i]); \
+}
+
+#define DICT_META_OPS_(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+\
+/* HASH_FN mixed, as for DICT_DEFINE_SWISS: home slot and tag both come */ \
+/* from it, and the distance cap needs the short probes of a mixed hash */ \
+static inline uint32_t NAME##_hash_key(KEY_TYPE key) { \
+    return dict_swiss_mix(HASH_FN(key)); \
+} \
+\
+static inline NAME* NAME##_create_with_capacity(size_t capacity) { \
+    NAME *dict = (NAME*)DICT_MALLOC(sizeof(NAME), DICT_ALLOC_CTX); \
+    if (!dict) return NULL; \
+    /* meta == 0 marks an empty slot, so zeroed memory is an empty table */ \
+    if (!NAME##_alloc_table(dict, capacity)) { \
+        DICT_FREE(dict, sizeof(NAME), DICT_ALLOC_CTX); \
+        return NULL; \
+    } \
+    dict->size = 0; \
+    return dict; \
+} \
+\
+static inline NAME* NAME##_create(void) { \
+    return NAME##_create_with_capacity(DICT_INITIAL_CAPACITY); \
+} \
+\
+static inline void NAME##_destroy(NAME *dict) { \
+    if (!dict) return; \
+    for (size_t i = 0; i < dict->capacity; i++) { \
+        if (*NAME##_meta_at(dict, i)) { \
+            FREE_KEY_FN(*NAME##_key_at(dict, i)); \
+        } \
+    } \
+    NAME##_free_table(dict); \
+    DICT_FREE(dict, sizeof(NAME), DICT_ALLOC_CTX); \
+} \
+\
+static inline size_t NAME##_find(const NAME *dict, KEY_TYPE key, uint32_t hash) { \
+    size_t probe = hash % dict->capacity; \
+    uint32_t want = DICT_META_TAG(hash) | 1; \
+    for (uint32_t dist = 1; dist <= DICT_META_MAX_PSL; dist++, want++) { \
+        uint32_t meta = *NAME##_meta_at(dict, probe); \
+        if (meta == want && EQ_FN(*NAME##_key_at(dict, probe), key)) \
+            return probe; \
+        if (DICT_META_PSL(meta) < dist) \
+            return SIZE_MAX; \
+        if (++probe == dict->capacity) probe = 0; \
+    } \
+    return SIZE_MAX; \
+} \
+\
+/* Robin Hood insert of a hash whose key is known to be absent: the run */ \
+/* from the first slot with a shorter distance up to the next empty slot */ \
+/* moves along by one. Writes the meta word and returns the slot for the */ \
+/* key and value, or SIZE_MAX (table unchanged) when a distance would */ \
+/* pass DICT_META_MAX_PSL or the table is full. */ \
+static inline size_t NAME##_place(NAME *dict, uint32_t hash) { \
+    size_t capacity = dict->capacity; \
+    size_t probe = hash % capacity; \
+    size_t pos = SIZE_MAX; \
+    uint32_t dist = 1; \
+    for (size_t j = 0; j < capacity; j++) { \
+        uint32_t psl = DICT_META_PSL(*NAME##_meta_at(dict, probe)); \
+        if (pos == SIZE_MAX && psl < dist) { \
+            if (dist > DICT_META_MAX_PSL) return SIZE_MAX; \
+            pos = probe; \
+        } \
+        if (!psl) { \
+            for (size_t k = probe; k != pos; ) { \
+                size_t prev = k ? k - 1 : capacity - 1; \
+                NAME##_move(dict, k, prev); \
+                (*NAME##_meta_at(dict, k))++; \
+                k = prev; \
+            } \
+            *NAME##_meta_at(dict, pos) = DICT_META_TAG(hash) | dist; \
+            return pos; \
+        } \
+        if (pos != SIZE_MAX && psl == DICT_META_MAX_PSL) return SIZE_MAX; \
+        if (pos == SIZE_MAX) dist++; \
+        if (++probe == capacity) probe = 0; \
+    } \
+    return SIZE_MAX; \
+} \
+\
+/* Backward shift deletion of the entry at pos */ \
+static inline void NAME##_erase_at(NAME *dict, size_t pos) { \
+    size_t empty = pos; \
+    for (size_t j = 1; j < dict->capacity; j++) { \
+        size_t next = empty + 1 == dict->capacity ? 0 : empty + 1; \
+        if (DICT_META_PSL(*NAME##_meta_at(dict, next)) <= 1) break; \
+        NAME##_move(dict, empty, next); \
+        (*NAME##_meta_at(dict, empty))--; \
+        empty = next; \
+    } \
+    *NAME##_meta_at(dict, empty) = 0; \
+} \
+\
+/* Rebuilds into new_capacity slots; on failure the table is unchanged */ \
+static inline bool NAME##_resize_to(NAME *dict, size_t new_capacity) { \
+    if (new_capacity <= dict->size) return false; \
+    NAME old = *dict; \
+    if (!NAME##_alloc_table(dict, new_capacity)) return false; \
+    for (size_t i = 0; i < old.capacity; i++) { \
+        if (!*NAME##_meta_at(&old, i)) continue; \
+        size_t slot = NAME##_place(dict, NAME##_hash_key(*NAME##_key_at(&old, i))); \
+        if (slot == SIZE_MAX) { \
+            NAME##_free_table(dict); \
+            *dict = old; \
+            return false; \
+        } \
+        *NAME##_key_at(dict, slot) = *NAME##_key_at(&old, i); \
+        *NAME##_value_at(dict, slot) = *NAME##_value_at(&old, i); \
+    } \
+    NAME##_free_table(&old); \
+    return true; \
+} \
+\
+static inline void NAME##_resize(NAME *dict, size_t new_capacity) { \
+    if (dict) NAME##_resize_to(dict, new_capacity); \
+} \
+\
+/* Grows once so that n entries fit; never shrinks */ \
+static inline void NAME##_reserve(NAME *dict, size_t n) { \
+    if (!dict) return; \
+    size_t capacity = (size_t)((double)n / DICT_LOAD_FACTOR) + 1; \
+    if (capacity > dict->capacity) NAME##_resize_to(dict, capacity); \
+} \
+\
+/* Handle + slot arrays + bytes owned by copied keys */ \
+static inline size_t NAME##_memory_usage(NAME *dict) { \
+    if (!dict) return 0; \
+    size_t bytes = sizeof(NAME) + dict->capacity * NAME##_slot_bytes(); \
+    for (size_t i = 0; i < dict->capacity; i++) { \
+        if (*NAME##_meta_at(dict, i)) bytes += dict_owned_key_bytes(NAME##_key_at(dict, i)); \
+    } \
+    return bytes; \
+} \
+\
+/* Insert-or-update: a lookup, then a placement if the key is new */ \
+static inline VALUE_TYPE* NAME##_slot_hashed(NAME *dict, KEY_TYPE key, uint32_t hash, \
+                                             VALUE_TYPE init, bool *inserted) { \
+    *inserted = false; \
+    size_t idx = NAME##_find(dict, key, hash); \
+    if (idx != SIZE_MAX) \
+        return NAME##_value_at(dict, idx); \
+    if ((double)(dict->size + 1) / dict->capacity > DICT_LOAD_FACTOR) \
+        NAME##_resize_to(dict, dict->capacity * 2); \
+    idx = NAME##_place(dict, hash); \
+    if (idx == SIZE_MAX) { \
+        /* Probe distance limit: grow and retry, unless the table is */ \
+        /* already so sparse that the probe is down to colliding hashes */ \
+        if (dict->size < dict->capacity / 8 || \
+            !NAME##_resize_to(dict, dict->capacity * 2)) return NULL; \
+        idx = NAME##_place(dict, hash); \
+        if (idx == SIZE_MAX) return NULL; \
+    } \
+    *NAME##_key_at(dict, idx) = COPY_KEY_FN(key); \
+    *NAME##_value_at(dict, idx) = init; \
+    dict->size++; \
+    *inserted = true; \
+    return NAME##_value_at(dict, idx); \
+} \
+\
+static inline bool NAME##_set_hashed(NAME *dict, KEY_TYPE key, uint32_t hash, VALUE_TYPE value) { \
+    bool inserted; \
+    VALUE_TYPE *slot = NAME##_slot_hashed(dict, key, hash, value, &inserted); \
+    if (slot && !inserted) *slot = value; \
+    return inserted; \
+} \
+\
+static inline bool NAME##_set(NAME *dict, KEY_TYPE key, VALUE_TYPE value) { \
+    if (!dict) return false; \
+    return NAME##_set_hashed(dict, key, NAME##_hash_key(key), value); \
+} \
+\
+static inline VALUE_TYPE* NAME##_get_or_insert(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    if (!dict) return NULL; \
+    bool inserted; \
+    return NAME##_slot_hashed(dict, key, NAME##_hash_key(key), default_val, &inserted); \
+} \
+\
+static inline bool NAME##_upsert(NAME *dict, KEY_TYPE key, NAME##_UpsertFn fn, void *ctx) { \
+    if (!dict) return false; \
+    VALUE_TYPE zero; \
+    memset(&zero, 0, sizeof(zero)); \
+    bool inserted; \
+    VALUE_TYPE *slot = NAME##_slot_hashed(dict, key, NAME##_hash_key(key), zero, &inserted); \
+    if (slot) fn(slot, inserted, ctx); \
+    return inserted; \
 } \
 \
 static inline VALUE_TYPE* NAME##_get_ptr(NAME *dict, KEY_TYPE key) { \
     if (!dict) return NULL; \
-    uint32_t hash = HASH_FN(key); \
-    size_t idx = hash % dict->capacity; \
-    for (int psl = 0; psl < (int)dict->capacity; psl++) { \
-        size_t probe = (idx + psl) % dict->capacity; \
-        if (dict->entries[probe].psl < 0 || dict->entries[probe].psl < psl) \
-            return NULL; \
-        if (dict->entries[probe].hash == hash && \
-            EQ_FN(dict->entries[probe].key, key)) \
-            return &dict->entries[probe].value; \
+    size_t idx = NAME##_find(dict, key, NAME##_hash_key(key)); \
+    return idx != SIZE_MAX ? NAME##_value_at(dict, idx) : NULL; \
+} \
+\
+static inline VALUE_TYPE NAME##_get(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    VALUE_TYPE *value = NAME##_get_ptr(dict, key); \
+    return value ? *value : default_val; \
+} \
+\
+static inline bool NAME##_contains(NAME *dict, KEY_TYPE key) { \
+    return NAME##_get_ptr(dict, key) != NULL; \
+} \
+\
+/* Batched operations, as for DICT_DEFINE */ \
+static inline void NAME##_prefetch_batch(NAME *dict, const NAME##_Key *keys, uint32_t *hashes, size_t n) { \
+    for (size_t i = 0; i < n; i++) { \
+        hashes[i] = NAME##_hash_key(keys[i]); \
+        NAME##_prefetch_slot(dict, hashes[i] % dict->capacity); \
+    } \
+} \
+\
+static inline void NAME##_get_many(NAME *dict, const NAME##_Key *keys, size_t n, \
+                                   VALUE_TYPE *out_values, VALUE_TYPE default_val) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    for (size_t base = 0; base < n; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        if (!dict) { \
+            for (size_t i = 0; i < m; i++) out_values[base + i] = default_val; \
+            continue; \
+        } \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) { \
+            size_t idx = NAME##_find(dict, keys[base + i], hashes[i]); \
+            out_values[base + i] = idx != SIZE_MAX ? *NAME##_value_at(dict, idx) : default_val; \
+        } \
+    } \
+} \
+\
+static inline size_t NAME##_contains_many(NAME *dict, const NAME##_Key *keys, size_t n, bool *out) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    size_t found = 0; \
+    for (size_t base = 0; base < n && dict; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        NAME##_prefetch_batch(dict, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) { \
+            bool hit = NAME##_find(dict, keys[base + i], hashes[i]) != SIZE_MAX; \
+            if (out) out[base + i] = hit; \
+            found += hit; \
+        } \
+    } \
+    if (!dict && out) memset(out, 0, n * sizeof(bool)); \
+    return found; \
+} \
+\
+static inline bool NAME##_remove(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return false; \
+    size_t idx = NAME##_find(dict, key, NAME##_hash_key(key)); \
+    if (idx == SIZE_MAX) return false; \
+    FREE_KEY_FN(*NAME##_key_at(dict, idx)); \
+    NAME##_erase_at(dict, idx); \
+    dict->size--; \
+    return true; \
+} \
+\
+static inline size_t NAME##_size(NAME *dict) { \
+    return dict ? dict->size : 0; \
+} \
+\
+static inline size_t NAME##_capacity(NAME *dict) { \
+    return dict ? dict->capacity : 0; \
+} \
+\
+static inline bool NAME##_empty(NAME *dict) { \
+    return !dict || dict->size == 0; \
+} \
+\
+static inline void NAME##_clear(NAME *dict) { \
+    if (!dict) return; \
+    for (size_t i = 0; i < dict->capacity; i++) { \
+        if (*NAME##_meta_at(dict, i)) { \
+            FREE_KEY_FN(*NAME##_key_at(dict, i)); \
+            *NAME##_meta_at(dict, i) = 0; \
+        } \
+    } \
+    dict->size = 0; \
+} \
+\
+static inline NAME##_Iterator NAME##_iter(NAME *dict) { \
+    NAME##_Iterator iter = {dict, 0}; \
+    return iter; \
+} \
+\
+/* key may be NULL: a value-only walk of a split table skips the keys */ \
+static inline bool NAME##_next(NAME##_Iterator *iter, KEY_TYPE *key, VALUE_TYPE *value) { \
+    if (!iter || !iter->dict) return false; \
+    while (iter->index < iter->dict->capacity) { \
+        size_t i = iter->index++; \
+        if (*NAME##_meta_at(iter->dict, i)) { \
+            if (key) *key = *NAME##_key_at(iter->dict, i); \
+            if (value) *value = *NAME##_value_at(iter->dict, i); \
+            return true; \
+        } \
+    } \
+    return false; \
+}
+
+// ============================================================================
+// DICT_DEFINE_ORDERED macro - compact, insertion-ordered dictionary
+// ============================================================================
+//
+// Same arguments as DICT_DEFINE, laid out like CPython's compact dict: a
+// dense entries array in insertion order plus a sparse uint32_t index of
+// entry positions (linear probing, at most 2/3 full). Iteration walks only
+// the dense array, so it costs O(size) however sparse the index is, and an
+// empty slot costs 4 bytes instead of a whole entry. Removes leave a hole
+// in the entries array; holes are compacted away once they outnumber the
+// live entries, or on the next rebuild.
+
+// Index slot values: 0 = empty, DUMMY = removed, otherwise entry position + 1
+#define DICT_ORDERED_DUMMY UINT32_MAX
+
+#define DICT_DEFINE_ORDERED(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+\
+typedef KEY_TYPE NAME##_Key; \
+typedef VALUE_TYPE NAME##_Value; \
+\
+typedef struct { \
+    KEY_TYPE key; \
+    VALUE_TYPE value; \
+    uint32_t hash; \
+    uint32_t live;  /* 0 once removed */ \
+} NAME##_Entry; \
+\
+typedef struct { \
+    uint32_t *index; \
+    size_t index_mask; \
+    NAME##_Entry *entries; \
+    size_t used;      /* entries appended, including holes */ \
+    size_t entries_capacity; \
+    size_t size; \
+} NAME; \
+\
+typedef struct { \
+    NAME *dict; \
+    size_t index; \
+} NAME##_Iterator; \
+\
+/* Smallest power-of-two index that keeps n entries at most 2/3 full */ \
+static inline size_t NAME##_index_size_for(size_t n) { \
+    size_t cap = 8; \
+    while (cap * 2 < n * 3) cap <<= 1; \
+    return cap; \
+} \
+\
+static inline void NAME##_index_insert(uint32_t *index, size_t mask, uint32_t hash, size_t pos) { \
+    size_t i = hash & mask; \
+    while (index[i]) i = (i + 1) & mask; \
+    index[i] = (uint32_t)(pos + 1); \
+} \
+\
+/* Drops holes from the entries array (keeping order) and reindexes it */ \
+static inline bool NAME##_rebuild(NAME *dict, size_t index_size) { \
+    uint32_t *index = (uint32_t*)calloc(index_size, sizeof(uint32_t)); \
+    if (!index) return false; \
+    size_t j = 0; \
+    for (size_t i = 0; i < dict->used; i++) { \
+        if (!dict->entries[i].live) continue; \
+        if (i != j) dict->entries[j] = dict->entries[i]; \
+        NAME##_index_insert(index, index_size - 1, dict->entries[j].hash, j); \
+        j++; \
+    } \
+    free(dict->index); \
+    dict->index = index; \
+    dict->index_mask = index_size - 1; \
+    dict->used = j; \
+    return true; \
+} \
+\
+static inline NAME* NAME##_create_with_capacity(size_t capacity) { \
+    NAME *dict = (NAME*)calloc(1, sizeof(NAME)); \
+    if (!dict) return NULL; \
+    /* Only the index is presized; the dense array grows by doubling, so */ \
+    /* unused capacity costs 4 bytes per index slot */ \
+    size_t index_size = NAME##_index_size_for(capacity); \
+    dict->entries_capacity = DICT_INITIAL_CAPACITY; \
+    dict->index = (uint32_t*)calloc(index_size, sizeof(uint32_t)); \
+    dict->entries = (NAME##_Entry*)malloc(dict->entries_capacity * sizeof(NAME##_Entry)); \
+    if (!dict->index || !dict->entries) { \
+        free(dict->index); \
+        free(dict->entries); \
+        free(dict); \
+        return NULL; \
     } \
-    return NULL; \
+    dict->index_mask = index_size - 1; \
+    return dict; \
 } \
 \
-static inline bool NAME##_contains(NAME *dict, KEY_TYPE key) { \
+static inline NAME* NAME##_create(void) { \
+    return NAME##_create_with_capacity(DICT_INITIAL_CAPACITY); \
+} \
+\
+static inline void NAME##_destroy(NAME *dict) { \
+    if (!dict) return; \
+    for (size_t i = 0; i < dict->used; i++) { \
+        if (dict->entries[i].live) FREE_KEY_FN(dict->entries[i].key); \
+    } \
+    free(dict->index); \
+    free(dict->entries); \
+    free(dict); \
+} \
+\
+/* Index slot holding key, or SIZE_MAX */ \
+static inline size_t NAME##_find(NAME *dict, KEY_TYPE key, uint32_t hash) { \
+    size_t i = hash & dict->index_mask; \
+    for (;;) { \
+        uint32_t slot = dict->index[i]; \
+        if (!slot) return SIZE_MAX; \
+        if (slot != DICT_ORDERED_DUMMY) { \
+            const NAME##_Entry *e = &dict->entries[slot - 1]; \
+            if (e->hash == hash && EQ_FN(e->key, key)) return i; \
+        } \
+        i = (i + 1) & dict->index_mask; \
+    } \
+} \
+\
+static inline bool NAME##_set(NAME *dict, KEY_TYPE key, VALUE_TYPE value) { \
     if (!dict) return false; \
-    uint32_t hash = HASH_FN(key); \
-    size_t idx = hash % dict->capacity; \
-    for (int psl = 0; psl < (int)dict->capacity; psl++) { \
-        size_t probe = (idx + psl) % dict->capacity; \
-        if (dict->entries[probe].psl < 0 || dict->entries[probe].psl < psl) \
-            return false; \
-        if (dict->entries[probe].hash == hash && \
-            EQ_FN(dict->entries[probe].key, key)) \
-            return true; \
+    uint32_t hash = dict_swiss_mix(HASH_FN(key)); \
+    size_t i = NAME##_find(dict, key, hash); \
+    if (i != SIZE_MAX) { \
+        dict->entries[dict->index[i] - 1].value = value; \
+        return false; \
     } \
-    return false; \
+    /* Full index (live + removed): grow if live entries need it, else compact */ \
+    if ((dict->used + 1) * 3 > (dict->index_mask + 1) * 2) { \
+        if (!NAME##_rebuild(dict, NAME##_index_size_for((dict->size + 1) * 2))) return false; \
+    } \
+    if (dict->used == dict->entries_capacity) { \
+        size_t cap = dict->entries_capacity * 2; \
+        NAME##_Entry *entries = (NAME##_Entry*)realloc(dict->entries, cap * sizeof(NAME##_Entry)); \
+        if (!entries) return false; \
+        dict->entries = entries; \
+        dict->entries_capacity = cap; \
+    } \
+    NAME##_Entry *e = &dict->entries[dict->used]; \
+    e->key = COPY_KEY_FN(key); \
+    e->value = value; \
+    e->hash = hash; \
+    e->live = 1; \
+    NAME##_index_insert(dict->index, dict->index_mask, hash, dict->used); \
+    dict->used++; \
+    dict->size++; \
+    return true; \
+} \
+\
+static inline VALUE_TYPE* NAME##_get_ptr(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return NULL; \
+    size_t i = NAME##_find(dict, key, dict_swiss_mix(HASH_FN(key))); \
+    return i != SIZE_MAX ? &dict->entries[dict->index[i] - 1].value : NULL; \
+} \
+\
+static inline VALUE_TYPE NAME##_get(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    VALUE_TYPE *value = NAME##_get_ptr(dict, key); \
+    return value ? *value : default_val; \
+} \
+\
+static inline bool NAME##_contains(NAME *dict, KEY_TYPE key) { \
+    return NAME##_get_ptr(dict, key) != NULL; \
 } \
 \
 static inline bool NAME##_remove(NAME *dict, KEY_TYPE key) { \
     if (!dict) return false; \
-    uint32_t hash = HASH_FN(key); \
-    size_t idx = hash % dict->capacity; \
-    for (int psl = 0; psl < (int)dict->capacity; psl++) { \
-        size_t probe = (idx + psl) % dict->capacity; \
-        if (dict->entries[probe].psl < 0 || dict->entries[probe].psl < psl) \
-            return false; \
-        if (dict->entries[probe].hash == hash && \
-            EQ_FN(dict->entries[probe].key, key)) { \
-            FREE_KEY_FN(dict->entries[probe].key); \
-            dict->entries[probe].psl = -1; \
-            dict->size--; \
-            size_t empty = probe; \
-            for (size_t j = 1; j < dict->capacity; j++) { \
-                size_t next = (probe + j) % dict->capacity; \
-                if (dict->entries[next].psl <= 0) break; \
-                dict->entries[empty] = dict->entries[next]; \
-                dict->entries[empty].psl--; \
-                dict->entries[next].psl = -1; \
-                empty = next; \
-            } \
-            return true; \
-        } \
-    } \
-    return false; \
+    size_t i = NAME##_find(dict, key, dict_swiss_mix(HASH_FN(key))); \
+    if (i == SIZE_MAX) return false; \
+    NAME##_Entry *e = &dict->entries[dict->index[i] - 1]; \
+    FREE_KEY_FN(e->key); \
+    e->live = 0; \
+    dict->index[i] = DICT_ORDERED_DUMMY; \
+    dict->size--; \
+    /* Keep iteration O(size): compact once holes outnumber live entries */ \
+    if (dict->used >= 16 && (dict->used - dict->size) * 2 > dict->used) \
+        NAME##_rebuild(dict, dict->index_mask + 1); \
+    return true; \
 } \
 \
 static inline size_t NAME##_size(NAME *dict) { \
     return dict ? dict->size : 0; \
 } \
 \
+/* Index slots; the entries array holds up to 2/3 of this without a rebuild */ \
 static inline size_t NAME##_capacity(NAME *dict) { \
-    return dict ? dict->capacity : 0; \
+    return dict ? dict->index_mask + 1 : 0; \
 } \
 \
 static inline bool NAME##_empty(NAME *dict) { \
@@ -342,15 +2692,25 @@ static inline bool NAME##_empty(NAME *dict) { \
 \
 static inline void NAME##_clear(NAME *dict) { \
     if (!dict) return; \
-    for (size_t i = 0; i < dict->capacity; i++) { \
-        if (dict->entries[i].psl >= 0) { \
-            FREE_KEY_FN(dict->entries[i].key); \
-            dict->entries[i].psl = -1; \
-        } \
+    for (size_t i = 0; i < dict->used; i++) { \
+        if (dict->entries[i].live) FREE_KEY_FN(dict->entries[i].key); \
     } \
+    memset(dict->index, 0, (dict->index_mask + 1) * sizeof(uint32_t)); \
+    dict->used = 0; \
     dict->size = 0; \
 } \
 \
+static inline size_t NAME##_memory_usage(NAME *dict) { \
+    if (!dict) return 0; \
+    size_t bytes = sizeof(NAME) + (dict->index_mask + 1) * sizeof(uint32_t) + \
+                   dict->entries_capacity * sizeof(NAME##_Entry); \
+    for (size_t i = 0; i < dict->used; i++) { \
+        if (dict->entries[i].live) bytes += dict_owned_key_bytes(&dict->entries[i].key); \
+    } \
+    return bytes; \
+} \
+\
+/* Iterates in insertion order */ \
 static inline NAME##_Iterator NAME##_iter(NAME *dict) { \
     NAME##_Iterator iter = {dict, 0}; \
     return iter; \
@@ -358,18 +2718,528 @@ static inline NAME##_Iterator NAME##_iter(NAME *dict) { \
 \
 static inline bool NAME##_next(NAME##_Iterator *iter, KEY_TYPE *key, VALUE_TYPE *value) { \
     if (!iter || !iter->dict) return false; \
-    while (iter->index < iter->dict->capacity) { \
-        if (iter->dict->entries[iter->index].psl >= 0) { \
-            if (key) *key = iter->dict->entries[iter->index].key; \
-            if (value) *value = iter->dict->entries[iter->index].value; \
-            iter->index++; \
+    while (iter->index < iter->dict->used) { \
+        const NAME##_Entry *e = &iter->dict->entries[iter->index++]; \
+        if (e->live) { \
+            if (key) *key = e->key; \
+            if (value) *value = e->value; \
+            return true; \
+        } \
+    } \
+    return false; \
+}
+
+// ============================================================================
+// DICT_DEFINE_SET macro - key-only Robin Hood set with bulk set algebra
+// ============================================================================
+//
+// DICT_DEFINE without the value: each slot is just the key, its hash and
+// the probe distance, so a uint64_t set costs 16 bytes per slot instead
+// of 24 for a dict with a dummy int value. Capacity is a power of two and
+// slots are found with the dict_swiss_mix'ed hash, which is stored so the
+// bulk operations can probe another set without rehashing any key.
+// union_into/intersect/difference walk one set in DICT_BATCH_SIZE chunks
+// and prefetch every home slot in the other before resolving the chunk;
+// union_into walks src, intersect the smaller set and difference a.
+
+#define DICT_DEFINE_SET(NAME, KEY_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+\
+typedef KEY_TYPE NAME##_Key; \
+\
+typedef struct { \
+    KEY_TYPE key; \
+    uint32_t hash; \
+    uint32_t dist;  /* probe distance + 1, 0 = empty slot */ \
+} NAME##_Entry; \
+\
+typedef struct { \
+    NAME##_Entry *entries; \
+    size_t mask;  /* capacity - 1 */ \
+    size_t size; \
+} NAME; \
+\
+typedef struct { \
+    NAME *set; \
+    size_t index; \
+} NAME##_Iterator; \
+\
+/* Smallest power-of-two capacity that holds n keys under DICT_LOAD_FACTOR */ \
+static inline size_t NAME##_capacity_for(size_t n) { \
+    size_t cap = DICT_INITIAL_CAPACITY; \
+    while ((double)n > (double)cap * DICT_LOAD_FACTOR) cap <<= 1; \
+    return cap; \
+} \
+\
+static inline NAME* NAME##_create_with_capacity(size_t capacity) { \
+    NAME *set = (NAME*)DICT_MALLOC(sizeof(NAME), DICT_ALLOC_CTX); \
+    if (!set) return NULL; \
+    size_t cap = NAME##_capacity_for(capacity); \
+    set->entries = (NAME##_Entry*)DICT_CALLOC(cap, sizeof(NAME##_Entry), DICT_ALLOC_CTX); \
+    if (!set->entries) { DICT_FREE(set, sizeof(NAME), DICT_ALLOC_CTX); return NULL; } \
+    set->mask = cap - 1; \
+    set->size = 0; \
+    return set; \
+} \
+\
+static inline NAME* NAME##_create(void) { \
+    return NAME##_create_with_capacity(0); \
+} \
+\
+static inline void NAME##_destroy(NAME *set) { \
+    if (!set) return; \
+    for (size_t i = 0; i <= set->mask; i++) { \
+        if (set->entries[i].dist) FREE_KEY_FN(set->entries[i].key); \
+    } \
+    DICT_FREE(set->entries, (set->mask + 1) * sizeof(NAME##_Entry), DICT_ALLOC_CTX); \
+    DICT_FREE(set, sizeof(NAME), DICT_ALLOC_CTX); \
+} \
+\
+/* Robin Hood insert from probe on, entry.dist being its distance there */ \
+static inline void NAME##_place_from(NAME##_Entry *entries, size_t mask, size_t probe, NAME##_Entry entry) { \
+    for (;;) { \
+        if (!entries[probe].dist) { \
+            entries[probe] = entry; \
+            return; \
+        } \
+        if (entry.dist > entries[probe].dist) { \
+            NAME##_Entry tmp = entries[probe]; \
+            entries[probe] = entry; \
+            entry = tmp; \
+        } \
+        entry.dist++; \
+        probe = (probe + 1) & mask; \
+    } \
+} \
+\
+static inline bool NAME##_resize(NAME *set, size_t capacity) { \
+    size_t cap = NAME##_capacity_for(capacity); \
+    if (cap < NAME##_capacity_for(set->size) || cap == set->mask + 1) return false; \
+    NAME##_Entry *entries = (NAME##_Entry*)DICT_CALLOC(cap, sizeof(NAME##_Entry), DICT_ALLOC_CTX); \
+    if (!entries) return false; \
+    for (size_t i = 0; i <= set->mask; i++) { \
+        if (!set->entries[i].dist) continue; \
+        NAME##_Entry e = set->entries[i]; \
+        e.dist = 1; \
+        NAME##_place_from(entries, cap - 1, e.hash & (cap - 1), e); \
+    } \
+    DICT_FREE(set->entries, (set->mask + 1) * sizeof(NAME##_Entry), DICT_ALLOC_CTX); \
+    set->entries = entries; \
+    set->mask = cap - 1; \
+    return true; \
+} \
+\
+/* Grows once so that n keys fit; never shrinks */ \
+static inline void NAME##_reserve(NAME *set, size_t n) { \
+    if (set && NAME##_capacity_for(n) > set->mask + 1) NAME##_resize(set, n); \
+} \
+\
+/* Slot holding key, or SIZE_MAX */ \
+static inline size_t NAME##_find(const NAME *set, KEY_TYPE key, uint32_t hash) { \
+    size_t probe = hash & set->mask; \
+    for (uint32_t dist = 1;; dist++) { \
+        const NAME##_Entry *e = &set->entries[probe]; \
+        if (e->dist < dist) return SIZE_MAX; \
+        if (e->hash == hash && EQ_FN(e->key, key)) return probe; \
+        probe = (probe + 1) & set->mask; \
+    } \
+} \
+\
+/* The hash stored in NAME##_Entry, for the _hashed variants */ \
+static inline uint32_t NAME##_hash_key(KEY_TYPE key) { \
+    return dict_swiss_mix(HASH_FN(key)); \
+} \
+\
+/* Adds key (copied with COPY_KEY_FN) unless present; true if it was added */ \
+static inline bool NAME##_add_hashed(NAME *set, KEY_TYPE key, uint32_t hash) { \
+    if ((double)(set->size + 1) > (double)(set->mask + 1) * DICT_LOAD_FACTOR) \
+        NAME##_resize(set, set->size + 1); \
+    size_t probe = hash & set->mask; \
+    NAME##_Entry entry; \
+    entry.key = key; \
+    entry.hash = hash; \
+    entry.dist = 1; \
+    for (;;) { \
+        NAME##_Entry *e = &set->entries[probe]; \
+        if (!e->dist || entry.dist > e->dist) break; \
+        if (e->hash == hash && EQ_FN(e->key, key)) return false; \
+        entry.dist++; \
+        probe = (probe + 1) & set->mask; \
+    } \
+    /* key is absent: it takes this slot and pushes the rest of the run along */ \
+    entry.key = COPY_KEY_FN(key); \
+    NAME##_place_from(set->entries, set->mask, probe, entry); \
+    set->size++; \
+    return true; \
+} \
+\
+static inline bool NAME##_add(NAME *set, KEY_TYPE key) { \
+    if (!set) return false; \
+    return NAME##_add_hashed(set, key, NAME##_hash_key(key)); \
+} \
+\
+static inline bool NAME##_contains(const NAME *set, KEY_TYPE key) { \
+    return set && NAME##_find(set, key, NAME##_hash_key(key)) != SIZE_MAX; \
+} \
+\
+static inline bool NAME##_remove(NAME *set, KEY_TYPE key) { \
+    if (!set) return false; \
+    size_t probe = NAME##_find(set, key, NAME##_hash_key(key)); \
+    if (probe == SIZE_MAX) return false; \
+    FREE_KEY_FN(set->entries[probe].key); \
+    /* Backward shift deletion */ \
+    for (;;) { \
+        size_t next = (probe + 1) & set->mask; \
+        if (set->entries[next].dist <= 1) break; \
+        set->entries[probe] = set->entries[next]; \
+        set->entries[probe].dist--; \
+        probe = next; \
+    } \
+    set->entries[probe].dist = 0; \
+    set->size--; \
+    return true; \
+} \
+\
+/* Batched operations: hash (or take the stored hash of) a chunk of keys and */ \
+/* prefetch every home slot before resolving any of them */ \
+static inline void NAME##_prefetch_batch(const NAME *set, const NAME##_Key *keys, uint32_t *hashes, size_t n) { \
+    for (size_t i = 0; i < n; i++) { \
+        hashes[i] = NAME##_hash_key(keys[i]); \
+        DICT_PREFETCH(&set->entries[hashes[i] & set->mask]); \
+    } \
+} \
+\
+/* Returns the number of keys that were newly added */ \
+static inline size_t NAME##_add_many(NAME *set, const NAME##_Key *keys, size_t n) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    size_t added = 0; \
+    for (size_t base = 0; base < n && set; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        /* Grow up front so the prefetched slots are the ones written */ \
+        NAME##_reserve(set, set->size + m); \
+        NAME##_prefetch_batch(set, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) \
+            added += NAME##_add_hashed(set, keys[base + i], hashes[i]); \
+    } \
+    return added; \
+} \
+\
+/* Returns the number of keys present; out may be NULL */ \
+static inline size_t NAME##_contains_many(const NAME *set, const NAME##_Key *keys, size_t n, bool *out) { \
+    uint32_t hashes[DICT_BATCH_SIZE]; \
+    size_t found = 0; \
+    for (size_t base = 0; base < n && set; base += DICT_BATCH_SIZE) { \
+        size_t m = n - base < DICT_BATCH_SIZE ? n - base : DICT_BATCH_SIZE; \
+        NAME##_prefetch_batch(set, keys + base, hashes, m); \
+        for (size_t i = 0; i < m; i++) { \
+            bool hit = NAME##_find(set, keys[base + i], hashes[i]) != SIZE_MAX; \
+            if (out) out[base + i] = hit; \
+            found += hit; \
+        } \
+    } \
+    if (!set && out) memset(out, 0, n * sizeof(bool)); \
+    return found; \
+} \
+\
+/* Collects up to DICT_BATCH_SIZE occupied slots of src from *pos on and */ \
+/* prefetches their home slots in other */ \
+static inline size_t NAME##_gather_batch(const NAME *src, size_t *pos, const NAME *other, \
+                                         const NAME##_Entry **batch) { \
+    size_t m = 0; \
+    while (m < DICT_BATCH_SIZE && *pos <= src->mask) { \
+        const NAME##_Entry *e = &src->entries[(*pos)++]; \
+        if (!e->dist) continue; \
+        DICT_PREFETCH(&other->entries[e->hash & other->mask]); \
+        batch[m++] = e; \
+    } \
+    return m; \
+} \
+\
+/* Adds every key of src to dst; returns the number newly added */ \
+static inline size_t NAME##_union_into(NAME *dst, const NAME *src) { \
+    if (!dst || !src || dst == src) return 0; \
+    const NAME##_Entry *batch[DICT_BATCH_SIZE]; \
+    size_t added = 0, pos = 0, m; \
+    /* The union has at least max(sizes) keys: reserve that, so overlapping */ \
+    /* sets never over-allocate; add_hashed grows for any further new keys */ \
+    NAME##_reserve(dst, dst->size > src->size ? dst->size : src->size); \
+    while ((m = NAME##_gather_batch(src, &pos, dst, batch)) > 0) { \
+        for (size_t i = 0; i < m; i++) \
+            added += NAME##_add_hashed(dst, batch[i]->key, batch[i]->hash); \
+    } \
+    return added; \
+} \
+\
+/* New set of the keys in both a and b (walks the smaller one) */ \
+static inline NAME* NAME##_intersect(const NAME *a, const NAME *b) { \
+    if (!a || !b) return NULL; \
+    if (b->size < a->size) { const NAME *t = a; a = b; b = t; } \
+    NAME *out = NAME##_create_with_capacity(a->size); \
+    if (!out) return NULL; \
+    const NAME##_Entry *batch[DICT_BATCH_SIZE]; \
+    size_t pos = 0, m; \
+    while ((m = NAME##_gather_batch(a, &pos, b, batch)) > 0) { \
+        for (size_t i = 0; i < m; i++) { \
+            if (NAME##_find(b, batch[i]->key, batch[i]->hash) != SIZE_MAX) \
+                NAME##_add_hashed(out, batch[i]->key, batch[i]->hash); \
+        } \
+    } \
+    return out; \
+} \
+\
+/* New set of the keys in a that are not in b */ \
+static inline NAME* NAME##_difference(const NAME *a, const NAME *b) { \
+    if (!a || !b) return NULL; \
+    NAME *out = NAME##_create_with_capacity(a->size); \
+    if (!out) return NULL; \
+    const NAME##_Entry *batch[DICT_BATCH_SIZE]; \
+    size_t pos = 0, m; \
+    while ((m = NAME##_gather_batch(a, &pos, b, batch)) > 0) { \
+        for (size_t i = 0; i < m; i++) { \
+            if (NAME##_find(b, batch[i]->key, batch[i]->hash) == SIZE_MAX) \
+                NAME##_add_hashed(out, batch[i]->key, batch[i]->hash); \
+        } \
+    } \
+    return out; \
+} \
+\
+static inline size_t NAME##_size(const NAME *set) { \
+    return set ? set->size : 0; \
+} \
+\
+static inline size_t NAME##_capacity(const NAME *set) { \
+    return set ? set->mask + 1 : 0; \
+} \
+\
+static inline bool NAME##_empty(const NAME *set) { \
+    return !set || set->size == 0; \
+} \
+\
+static inline void NAME##_clear(NAME *set) { \
+    if (!set) return; \
+    for (size_t i = 0; i <= set->mask; i++) { \
+        if (set->entries[i].dist) { \
+            FREE_KEY_FN(set->entries[i].key); \
+            set->entries[i].dist = 0; \
+        } \
+    } \
+    set->size = 0; \
+} \
+\
+static inline size_t NAME##_memory_usage(const NAME *set) { \
+    if (!set) return 0; \
+    size_t bytes = sizeof(NAME) + (set->mask + 1) * sizeof(NAME##_Entry); \
+    for (size_t i = 0; i <= set->mask; i++) { \
+        if (set->entries[i].dist) bytes += dict_owned_key_bytes(&set->entries[i].key); \
+    } \
+    return bytes; \
+} \
+\
+static inline NAME##_Iterator NAME##_iter(NAME *set) { \
+    NAME##_Iterator iter = {set, 0}; \
+    return iter; \
+} \
+\
+static inline bool NAME##_next(NAME##_Iterator *iter, KEY_TYPE *key) { \
+    if (!iter || !iter->set) return false; \
+    while (iter->index <= iter->set->mask) { \
+        const NAME##_Entry *e = &iter->set->entries[iter->index++]; \
+        if (e->dist) { \
+            if (key) *key = e->key; \
             return true; \
         } \
-        iter->index++; \
     } \
     return false; \
 }
 
+// ============================================================================
+// DICT_DEFINE_STATIC macro - perfect hash table for a fixed string key set
+// ============================================================================
+//
+// Hash and displace: keys are grouped into buckets by the high bits of their
+// wyhash, and each bucket gets a seed chosen at build time such that
+// dict_perfect_slot(hash, seed) sends all of its keys to distinct free slots.
+// A lookup is one wyhash, one multiply and one compare, with no probe loop.
+// The table is built once from the key list (O(n), microseconds for a few
+// thousand keys) and is read-only afterwards. Keys are not copied.
+
+// Seeds tried per bucket before the build retries with more slots
+#ifndef DICT_PERFECT_MAX_SEED
+#define DICT_PERFECT_MAX_SEED (1u << 16)
+#endif
+
+static inline size_t dict_perfect_slot(uint64_t hash, uint32_t seed, size_t slot_mask) {
+    return (size_t)dict_wymix(hash ^ dict_wyhash_secret[2], seed ^ dict_wyhash_secret[3]) & slot_mask;
+}
+
+static inline size_t dict_perfect_bucket(uint64_t hash, size_t bucket_mask) {
+    return (size_t)(hash >> 32) & bucket_mask;
+}
+
+// Picks a seed per bucket (largest buckets first) and writes each key's slot
+// to slot_of. Fails on equal hashes (duplicate keys) or if a bucket runs out
+// of seeds.
+static inline bool dict_perfect_build(const uint64_t *hashes, size_t n, size_t slot_mask,
+                                      size_t bucket_mask, uint32_t *seeds, size_t *slot_of) {
+    size_t nbuckets = bucket_mask + 1;
+    size_t *start = (size_t*)calloc(nbuckets + 1, sizeof(size_t));
+    size_t *members = (size_t*)malloc((n ? n : 1) * sizeof(size_t));
+    size_t *by_size = (size_t*)malloc(nbuckets * sizeof(size_t));
+    size_t *size_start = (size_t*)calloc(n + 2, sizeof(size_t));
+    uint8_t *taken = (uint8_t*)calloc(slot_mask + 1, 1);
+    bool ok = start && members && by_size && size_start && taken;
+    
+    if (ok) {
+        // Counting sort of keys by bucket, then of buckets by size (descending)
+        for (size_t i = 0; i < n; i++) start[dict_perfect_bucket(hashes[i], bucket_mask) + 1]++;
+        for (size_t b = 0; b < nbuckets; b++) start[b + 1] += start[b];
+        memcpy(by_size, start, nbuckets * sizeof(size_t));  /* fill cursors */
+        for (size_t i = 0; i < n; i++) members[by_size[dict_perfect_bucket(hashes[i], bucket_mask)]++] = i;
+        for (size_t b = 0; b < nbuckets; b++) size_start[n - (start[b + 1] - start[b]) + 1]++;
+        for (size_t k = 0; k <= n; k++) size_start[k + 1] += size_start[k];
+        for (size_t b = 0; b < nbuckets; b++) by_size[size_start[n - (start[b + 1] - start[b])]++] = b;
+    }
+    
+    for (size_t j = 0; ok && j < nbuckets; j++) {
+        size_t b = by_size[j];
+        const size_t *keys = members + start[b];
+        size_t count = start[b + 1] - start[b];
+        seeds[b] = 0;
+        if (count == 0) continue;
+        for (size_t x = 0; ok && x < count; x++)
+            for (size_t y = x + 1; y < count; y++)
+                if (hashes[keys[x]] == hashes[keys[y]]) ok = false;
+        bool placed = false;
+        for (uint32_t seed = 0; ok && !placed && seed < DICT_PERFECT_MAX_SEED; seed++) {
+            size_t x = 0;
+            for (; x < count; x++) {
+                size_t slot = dict_perfect_slot(hashes[keys[x]], seed, slot_mask);
+                if (taken[slot]) break;
+                taken[slot] = 1;
+                slot_of[keys[x]] = slot;
+            }
+            if (x == count) {
+                seeds[b] = seed;
+                placed = true;
+            } else {
+                while (x-- > 0) taken[slot_of[keys[x]]] = 0;
+            }
+        }
+        if (!placed) ok = false;
+    }
+    
+    free(start);
+    free(members);
+    free(by_size);
+    free(size_start);
+    free(taken);
+    return ok;
+}
+
+#define DICT_DEFINE_STATIC(NAME, VALUE_TYPE) \
+\
+typedef VALUE_TYPE NAME##_Value; \
+\
+typedef struct { \
+    const char *key;  /* NULL = empty slot */ \
+    size_t len; \
+    uint64_t hash; \
+    VALUE_TYPE value; \
+} NAME##_Slot; \
+\
+typedef struct { \
+    uint32_t *seeds; \
+    NAME##_Slot *slots; \
+    size_t bucket_mask; \
+    size_t slot_mask; \
+    size_t size; \
+} NAME; \
+\
+static inline void NAME##_destroy(NAME *dict) { \
+    if (!dict) return; \
+    free(dict->seeds); \
+    free(dict->slots); \
+    free(dict); \
+} \
+\
+/* Builds the table for n distinct keys; the key strings must outlive it. */ \
+/* Returns NULL on duplicate keys or allocation failure. */ \
+static inline NAME* NAME##_create(const char *const *keys, const VALUE_TYPE *values, size_t n) { \
+    NAME *dict = (NAME*)calloc(1, sizeof(NAME)); \
+    uint64_t *hashes = (uint64_t*)malloc((n ? n : 1) * sizeof(uint64_t)); \
+    size_t *slot_of = (size_t*)malloc((n ? n : 1) * sizeof(size_t)); \
+    size_t buckets = 1, slots = 8; \
+    while (buckets * 4 < n) buckets <<= 1; \
+    while (slots < n + n / 4) slots <<= 1; \
+    bool ok = dict && hashes && slot_of; \
+    if (ok) { \
+        for (size_t i = 0; i < n; i++) hashes[i] = dict_wyhash(keys[i], strlen(keys[i]), 0); \
+        dict->bucket_mask = buckets - 1; \
+        dict->seeds = (uint32_t*)malloc(buckets * sizeof(uint32_t)); \
+        ok = dict->seeds != NULL; \
+    } \
+    /* Retry with twice the slots if some bucket found no seed */ \
+    for (int attempt = 0; ok; attempt++, slots <<= 1) { \
+        if (dict_perfect_build(hashes, n, slots - 1, dict->bucket_mask, dict->seeds, slot_of)) break; \
+        if (attempt == 3) ok = false; \
+    } \
+    if (ok) { \
+        dict->slot_mask = slots - 1; \
+        dict->slots = (NAME##_Slot*)calloc(slots, sizeof(NAME##_Slot)); \
+        ok = dict->slots != NULL; \
+    } \
+    if (ok) { \
+        for (size_t i = 0; i < n; i++) { \
+            NAME##_Slot *slot = &dict->slots[slot_of[i]]; \
+            slot->key = keys[i]; \
+            slot->len = strlen(keys[i]); \
+            slot->hash = hashes[i]; \
+            slot->value = values[i]; \
+        } \
+        dict->size = n; \
+    } \
+    free(hashes); \
+    free(slot_of); \
+    if (!ok) { \
+        NAME##_destroy(dict); \
+        return NULL; \
+    } \
+    return dict; \
+} \
+\
+/* The only slot key can be in, if it is in the set */ \
+static inline const NAME##_Slot* NAME##_find(const NAME *dict, const char *key, size_t len) { \
+    uint64_t h = dict_wyhash(key, len, 0); \
+    uint32_t seed = dict->seeds[dict_perfect_bucket(h, dict->bucket_mask)]; \
+    const NAME##_Slot *slot = &dict->slots[dict_perfect_slot(h, seed, dict->slot_mask)]; \
+    if (slot->key && slot->hash == h && slot->len == len && memcmp(slot->key, key, len) == 0) \
+        return slot; \
+    return NULL; \
+} \
+\
+static inline VALUE_TYPE NAME##_getn(const NAME *dict, const char *key, size_t len, VALUE_TYPE default_val) { \
+    if (!dict) return default_val; \
+    const NAME##_Slot *slot = NAME##_find(dict, key, len); \
+    return slot ? slot->value : default_val; \
+} \
+\
+static inline VALUE_TYPE NAME##_get(const NAME *dict, const char *key, VALUE_TYPE default_val) { \
+    return NAME##_getn(dict, key, strlen(key), default_val); \
+} \
+\
+static inline bool NAME##_contains(const NAME *dict, const char *key) { \
+    return dict && NAME##_find(dict, key, strlen(key)) != NULL; \
+} \
+\
+static inline size_t NAME##_size(const NAME *dict) { \
+    return dict ? dict->size : 0; \
+} \
+\
+static inline size_t NAME##_memory_usage(const NAME *dict) { \
+    if (!dict) return 0; \
+    return sizeof(NAME) + (dict->bucket_mask + 1) * sizeof(uint32_t) + \
+           (dict->slot_mask + 1) * sizeof(NAME##_Slot); \
+}
+
 // ============================================================================
 // Convenience macros for common types
 // ============================================================================
@@ -434,6 +3304,88 @@ static inline bool NAME##_next(NAME##_Iterator *iter, KEY_TYPE *key, VALUE_TYPE
 #define DICT_DEFINE_PTR_PTR(NAME) \
     DICT_DEFINE(NAME, void*, void*, dict_hash_ptr, dict_eq_ptr, dict_copy_val, dict_free_val)
 
+// Dict<dict_strlen_t, VALUE_TYPE> - length-carrying keys, wyhash
+#define DICT_DEFINE_STRLEN(NAME, VALUE_TYPE) \
+    DICT_DEFINE(NAME, dict_strlen_t, VALUE_TYPE, dict_hash_strlen, dict_eq_strlen, dict_copy_strlen, dict_free_strlen)
+
+#define DICT_DEFINE_STRLEN_INT(NAME) DICT_DEFINE_STRLEN(NAME, int)
+#define DICT_DEFINE_STRLEN_DOUBLE(NAME) DICT_DEFINE_STRLEN(NAME, double)
+#define DICT_DEFINE_STRLEN_PTR(NAME) DICT_DEFINE_STRLEN(NAME, void*)
+
+// Dict<dict_sso_t, VALUE_TYPE> - short keys stored inline in the entry
+#define DICT_DEFINE_SSO(NAME, VALUE_TYPE) \
+    DICT_DEFINE(NAME, dict_sso_t, VALUE_TYPE, dict_hash_sso, dict_eq_sso, dict_copy_sso, dict_free_sso)
+
+#define DICT_DEFINE_SSO_INT(NAME) DICT_DEFINE_SSO(NAME, int)
+#define DICT_DEFINE_SSO_DOUBLE(NAME) DICT_DEFINE_SSO(NAME, double)
+#define DICT_DEFINE_SSO_PTR(NAME) DICT_DEFINE_SSO(NAME, void*)
+
+// Arena-backed string keys
+#define DICT_DEFINE_ARENA_STR_INT(NAME) \
+    DICT_DEFINE_ARENA(NAME, char*, int, dict_hash_str, dict_eq_str, dict_arena_copy_str)
+
+#define DICT_DEFINE_ARENA_STR_DOUBLE(NAME) \
+    DICT_DEFINE_ARENA(NAME, char*, double, dict_hash_str, dict_eq_str, dict_arena_copy_str)
+
+#define DICT_DEFINE_ARENA_STR_PTR(NAME) \
+    DICT_DEFINE_ARENA(NAME, char*, void*, dict_hash_str, dict_eq_str, dict_arena_copy_str)
+
+#define DICT_DEFINE_ARENA_STRLEN(NAME, VALUE_TYPE) \
+    DICT_DEFINE_ARENA(NAME, dict_strlen_t, VALUE_TYPE, dict_hash_strlen, dict_eq_strlen, dict_arena_copy_strlen)
+
+// Insertion-ordered variants
+#define DICT_DEFINE_ORDERED_STR_INT(NAME) \
+    DICT_DEFINE_ORDERED(NAME, char*, int, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+#define DICT_DEFINE_ORDERED_INT_INT(NAME) \
+    DICT_DEFINE_ORDERED(NAME, int, int, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+
+// Key-only sets
+#define DICT_DEFINE_SET_STR(NAME) \
+    DICT_DEFINE_SET(NAME, char*, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+#define DICT_DEFINE_SET_INT(NAME) \
+    DICT_DEFINE_SET(NAME, int, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+
+#define DICT_DEFINE_SET_UINT64(NAME) \
+    DICT_DEFINE_SET(NAME, uint64_t, dict_hash_uint64, dict_eq_uint64, dict_copy_val, dict_free_val)
+
+// Swiss table variants
+#define DICT_DEFINE_SWISS_STRLEN_INT(NAME) \
+    DICT_DEFINE_SWISS(NAME, dict_strlen_t, int, dict_hash_strlen, dict_eq_strlen, dict_copy_strlen, dict_free_strlen)
+
+#define DICT_DEFINE_SWISS_STR_INT(NAME) \
+    DICT_DEFINE_SWISS(NAME, char*, int, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+#define DICT_DEFINE_SWISS_STR_PTR(NAME) \
+    DICT_DEFINE_SWISS(NAME, char*, void*, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+#define DICT_DEFINE_SWISS_INT_INT(NAME) \
+    DICT_DEFINE_SWISS(NAME, int, int, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+
+#define DICT_DEFINE_SWISS_UINT64_INT(NAME) \
+    DICT_DEFINE_SWISS(NAME, uint64_t, int, dict_hash_uint64, dict_eq_uint64, dict_copy_val, dict_free_val)
+
+// Packed meta word variants (one array of {key, meta, value})
+#define DICT_DEFINE_PACKED_STR_INT(NAME) \
+    DICT_DEFINE_PACKED(NAME, char*, int, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+#define DICT_DEFINE_PACKED_INT_INT(NAME) \
+    DICT_DEFINE_PACKED(NAME, int, int, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+
+#define DICT_DEFINE_PACKED_UINT64_INT(NAME) \
+    DICT_DEFINE_PACKED(NAME, uint64_t, int, dict_hash_uint64, dict_eq_uint64, dict_copy_val, dict_free_val)
+
+// Split variants (separate keys[], values[] and meta[] arrays)
+#define DICT_DEFINE_SPLIT_STR_INT(NAME) \
+    DICT_DEFINE_SPLIT(NAME, char*, int, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+#define DICT_DEFINE_SPLIT_INT_INT(NAME) \
+    DICT_DEFINE_SPLIT(NAME, int, int, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+
+#define DICT_DEFINE_SPLIT_UINT64_INT(NAME) \
+    DICT_DEFINE_SPLIT(NAME, uint64_t, int, dict_hash_uint64, dict_eq_uint64, dict_copy_val, dict_free_val)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,666 @@
+/*
+ * dict_concurrent.h - Thread-safe dictionary (lock striping + seqlock reads)
+ *
+ * Companion to dict.h. The key space is split across DICT_CONCURRENT_SEGMENTS
+ * independent segments, each a linear-probing table with its own mutex and
+ * sequence counter. Writers lock one segment; readers take no lock at all:
+ * they read the segment's sequence number, probe, and retry if a writer
+ * touched the segment in the meantime.
+ *
+ * Usage:
+ *   DICT_DEFINE_CONCURRENT_INT_INT(SharedCounts)
+ *
+ *   SharedCounts *d = SharedCounts_create();
+ *   SharedCounts_set(d, 42, 1);                  // from any thread
+ *   int v = SharedCounts_get(d, 42, 0);          // lock-free read
+ *   SharedCounts_destroy(d);                     // no other threads active
+ *
+ * Removed keys and the tables replaced by a resize are retired rather than
+ * freed, because a reader may still be looking at them. They are released by
+ * NAME##_reclaim, NAME##_clear or NAME##_destroy, which must only be called
+ * while no other thread is using the dict.
+ *
+ * Link with -pthread.
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef DICT_CONCURRENT_H
+#define DICT_CONCURRENT_H
+
+#include "dict.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+// Number of lock stripes (power of two, at most 256)
+#ifndef DICT_CONCURRENT_SEGMENTS
+#define DICT_CONCURRENT_SEGMENTS 64
+#endif
+
+#ifndef DICT_CACHE_LINE
+#define DICT_CACHE_LINE 64
+#endif
+
+#if defined(__SSE2__)
+#define DICT_CPU_RELAX() _mm_pause()
+#else
+#define DICT_CPU_RELAX() ((void)0)
+#endif
+
+// Spins on an odd sequence number before yielding to the writer
+#define DICT_SEQLOCK_SPINS 64
+
+// ============================================================================
+// Seqlock slot access
+// ============================================================================
+//
+// A reader can load a slot while the segment's writer is storing to it, so
+// both sides access live slot fields with relaxed atomics (keys and values
+// byte by byte, whatever their type), which keeps the race defined. The
+// write_begin fence and write_end release store order those stores against
+// the sequence number; a reader only trusts what it copied out once the
+// sequence number checks out.
+
+static inline void dict_seq_load(void *dst, const void *src, size_t n) {
+    unsigned char *d = (unsigned char*)dst;
+    const unsigned char *s = (const unsigned char*)src;
+    for (size_t i = 0; i < n; i++) d[i] = __atomic_load_n(s + i, __ATOMIC_RELAXED);
+}
+
+static inline void dict_seq_store(void *dst, const void *src, size_t n) {
+    unsigned char *d = (unsigned char*)dst;
+    const unsigned char *s = (const unsigned char*)src;
+    for (size_t i = 0; i < n; i++) __atomic_store_n(d + i, s[i], __ATOMIC_RELAXED);
+}
+
+// ============================================================================
+// DICT_DEFINE_CONCURRENT macro
+// ============================================================================
+
+#define DICT_DEFINE_CONCURRENT(NAME, KEY_TYPE, VALUE_TYPE, HASH_FN, EQ_FN, COPY_KEY_FN, FREE_KEY_FN) \
+\
+typedef struct { \
+    KEY_TYPE key; \
+    VALUE_TYPE value; \
+    uint32_t hash; \
+    uint32_t used; \
+} NAME##_Entry; \
+\
+typedef struct NAME##_Table { \
+    struct NAME##_Table *retired;  /* next table in the segment's retire list */ \
+    size_t mask; \
+    NAME##_Entry slots[]; \
+} NAME##_Table; \
+\
+typedef struct { \
+    _Alignas(DICT_CACHE_LINE) pthread_mutex_t lock; \
+    atomic_uint seq;  /* odd while a writer is modifying the segment */ \
+    NAME##_Table *_Atomic table; \
+    atomic_size_t size; \
+    NAME##_Table *retired_tables; \
+    KEY_TYPE *retired_keys; \
+    size_t retired_count; \
+    size_t retired_capacity; \
+} NAME##_Segment; \
+\
+typedef struct { \
+    NAME##_Segment *segments; \
+} NAME; \
+\
+static inline NAME##_Table* NAME##_alloc_table(size_t capacity) { \
+    NAME##_Table *t = (NAME##_Table*)calloc(1, sizeof(NAME##_Table) + capacity * sizeof(NAME##_Entry)); \
+    if (t) t->mask = capacity - 1; \
+    return t; \
+} \
+\
+static inline NAME* NAME##_create_with_capacity(size_t capacity) { \
+    NAME *dict = (NAME*)malloc(sizeof(NAME)); \
+    if (!dict) return NULL; \
+    dict->segments = (NAME##_Segment*)aligned_alloc(DICT_CACHE_LINE, \
+        DICT_CONCURRENT_SEGMENTS * sizeof(NAME##_Segment)); \
+    if (!dict->segments) { free(dict); return NULL; } \
+    size_t per_segment = 8; \
+    while (per_segment * DICT_CONCURRENT_SEGMENTS * 3 / 4 < capacity) per_segment *= 2; \
+    for (size_t i = 0; i < DICT_CONCURRENT_SEGMENTS; i++) { \
+        NAME##_Segment *seg = &dict->segments[i]; \
+        NAME##_Table *t = NAME##_alloc_table(per_segment); \
+        if (!t) { \
+            while (i > 0) { \
+                seg = &dict->segments[--i]; \
+                free(atomic_load_explicit(&seg->table, memory_order_relaxed)); \
+                pthread_mutex_destroy(&seg->lock); \
+            } \
+            free(dict->segments); \
+            free(dict); \
+            return NULL; \
+        } \
+        pthread_mutex_init(&seg->lock, NULL); \
+        atomic_init(&seg->seq, 0); \
+        atomic_init(&seg->table, t); \
+        atomic_init(&seg->size, 0); \
+        seg->retired_tables = NULL; \
+        seg->retired_keys = NULL; \
+        seg->retired_count = 0; \
+        seg->retired_capacity = 0; \
+    } \
+    return dict; \
+} \
+\
+static inline NAME* NAME##_create(void) { \
+    return NAME##_create_with_capacity(DICT_INITIAL_CAPACITY * DICT_CONCURRENT_SEGMENTS); \
+} \
+\
+static inline NAME##_Segment* NAME##_segment(NAME *dict, uint32_t hash) { \
+    return &dict->segments[hash & (DICT_CONCURRENT_SEGMENTS - 1)]; \
+} \
+\
+/* Writer-side linear probe from the home slot (segment lock held); the */ \
+/* low 8 bits select the segment */ \
+static inline size_t NAME##_probe(NAME##_Table *t, KEY_TYPE key, uint32_t hash) { \
+    size_t i = (hash >> 8) & t->mask; \
+    for (size_t n = 0; n <= t->mask; n++, i = (i + 1) & t->mask) { \
+        if (!t->slots[i].used) return SIZE_MAX; \
+        if (t->slots[i].hash == hash && EQ_FN(t->slots[i].key, key)) return i; \
+    } \
+    return SIZE_MAX; \
+} \
+\
+static inline size_t NAME##_probe_free(NAME##_Table *t, uint32_t hash) { \
+    size_t i = (hash >> 8) & t->mask; \
+    while (t->slots[i].used) i = (i + 1) & t->mask; \
+    return i; \
+} \
+\
+/* Stores a live slot, inside a write section */ \
+static inline void NAME##_publish(NAME##_Entry *slot, KEY_TYPE key, VALUE_TYPE value, uint32_t hash) { \
+    dict_seq_store(&slot->key, &key, sizeof(KEY_TYPE)); \
+    dict_seq_store(&slot->value, &value, sizeof(VALUE_TYPE)); \
+    __atomic_store_n(&slot->hash, hash, __ATOMIC_RELAXED); \
+    __atomic_store_n(&slot->used, 1, __ATOMIC_RELAXED); \
+} \
+\
+/* Writers bracket every visible change with an odd/even seq pair */ \
+static inline void NAME##_write_begin(NAME##_Segment *seg) { \
+    unsigned seq = atomic_load_explicit(&seg->seq, memory_order_relaxed); \
+    atomic_store_explicit(&seg->seq, seq + 1, memory_order_relaxed); \
+    atomic_thread_fence(memory_order_release); \
+} \
+\
+static inline void NAME##_write_end(NAME##_Segment *seg) { \
+    unsigned seq = atomic_load_explicit(&seg->seq, memory_order_relaxed); \
+    atomic_store_explicit(&seg->seq, seq + 1, memory_order_release); \
+} \
+\
+static inline unsigned NAME##_read_begin(NAME##_Segment *seg) { \
+    unsigned seq; \
+    int spins = 0; \
+    while ((seq = atomic_load_explicit(&seg->seq, memory_order_acquire)) & 1) { \
+        if (++spins < DICT_SEQLOCK_SPINS) { \
+            DICT_CPU_RELAX(); \
+        } else { \
+            sched_yield(); \
+            spins = 0; \
+        } \
+    } \
+    return seq; \
+} \
+\
+static inline bool NAME##_read_retry(NAME##_Segment *seg, unsigned seq) { \
+    atomic_thread_fence(memory_order_acquire); \
+    return atomic_load_explicit(&seg->seq, memory_order_relaxed) != seq; \
+} \
+\
+/* Lock-free lookup: copies the value out if found. A candidate key is */ \
+/* copied out and the sequence number re-checked before EQ_FN sees it, */ \
+/* since a slot being filled may not hold a valid key yet. */ \
+static inline bool NAME##_lookup(NAME *dict, KEY_TYPE key, VALUE_TYPE *out) { \
+    uint32_t hash = dict_swiss_mix(HASH_FN(key)); \
+    NAME##_Segment *seg = NAME##_segment(dict, hash); \
+    VALUE_TYPE value; \
+    bool found; \
+    unsigned seq; \
+    do { \
+        seq = NAME##_read_begin(seg); \
+        NAME##_Table *t = atomic_load_explicit(&seg->table, memory_order_acquire); \
+        found = false; \
+        size_t i = (hash >> 8) & t->mask; \
+        for (size_t n = 0; n <= t->mask; n++, i = (i + 1) & t->mask) { \
+            NAME##_Entry *slot = &t->slots[i]; \
+            if (!__atomic_load_n(&slot->used, __ATOMIC_RELAXED)) break; \
+            if (__atomic_load_n(&slot->hash, __ATOMIC_RELAXED) != hash) continue; \
+            KEY_TYPE candidate; \
+            dict_seq_load(&candidate, &slot->key, sizeof(KEY_TYPE)); \
+            if (NAME##_read_retry(seg, seq)) break;  /* retried by the loop */ \
+            if (EQ_FN(candidate, key)) { \
+                dict_seq_load(&value, &slot->value, sizeof(VALUE_TYPE)); \
+                found = true; \
+                break; \
+            } \
+        } \
+    } while (NAME##_read_retry(seg, seq)); \
+    if (found && out) *out = value; \
+    return found; \
+} \
+\
+static inline VALUE_TYPE NAME##_get(NAME *dict, KEY_TYPE key, VALUE_TYPE default_val) { \
+    if (!dict) return default_val; \
+    VALUE_TYPE value; \
+    return NAME##_lookup(dict, key, &value) ? value : default_val; \
+} \
+\
+static inline bool NAME##_contains(NAME *dict, KEY_TYPE key) { \
+    return dict && NAME##_lookup(dict, key, NULL); \
+} \
+\
+/* Builds the doubled table off to the side; readers keep using the old */ \
+/* one until the new pointer is published inside a write section */ \
+static inline NAME##_Table* NAME##_grow(NAME##_Segment *seg, NAME##_Table *t) { \
+    NAME##_Table *bigger = NAME##_alloc_table((t->mask + 1) * 2); \
+    if (!bigger) return NULL; \
+    for (size_t i = 0; i <= t->mask; i++) { \
+        if (t->slots[i].used) \
+            bigger->slots[NAME##_probe_free(bigger, t->slots[i].hash)] = t->slots[i]; \
+    } \
+    NAME##_write_begin(seg); \
+    atomic_store_explicit(&seg->table, bigger, memory_order_release); \
+    NAME##_write_end(seg); \
+    t->retired = seg->retired_tables; \
+    seg->retired_tables = t; \
+    return bigger; \
+} \
+\
+static inline bool NAME##_set(NAME *dict, KEY_TYPE key, VALUE_TYPE value) { \
+    if (!dict) return false; \
+    uint32_t hash = dict_swiss_mix(HASH_FN(key)); \
+    NAME##_Segment *seg = NAME##_segment(dict, hash); \
+    pthread_mutex_lock(&seg->lock); \
+    NAME##_Table *t = atomic_load_explicit(&seg->table, memory_order_relaxed); \
+    size_t idx = NAME##_probe(t, key, hash); \
+    if (idx != SIZE_MAX) { \
+        NAME##_write_begin(seg); \
+        dict_seq_store(&t->slots[idx].value, &value, sizeof(VALUE_TYPE)); \
+        NAME##_write_end(seg); \
+        pthread_mutex_unlock(&seg->lock); \
+        return false; \
+    } \
+    size_t size = atomic_load_explicit(&seg->size, memory_order_relaxed); \
+    if ((size + 1) * 4 > (t->mask + 1) * 3) { \
+        NAME##_Table *bigger = NAME##_grow(seg, t); \
+        if (!bigger) { pthread_mutex_unlock(&seg->lock); return false; } \
+        t = bigger; \
+    } \
+    KEY_TYPE copy = COPY_KEY_FN(key); \
+    idx = NAME##_probe_free(t, hash); \
+    NAME##_write_begin(seg); \
+    NAME##_publish(&t->slots[idx], copy, value, hash); \
+    NAME##_write_end(seg); \
+    atomic_store_explicit(&seg->size, size + 1, memory_order_relaxed); \
+    pthread_mutex_unlock(&seg->lock); \
+    return true; \
+} \
+\
+static inline bool NAME##_remove(NAME *dict, KEY_TYPE key) { \
+    if (!dict) return false; \
+    uint32_t hash = dict_swiss_mix(HASH_FN(key)); \
+    NAME##_Segment *seg = NAME##_segment(dict, hash); \
+    pthread_mutex_lock(&seg->lock); \
+    NAME##_Table *t = atomic_load_explicit(&seg->table, memory_order_relaxed); \
+    size_t i = NAME##_probe(t, key, hash); \
+    if (i == SIZE_MAX) { \
+        pthread_mutex_unlock(&seg->lock); \
+        return false; \
+    } \
+    if (seg->retired_count == seg->retired_capacity) { \
+        size_t cap = seg->retired_capacity ? seg->retired_capacity * 2 : 16; \
+        KEY_TYPE *keys = (KEY_TYPE*)realloc(seg->retired_keys, cap * sizeof(KEY_TYPE)); \
+        if (!keys) { pthread_mutex_unlock(&seg->lock); return false; } \
+        seg->retired_keys = keys; \
+        seg->retired_capacity = cap; \
+    } \
+    seg->retired_keys[seg->retired_count++] = t->slots[i].key; \
+    NAME##_write_begin(seg); \
+    /* Backward shift: pull later entries of the cluster into the hole */ \
+    __atomic_store_n(&t->slots[i].used, 0, __ATOMIC_RELAXED); \
+    for (size_t j = i;;) { \
+        j = (j + 1) & t->mask; \
+        if (!t->slots[j].used) break; \
+        size_t home = (t->slots[j].hash >> 8) & t->mask; \
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) continue; \
+        NAME##_publish(&t->slots[i], t->slots[j].key, t->slots[j].value, t->slots[j].hash); \
+        __atomic_store_n(&t->slots[j].used, 0, __ATOMIC_RELAXED); \
+        i = j; \
+    } \
+    NAME##_write_end(seg); \
+    atomic_fetch_sub_explicit(&seg->size, 1, memory_order_relaxed); \
+    pthread_mutex_unlock(&seg->lock); \
+    return true; \
+} \
+\
+static inline size_t NAME##_size(NAME *dict) { \
+    if (!dict) return 0; \
+    size_t size = 0; \
+    for (size_t i = 0; i < DICT_CONCURRENT_SEGMENTS; i++) \
+        size += atomic_load_explicit(&dict->segments[i].size, memory_order_relaxed); \
+    return size; \
+} \
+\
+static inline bool NAME##_empty(NAME *dict) { \
+    return NAME##_size(dict) == 0; \
+} \
+\
+/* Frees retired keys and tables. Caller guarantees no concurrent access. */ \
+static inline void NAME##_reclaim(NAME *dict) { \
+    if (!dict) return; \
+    for (size_t i = 0; i < DICT_CONCURRENT_SEGMENTS; i++) { \
+        NAME##_Segment *seg = &dict->segments[i]; \
+        for (size_t k = 0; k < seg->retired_count; k++) \
+            FREE_KEY_FN(seg->retired_keys[k]); \
+        seg->retired_count = 0; \
+        while (seg->retired_tables) { \
+            NAME##_Table *next = seg->retired_tables->retired; \
+            free(seg->retired_tables); \
+            seg->retired_tables = next; \
+        } \
+    } \
+} \
+\
+/* Removes all entries. Caller guarantees no concurrent access. */ \
+static inline void NAME##_clear(NAME *dict) { \
+    if (!dict) return; \
+    for (size_t i = 0; i < DICT_CONCURRENT_SEGMENTS; i++) { \
+        NAME##_Segment *seg = &dict->segments[i]; \
+        NAME##_Table *t = atomic_load_explicit(&seg->table, memory_order_relaxed); \
+        for (size_t k = 0; k <= t->mask; k++) { \
+            if (t->slots[k].used) { \
+                FREE_KEY_FN(t->slots[k].key); \
+                t->slots[k].used = 0; \
+            } \
+        } \
+        atomic_store_explicit(&seg->size, 0, memory_order_relaxed); \
+    } \
+    NAME##_reclaim(dict); \
+} \
+\
+static inline void NAME##_destroy(NAME *dict) { \
+    if (!dict) return; \
+    NAME##_clear(dict); \
+    for (size_t i = 0; i < DICT_CONCURRENT_SEGMENTS; i++) { \
+        NAME##_Segment *seg = &dict->segments[i]; \
+        free(atomic_load_explicit(&seg->table, memory_order_relaxed)); \
+        free(seg->retired_keys); \
+        pthread_mutex_destroy(&seg->lock); \
+    } \
+    free(dict->segments); \
+    free(dict); \
+}
+
+// ============================================================================
+// DICT_DEFINE_SHARDED macro
+// ============================================================================
+
+/*
+ * Per-thread aggregation over an existing DICT_DEFINE type. Each worker
+ * updates only its own local table (no locking), then NAME##_merge splits
+ * every local table by hash partition and combines the partitions in
+ * parallel into nparts disjoint result tables.
+ *
+ *   DICT_DEFINE_STR_INT(WordDict)
+ *   DICT_DEFINE_SHARDED(WordShards, WordDict)
+ *
+ *   WordShards *s = WordShards_create(nthreads, dict_combine_sum_int);
+ *   WordShards_update(s, tid, word, 1);          // in worker thread tid
+ *   WordShards_merge(s, nthreads);               // after workers finish
+ *   int n = WordShards_get(s, "the", 0);
+ */
+
+// Ready-made combine functions
+static inline int dict_combine_sum_int(int acc, int value) { return acc + value; }
+static inline int dict_combine_max_int(int acc, int value) { return value > acc ? value : acc; }
+static inline double dict_combine_sum_double(double acc, double value) { return acc + value; }
+
+// Maps a stored hash to one of n partitions independently of the table slot
+static inline size_t dict_partition(uint32_t hash, size_t n) {
+    return (size_t)(((uint64_t)dict_swiss_mix(hash) * n) >> 32);
+}
+
+// Runs fn on n tasks of task_size bytes, one thread each, and joins them.
+// Like dict_run_parallel, a task whose thread can't be started runs on the
+// calling thread instead. tids and started hold n elements.
+static inline void dict_run_tasks(void *(*fn)(void*), void *tasks, size_t task_size, size_t n,
+                                  pthread_t *tids, bool *started) {
+    for (size_t i = 0; i < n; i++) {
+        started[i] = pthread_create(&tids[i], NULL, fn, (char*)tasks + i * task_size) == 0;
+        if (!started[i]) fn((char*)tasks + i * task_size);
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (started[i]) pthread_join(tids[i], NULL);
+    }
+}
+
+#define DICT_DEFINE_SHARDED(NAME, DICT) \
+\
+typedef DICT##_Value (*NAME##_CombineFn)(DICT##_Value acc, DICT##_Value value); \
+\
+typedef struct { \
+    DICT **locals; \
+    size_t nthreads; \
+    DICT **parts;  /* merge results, one per hash partition */ \
+    size_t nparts; \
+    NAME##_CombineFn combine; \
+} NAME; \
+\
+static inline NAME* NAME##_create(size_t nthreads, NAME##_CombineFn combine) { \
+    NAME *s = (NAME*)malloc(sizeof(NAME)); \
+    if (!s) return NULL; \
+    s->locals = (DICT**)calloc(nthreads, sizeof(DICT*)); \
+    if (!s->locals) { free(s); return NULL; } \
+    for (size_t t = 0; t < nthreads; t++) { \
+        s->locals[t] = DICT##_create(); \
+        if (!s->locals[t]) { \
+            while (t > 0) DICT##_destroy(s->locals[--t]); \
+            free(s->locals); \
+            free(s); \
+            return NULL; \
+        } \
+    } \
+    s->nthreads = nthreads; \
+    s->parts = NULL; \
+    s->nparts = 0; \
+    s->combine = combine; \
+    return s; \
+} \
+\
+static inline void NAME##_free_parts(NAME *s) { \
+    for (size_t p = 0; p < s->nparts; p++) DICT##_destroy(s->parts[p]); \
+    free(s->parts); \
+    s->parts = NULL; \
+    s->nparts = 0; \
+} \
+\
+static inline void NAME##_destroy(NAME *s) { \
+    if (!s) return; \
+    for (size_t t = 0; t < s->nthreads; t++) DICT##_destroy(s->locals[t]); \
+    NAME##_free_parts(s); \
+    free(s->locals); \
+    free(s); \
+} \
+\
+/* The table owned by worker tid; only that thread may touch it */ \
+static inline DICT* NAME##_local(NAME *s, size_t tid) { \
+    return s->locals[tid]; \
+} \
+\
+/* Combines value into the worker's table, inserting it if the key is new */ \
+static inline void NAME##_update(NAME *s, size_t tid, DICT##_Key key, DICT##_Value value) { \
+    DICT *local = s->locals[tid]; \
+    uint32_t hash = DICT##_hash_key(key); \
+    bool inserted; \
+    DICT##_Value *acc = DICT##_slot_hashed(local, key, hash, value, &inserted); \
+    if (acc && !inserted) \
+        *acc = s->combine(*acc, value); \
+} \
+\
+typedef struct { \
+    NAME *s; \
+    size_t index; \
+    DICT##_Entry ***buckets;  /* per thread, entry pointers grouped by partition */ \
+    size_t **counts;          /* per thread, entries in each partition */ \
+} NAME##_MergeTask; \
+\
+/* Phase 1: bucket one local table's entries by partition */ \
+static inline void* NAME##_scatter(void *arg) { \
+    NAME##_MergeTask *task = (NAME##_MergeTask*)arg; \
+    NAME *s = task->s; \
+    DICT *local = s->locals[task->index]; \
+    size_t *counts = task->counts[task->index]; \
+    size_t *fill = counts + s->nparts; \
+    DICT##_Entry **buckets = task->buckets[task->index]; \
+    for (size_t i = 0; i < local->capacity; i++) { \
+        if (local->entries[i].dist) counts[dict_partition(local->entries[i].hash, s->nparts)]++; \
+    } \
+    for (size_t i = 0; i < local->old_capacity; i++) { \
+        if (local->old_entries[i].dist) counts[dict_partition(local->old_entries[i].hash, s->nparts)]++; \
+    } \
+    size_t offset = 0; \
+    for (size_t p = 0; p < s->nparts; p++) { \
+        fill[p] = offset; \
+        offset += counts[p]; \
+    } \
+    for (size_t i = 0; i < local->capacity; i++) { \
+        DICT##_Entry *e = &local->entries[i]; \
+        if (e->dist) buckets[fill[dict_partition(e->hash, s->nparts)]++] = e; \
+    } \
+    for (size_t i = 0; i < local->old_capacity; i++) { \
+        DICT##_Entry *e = &local->old_entries[i]; \
+        if (e->dist) buckets[fill[dict_partition(e->hash, s->nparts)]++] = e; \
+    } \
+    return NULL; \
+} \
+\
+/* Phase 2: combine one partition from every thread's buckets */ \
+static inline void* NAME##_gather(void *arg) { \
+    NAME##_MergeTask *task = (NAME##_MergeTask*)arg; \
+    NAME *s = task->s; \
+    size_t p = task->index; \
+    size_t largest = 0; \
+    for (size_t t = 0; t < s->nthreads; t++) { \
+        if (task->counts[t][p] > largest) largest = task->counts[t][p]; \
+    } \
+    DICT *part = DICT##_create(); \
+    s->parts[p] = part; \
+    if (!part) return NULL; \
+    DICT##_reserve(part, largest); \
+    for (size_t t = 0; t < s->nthreads; t++) { \
+        size_t start = 0; \
+        for (size_t q = 0; q < p; q++) start += task->counts[t][q]; \
+        DICT##_Entry **items = task->buckets[t] + start; \
+        for (size_t i = 0; i < task->counts[t][p]; i++) { \
+            DICT##_Entry *e = items[i]; \
+            bool inserted; \
+            DICT##_Value *acc = DICT##_slot_hashed(part, e->key, e->hash, e->value, &inserted); \
+            if (acc && !inserted) \
+                *acc = s->combine(*acc, e->value); \
+        } \
+    } \
+    return NULL; \
+} \
+\
+/* Merges all local tables into nparts partitions using up to */ \
+/* max(nthreads, nparts) threads. Local tables are kept and may be reused. */ \
+static inline bool NAME##_merge(NAME *s, size_t nparts) { \
+    if (!s || nparts == 0) return false; \
+    NAME##_free_parts(s); \
+    size_t nt = s->nthreads; \
+    size_t ntasks = nt > nparts ? nt : nparts; \
+    bool ok = false; \
+    s->parts = (DICT**)calloc(nparts, sizeof(DICT*)); \
+    DICT##_Entry ***buckets = (DICT##_Entry***)calloc(nt, sizeof(DICT##_Entry**)); \
+    size_t **counts = (size_t**)calloc(nt, sizeof(size_t*)); \
+    NAME##_MergeTask *tasks = (NAME##_MergeTask*)malloc(ntasks * sizeof(NAME##_MergeTask)); \
+    pthread_t *tids = (pthread_t*)malloc(ntasks * sizeof(pthread_t)); \
+    bool *started = (bool*)malloc(ntasks * sizeof(bool)); \
+    if (!s->parts || !buckets || !counts || !tasks || !tids || !started) goto NAME##_merge_out; \
+    s->nparts = nparts; \
+    for (size_t t = 0; t < nt; t++) { \
+        size_t n = s->locals[t]->size ? s->locals[t]->size : 1; \
+        buckets[t] = (DICT##_Entry**)malloc(n * sizeof(DICT##_Entry*)); \
+        counts[t] = (size_t*)calloc(nparts * 2, sizeof(size_t));  /* counts, then fill cursors */ \
+        if (!buckets[t] || !counts[t]) goto NAME##_merge_out; \
+    } \
+    for (size_t i = 0; i < ntasks; i++) { \
+        tasks[i].s = s; \
+        tasks[i].index = i; \
+        tasks[i].buckets = buckets; \
+        tasks[i].counts = counts; \
+    } \
+    dict_run_tasks(NAME##_scatter, tasks, sizeof(NAME##_MergeTask), nt, tids, started); \
+    dict_run_tasks(NAME##_gather, tasks, sizeof(NAME##_MergeTask), nparts, tids, started); \
+    ok = true; \
+    for (size_t p = 0; p < nparts; p++) ok = ok && s->parts[p]; \
+NAME##_merge_out: \
+    for (size_t t = 0; t < nt && buckets && counts; t++) { \
+        free(buckets[t]); \
+        free(counts[t]); \
+    } \
+    free(buckets); \
+    free(counts); \
+    free(tasks); \
+    free(tids); \
+    free(started); \
+    if (!ok && s->parts) NAME##_free_parts(s); \
+    return ok; \
+} \
+\
+/* Lookups and iteration over the merged result */ \
+static inline DICT##_Value NAME##_get(NAME *s, DICT##_Key key, DICT##_Value default_val) { \
+    if (!s || !s->nparts) return default_val; \
+    uint32_t hash = DICT##_hash_key(key); \
+    DICT##_Value *v = DICT##_lookup(s->parts[dict_partition(hash, s->nparts)], key, hash); \
+    return v ? *v : default_val; \
+} \
+\
+static inline DICT* NAME##_part(NAME *s, size_t p) { \
+    return s && p < s->nparts ? s->parts[p] : NULL; \
+} \
+\
+static inline size_t NAME##_size(NAME *s) { \
+    size_t size = 0; \
+    for (size_t p = 0; s && p < s->nparts; p++) size += DICT##_size(s->parts[p]); \
+    return size; \
+}
+
+// ============================================================================
+// Convenience macros for common types
+// ============================================================================
+
+// ConcurrentDict<string, int>
+#define DICT_DEFINE_CONCURRENT_STR_INT(NAME) \
+    DICT_DEFINE_CONCURRENT(NAME, char*, int, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+// ConcurrentDict<string, void*>
+#define DICT_DEFINE_CONCURRENT_STR_PTR(NAME) \
+    DICT_DEFINE_CONCURRENT(NAME, char*, void*, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+
+// ConcurrentDict<int, int>
+#define DICT_DEFINE_CONCURRENT_INT_INT(NAME) \
+    DICT_DEFINE_CONCURRENT(NAME, int, int, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+
+// ConcurrentDict<uint64_t, int>
+#define DICT_DEFINE_CONCURRENT_UINT64_INT(NAME) \
+    DICT_DEFINE_CONCURRENT(NAME, uint64_t, int, dict_hash_uint64, dict_eq_uint64, dict_copy_val, dict_free_val)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DICT_CONCURRENT_H
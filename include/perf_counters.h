@@ -0,0 +1,270 @@
+/*
+ * perf_counters.h - Optional hardware performance counters for benchmark rows
+ *
+ * Wraps perf_event_open(2) so a benchmark can report, per row, where the
+ * time went: cycles and instructions (IPC), L1D and last-level cache
+ * misses, branch misses and dTLB misses. Off unless the environment
+ * variable BENCH_PERF is set, so the normal output does not change.
+ *
+ *   - Counters follow the thread that calls perf_counters_open and the
+ *     threads it creates afterwards (user space only); a worker's counts
+ *     are included once it has exited, so stop after joining it
+ *   - Counters are read at start / stop, so a row can cover several timed
+ *     loops and none of the untimed setup between them
+ *   - Events the CPU or hypervisor does not expose print as n/a; if none
+ *     can be opened one note is printed and rows are not recorded
+ *   - Multiplexed counters are scaled by time enabled / time running
+ *
+ * Usage:
+ *   static perf_counters perf;
+ *   perf_counters_open(&perf);
+ *   perf_counters_start(&perf);
+ *   ... timed loop(s) ...
+ *   perf_counters_stop(&perf);
+ *   perf_counters_row(&perf, "chain_linked_list", ops);
+ *   perf_counters_print(&perf, stdout, "Hash Table Implementation Comparison");
+ *   perf_counters_close(&perf);
+ *
+ * Run with: BENCH_PERF=1 ./bin/benchmark_dict
+ * Needs _GNU_SOURCE (for syscall) and perf_event_paranoid <= 2, the
+ * default, for user-space counting.
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum {
+    PERF_CTR_CYCLES,
+    PERF_CTR_INSTRUCTIONS,
+    PERF_CTR_L1D_MISSES,
+    PERF_CTR_LLC_MISSES,
+    PERF_CTR_BRANCH_MISSES,
+    PERF_CTR_DTLB_MISSES,
+    PERF_CTR_COUNT
+} perf_counter_id;
+
+#define PERF_COUNTERS_MAX_ROWS 256
+
+typedef struct {
+    char label[48];
+    double ops;
+    double value[PERF_CTR_COUNT];
+} perf_counter_row;
+
+typedef struct {
+    bool enabled;                    // BENCH_PERF set and at least one counter open
+    bool requested;                  // BENCH_PERF set
+    int open_errno;                  // why the first counter failed, for the note
+    int fd[PERF_CTR_COUNT];          // -1 = not available
+    uint64_t start[PERF_CTR_COUNT][3];  // value, time enabled, time running at start
+    double value[PERF_CTR_COUNT];    // accumulated since the last row
+    perf_counter_row *rows;
+    size_t row_count;
+} perf_counters;
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+#ifdef __linux__
+
+static inline bool perf_counters_event(perf_counter_id id, struct perf_event_attr *attr) {
+    const uint64_t read_miss = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+    attr->type = PERF_TYPE_HARDWARE;
+    switch (id) {
+    case PERF_CTR_CYCLES:        attr->config = PERF_COUNT_HW_CPU_CYCLES; return true;
+    case PERF_CTR_INSTRUCTIONS:  attr->config = PERF_COUNT_HW_INSTRUCTIONS; return true;
+    case PERF_CTR_LLC_MISSES:    attr->config = PERF_COUNT_HW_CACHE_MISSES; return true;
+    case PERF_CTR_BRANCH_MISSES: attr->config = PERF_COUNT_HW_BRANCH_MISSES; return true;
+    case PERF_CTR_L1D_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_L1D | read_miss;
+        return true;
+    case PERF_CTR_DTLB_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_DTLB | read_miss;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Opens every event as one group where the PMU allows it, so they are
+// scheduled together; an event that cannot join is opened on its own
+static inline void perf_counters_open(perf_counters *pc) {
+    memset(pc, 0, sizeof(*pc));
+    for (int i = 0; i < PERF_CTR_COUNT; i++) pc->fd[i] = -1;
+    pc->requested = getenv("BENCH_PERF") != NULL;
+    if (!pc->requested) return;
+
+    int leader = -1;
+    for (int i = 0; i < PERF_CTR_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (!perf_counters_event((perf_counter_id)i, &attr)) continue;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;  // worker threads; no PERF_FORMAT_GROUP, which inherit rejects
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd < 0 && leader >= 0)
+            fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) {
+            if (!pc->open_errno) pc->open_errno = errno;
+            continue;
+        }
+        if (leader < 0) leader = fd;
+        pc->fd[i] = fd;
+        pc->enabled = true;
+    }
+    if (pc->enabled)
+        pc->rows = (perf_counter_row*)calloc(PERF_COUNTERS_MAX_ROWS, sizeof(perf_counter_row));
+    if (!pc->rows) pc->enabled = false;
+}
+
+static inline void perf_counters_close(perf_counters *pc) {
+    for (int i = 0; i < PERF_CTR_COUNT; i++) {
+        if (pc->fd[i] >= 0) close(pc->fd[i]);
+        pc->fd[i] = -1;
+    }
+    free(pc->rows);
+    pc->rows = NULL;
+    pc->enabled = false;
+}
+
+static inline bool perf_counters_read(int fd, uint64_t out[3]) {
+    return read(fd, out, 3 * sizeof(uint64_t)) == (ssize_t)(3 * sizeof(uint64_t));
+}
+
+static inline void perf_counters_start(perf_counters *pc) {
+    if (!pc->enabled) return;
+    for (int i = 0; i < PERF_CTR_COUNT; i++) {
+        if (pc->fd[i] >= 0 && !perf_counters_read(pc->fd[i], pc->start[i]))
+            memset(pc->start[i], 0, sizeof(pc->start[i]));
+    }
+}
+
+// Adds the counts since perf_counters_start to the current row
+static inline void perf_counters_stop(perf_counters *pc) {
+    if (!pc->enabled) return;
+    for (int i = 0; i < PERF_CTR_COUNT; i++) {
+        uint64_t end[3];
+        if (pc->fd[i] < 0 || !perf_counters_read(pc->fd[i], end)) continue;
+        double count = (double)(end[0] - pc->start[i][0]);
+        uint64_t enabled = end[1] - pc->start[i][1];
+        uint64_t running = end[2] - pc->start[i][2];
+        if (running > 0 && running < enabled)
+            count *= (double)enabled / (double)running;
+        pc->value[i] += count;
+    }
+}
+
+#else
+
+static inline void perf_counters_open(perf_counters *pc) {
+    memset(pc, 0, sizeof(*pc));
+    for (int i = 0; i < PERF_CTR_COUNT; i++) pc->fd[i] = -1;
+    pc->requested = getenv("BENCH_PERF") != NULL;
+    pc->open_errno = ENOSYS;
+}
+
+static inline void perf_counters_close(perf_counters *pc) { (void)pc; }
+static inline void perf_counters_start(perf_counters *pc) { (void)pc; }
+static inline void perf_counters_stop(perf_counters *pc) { (void)pc; }
+
+#endif
+
+// ============================================================================
+// Rows and output
+// ============================================================================
+
+// Closes the current row: the counts accumulated since the last row,
+// normalised by ops (0 = totals only)
+static inline void perf_counters_row(perf_counters *pc, const char *label, double ops) {
+    if (!pc->enabled) return;
+    if (pc->row_count < PERF_COUNTERS_MAX_ROWS) {
+        perf_counter_row *row = &pc->rows[pc->row_count++];
+        snprintf(row->label, sizeof(row->label), "%s", label);
+        row->ops = ops;
+        memcpy(row->value, pc->value, sizeof(row->value));
+    }
+    memset(pc->value, 0, sizeof(pc->value));
+}
+
+static inline void perf_counters_cell(FILE *out, const perf_counters *pc, const perf_counter_row *row,
+                                      perf_counter_id id) {
+    if (pc->fd[id] < 0) {
+        fprintf(out, " n/a |");
+        return;
+    }
+    double v = row->ops > 0 ? row->value[id] / row->ops : row->value[id];
+    fprintf(out, row->ops > 0 ? " %.3f |" : " %.0f |", v);
+}
+
+// Prints the recorded rows as a Markdown table and clears them. Without
+// counters it prints a one-line note the first time BENCH_PERF is seen.
+static inline void perf_counters_print(perf_counters *pc, FILE *out, const char *title) {
+    static bool noted = false;
+    if (!pc->enabled) {
+        if (pc->requested && !noted) {
+            fprintf(out, "\n*BENCH_PERF: no hardware counters available (perf_event_open: %s)*\n",
+                    strerror(pc->open_errno));
+            noted = true;
+        }
+        return;
+    }
+    if (pc->row_count == 0) return;
+
+    fprintf(out, "\n#### Hardware Counters: %s\n\n", title);
+    fprintf(out, "| Row | Cycles/op | IPC | L1D miss/op | LLC miss/op | Branch miss/op | dTLB miss/op |\n");
+    fprintf(out, "|-----|----------:|----:|------------:|------------:|---------------:|-------------:|\n");
+    for (size_t r = 0; r < pc->row_count; r++) {
+        const perf_counter_row *row = &pc->rows[r];
+        fprintf(out, "| %s |", row->label);
+        perf_counters_cell(out, pc, row, PERF_CTR_CYCLES);
+        if (pc->fd[PERF_CTR_CYCLES] >= 0 && pc->fd[PERF_CTR_INSTRUCTIONS] >= 0 &&
+            row->value[PERF_CTR_CYCLES] > 0)
+            fprintf(out, " %.2f |", row->value[PERF_CTR_INSTRUCTIONS] / row->value[PERF_CTR_CYCLES]);
+        else
+            fprintf(out, " n/a |");
+        perf_counters_cell(out, pc, row, PERF_CTR_L1D_MISSES);
+        perf_counters_cell(out, pc, row, PERF_CTR_LLC_MISSES);
+        perf_counters_cell(out, pc, row, PERF_CTR_BRANCH_MISSES);
+        perf_counters_cell(out, pc, row, PERF_CTR_DTLB_MISSES);
+        fprintf(out, "\n");
+    }
+    fprintf(out, "\n*User-space counts per operation; n/a = event not exposed by this CPU / hypervisor*\n");
+    pc->row_count = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_COUNTERS_H
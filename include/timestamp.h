@@ -0,0 +1,366 @@
+/*
+ * timestamp.h - Thread-safe "[ HH:MM:SS:mmm.uuu ]" local-time formatting
+ *
+ * Packages the fastest benchmark.c methods (fully_cached, minimal_gettimeofday)
+ * without their process-global statics:
+ *
+ *   - Each thread caches the formatted "[ HH:MM:" prefix of its current
+ *     local minute; a call inside that minute only writes the seconds and
+ *     the sub-second digits from the digit_pairs / digit_triples tables
+ *   - localtime_r runs again when the second leaves the cached minute
+ *     window (also when the clock steps backwards), so a DST change takes
+ *     effect at the minute it happens
+ *   - ts_tz_changed() re-reads TZ / /etc/localtime and invalidates every
+ *     thread's cache through a generation counter
+ *
+ * Usage:
+ *   char buf[TS_BUF_SIZE];
+ *   size_t n = ts_format(buf);            // now, from gettimeofday
+ *   ts_format_at(buf, tv.tv_sec, tv.tv_usec);
+ *   ts_format_batch(stamps, out, n);      // n records, TS_BUF_SIZE apart
+ *   setenv("TZ", "Europe/Berlin", 1);
+ *   ts_tz_changed();                      // after changing the time zone
+ *
+ * ts_format_batch converts the digits of 8 (AVX2) or 4 (SSE4.1) timestamps
+ * per step; without either it is a ts_format_at loop.
+ *
+ * The tables are static const, so there is nothing to initialise. Needs C11
+ * (_Thread_local, stdatomic.h). Assumes UTC offsets change only on minute
+ * boundaries, true of every zone since 1972.
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <sys/time.h>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TS_FORMAT_LEN 20               // strlen("[ HH:MM:SS:mmm.uuu ]")
+#define TS_BUF_SIZE (TS_FORMAT_LEN + 1)
+
+// ============================================================================
+// Digit tables
+// ============================================================================
+
+static const char ts_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// 000-999, 4 bytes each (the 4th is padding) so an index is a shift
+#define TS_TRIPLE(a, b, c) #a #b #c "\0"
+#define TS_TRIPLES_10(a, b) TS_TRIPLE(a, b, 0) TS_TRIPLE(a, b, 1) TS_TRIPLE(a, b, 2) \
+    TS_TRIPLE(a, b, 3) TS_TRIPLE(a, b, 4) TS_TRIPLE(a, b, 5) TS_TRIPLE(a, b, 6)    \
+    TS_TRIPLE(a, b, 7) TS_TRIPLE(a, b, 8) TS_TRIPLE(a, b, 9)
+#define TS_TRIPLES_100(a) TS_TRIPLES_10(a, 0) TS_TRIPLES_10(a, 1) TS_TRIPLES_10(a, 2) \
+    TS_TRIPLES_10(a, 3) TS_TRIPLES_10(a, 4) TS_TRIPLES_10(a, 5) TS_TRIPLES_10(a, 6)  \
+    TS_TRIPLES_10(a, 7) TS_TRIPLES_10(a, 8) TS_TRIPLES_10(a, 9)
+
+static const char ts_digit_triples[4001] =
+    TS_TRIPLES_100(0) TS_TRIPLES_100(1) TS_TRIPLES_100(2) TS_TRIPLES_100(3) TS_TRIPLES_100(4)
+    TS_TRIPLES_100(5) TS_TRIPLES_100(6) TS_TRIPLES_100(7) TS_TRIPLES_100(8) TS_TRIPLES_100(9);
+
+#undef TS_TRIPLE
+#undef TS_TRIPLES_10
+#undef TS_TRIPLES_100
+
+// ============================================================================
+// Per-thread cache
+// ============================================================================
+
+typedef struct {
+    char prefix[8];       // "[ HH:MM:"
+    time_t minute_start;  // first second of the cached local minute
+    time_t minute_end;    // first second after it
+    unsigned generation;  // ts_generation when filled; 0 = empty
+} ts_cache;
+
+// Bumped by ts_tz_changed; starts at 1 so a zeroed cache is stale
+static atomic_uint ts_generation = 1;
+static _Thread_local ts_cache ts_tls;
+
+// Call after changing TZ or /etc/localtime; every thread refreshes on its
+// next ts_format
+static inline void ts_tz_changed(void) {
+    tzset();
+    atomic_fetch_add_explicit(&ts_generation, 1, memory_order_release);
+}
+
+static inline void ts_cache_fill(ts_cache *c, time_t sec, unsigned generation) {
+    struct tm tm_info;
+    localtime_r(&sec, &tm_info);
+    // tm_sec is 60 only on a leap second of a "right/" zone; that minute
+    // then simply ends one second early
+    time_t into = tm_info.tm_sec < 60 ? tm_info.tm_sec : 59;
+    c->minute_start = sec - into;
+    c->minute_end = c->minute_start + 60;
+    memcpy(c->prefix, "[ ", 2);
+    memcpy(c->prefix + 2, ts_digit_pairs + tm_info.tm_hour * 2, 2);
+    c->prefix[4] = ':';
+    memcpy(c->prefix + 5, ts_digit_pairs + tm_info.tm_min * 2, 2);
+    c->prefix[7] = ':';
+    c->generation = generation;
+}
+
+// ============================================================================
+// Formatting
+// ============================================================================
+
+// Writes "[ HH:MM:SS:mmm.uuu ]" and a NUL for the given wall-clock time
+// into buf (TS_BUF_SIZE bytes); returns TS_FORMAT_LEN
+static inline size_t ts_format_at(char *buf, time_t sec, long usec) {
+    ts_cache *c = &ts_tls;
+    unsigned generation = atomic_load_explicit(&ts_generation, memory_order_acquire);
+    if (sec < c->minute_start || sec >= c->minute_end || c->generation != generation)
+        ts_cache_fill(c, sec, generation);
+
+    unsigned ms = (unsigned)usec / 1000;
+    unsigned us = (unsigned)usec - ms * 1000;
+    memcpy(buf, c->prefix, 8);
+    memcpy(buf + 8, ts_digit_pairs + (sec - c->minute_start) * 2, 2);
+    buf[10] = ':';
+    memcpy(buf + 11, ts_digit_triples + ms * 4, 3);
+    buf[14] = '.';
+    memcpy(buf + 15, ts_digit_triples + us * 4, 3);
+    memcpy(buf + 18, " ]", 3);
+    return TS_FORMAT_LEN;
+}
+
+// Current local time, from gettimeofday (vDSO)
+static inline size_t ts_format(char *buf) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return ts_format_at(buf, tv.tv_sec, (long)tv.tv_usec);
+}
+
+// ============================================================================
+// Batch formatting
+// ============================================================================
+//
+// A step takes TS_BATCH_LANES timestamps. If all fall in the cached minute
+// (the usual case for a log batch) everything is vector code:
+//   - seconds and nanoseconds are de-interleaved from the timespecs
+//   - ns -> ms and us with 32x32->64 multiply-shift (n / 1000000 =
+//     n * 1125899907 >> 50, n / 1000 = n * 274877907 >> 38)
+//   - digits with x / 100 = x * 41 >> 12 and x / 10 = x * 205 >> 11
+//     (exact below 1000), packed with the separators into the three
+//     template dwords after the prefix: "SS:m" "mm.u" "uu ]"
+//   - each record is the cached 8-byte prefix plus one 16-byte store
+// A step that crosses a minute, or the tail, goes through ts_format_at.
+
+#if defined(__AVX2__)
+#define TS_BATCH_LANES 8
+#elif defined(__SSE4_1__)
+#define TS_BATCH_LANES 4
+#else
+#define TS_BATCH_LANES 1
+#endif
+
+#if TS_BATCH_LANES > 1
+
+#if defined(__AVX2__)
+typedef __m256i ts_vec;
+#define TS_SET1(x) _mm256_set1_epi32(x)
+#define TS_MUL(a, b) _mm256_mullo_epi32(a, b)
+#define TS_SUB(a, b) _mm256_sub_epi32(a, b)
+#define TS_ADD(a, b) _mm256_add_epi32(a, b)
+#define TS_OR(a, b) _mm256_or_si256(a, b)
+#define TS_SRL(a, n) _mm256_srli_epi32(a, n)
+#define TS_SLL(a, n) _mm256_slli_epi32(a, n)
+#define TS_MUL64(a, b) _mm256_mul_epu32(a, b)
+#define TS_SRL64(a, n) _mm256_srli_epi64(a, n)
+#define TS_SLL64(a, n) _mm256_slli_epi64(a, n)
+#define TS_BLEND_ODD(even, odd) _mm256_blend_epi32(even, odd, 0xAA)
+#else
+typedef __m128i ts_vec;
+#define TS_SET1(x) _mm_set1_epi32(x)
+#define TS_MUL(a, b) _mm_mullo_epi32(a, b)
+#define TS_SUB(a, b) _mm_sub_epi32(a, b)
+#define TS_ADD(a, b) _mm_add_epi32(a, b)
+#define TS_OR(a, b) _mm_or_si128(a, b)
+#define TS_SRL(a, n) _mm_srli_epi32(a, n)
+#define TS_SLL(a, n) _mm_slli_epi32(a, n)
+#define TS_MUL64(a, b) _mm_mul_epu32(a, b)
+#define TS_SRL64(a, n) _mm_srli_epi64(a, n)
+#define TS_SLL64(a, n) _mm_slli_epi64(a, n)
+#define TS_BLEND_ODD(even, odd) _mm_blend_epi16(even, odd, 0xCC)
+#endif
+
+// floor(x * m >> shift) per 32-bit lane, through 64-bit products
+#define TS_MULSHIFT(x, m, shift) \
+    TS_BLEND_ODD(TS_SRL64(TS_MUL64(x, m), shift), TS_SLL64(TS_SRL64(TS_MUL64(TS_SRL64(x, 32), m), shift), 32))
+
+// Low and high dwords of tv_sec and the tv_nsec of TS_BATCH_LANES timespecs
+static inline void ts_load_lanes(const struct timespec *in, ts_vec *sec_lo, ts_vec *sec_hi, ts_vec *nsec) {
+#if defined(__AVX2__)
+    const __m256i *p = (const __m256i*)in;
+    __m256i v0 = _mm256_loadu_si256(p), v1 = _mm256_loadu_si256(p + 1);
+    __m256i v2 = _mm256_loadu_si256(p + 2), v3 = _mm256_loadu_si256(p + 3);
+    // 64-bit [s0 s2 | s1 s3] and [n0 n2 | n1 n3] (and 4-7), then dwords
+    __m256 s01 = _mm256_castsi256_ps(_mm256_unpacklo_epi64(v0, v1));
+    __m256 s23 = _mm256_castsi256_ps(_mm256_unpacklo_epi64(v2, v3));
+    __m256 n01 = _mm256_castsi256_ps(_mm256_unpackhi_epi64(v0, v1));
+    __m256 n23 = _mm256_castsi256_ps(_mm256_unpackhi_epi64(v2, v3));
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    *sec_lo = _mm256_permutevar8x32_epi32(_mm256_castps_si256(_mm256_shuffle_ps(s01, s23, 0x88)), order);
+    *sec_hi = _mm256_permutevar8x32_epi32(_mm256_castps_si256(_mm256_shuffle_ps(s01, s23, 0xDD)), order);
+    *nsec = _mm256_permutevar8x32_epi32(_mm256_castps_si256(_mm256_shuffle_ps(n01, n23, 0x88)), order);
+#else
+    const __m128i *p = (const __m128i*)in;
+    __m128i v0 = _mm_loadu_si128(p), v1 = _mm_loadu_si128(p + 1);
+    __m128i v2 = _mm_loadu_si128(p + 2), v3 = _mm_loadu_si128(p + 3);
+    __m128 s01 = _mm_castsi128_ps(_mm_unpacklo_epi64(v0, v1));
+    __m128 s23 = _mm_castsi128_ps(_mm_unpacklo_epi64(v2, v3));
+    __m128 n01 = _mm_castsi128_ps(_mm_unpackhi_epi64(v0, v1));
+    __m128 n23 = _mm_castsi128_ps(_mm_unpackhi_epi64(v2, v3));
+    *sec_lo = _mm_castps_si128(_mm_shuffle_ps(s01, s23, 0x88));
+    *sec_hi = _mm_castps_si128(_mm_shuffle_ps(s01, s23, 0xDD));
+    *nsec = _mm_castps_si128(_mm_shuffle_ps(n01, n23, 0x88));
+#endif
+}
+
+// All lanes inside [start, start + 60)? Seconds-into-minute in *into
+static inline bool ts_lanes_in_minute(ts_vec sec_lo, ts_vec sec_hi, time_t start, ts_vec *into) {
+    uint64_t s = (uint64_t)start;
+    *into = TS_SUB(sec_lo, TS_SET1((int)(uint32_t)s));
+#if defined(__AVX2__)
+    __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_min_epu32(*into, TS_SET1(59)), *into),
+                                  _mm256_cmpeq_epi32(sec_hi, TS_SET1((int)(uint32_t)(s >> 32))));
+    return _mm256_movemask_epi8(ok) == -1;
+#else
+    __m128i ok = _mm_and_si128(_mm_cmpeq_epi32(_mm_min_epu32(*into, TS_SET1(59)), *into),
+                               _mm_cmpeq_epi32(sec_hi, TS_SET1((int)(uint32_t)(s >> 32))));
+    return _mm_movemask_epi8(ok) == 0xFFFF;
+#endif
+}
+
+// Hundreds, tens and ones of x < 1000
+static inline void ts_digits3(ts_vec x, ts_vec *h, ts_vec *t, ts_vec *o) {
+    *h = TS_SRL(TS_MUL(x, TS_SET1(41)), 12);
+    ts_vec r = TS_SUB(x, TS_MUL(*h, TS_SET1(100)));
+    *t = TS_SRL(TS_MUL(r, TS_SET1(205)), 11);
+    *o = TS_SUB(r, TS_MUL(*t, TS_SET1(10)));
+}
+
+// Records rec[0..TS_BATCH_LANES): prefix + "SS:mmm.uuu ]" + NUL. Each 16-byte
+// store writes 3 bytes into the next record, which its prefix then
+// overwrites; with last set the final record is copied at its exact size.
+static inline void ts_store_lanes(char *rec, const char *prefix, ts_vec into, ts_vec nsec, bool last) {
+    ts_vec ms = TS_MULSHIFT(nsec, TS_SET1(1125899907), 50);
+    ts_vec us = TS_SUB(TS_MULSHIFT(nsec, TS_SET1(274877907), 38), TS_MUL(ms, TS_SET1(1000)));
+    ts_vec s_h, s_t, s_o, m_h, m_t, m_o, u_h, u_t, u_o;
+    ts_digits3(into, &s_h, &s_t, &s_o);
+    ts_digits3(ms, &m_h, &m_t, &m_o);
+    ts_digits3(us, &u_h, &u_t, &u_o);
+    (void)s_h;
+    // Little-endian: the first character is the low byte
+    ts_vec a = TS_ADD(TS_OR(TS_OR(s_t, TS_SLL(s_o, 8)), TS_SLL(m_h, 24)), TS_SET1(0x303A3030));
+    ts_vec b = TS_ADD(TS_OR(TS_OR(m_t, TS_SLL(m_o, 8)), TS_SLL(u_h, 24)), TS_SET1(0x302E3030));
+    ts_vec c = TS_ADD(TS_OR(u_t, TS_SLL(u_o, 8)), TS_SET1(0x5D203030));
+
+    // Transpose to one [a b c 0] 16-byte row per record
+#if defined(__AVX2__)
+    __m256i ab_lo = _mm256_unpacklo_epi32(a, b), ab_hi = _mm256_unpackhi_epi32(a, b);
+    __m256i c0_lo = _mm256_unpacklo_epi32(c, _mm256_setzero_si256());
+    __m256i c0_hi = _mm256_unpackhi_epi32(c, _mm256_setzero_si256());
+    __m256i r04 = _mm256_unpacklo_epi64(ab_lo, c0_lo), r15 = _mm256_unpackhi_epi64(ab_lo, c0_lo);
+    __m256i r26 = _mm256_unpacklo_epi64(ab_hi, c0_hi), r37 = _mm256_unpackhi_epi64(ab_hi, c0_hi);
+    __m128i rows[8] = {
+        _mm256_castsi256_si128(r04), _mm256_castsi256_si128(r15),
+        _mm256_castsi256_si128(r26), _mm256_castsi256_si128(r37),
+        _mm256_extracti128_si256(r04, 1), _mm256_extracti128_si256(r15, 1),
+        _mm256_extracti128_si256(r26, 1), _mm256_extracti128_si256(r37, 1),
+    };
+#else
+    __m128i ab_lo = _mm_unpacklo_epi32(a, b), ab_hi = _mm_unpackhi_epi32(a, b);
+    __m128i c0_lo = _mm_unpacklo_epi32(c, _mm_setzero_si128());
+    __m128i c0_hi = _mm_unpackhi_epi32(c, _mm_setzero_si128());
+    __m128i rows[4] = {
+        _mm_unpacklo_epi64(ab_lo, c0_lo), _mm_unpackhi_epi64(ab_lo, c0_lo),
+        _mm_unpacklo_epi64(ab_hi, c0_hi), _mm_unpackhi_epi64(ab_hi, c0_hi),
+    };
+#endif
+    for (int l = 0; l < TS_BATCH_LANES; l++) {
+        char *r = rec + (size_t)l * TS_BUF_SIZE;
+        memcpy(r, prefix, 8);
+        if (last && l == TS_BATCH_LANES - 1) {
+            char row[16];
+            _mm_storeu_si128((__m128i*)row, rows[l]);
+            memcpy(r + 8, row, TS_BUF_SIZE - 8);
+        } else {
+            _mm_storeu_si128((__m128i*)(r + 8), rows[l]);
+        }
+    }
+}
+
+#undef TS_SET1
+#undef TS_MUL
+#undef TS_SUB
+#undef TS_ADD
+#undef TS_OR
+#undef TS_SRL
+#undef TS_SLL
+#undef TS_MUL64
+#undef TS_SRL64
+#undef TS_SLL64
+#undef TS_BLEND_ODD
+#undef TS_MULSHIFT
+
+#endif
+
+// Formats in[0..n) into out, one NUL-terminated record every TS_BUF_SIZE
+// bytes; the timestamps need not be sorted
+static inline void ts_format_batch(const struct timespec *in, char *out, size_t n) {
+    size_t i = 0;
+#if TS_BATCH_LANES > 1
+    ts_cache *c = &ts_tls;
+    unsigned generation = atomic_load_explicit(&ts_generation, memory_order_acquire);
+    for (; i + TS_BATCH_LANES <= n; i += TS_BATCH_LANES) {
+        if (c->generation != generation) ts_cache_fill(c, in[i].tv_sec, generation);
+        ts_vec sec_lo, sec_hi, nsec, into;
+        ts_load_lanes(in + i, &sec_lo, &sec_hi, &nsec);
+        if (!ts_lanes_in_minute(sec_lo, sec_hi, c->minute_start, &into)) {
+            // Refill on the first lane's minute and retry; a batch that
+            // still spans two minutes takes the scalar path
+            ts_cache_fill(c, in[i].tv_sec, generation);
+            if (!ts_lanes_in_minute(sec_lo, sec_hi, c->minute_start, &into)) {
+                for (int l = 0; l < TS_BATCH_LANES; l++)
+                    ts_format_at(out + (i + (size_t)l) * TS_BUF_SIZE, in[i + (size_t)l].tv_sec,
+                                 in[i + (size_t)l].tv_nsec / 1000);
+                continue;
+            }
+        }
+        ts_store_lanes(out + i * TS_BUF_SIZE, c->prefix, into, nsec, i + TS_BATCH_LANES == n);
+    }
+#endif
+    for (; i < n; i++)
+        ts_format_at(out + i * TS_BUF_SIZE, in[i].tv_sec, in[i].tv_nsec / 1000);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMESTAMP_H
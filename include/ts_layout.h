@@ -0,0 +1,268 @@
+/*
+ * ts_layout.h - Datetime layouts compiled from a format string
+ *
+ * Any layout gets the speed of the cached "[ HH:MM:SS:mmm.uuu ]" formatter
+ * (timestamp.h) without going through strftime:
+ *
+ *   - ts_layout_compile turns a strftime-like spec into a fixed template
+ *     plus the offsets of its digit fields
+ *   - The fields that only change once a minute (date, hour, minute, UTC
+ *     offset) are rendered into the template when the minute changes
+ *   - A call copies the template and writes only the seconds and fraction
+ *     fields, from the digit_pairs / digit_triples tables
+ *
+ * Conversions:
+ *   %Y year (4 digits)   %y year (2)       %m month     %d day
+ *   %j day of the year   %H hour           %M minute    %S second
+ *   %L milliseconds      %K microseconds within the millisecond (000-999)
+ *   %3N %6N %9N fraction of the second as ms / us / ns (%N = %9N)
+ *   %z +hhmm offset      %:z +hh:mm offset %% a '%'
+ * Anything else is copied as is.
+ *
+ * Usage:
+ *   TS_LAYOUT(iso8601_ns, "%Y-%m-%dT%H:%M:%S.%9N%:z", false)  // local time
+ *   TS_LAYOUT(rfc3339_utc, "%Y-%m-%dT%H:%M:%S.%6NZ", true)    // UTC
+ *   char buf[TS_LAYOUT_MAX];
+ *   size_t n = iso8601_ns(buf, ts.tv_sec, ts.tv_nsec);
+ *
+ * TS_LAYOUT defines a function with a per-thread compiled layout and
+ * cache, so it is thread-safe; ts_tz_changed() (timestamp.h) also
+ * invalidates these caches. The output buffer needs TS_LAYOUT_MAX bytes
+ * whatever the layout's length (the template is copied whole). Needs
+ * _GNU_SOURCE or _DEFAULT_SOURCE for tm_gmtoff.
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef TS_LAYOUT_H
+#define TS_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "timestamp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TS_LAYOUT_MAX 64     // output bytes, NUL included
+#define TS_LAYOUT_FIELDS 16
+
+typedef enum {
+    // Rendered once per minute
+    TS_FIELD_YEAR,
+    TS_FIELD_YEAR2,
+    TS_FIELD_MONTH,
+    TS_FIELD_DAY,
+    TS_FIELD_YDAY,
+    TS_FIELD_HOUR,
+    TS_FIELD_MINUTE,
+    TS_FIELD_OFFSET,
+    TS_FIELD_OFFSET_COLON,
+    // Written on every call
+    TS_FIELD_SECOND,
+    TS_FIELD_MILLI,
+    TS_FIELD_MICRO_IN_MILLI,
+    TS_FIELD_FRAC_MS,
+    TS_FIELD_FRAC_US,
+    TS_FIELD_FRAC_NS,
+} ts_field_kind;
+
+typedef struct {
+    uint8_t kind;    // ts_field_kind
+    uint8_t offset;
+} ts_field;
+
+typedef struct {
+    char text[TS_LAYOUT_MAX];          // template, minute fields filled in
+    uint8_t len;                       // 0 = not compiled / invalid spec
+    bool utc;
+    uint8_t minute_count;
+    uint8_t call_count;
+    ts_field minute_fields[TS_LAYOUT_FIELDS];
+    ts_field call_fields[TS_LAYOUT_FIELDS];
+    // Cache, as in timestamp.h
+    time_t minute_start;
+    time_t minute_end;
+    unsigned generation;
+} ts_layout;
+
+// ============================================================================
+// Compiling
+// ============================================================================
+
+static inline bool ts_layout_add(ts_layout *l, char *out, size_t *pos, ts_field_kind kind, size_t width) {
+    if (*pos + width >= TS_LAYOUT_MAX) return false;
+    bool per_call = kind >= TS_FIELD_SECOND;
+    uint8_t *count = per_call ? &l->call_count : &l->minute_count;
+    if (*count == TS_LAYOUT_FIELDS) return false;
+    ts_field *f = per_call ? &l->call_fields[*count] : &l->minute_fields[*count];
+    f->kind = (uint8_t)kind;
+    f->offset = (uint8_t)*pos;
+    (*count)++;
+    memset(out + *pos, '0', width);
+    *pos += width;
+    return true;
+}
+
+// Returns false (and leaves len 0) for an unknown conversion or a layout
+// longer than TS_LAYOUT_MAX - 1
+static inline bool ts_layout_compile(ts_layout *l, const char *spec, bool utc) {
+    memset(l, 0, sizeof(*l));
+    l->utc = utc;
+    char *out = l->text;
+    size_t pos = 0;
+    for (const char *p = spec; *p; p++) {
+        if (*p != '%') {
+            if (pos + 1 >= TS_LAYOUT_MAX) return false;
+            out[pos++] = *p;
+            continue;
+        }
+        p++;
+        bool ok;
+        switch (*p) {
+        case 'Y': ok = ts_layout_add(l, out, &pos, TS_FIELD_YEAR, 4); break;
+        case 'y': ok = ts_layout_add(l, out, &pos, TS_FIELD_YEAR2, 2); break;
+        case 'm': ok = ts_layout_add(l, out, &pos, TS_FIELD_MONTH, 2); break;
+        case 'd': ok = ts_layout_add(l, out, &pos, TS_FIELD_DAY, 2); break;
+        case 'j': ok = ts_layout_add(l, out, &pos, TS_FIELD_YDAY, 3); break;
+        case 'H': ok = ts_layout_add(l, out, &pos, TS_FIELD_HOUR, 2); break;
+        case 'M': ok = ts_layout_add(l, out, &pos, TS_FIELD_MINUTE, 2); break;
+        case 'S': ok = ts_layout_add(l, out, &pos, TS_FIELD_SECOND, 2); break;
+        case 'L': ok = ts_layout_add(l, out, &pos, TS_FIELD_MILLI, 3); break;
+        case 'K': ok = ts_layout_add(l, out, &pos, TS_FIELD_MICRO_IN_MILLI, 3); break;
+        case 'N': ok = ts_layout_add(l, out, &pos, TS_FIELD_FRAC_NS, 9); break;
+        case 'z': ok = ts_layout_add(l, out, &pos, TS_FIELD_OFFSET, 5); break;
+        case '3': case '6': case '9':
+            ok = p[1] == 'N';
+            if (ok) {
+                ts_field_kind kind = *p == '3' ? TS_FIELD_FRAC_MS : *p == '6' ? TS_FIELD_FRAC_US : TS_FIELD_FRAC_NS;
+                ok = ts_layout_add(l, out, &pos, kind, (size_t)(*p - '0'));
+                p++;
+            }
+            break;
+        case ':':
+            ok = p[1] == 'z' && ts_layout_add(l, out, &pos, TS_FIELD_OFFSET_COLON, 6);
+            p++;
+            break;
+        case '%':
+            ok = pos + 1 < TS_LAYOUT_MAX;
+            if (ok) out[pos++] = '%';
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) {
+            l->len = 0;
+            return false;
+        }
+    }
+    out[pos] = '\0';
+    l->len = (uint8_t)pos;
+    return true;
+}
+
+// ============================================================================
+// Formatting
+// ============================================================================
+
+static inline void ts_layout_offset(char *out, long gmtoff, bool colon) {
+    out[0] = gmtoff < 0 ? '-' : '+';
+    long minutes = (gmtoff < 0 ? -gmtoff : gmtoff) / 60;
+    memcpy(out + 1, ts_digit_pairs + (minutes / 60 % 100) * 2, 2);
+    if (colon) out[3] = ':';
+    memcpy(out + (colon ? 4 : 3), ts_digit_pairs + (minutes % 60) * 2, 2);
+}
+
+// Renders the minute fields for the minute holding sec
+static inline void ts_layout_fill(ts_layout *l, time_t sec, unsigned generation) {
+    struct tm tm_info;
+    if (l->utc) gmtime_r(&sec, &tm_info);
+    else localtime_r(&sec, &tm_info);
+    time_t into = tm_info.tm_sec < 60 ? tm_info.tm_sec : 59;
+    l->minute_start = sec - into;
+    l->minute_end = l->minute_start + 60;
+    l->generation = generation;
+
+    int year = tm_info.tm_year + 1900;
+    for (int i = 0; i < l->minute_count; i++) {
+        char *out = l->text + l->minute_fields[i].offset;
+        switch ((ts_field_kind)l->minute_fields[i].kind) {
+        case TS_FIELD_YEAR:
+            memcpy(out, ts_digit_pairs + (year / 100 % 100) * 2, 2);
+            memcpy(out + 2, ts_digit_pairs + (year % 100) * 2, 2);
+            break;
+        case TS_FIELD_YEAR2:  memcpy(out, ts_digit_pairs + (year % 100) * 2, 2); break;
+        case TS_FIELD_MONTH:  memcpy(out, ts_digit_pairs + (tm_info.tm_mon + 1) * 2, 2); break;
+        case TS_FIELD_DAY:    memcpy(out, ts_digit_pairs + tm_info.tm_mday * 2, 2); break;
+        case TS_FIELD_YDAY:   memcpy(out, ts_digit_triples + (tm_info.tm_yday + 1) * 4, 3); break;
+        case TS_FIELD_HOUR:   memcpy(out, ts_digit_pairs + tm_info.tm_hour * 2, 2); break;
+        case TS_FIELD_MINUTE: memcpy(out, ts_digit_pairs + tm_info.tm_min * 2, 2); break;
+        case TS_FIELD_OFFSET: ts_layout_offset(out, l->utc ? 0 : tm_info.tm_gmtoff, false); break;
+        case TS_FIELD_OFFSET_COLON: ts_layout_offset(out, l->utc ? 0 : tm_info.tm_gmtoff, true); break;
+        default: break;
+        }
+    }
+}
+
+// Writes the layout for sec / nsec into buf (TS_LAYOUT_MAX bytes, NUL
+// terminated); returns its length, 0 if the layout did not compile
+static inline size_t ts_layout_format(ts_layout *l, char *buf, time_t sec, long nsec) {
+    unsigned generation = atomic_load_explicit(&ts_generation, memory_order_acquire);
+    if (sec < l->minute_start || sec >= l->minute_end || l->generation != generation)
+        ts_layout_fill(l, sec, generation);
+
+    memcpy(buf, l->text, TS_LAYOUT_MAX);
+    unsigned ns = (unsigned)nsec;
+    unsigned ms = ns / 1000000;
+    unsigned us = ns / 1000 - ms * 1000;
+    unsigned sub_us = ns - (ns / 1000) * 1000;
+    for (int i = 0; i < l->call_count; i++) {
+        char *out = buf + l->call_fields[i].offset;
+        switch ((ts_field_kind)l->call_fields[i].kind) {
+        case TS_FIELD_SECOND:
+            memcpy(out, ts_digit_pairs + (sec - l->minute_start) * 2, 2);
+            break;
+        case TS_FIELD_MILLI:
+        case TS_FIELD_FRAC_MS:
+            memcpy(out, ts_digit_triples + ms * 4, 3);
+            break;
+        case TS_FIELD_MICRO_IN_MILLI:
+            memcpy(out, ts_digit_triples + us * 4, 3);
+            break;
+        case TS_FIELD_FRAC_US:
+            memcpy(out, ts_digit_triples + ms * 4, 3);
+            memcpy(out + 3, ts_digit_triples + us * 4, 3);
+            break;
+        case TS_FIELD_FRAC_NS:
+            memcpy(out, ts_digit_triples + ms * 4, 3);
+            memcpy(out + 3, ts_digit_triples + us * 4, 3);
+            memcpy(out + 6, ts_digit_triples + sub_us * 4, 3);
+            break;
+        default:
+            break;
+        }
+    }
+    return l->len;
+}
+
+// Defines size_t name(char *buf, time_t sec, long nsec) for one layout,
+// compiled on first use in each thread
+#define TS_LAYOUT(name, spec, utc)                                   \
+    static inline size_t name(char *buf, time_t sec, long nsec) {    \
+        static _Thread_local ts_layout layout;                       \
+        if (layout.len == 0 && !ts_layout_compile(&layout, spec, utc)) { \
+            buf[0] = '\0';                                           \
+            return 0;                                                \
+        }                                                            \
+        return ts_layout_format(&layout, buf, sec, nsec);            \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TS_LAYOUT_H
@@ -0,0 +1,233 @@
+/*
+ * tsc_clock.h - Wall-clock time from the TSC, calibrated against CLOCK_REALTIME
+ *
+ * Reads rdtsc and converts with a fixed-point rate instead of entering the
+ * vDSO on every call:
+ *
+ *   - Startup calibration: two (TSC, CLOCK_REALTIME) pairs 10 ms apart, each
+ *     the tightest of several rdtsc-bracketed clock_gettime calls
+ *   - Drift correction: after TSC_CLOCK_RESYNC_NS the next caller takes a
+ *     fresh pair, rebases on it and re-derives the rate over the whole run,
+ *     so NTP slewing and calibration error do not accumulate
+ *   - A wall-clock step (settimeofday, NTP step) larger than
+ *     TSC_CLOCK_STEP_NS restarts the rate baseline at the next resync
+ *   - Invariant-TSC check (CPUID 0x80000007 EDX bit 8): without it, or off
+ *     x86, every call falls back to clock_gettime(CLOCK_REALTIME)
+ *
+ * The conversion state is published through a seqlock, so any thread may
+ * read the clock and whichever one notices the interval has passed resyncs.
+ * Between resyncs the clock can be off by the rate error times the interval;
+ * a resync may step it by that amount in either direction.
+ *
+ * Usage:
+ *   tsc_clock_init();
+ *   struct timespec ts;
+ *   tsc_clock_gettime(&ts);            // like clock_gettime(CLOCK_REALTIME)
+ *   uint64_t ns = tsc_clock_now_ns();  // ns since the epoch
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef TSC_CLOCK_H
+#define TSC_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TSC_CLOCK_RESYNC_NS 1000000000ULL  // drift correction interval
+#define TSC_CLOCK_STEP_NS 1000000LL        // larger error = the wall clock was set
+#define TSC_CLOCK_CALIBRATE_NS 10000000ULL
+
+typedef struct {
+    // Seqlock-protected conversion: ns = base_ns + ((tsc - base_tsc) * mult >> 32)
+    atomic_uint seq;              // odd while a resync is writing
+    _Atomic uint64_t base_tsc;
+    _Atomic uint64_t base_ns;
+    _Atomic uint64_t mult;        // ns per tick, 32.32 fixed point
+    uint64_t limit;               // ticks past base_tsc that trigger a resync
+    atomic_flag busy;             // held by the resyncing thread
+
+    // Written only under busy
+    uint64_t origin_tsc;          // start of the rate baseline
+    uint64_t origin_ns;
+    int64_t last_error_ns;        // realtime - TSC clock at the last resync
+    uint64_t resyncs;
+    uint64_t steps;
+
+    bool enabled;                 // invariant TSC found and calibrated
+    bool invariant;
+    double ticks_per_ns;
+} tsc_clock_state;
+
+static tsc_clock_state tsc_clock = {.busy = ATOMIC_FLAG_INIT};
+
+// ============================================================================
+// Raw reads
+// ============================================================================
+
+static inline uint64_t tsc_clock_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return (uint64_t)hi << 32 | lo;
+#else
+    return 0;
+#endif
+}
+
+static inline uint64_t tsc_clock_realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Counter rate does not change with P-states or stop in C-states
+static inline bool tsc_clock_invariant(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) return false;
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx >> 8) & 1;
+#else
+    return false;
+#endif
+}
+
+// (TSC, CLOCK_REALTIME) taken as close together as possible: the
+// realtime read with the fewest ticks around it, TSC at its midpoint
+static inline void tsc_clock_pair(uint64_t *tsc, uint64_t *ns) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 8; i++) {
+        uint64_t t0 = tsc_clock_ticks();
+        uint64_t r = tsc_clock_realtime_ns();
+        uint64_t t1 = tsc_clock_ticks();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+            *tsc = t0 + (t1 - t0) / 2;
+            *ns = r;
+        }
+    }
+}
+
+// ============================================================================
+// Calibration and drift correction
+// ============================================================================
+
+static inline uint64_t tsc_clock_fixed_rate(double ns_per_tick) {
+    return (uint64_t)(ns_per_tick * 4294967296.0);
+}
+
+// delta * mult >> 32 without overflow for any delta (a resync after a long
+// idle); the fast path only sees delta < limit and multiplies directly
+static inline uint64_t tsc_clock_scale(uint64_t delta, uint64_t mult) {
+    return (delta >> 32) * mult + ((delta & 0xFFFFFFFFu) * mult >> 32);
+}
+
+static inline void tsc_clock_publish(uint64_t tsc, uint64_t ns, uint64_t mult) {
+    unsigned seq = atomic_load_explicit(&tsc_clock.seq, memory_order_relaxed);
+    atomic_store_explicit(&tsc_clock.seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&tsc_clock.base_tsc, tsc, memory_order_relaxed);
+    atomic_store_explicit(&tsc_clock.base_ns, ns, memory_order_relaxed);
+    atomic_store_explicit(&tsc_clock.mult, mult, memory_order_relaxed);
+    atomic_store_explicit(&tsc_clock.seq, seq + 2, memory_order_release);
+}
+
+// Returns whether the TSC clock is in use (else the fallback is)
+static inline bool tsc_clock_init(void) {
+    tsc_clock.invariant = tsc_clock_invariant();
+    tsc_clock.enabled = false;
+    if (!tsc_clock.invariant) return false;
+
+    uint64_t t0 = 0, n0 = 0, t1 = 0, n1 = 0;
+    tsc_clock_pair(&t0, &n0);
+    do {
+        tsc_clock_pair(&t1, &n1);
+    } while (n1 - n0 < TSC_CLOCK_CALIBRATE_NS);
+    if (t1 <= t0) return false;
+
+    tsc_clock.ticks_per_ns = (double)(t1 - t0) / (double)(n1 - n0);
+    tsc_clock.limit = (uint64_t)((double)TSC_CLOCK_RESYNC_NS * tsc_clock.ticks_per_ns);
+    tsc_clock.origin_tsc = t0;
+    tsc_clock.origin_ns = n0;
+    tsc_clock.last_error_ns = 0;
+    tsc_clock.resyncs = 0;
+    tsc_clock.steps = 0;
+    tsc_clock_publish(t1, n1, tsc_clock_fixed_rate(1.0 / tsc_clock.ticks_per_ns));
+    tsc_clock.enabled = true;
+    return true;
+}
+
+// Rebases on a fresh pair and refines the rate over origin..now; false if
+// another thread is already doing it
+static inline bool tsc_clock_resync(void) {
+    if (atomic_flag_test_and_set_explicit(&tsc_clock.busy, memory_order_acquire)) return false;
+    uint64_t tsc, ns;
+    tsc_clock_pair(&tsc, &ns);
+
+    uint64_t base_tsc = atomic_load_explicit(&tsc_clock.base_tsc, memory_order_relaxed);
+    uint64_t base_ns = atomic_load_explicit(&tsc_clock.base_ns, memory_order_relaxed);
+    uint64_t mult = atomic_load_explicit(&tsc_clock.mult, memory_order_relaxed);
+    uint64_t predicted = base_ns + tsc_clock_scale(tsc - base_tsc, mult);
+    tsc_clock.last_error_ns = (int64_t)(ns - predicted);
+    tsc_clock.resyncs++;
+
+    if (tsc_clock.last_error_ns > TSC_CLOCK_STEP_NS || tsc_clock.last_error_ns < -TSC_CLOCK_STEP_NS ||
+        ns <= tsc_clock.origin_ns) {
+        // The wall clock was set: keep the rate, restart its baseline
+        tsc_clock.origin_tsc = tsc;
+        tsc_clock.origin_ns = ns;
+        tsc_clock.steps++;
+    } else {
+        mult = tsc_clock_fixed_rate((double)(ns - tsc_clock.origin_ns) / (double)(tsc - tsc_clock.origin_tsc));
+    }
+    tsc_clock_publish(tsc, ns, mult);
+    atomic_flag_clear_explicit(&tsc_clock.busy, memory_order_release);
+    return true;
+}
+
+// ============================================================================
+// Reading the clock
+// ============================================================================
+
+// Nanoseconds since the epoch
+static inline uint64_t tsc_clock_now_ns(void) {
+    if (!tsc_clock.enabled) return tsc_clock_realtime_ns();
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&tsc_clock.seq, memory_order_acquire);
+        if (seq & 1) continue;
+        uint64_t base_tsc = atomic_load_explicit(&tsc_clock.base_tsc, memory_order_relaxed);
+        uint64_t base_ns = atomic_load_explicit(&tsc_clock.base_ns, memory_order_relaxed);
+        uint64_t mult = atomic_load_explicit(&tsc_clock.mult, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&tsc_clock.seq, memory_order_relaxed) != seq) continue;
+
+        uint64_t tsc = tsc_clock_ticks();
+        // A TSC read before another thread's newer base counts as the base
+        uint64_t delta = (int64_t)(tsc - base_tsc) > 0 ? tsc - base_tsc : 0;
+        if (delta < tsc_clock.limit) return base_ns + (delta * mult >> 32);
+        if (!tsc_clock_resync()) return tsc_clock_realtime_ns();
+    }
+}
+
+static inline void tsc_clock_gettime(struct timespec *ts) {
+    uint64_t ns = tsc_clock_now_ns();
+    ts->tv_sec = (time_t)(ns / 1000000000ULL);
+    ts->tv_nsec = (long)(ns % 1000000000ULL);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TSC_CLOCK_H
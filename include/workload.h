@@ -0,0 +1,318 @@
+/*
+ * workload.h - Key-value workload generator for the dictionary benchmarks
+ *
+ * Builds a key space and a pre-generated, interleaved operation stream, so
+ * the benchmark loop only replays it and none of the random number or
+ * string work is timed.
+ *
+ *   - Key popularity: uniform, Zipfian (YCSB scrambled Zipfian), hotspot
+ *     (a fraction of the keys gets a fraction of the operations) and latest
+ *     (Zipfian over the most recently inserted keys)
+ *   - Operation mix: read / update / insert / remove / scan / read-modify-write
+ *     percentages, with the YCSB core workloads A-F predefined
+ *   - Key lengths: fixed, uniform in [min, max] or bimodal (mostly short keys
+ *     with a share of long ones)
+ *
+ * Usage:
+ *   workload_key_len len = {WORKLOAD_LEN_UNIFORM, 8, 64, 0};
+ *   workload *w = workload_create(&workload_ycsb[0], 100000, 1000000, len, 42);
+ *   for (size_t i = 0; i < w->records; i++) set(w->keys[i]);      // load phase
+ *   for (size_t i = 0; i < w->op_count; i++) replay(&w->ops[i]);  // run phase
+ *   workload_destroy(w);
+ *
+ * Needs -lm (pow).
+ *
+ * License: Public Domain / MIT
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef enum {
+    WORKLOAD_UNIFORM,
+    WORKLOAD_ZIPFIAN,
+    WORKLOAD_HOTSPOT,
+    WORKLOAD_LATEST,
+} workload_dist;
+
+typedef enum {
+    WORKLOAD_OP_READ,
+    WORKLOAD_OP_UPDATE,
+    WORKLOAD_OP_INSERT,   // a key from the not-yet-loaded part of the key space
+    WORKLOAD_OP_REMOVE,
+    WORKLOAD_OP_SCAN,     // reads of count consecutive key ids (hash tables have no order)
+    WORKLOAD_OP_RMW,      // read, then write back a derived value
+} workload_op_kind;
+
+typedef enum {
+    WORKLOAD_LEN_FIXED,    // always min
+    WORKLOAD_LEN_UNIFORM,  // uniform in [min, max]
+    WORKLOAD_LEN_BIMODAL,  // min, or max for long_pct percent of the keys
+} workload_len_kind;
+
+typedef struct {
+    workload_len_kind kind;
+    int min;
+    int max;
+    int long_pct;
+} workload_key_len;
+
+typedef struct {
+    const char *name;
+    int read_pct;
+    int update_pct;
+    int insert_pct;
+    int remove_pct;
+    int scan_pct;
+    int rmw_pct;
+    workload_dist dist;
+    double zipf_theta;  // Zipfian and latest skew (YCSB: 0.99)
+    double hot_keys;    // hotspot: fraction of the keys that are hot
+    double hot_ops;     // hotspot: fraction of the operations that hit them
+    int scan_max;       // scan length is uniform in [1, scan_max]
+} workload_spec;
+
+typedef struct {
+    uint8_t kind;   // workload_op_kind
+    uint8_t count;  // scan length
+    uint32_t key;   // index into workload.keys
+} workload_op;
+
+typedef struct {
+    char **keys;        // records initial keys, then one per insert op
+    size_t key_count;
+    size_t records;
+    workload_op *ops;
+    size_t op_count;
+} workload;
+
+// YCSB core workloads (scan is a run of point reads here)
+static const workload_spec workload_ycsb[] = {
+    {"A", 50, 50, 0, 0, 0, 0, WORKLOAD_ZIPFIAN, 0.99, 0, 0, 0},   // update heavy
+    {"B", 95, 5, 0, 0, 0, 0, WORKLOAD_ZIPFIAN, 0.99, 0, 0, 0},    // read mostly
+    {"C", 100, 0, 0, 0, 0, 0, WORKLOAD_ZIPFIAN, 0.99, 0, 0, 0},   // read only
+    {"D", 95, 0, 5, 0, 0, 0, WORKLOAD_LATEST, 0.99, 0, 0, 0},     // read latest
+    {"E", 0, 0, 5, 0, 95, 0, WORKLOAD_ZIPFIAN, 0.99, 0, 0, 10},   // short ranges
+    {"F", 50, 0, 0, 0, 0, 50, WORKLOAD_ZIPFIAN, 0.99, 0, 0, 0},   // read-modify-write
+};
+
+#define WORKLOAD_YCSB_COUNT (sizeof(workload_ycsb) / sizeof(workload_ycsb[0]))
+
+// ============================================================================
+// Random numbers
+// ============================================================================
+
+static inline uint64_t workload_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform double in [0, 1)
+static inline double workload_unit(uint64_t *state) {
+    return (double)(workload_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static inline uint64_t workload_fnv64(uint64_t x) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < 8; i++) {
+        hash ^= x & 0xFF;
+        hash *= 0x100000001B3ULL;
+        x >>= 8;
+    }
+    return hash;
+}
+
+// ============================================================================
+// Zipfian generator (Gray et al., "Quickly Generating Billion-Record
+// Synthetic Databases", as used by YCSB)
+// ============================================================================
+
+typedef struct {
+    size_t n;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+} workload_zipf;
+
+static inline double workload_zeta(size_t n, double theta) {
+    double sum = 0;
+    for (size_t i = 1; i <= n; i++) sum += 1.0 / pow((double)i, theta);
+    return sum;
+}
+
+static inline void workload_zipf_init(workload_zipf *z, size_t n, double theta) {
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1.0 / (1.0 - theta);
+    z->zetan = workload_zeta(n, theta);
+    z->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - workload_zeta(2, theta) / z->zetan);
+}
+
+// Rank in [0, n), 0 the most popular
+static inline size_t workload_zipf_next(const workload_zipf *z, uint64_t *state) {
+    double u = workload_unit(state);
+    double uz = u * z->zetan;
+    if (uz < 1.0) return 0;
+    if (uz < 1.0 + pow(0.5, z->theta)) return 1;
+    size_t rank = (size_t)((double)z->n * pow(z->eta * u - z->eta + 1.0, z->alpha));
+    return rank < z->n ? rank : z->n - 1;
+}
+
+// ============================================================================
+// Key space
+// ============================================================================
+
+static inline int workload_pick_len(workload_key_len len, uint64_t *state) {
+    switch (len.kind) {
+    case WORKLOAD_LEN_UNIFORM:
+        return len.min + (int)(workload_next(state) % (uint64_t)(len.max - len.min + 1));
+    case WORKLOAD_LEN_BIMODAL:
+        return (int)(workload_next(state) % 100) < len.long_pct ? len.max : len.min;
+    default:
+        return len.min;
+    }
+}
+
+// "k<id in hex>:" (unique), padded to length with letters derived from the
+// id; a length too short for the id is stretched to fit it
+static inline char* workload_make_key(size_t id, int length) {
+    char head[24];
+    int n = snprintf(head, sizeof(head), "k%zx:", id);
+    if (length < n) length = n;
+    char *key = (char*)malloc((size_t)length + 1);
+    if (!key) return NULL;
+    memcpy(key, head, (size_t)n);
+    uint64_t fill = id;
+    for (int i = n; i < length; i++) key[i] = (char)('a' + workload_next(&fill) % 26);
+    key[length] = '\0';
+    return key;
+}
+
+// ============================================================================
+// Operation stream
+// ============================================================================
+
+static inline void workload_destroy(workload *w) {
+    if (!w) return;
+    if (w->keys) {
+        for (size_t i = 0; i < w->key_count; i++) free(w->keys[i]);
+    }
+    free(w->keys);
+    free(w->ops);
+    free(w);
+}
+
+// Key id for a non-insert op while inserted keys are live
+static inline size_t workload_pick_key(const workload_spec *spec, const workload_zipf *zipf,
+                                       size_t inserted, uint64_t *state) {
+    switch (spec->dist) {
+    case WORKLOAD_ZIPFIAN:
+        // Scrambled, so the hot keys are spread over the key space
+        return (size_t)(workload_fnv64(workload_zipf_next(zipf, state)) % inserted);
+    case WORKLOAD_HOTSPOT: {
+        size_t hot = (size_t)(spec->hot_keys * (double)inserted);
+        if (hot == 0) hot = 1;
+        if (workload_unit(state) < spec->hot_ops || hot == inserted)
+            return (size_t)(workload_next(state) % hot);
+        return hot + (size_t)(workload_next(state) % (inserted - hot));
+    }
+    case WORKLOAD_LATEST: {
+        size_t back = workload_zipf_next(zipf, state);
+        return back < inserted ? inserted - 1 - back : 0;
+    }
+    default:
+        return (size_t)(workload_next(state) % inserted);
+    }
+}
+
+static inline workload* workload_create(const workload_spec *spec, size_t records, size_t ops,
+                                        workload_key_len len, uint64_t seed) {
+    uint64_t state = seed;
+    workload *w = (workload*)calloc(1, sizeof(workload));
+    if (!w || records == 0) {
+        free(w);
+        return NULL;
+    }
+
+    // Pre-count the inserts so every key string exists before the run
+    workload_op_kind *kinds = (workload_op_kind*)malloc((ops ? ops : 1) * sizeof(workload_op_kind));
+    w->ops = (workload_op*)malloc((ops ? ops : 1) * sizeof(workload_op));
+    if (!kinds || !w->ops) {
+        free(kinds);
+        workload_destroy(w);
+        return NULL;
+    }
+    const int pct[6] = {spec->read_pct, spec->update_pct, spec->insert_pct,
+                        spec->remove_pct, spec->scan_pct, spec->rmw_pct};
+    int total = 0;
+    for (int k = 0; k < 6; k++) total += pct[k];
+    size_t inserts = 0;
+    for (size_t i = 0; i < ops; i++) {
+        int r = total > 0 ? (int)(workload_next(&state) % (uint64_t)total) : 0;
+        int k = 0;
+        while (k < 5 && r >= pct[k]) r -= pct[k++];
+        kinds[i] = (workload_op_kind)k;
+        inserts += kinds[i] == WORKLOAD_OP_INSERT;
+    }
+
+    w->records = records;
+    w->key_count = records + inserts;
+    w->keys = (char**)calloc(w->key_count, sizeof(char*));
+    if (!w->keys) {
+        free(kinds);
+        workload_destroy(w);
+        return NULL;
+    }
+    for (size_t i = 0; i < w->key_count; i++) {
+        w->keys[i] = workload_make_key(i, workload_pick_len(len, &state));
+        if (!w->keys[i]) {
+            free(kinds);
+            workload_destroy(w);
+            return NULL;
+        }
+    }
+
+    workload_zipf zipf;
+    workload_zipf_init(&zipf, records, spec->zipf_theta > 0 ? spec->zipf_theta : 0.99);
+    size_t inserted = records;
+    for (size_t i = 0; i < ops; i++) {
+        workload_op *op = &w->ops[i];
+        op->kind = (uint8_t)kinds[i];
+        op->count = 1;
+        if (kinds[i] == WORKLOAD_OP_INSERT) {
+            op->key = (uint32_t)inserted++;
+            continue;
+        }
+        op->key = (uint32_t)workload_pick_key(spec, &zipf, inserted, &state);
+        if (kinds[i] == WORKLOAD_OP_SCAN && spec->scan_max > 1)
+            op->count = (uint8_t)(1 + workload_next(&state) % (uint64_t)spec->scan_max);
+    }
+    w->op_count = ops;
+    free(kinds);
+    return w;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WORKLOAD_H
@@ -0,0 +1,294 @@
+/*
+ * bench_compare.c - Flags benchmark rows that regressed against a baseline
+ *
+ * Reads two result files written with BENCH_OUTPUT (JSON or CSV, see
+ * include/bench.h), matches rows by section and name, and reports the rows
+ * whose median ns/op moved by more than the threshold. A change only counts
+ * when it also exceeds the noise: SIGMAS times the combined trial stddev of
+ * the two runs.
+ *
+ * Usage: bench_compare BASELINE CURRENT [THRESHOLD_PCT=5] [SIGMAS=2]
+ * Exit status: 0 = no regressions, 1 = regressions, 2 = bad input
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#define META_KEYS 8
+
+static const char *meta_keys[META_KEYS] = {
+    "program", "timestamp", "cpu", "kernel", "compiler", "cflags", "git", "config"
+};
+
+typedef struct {
+    char *section;
+    char *name;
+    double median;
+    double stddev;
+    bool matched;
+} Row;
+
+typedef struct {
+    char *meta[META_KEYS];
+    Row *rows;
+    size_t count;
+    size_t capacity;
+} Results;
+
+// ============================================================================
+// Parsing
+// ============================================================================
+
+static void add_row(Results *r, const char *section, const char *name, double median, double stddev) {
+    if (r->count == r->capacity) {
+        r->capacity = r->capacity ? r->capacity * 2 : 64;
+        r->rows = realloc(r->rows, r->capacity * sizeof(Row));
+        if (!r->rows) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+    Row *row = &r->rows[r->count++];
+    row->section = strdup(section);
+    row->name = strdup(name);
+    row->median = median;
+    row->stddev = stddev;
+    row->matched = false;
+}
+
+static void set_meta(Results *r, const char *key, const char *value) {
+    for (int i = 0; i < META_KEYS; i++) {
+        if (strcmp(key, meta_keys[i]) == 0 && !r->meta[i]) {
+            r->meta[i] = strdup(value);
+            return;
+        }
+    }
+}
+
+// Decodes the JSON string starting at the opening quote p into out;
+// returns the position after the closing quote, NULL if malformed
+static const char* json_string(const char *p, char *out, size_t size) {
+    if (*p != '"') return NULL;
+    size_t n = 0;
+    for (p++; *p && *p != '"'; p++) {
+        char c = *p;
+        if (c == '\\') {
+            p++;
+            if (*p == 'u') {
+                unsigned code = 0;
+                if (sscanf(p + 1, "%4x", &code) != 1) return NULL;
+                c = (char)code;
+                p += 4;
+            } else if (*p == 'n') {
+                c = '\n';
+            } else if (*p == 't') {
+                c = '\t';
+            } else {
+                c = *p;
+            }
+            if (!c) return NULL;
+        }
+        if (n + 1 < size) out[n++] = c;
+    }
+    out[n] = '\0';
+    return *p == '"' ? p + 1 : NULL;
+}
+
+static bool json_field_string(const char *line, const char *key, char *out, size_t size) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *p = strstr(line, pattern);
+    return p && json_string(p + strlen(pattern), out, size);
+}
+
+static bool json_field_number(const char *line, const char *key, double *out) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *p = strstr(line, pattern);
+    if (!p) return false;
+    char *end;
+    *out = strtod(p + strlen(pattern), &end);
+    return end != p + strlen(pattern);
+}
+
+// bench.h writes one result object per line and one metadata pair per line
+static void parse_json_line(Results *r, const char *line) {
+    char section[256], name[256];
+    double median, stddev;
+    if (json_field_string(line, "section", section, sizeof(section))) {
+        if (json_field_string(line, "name", name, sizeof(name)) &&
+            json_field_number(line, "median_ns", &median) &&
+            json_field_number(line, "stddev_ns", &stddev))
+            add_row(r, section, name, median, stddev);
+        return;
+    }
+    const char *p = line + strspn(line, " \t");
+    char key[64], value[512];
+    p = json_string(p, key, sizeof(key));
+    if (!p || strncmp(p, ": \"", 3) != 0) return;
+    if (json_string(p + 2, value, sizeof(value))) set_meta(r, key, value);
+}
+
+// Splits one CSV line into fields ("" inside quotes is a quote)
+static int csv_fields(char *line, char **fields, int max) {
+    int n = 0;
+    char *p = line;
+    while (n < max) {
+        char *out = p;
+        fields[n++] = p;
+        if (*p == '"') {
+            char *in = p + 1;
+            for (;;) {
+                if (*in == '"' && in[1] == '"') {
+                    *out++ = '"';
+                    in += 2;
+                } else if (*in == '"' || !*in) {
+                    break;
+                } else {
+                    *out++ = *in++;
+                }
+            }
+            p = *in ? in + 1 : in;
+        } else {
+            while (*p && *p != ',' && *p != '\n') p++;
+            out = p;
+        }
+        char sep = *p;
+        *out = '\0';
+        if (sep != ',') break;
+        p++;
+    }
+    return n;
+}
+
+static void parse_csv_line(Results *r, char *line) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '#') {
+        char *colon = strstr(line, ": ");
+        if (!colon) return;
+        *colon = '\0';
+        set_meta(r, line + 2, colon + 2);
+        return;
+    }
+    if (strncmp(line, "section,", 8) == 0) return;
+    char *fields[11];
+    if (csv_fields(line, fields, 11) < 4) return;
+    add_row(r, fields[0], fields[1], strtod(fields[2], NULL), strtod(fields[3], NULL));
+}
+
+static bool load_results(const char *path, Results *r) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    memset(r, 0, sizeof(*r));
+    char line[4096];
+    bool csv = false, first = true;
+    while (fgets(line, sizeof(line), f)) {
+        if (first) {
+            csv = line[0] != '{';
+            first = false;
+        }
+        if (csv) parse_csv_line(r, line);
+        else parse_json_line(r, line);
+    }
+    fclose(f);
+    if (r->count == 0) fprintf(stderr, "%s: no result rows\n", path);
+    return r->count > 0;
+}
+
+static Row* find_row(Results *r, const char *section, const char *name) {
+    for (size_t i = 0; i < r->count; i++) {
+        Row *row = &r->rows[i];
+        if (!row->matched && strcmp(row->section, section) == 0 && strcmp(row->name, name) == 0)
+            return row;
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+typedef enum { CHANGE_NONE, CHANGE_REGRESSED, CHANGE_IMPROVED } Change;
+
+typedef struct {
+    const Row *base;
+    const Row *cur;
+    double pct;
+    double noise;
+} Delta;
+
+static void print_deltas(const char *title, const Delta *d, size_t n) {
+    if (n == 0) return;
+    printf("\n## %s\n\n", title);
+    printf("| Section | Row | Baseline (ns) | Current (ns) | Change | Noise (ns) |\n");
+    printf("|---------|-----|--------------:|-------------:|-------:|-----------:|\n");
+    for (size_t i = 0; i < n; i++) {
+        printf("| %s | %s | %.2f | %.2f | %+.1f%% | %.2f |\n", d[i].base->section, d[i].base->name,
+               d[i].base->median, d[i].cur->median, d[i].pct, d[i].noise);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s BASELINE CURRENT [THRESHOLD_PCT=5] [SIGMAS=2]\n", argv[0]);
+        return 2;
+    }
+    double threshold = argc > 3 ? atof(argv[3]) : 5.0;
+    double sigmas = argc > 4 ? atof(argv[4]) : 2.0;
+
+    Results base, cur;
+    if (!load_results(argv[1], &base) || !load_results(argv[2], &cur)) return 2;
+
+    printf("# Benchmark Comparison\n\n");
+    printf("| | Baseline | Current |\n");
+    printf("|-|----------|---------|\n");
+    printf("| file | %s | %s |\n", argv[1], argv[2]);
+    for (int i = 0; i < META_KEYS; i++) {
+        printf("| %s | %s | %s |\n", meta_keys[i], base.meta[i] ? base.meta[i] : "-",
+               cur.meta[i] ? cur.meta[i] : "-");
+    }
+    printf("\nFlagged: median change above %.1f%% and above %.1f x the combined trial stddev\n",
+           threshold, sigmas);
+
+    Delta *regressed = calloc(base.count, sizeof(Delta));
+    Delta *improved = calloc(base.count, sizeof(Delta));
+    size_t n_regressed = 0, n_improved = 0, compared = 0, missing = 0;
+    for (size_t i = 0; i < base.count; i++) {
+        const Row *b = &base.rows[i];
+        Row *c = find_row(&cur, b->section, b->name);
+        if (!c) {
+            missing++;
+            continue;
+        }
+        c->matched = true;
+        compared++;
+        if (b->median <= 0) continue;
+        double diff = c->median - b->median;
+        Delta d = {b, c, 100.0 * diff / b->median, sigmas * sqrt(b->stddev * b->stddev + c->stddev * c->stddev)};
+        Change change = CHANGE_NONE;
+        if (fabs(d.pct) > threshold && fabs(diff) > d.noise)
+            change = diff > 0 ? CHANGE_REGRESSED : CHANGE_IMPROVED;
+        if (change == CHANGE_REGRESSED) regressed[n_regressed++] = d;
+        else if (change == CHANGE_IMPROVED) improved[n_improved++] = d;
+    }
+    size_t added = 0;
+    for (size_t i = 0; i < cur.count; i++) added += !cur.rows[i].matched;
+
+    print_deltas("Regressions", regressed, n_regressed);
+    print_deltas("Improvements", improved, n_improved);
+    printf("\n**%zu rows compared: %zu regressed, %zu improved, %zu unchanged**", compared,
+           n_regressed, n_improved, compared - n_regressed - n_improved);
+    if (missing || added) printf(" (%zu only in baseline, %zu only in current)", missing, added);
+    printf("\n");
+
+    free(regressed);
+    free(improved);
+    return n_regressed ? 1 : 0;
+}
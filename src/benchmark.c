@@ -8,21 +8,27 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include "../include/bench.h"
+#include "../include/timestamp.h"
+#include "../include/tsc_clock.h"
+#include "../include/ts_layout.h"
+#include "../include/perf_counters.h"
 
 #define ITERATIONS 1000000
 #define WARMUP_ITERATIONS 10000
+#define THREAD_ITERATIONS 200000   // per thread and trial
+#define MAX_THREADS 64
+#define BATCH_TIMESTAMPS 262144    // per trial, split into batches
+#define MAX_BATCH 512
 
 // Target format: [ HH:MM:SS:mmm.uuu ]
 // Where mmm = milliseconds, uuu = microseconds
 
 typedef void (*benchmark_func)(char *buf, size_t size);
 
-// Get high-resolution timestamp
-static inline uint64_t get_nanos(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
-}
+// Hardware counters per row when BENCH_PERF is set (perf_counters.h)
+static perf_counters perf;
 
 // ============================================================================
 // Benchmark 1: strftime + gettimeofday (basic approach)
@@ -1229,6 +1235,101 @@ void bench_batch_read(char *buf, size_t size) {
     buf[20] = '\0';
 }
 
+// ============================================================================
+// Benchmark 33: timestamp.h ts_format (per-thread cache, thread-safe)
+// ============================================================================
+void bench_ts_format(char *buf, size_t size) {
+    (void)size;
+    ts_format(buf);
+}
+
+// ============================================================================
+// Benchmark 34: TSC clock (tsc_clock.h) + ts_format_at (cached)
+// ============================================================================
+void bench_tsc_cached(char *buf, size_t size) {
+    (void)size;
+    struct timespec ts;
+    tsc_clock_gettime(&ts);
+    ts_format_at(buf, ts.tv_sec, ts.tv_nsec / 1000);
+}
+
+// ============================================================================
+// Benchmark 34b: TSC clock + localtime_r + full lookup (no cache)
+// ============================================================================
+void bench_tsc_nocache(char *buf, size_t size) {
+    (void)size;
+    struct timespec ts;
+    struct tm tm_info;
+    tsc_clock_gettime(&ts);
+    localtime_r(&ts.tv_sec, &tm_info);
+    
+    int ms = ts.tv_nsec / 1000000;
+    int us = (ts.tv_nsec / 1000) % 1000;
+    
+    memcpy(buf, "[ ", 2);
+    memcpy(buf + 2, digit_pairs + tm_info.tm_hour * 2, 2);
+    buf[4] = ':';
+    memcpy(buf + 5, digit_pairs + tm_info.tm_min * 2, 2);
+    buf[7] = ':';
+    memcpy(buf + 8, digit_pairs + tm_info.tm_sec * 2, 2);
+    buf[10] = ':';
+    memcpy(buf + 11, digit_triples + ms * 4, 3);
+    buf[14] = '.';
+    memcpy(buf + 15, digit_triples + us * 4, 3);
+    memcpy(buf + 18, " ]", 3);
+}
+
+// ============================================================================
+// Benchmark 35: ts_layout.h compiled layouts (cached)
+// ============================================================================
+TS_LAYOUT(layout_bracket, "[ %H:%M:%S:%L.%K ]", false)
+TS_LAYOUT(layout_iso8601_ns, "%Y-%m-%dT%H:%M:%S.%9N%:z", false)
+TS_LAYOUT(layout_rfc3339_utc, "%Y-%m-%dT%H:%M:%S.%6NZ", true)
+TS_LAYOUT(layout_date_time_ms, "%Y-%m-%d %H:%M:%S.%3N", false)
+
+void bench_layout_bracket(char *buf, size_t size) {
+    (void)size;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    layout_bracket(buf, tv.tv_sec, tv.tv_usec * 1000);
+}
+
+void bench_layout_iso8601_ns(char *buf, size_t size) {
+    (void)size;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    layout_iso8601_ns(buf, ts.tv_sec, ts.tv_nsec);
+}
+
+void bench_layout_rfc3339_utc(char *buf, size_t size) {
+    (void)size;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    layout_rfc3339_utc(buf, ts.tv_sec, ts.tv_nsec);
+}
+
+void bench_layout_date_time_ms(char *buf, size_t size) {
+    (void)size;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    layout_date_time_ms(buf, ts.tv_sec, ts.tv_nsec);
+}
+
+// ============================================================================
+// Benchmark 35b: strftime for the same ISO-8601 layout (no cache)
+// ============================================================================
+void bench_strftime_iso8601_ns(char *buf, size_t size) {
+    struct timespec ts;
+    struct tm tm_info;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    localtime_r(&ts.tv_sec, &tm_info);
+    
+    char date_buf[32], zone_buf[8];
+    strftime(date_buf, sizeof(date_buf), "%Y-%m-%dT%H:%M:%S", &tm_info);
+    strftime(zone_buf, sizeof(zone_buf), "%z", &tm_info);
+    snprintf(buf, size, "%s.%09ld%.3s:%s", date_buf, ts.tv_nsec, zone_buf, zone_buf + 3);
+}
+
 // ============================================================================
 // Benchmark runner
 // ============================================================================
@@ -1279,13 +1380,22 @@ static benchmark_t benchmarks[] = {
     {"minimal_nocache", bench_minimal_nocache, "Minimal with full lookup (no cache)"},
     {"monotonic_relative", bench_monotonic_relative, "CLOCK_MONOTONIC relative"},
     {"batch_read", bench_batch_read, "Batched time read pattern"},
+    {"ts_format", bench_ts_format, "timestamp.h ts_format() (per-thread cache)"},
+    {"tsc_cached", bench_tsc_cached, "Calibrated TSC clock + ts_format_at() (cached)"},
+    {"tsc_nocache", bench_tsc_nocache, "Calibrated TSC clock + localtime_r() + full lookup"},
+    {"layout_bracket", bench_layout_bracket, "ts_layout.h \"[ %H:%M:%S:%L.%K ]\" (this format)"},
+    {"layout_iso8601_ns", bench_layout_iso8601_ns, "ts_layout.h ISO-8601 local, ns + UTC offset"},
+    {"layout_rfc3339_utc", bench_layout_rfc3339_utc, "ts_layout.h RFC 3339 UTC, us"},
+    {"layout_date_time_ms", bench_layout_date_time_ms, "ts_layout.h date + time, ms"},
+    {"strftime_iso8601_ns", bench_strftime_iso8601_ns, "strftime() ISO-8601 local, ns + UTC offset"},
 };
 
 #define NUM_BENCHMARKS (sizeof(benchmarks) / sizeof(benchmarks[0]))
 
 void run_benchmark(benchmark_t *bench) {
     char buf[64];
-    uint64_t start, end;
+    bench_timer timer;
+    bench_timer_init(&timer);
     
     // Warmup
     for (int i = 0; i < WARMUP_ITERATIONS; i++) {
@@ -1293,21 +1403,219 @@ void run_benchmark(benchmark_t *bench) {
     }
     
     // Benchmark
-    start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        bench->func(buf, sizeof(buf));
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        bench_trial_begin(&timer);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&timer, i);
+            bench->func(buf, sizeof(buf));
+            bench_op_end(&timer);
+        }
+        bench_trial_end(&timer, ITERATIONS);
     }
-    end = get_nanos();
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, bench->name, (double)ITERATIONS * bench_cfg.trials);
     
-    double total_ms = (double)(end - start) / 1000000.0;
-    double per_call_ns = (double)(end - start) / ITERATIONS;
-    double calls_per_sec = 1000000000.0 / per_call_ns;
+    bench_stats st = bench_timer_stats(&timer);
+    bench_emit(bench->name, &st);
+    double calls_per_sec = 1000000000.0 / st.median;
     
     // Get sample output
     bench->func(buf, sizeof(buf));
     
-    printf("| %-28s | %10.2f | %8.2f | %12.0f | %s |\n",
-           bench->name, total_ms, per_call_ns, calls_per_sec, buf);
+    printf("| %-28s | %8.2f | %6.2f | %5.0f | %5.0f | %6.0f | %8.0f | %12.0f | %s |\n",
+           bench->name, st.median, st.stddev, st.p50, st.p99, st.p999, st.max, calls_per_sec, buf);
+}
+
+// ============================================================================
+// TSC clock error vs CLOCK_REALTIME
+// ============================================================================
+#define TSC_ERROR_SAMPLES 100000
+
+// Error of one TSC read against the midpoint of the two realtime reads
+// around it; reads interrupted for more than 1 us are skipped
+static void print_tsc_error_row(const char *phase) {
+    bench_hist err;
+    bench_hist_reset(&err);
+    double sum = 0, bracket = 0;
+    for (int i = 0; i < TSC_ERROR_SAMPLES; i++) {
+        uint64_t r0 = tsc_clock_realtime_ns();
+        uint64_t t = tsc_clock_now_ns();
+        uint64_t r1 = tsc_clock_realtime_ns();
+        if (r1 - r0 > 1000) continue;
+        int64_t e = (int64_t)(t - r0) - (int64_t)(r1 - r0) / 2;
+        uint64_t abs_err = (uint64_t)(e < 0 ? -e : e);
+        sum += (double)abs_err;
+        bracket += (double)(r1 - r0) / 2;
+        bench_hist_record(&err, abs_err);
+    }
+    double n = err.total ? (double)err.total : 1;
+    printf("| %s | %" PRIu64 " | %.1f | %" PRIu64 " | %" PRIu64 " | %.1f | %" PRIu64 " | %" PRId64 " |\n", phase,
+           err.total, sum / n, bench_hist_percentile(&err, 99.0), err.max, bracket / n, tsc_clock.resyncs,
+           tsc_clock.last_error_ns);
+}
+
+static void print_tsc_error(void) {
+    printf("\n## TSC Clock vs CLOCK_REALTIME\n\n");
+    if (!tsc_clock.enabled) {
+        printf("*No invariant TSC: tsc_cached / tsc_nocache fell back to clock_gettime(CLOCK_REALTIME)*\n");
+        return;
+    }
+    printf("Calibrated: %.4f ticks/ns, drift correction every %.1f s\n\n", tsc_clock.ticks_per_ns,
+           (double)TSC_CLOCK_RESYNC_NS / 1e9);
+    printf("| Phase | Reads | Mean abs error (ns) | p99 abs error | Max abs error | Realtime read +/- (ns) | Resyncs | Last resync error (ns) |\n");
+    printf("|-------|------:|--------------------:|--------------:|--------------:|-----------------------:|--------:|-----------------------:|\n");
+    print_tsc_error_row("after the results");
+    struct timespec pause = {1, 100000000};
+    nanosleep(&pause, NULL);  // past TSC_CLOCK_RESYNC_NS, so the next read resyncs
+    print_tsc_error_row("after 1.1 s idle");
+    printf("\n*Error = TSC clock - midpoint of the two realtime reads around it, of %d reads per phase minus "
+           "those interrupted; +/- is half the time between those reads*\n", TSC_ERROR_SAMPLES);
+}
+
+// ============================================================================
+// Batch formatting: ts_format_batch vs a ts_format_at loop
+// ============================================================================
+static void run_batch_row(const struct timespec *in, char *out, size_t batch, bool simd) {
+    size_t batches = BATCH_TIMESTAMPS / batch;
+    bench_timer timer;
+    bench_timer_init(&timer);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        bench_trial_begin(&timer);
+        for (size_t b = 0; b < batches; b++) {
+            const struct timespec *ts = in + (b * batch) % MAX_BATCH;
+            bench_op_begin(&timer, b);
+            if (simd) {
+                ts_format_batch(ts, out, batch);
+            } else {
+                for (size_t i = 0; i < batch; i++)
+                    ts_format_at(out + i * TS_BUF_SIZE, ts[i].tv_sec, ts[i].tv_nsec / 1000);
+            }
+            bench_op_end(&timer);
+        }
+        bench_trial_end(&timer, batches * batch);
+    }
+    char label[64];
+    snprintf(label, sizeof(label), "%s / batch %zu", simd ? "ts_format_batch" : "ts_format_at loop", batch);
+    bench_timer_print_row(stdout, label, &timer);
+}
+
+static void run_batch_formatting(void) {
+    static const size_t sizes[] = {1, 8, 64, 512};
+    // A log batch: 2 * MAX_BATCH records about 1 us apart, crossing a second
+    static struct timespec in[2 * MAX_BATCH];
+    static char out[MAX_BATCH * TS_BUF_SIZE];
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t ns = (uint64_t)now.tv_sec * 1000000000ULL + 999500000ULL;
+    for (size_t i = 0; i < 2 * MAX_BATCH; i++) {
+        ns += 700 + (i * 7919) % 600;
+        in[i].tv_sec = (time_t)(ns / 1000000000ULL);
+        in[i].tv_nsec = (long)(ns % 1000000000ULL);
+    }
+
+    printf("\n## Batch Formatting (%d timestamps per trial, %d-lane digit conversion)\n\n",
+           BATCH_TIMESTAMPS, TS_BATCH_LANES);
+    bench_section("Batch Formatting");
+    bench_stats_header(stdout, "Benchmark");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        run_batch_row(in, out, sizes[s], false);
+        run_batch_row(in, out, sizes[s], true);
+    }
+    printf("\n*Median (ns) = per timestamp, median of %d trials; percentiles and max are one whole batch*\n",
+           bench_cfg.trials);
+}
+
+// ============================================================================
+// Thread scaling: the global-static caches vs timestamp.h
+// ============================================================================
+typedef struct {
+    benchmark_func func;
+    pthread_barrier_t *start;
+    pthread_barrier_t *done;
+    bench_timer timer;
+} thread_worker;
+
+static void* thread_worker_main(void *arg) {
+    thread_worker *w = arg;
+    char buf[64];
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) w->func(buf, sizeof(buf));
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        pthread_barrier_wait(w->start);
+        bench_trial_begin(&w->timer);
+        for (int i = 0; i < THREAD_ITERATIONS; i++) {
+            bench_op_begin(&w->timer, (size_t)i);
+            w->func(buf, sizeof(buf));
+            bench_op_end(&w->timer);
+        }
+        bench_trial_end(&w->timer, THREAD_ITERATIONS);
+        pthread_barrier_wait(w->done);
+    }
+    return NULL;
+}
+
+// One row: threads run func in lockstep trials; ns/call is wall time over
+// all threads' calls, the percentiles are all threads' samples
+static void run_thread_row(const benchmark_t *bench, int threads) {
+    static thread_worker workers[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    pthread_barrier_t start, done;
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    pthread_barrier_init(&done, NULL, (unsigned)threads + 1);
+    for (int t = 0; t < threads; t++) {
+        workers[t].func = bench->func;
+        workers[t].start = &start;
+        workers[t].done = &done;
+        bench_timer_init(&workers[t].timer);
+        pthread_create(&tids[t], NULL, thread_worker_main, &workers[t]);
+    }
+
+    bench_timer row;
+    bench_timer_init(&row);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        pthread_barrier_wait(&start);
+        bench_trial_begin(&row);
+        pthread_barrier_wait(&done);
+        bench_trial_end(&row, (size_t)threads * THREAD_ITERATIONS);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        bench_hist_merge(&row.hist, &workers[t].timer.hist);
+    }
+    pthread_barrier_destroy(&start);
+    pthread_barrier_destroy(&done);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s / %d thread%s", bench->name, threads, threads > 1 ? "s" : "");
+    bench_timer_print_row(stdout, label, &row);
+}
+
+static void run_thread_scaling(void) {
+    static const benchmark_t variants[] = {
+        {"fully_cached", bench_fully_cached, "global fully_cached[] prefix"},
+        {"minimal_gettimeofday", bench_minimal_gettimeofday, "global cached_tm"},
+        {"cached_localtime", bench_cached_localtime, "global cached_tm"},
+        {"nocache_full_lookup", bench_nocache_full_lookup, "localtime_r per call"},
+        {"ts_format", bench_ts_format, "timestamp.h per-thread cache"},
+    };
+    int max_threads = bench_env_int("BENCH_THREADS", 4);
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    printf("\n## Thread Scaling (1-%d threads, %d calls per thread and trial, %ld CPUs)\n\n",
+           max_threads, THREAD_ITERATIONS, sysconf(_SC_NPROCESSORS_ONLN));
+    bench_section("Thread Scaling");
+    bench_stats_header(stdout, "Benchmark");
+    bench_unpin();  // the workers need every CPU
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+        for (int threads = 1; threads <= max_threads; threads *= 2)
+            run_thread_row(&variants[v], threads);
+    }
+    bench_repin();
+    printf("\n*Median (ns) = wall time / calls of all threads, median of %d trials; percentiles are "
+           "single calls*\n", bench_cfg.trials);
+    printf("*fully_cached, minimal_gettimeofday and cached_localtime share process-global caches: "
+           "threads race on them and can print a torn second. ts_format keeps one cache per thread.*\n");
 }
 
 int main(int argc, char *argv[]) {
@@ -1316,11 +1624,16 @@ int main(int argc, char *argv[]) {
     
     // Initialize lookup tables
     init_triples();
+    bench_init(5);
+    tsc_clock_init();
+    perf_counters_open(&perf);
     
     printf("# DateTime String Benchmark Results\n\n");
     printf("Format: [ HH:MM:SS:mmm.uuu ]\n");
     printf("Iterations: %d\n", ITERATIONS);
-    printf("Warmup: %d\n\n", WARMUP_ITERATIONS);
+    printf("Warmup: %d\n", WARMUP_ITERATIONS);
+    bench_print_config(stdout);
+    printf("\n");
     
     // System info
     printf("## System Info\n");
@@ -1338,19 +1651,29 @@ int main(int argc, char *argv[]) {
     printf("\n");
     
     printf("## Results\n\n");
-    printf("| %-28s | %10s | %8s | %12s | %s |\n",
-           "Benchmark", "Total (ms)", "Per call (ns)", "Calls/sec", "Sample Output");
-    printf("|%-30s|%12s|%10s|%14s|%22s|\n",
-           "------------------------------", "------------", "----------", "--------------", "----------------------");
+    printf("| %-28s | %8s | %6s | %5s | %5s | %6s | %8s | %12s | %s |\n",
+           "Benchmark", "Per call (ns)", "Stddev", "p50", "p99", "p99.9", "Max", "Calls/sec", "Sample Output");
+    printf("|%-30s|%10s|%8s|%7s|%7s|%8s|%10s|%14s|%22s|\n",
+           "------------------------------", "---------:", "-------:", "------:", "------:", "-------:",
+           "---------:", "-------------:", "----------------------");
     
+    bench_section("Results");
     for (size_t i = 0; i < NUM_BENCHMARKS; i++) {
         run_benchmark(&benchmarks[i]);
     }
+    printf("\n*Per call = median of %d trials; p50 / p99 / p99.9 / Max (ns) are single calls, 1 in %zu sampled*\n",
+           bench_cfg.trials, bench_cfg.sample_mask + 1);
+    perf_counters_print(&perf, stdout, "Results");
+    
+    print_tsc_error();
+    run_batch_formatting();
+    run_thread_scaling();
     
     printf("\n## Benchmark Descriptions\n\n");
     for (size_t i = 0; i < NUM_BENCHMARKS; i++) {
         printf("%zu. **%s**: %s\n", i + 1, benchmarks[i].name, benchmarks[i].description);
     }
     
+    perf_counters_close(&perf);
     return 0;
 }
@@ -9,18 +9,22 @@
 #include <fcntl.h>
 #include <stdarg.h>
 #include <sys/uio.h>
+#include <pthread.h>
+#include "../include/bench.h"
+#include "../include/perf_counters.h"
+#include "../include/async_log.h"
+#include "../include/console_sink.h"
 
 #define ITERATIONS 10000
 #define WARMUP_ITERATIONS 1000
+#define MAX_THREADS 64
+#define ASYNC_CAPACITY 4096
+#define THREAD_BATCH 64          // lines per writev in bench_thread_writev
 
 typedef void (*benchmark_func)(void);
 
-// Get high-resolution timestamp
-static inline uint64_t get_nanos(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
-}
+// Hardware counters per row when BENCH_PERF is set (perf_counters.h)
+static perf_counters perf;
 
 // Test strings
 static const char *test_string_short = "Hello, C!!!!\n";
@@ -210,6 +214,107 @@ void bench_dprintf_formatted(void) {
     dprintf(STDOUT_FILENO, "Value: %d, String: %s\n", 42, "test");
 }
 
+// ============================================================================
+// Benchmark 16: async_log - producers only copy into an MPSC ring
+// ============================================================================
+// The same timestamped record through each path; the sink is /dev/null or
+// a file, shared by all producer threads
+static int async_fd = -1;
+static FILE *async_file;
+static async_log *async_logger;
+
+// Where run_benchmark sends stdout: BENCH_SINK (null, pipe, tmpfs, file, pty)
+static console_sink stdout_sink;
+
+static size_t format_record(char *rec) {
+    ts_format(rec);
+    rec[TS_FORMAT_LEN] = ' ';
+    memcpy(rec + TS_FORMAT_LEN + 1, test_string_medium, 63);
+    return TS_FORMAT_LEN + 1 + 63;
+}
+
+void bench_sync_fwrite(void) {
+    char rec[128];
+    size_t len = format_record(rec);
+    fwrite(rec, 1, len, async_file);
+}
+
+void bench_sync_write(void) {
+    char rec[128];
+    size_t len = format_record(rec);
+    (void)write(async_fd, rec, len);
+}
+
+void bench_async_log(void) {
+    async_log_write(async_logger, test_string_medium, 63);
+}
+
+// ============================================================================
+// Benchmark 17: stdout shared by threads - explicit locking, per-thread I/O
+// ============================================================================
+// One line from three pieces, like bench_writev_multi: other threads can
+// get between the pieces unless the FILE stays locked across them
+void bench_fwrite_parts(void) {
+    fwrite("[INFO] ", 1, 7, stdout);
+    fwrite("Hello, C!!!!", 1, 12, stdout);
+    fwrite("\n", 1, 1, stdout);
+}
+
+void bench_fwrite_unlocked_parts(void) {
+    flockfile(stdout);
+    fwrite_unlocked("[INFO] ", 1, 7, stdout);
+    fwrite_unlocked("Hello, C!!!!", 1, 12, stdout);
+    fwrite_unlocked("\n", 1, 1, stdout);
+    funlockfile(stdout);
+}
+
+void bench_putc_unlocked_loop(void) {
+    const char *s = test_string_short;
+    flockfile(stdout);
+    while (*s) {
+        putc_unlocked(*s++, stdout);
+    }
+    funlockfile(stdout);
+}
+
+// Each thread gathers its lines and hands THREAD_BATCH of them to one writev
+static _Thread_local struct iovec thread_iov[THREAD_BATCH];
+static _Thread_local int thread_iov_count;
+
+void flush_thread_writev(void) {
+    if (thread_iov_count > 0) (void)writev(STDOUT_FILENO, thread_iov, thread_iov_count);
+    thread_iov_count = 0;
+}
+
+void bench_thread_writev(void) {
+    thread_iov[thread_iov_count].iov_base = (void*)test_string_short;
+    thread_iov[thread_iov_count].iov_len = 13;
+    if (++thread_iov_count == THREAD_BATCH) flush_thread_writev();
+}
+
+// Each thread opens the log itself (like separate processes would), with
+// or without O_APPEND
+static char thread_fd_path[64];
+static _Thread_local int thread_fd = -1;
+
+static void thread_fd_write(int flags) {
+    if (thread_fd == -1) thread_fd = open(thread_fd_path, O_WRONLY | flags);
+    (void)write(thread_fd, test_string_short, 13);
+}
+
+void bench_own_fd_write(void) {
+    thread_fd_write(0);
+}
+
+void bench_own_fd_append(void) {
+    thread_fd_write(O_APPEND);
+}
+
+void close_thread_fd(void) {
+    if (thread_fd != -1) close(thread_fd);
+    thread_fd = -1;
+}
+
 // ============================================================================
 // Run benchmark and measure time
 // ============================================================================
@@ -224,12 +329,8 @@ double run_benchmark(Benchmark *bench, int silent __attribute__((unused))) {
     // Save original stdout
     int stdout_copy = dup(STDOUT_FILENO);
     
-    // Redirect stdout to /dev/null during benchmark
-    int devnull = open("/dev/null", O_WRONLY);
-    if (devnull == -1) {
-        perror("open /dev/null");
-        return -1;
-    }
+    // Redirect stdout to the sink (/dev/null by default) during benchmark
+    console_sink_rewind(&stdout_sink);
     
     // Handle special buffer modes
     if (bench->special_setup == 1) {
@@ -241,8 +342,7 @@ double run_benchmark(Benchmark *bench, int silent __attribute__((unused))) {
         setvbuf(stdout, buf, _IOFBF, BUFSIZ);
     }
     
-    dup2(devnull, STDOUT_FILENO);
-    close(devnull);
+    dup2(stdout_sink.fd, STDOUT_FILENO);
     
     // Warmup
     for (int i = 0; i < WARMUP_ITERATIONS; i++) {
@@ -250,13 +350,23 @@ double run_benchmark(Benchmark *bench, int silent __attribute__((unused))) {
     }
     fflush(stdout);
     
-    // Benchmark
-    uint64_t start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        bench->func();
+    // Benchmark (the flush at the end of a trial is part of its time)
+    bench_timer timer;
+    bench_timer_init(&timer);
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        bench_trial_begin(&timer);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&timer, i);
+            bench->func();
+            bench_op_end(&timer);
+        }
+        fflush(stdout);
+        bench_trial_end(&timer, ITERATIONS);
     }
-    fflush(stdout);
-    uint64_t end = get_nanos();
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, bench->name, (double)ITERATIONS * bench_cfg.trials);
+    bench_report_row(bench->name, &timer);
     
     // Restore stdout
     dup2(stdout_copy, STDOUT_FILENO);
@@ -265,18 +375,419 @@ double run_benchmark(Benchmark *bench, int silent __attribute__((unused))) {
     // Reset buffer mode to line buffered
     setvbuf(stdout, NULL, _IOLBF, 0);
     
-    double total_ns = (double)(end - start);
-    double per_op_ns = total_ns / ITERATIONS;
-    
-    return per_op_ns;
+    return bench_timer_stats(&timer).median;
+}
+
+// ============================================================================
+// Async logging: producer threads against a shared sink
+// ============================================================================
+
+typedef struct {
+    const char *name;
+    benchmark_func func;
+    bool async;
+} async_method;
+
+typedef struct {
+    benchmark_func func;
+    pthread_barrier_t *start;
+    pthread_barrier_t *done;
+    bench_timer timer;
+} producer;
+
+static void* producer_main(void *arg) {
+    producer *p = arg;
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        pthread_barrier_wait(p->start);
+        bench_trial_begin(&p->timer);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&p->timer, (size_t)i);
+            p->func();
+            bench_op_end(&p->timer);
+        }
+        bench_trial_end(&p->timer, ITERATIONS);
+        pthread_barrier_wait(p->done);
+    }
+    return NULL;
+}
+
+// One row: threads log in lockstep trials. A trial ends once the records
+// reached the fd (fflush / async_log_flush), so ns/record is sustained
+// wall time; the percentiles are the producers' own calls.
+static void run_async_row(const char *sink, const async_method *m, int threads) {
+    static producer producers[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    pthread_barrier_t start, done;
+
+    (void)ftruncate(async_fd, 0);
+    if (m->async) async_logger = async_log_create(async_fd, ASYNC_CAPACITY, ASYNC_LOG_BLOCK);
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) m->func();
+    if (m->async) async_log_flush(async_logger);
+    else fflush(async_file);
+    // Counters cover the measured trials only
+    uint64_t batches0 = m->async ? atomic_load(&async_logger->batches) : 0;
+    uint64_t records0 = m->async ? atomic_load(&async_logger->records) : 0;
+    uint64_t waits0 = m->async ? atomic_load(&async_logger->full_waits) : 0;
+
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    pthread_barrier_init(&done, NULL, (unsigned)threads + 1);
+    for (int t = 0; t < threads; t++) {
+        producers[t].func = m->func;
+        producers[t].start = &start;
+        producers[t].done = &done;
+        bench_timer_init(&producers[t].timer);
+        pthread_create(&tids[t], NULL, producer_main, &producers[t]);
+    }
+
+    bench_timer row;
+    bench_timer_init(&row);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        pthread_barrier_wait(&start);
+        bench_trial_begin(&row);
+        pthread_barrier_wait(&done);
+        if (m->async) async_log_flush(async_logger);
+        else fflush(async_file);
+        bench_trial_end(&row, (size_t)threads * ITERATIONS);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        bench_hist_merge(&row.hist, &producers[t].timer.hist);
+    }
+    pthread_barrier_destroy(&start);
+    pthread_barrier_destroy(&done);
+
+    char per_writev[32] = "-", waits[32] = "-";
+    if (m->async) {
+        uint64_t batches = atomic_load(&async_logger->batches) - batches0;
+        uint64_t records = atomic_load(&async_logger->records) - records0;
+        snprintf(per_writev, sizeof(per_writev), "%.1f", batches ? (double)records / (double)batches : 0.0);
+        snprintf(waits, sizeof(waits), "%" PRIu64, atomic_load(&async_logger->full_waits) - waits0);
+        async_log_destroy(async_logger);
+        async_logger = NULL;
+    }
+
+    bench_stats s = bench_timer_stats(&row);
+    fprintf(stderr, "| %s | %s | %d | %.0f | %.0f | %.0f | %.2fM/s | %s | %s |\n", sink, m->name, threads,
+            s.p50, s.p99, s.p999, s.median > 0 ? 1000.0 / s.median : 0.0, per_writev, waits);
+    char label[48];
+    snprintf(label, sizeof(label), "%s / %s / %d thread%s", sink, m->name, threads, threads > 1 ? "s" : "");
+    bench_report_row(label, &row);
+}
+
+static void run_async_logging(void) {
+    static const async_method methods[] = {
+        {"fwrite", bench_sync_fwrite, false},
+        {"write", bench_sync_write, false},
+        {"async_log", bench_async_log, true},
+    };
+    int max_threads = bench_env_int("BENCH_THREADS", 4);
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    fprintf(stderr, "## Async Logging (%d-byte records, 1-%d producer threads, %ld CPUs)\n\n",
+            TS_FORMAT_LEN + 1 + 63, max_threads, sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(stderr, "| Sink | Method | Threads | Producer p50 (ns) | p99 | p99.9 | Sustained | Records/writev | Full waits |\n");
+    fprintf(stderr, "|------|--------|--------:|------------------:|----:|------:|----------:|---------------:|-----------:|\n");
+
+    char path[] = "/tmp/benchmark_console_XXXXXX";
+    struct {
+        const char *name;
+        int fd;
+    } sinks[] = {
+        {"/dev/null", open("/dev/null", O_WRONLY)},
+        {"file", mkstemp(path)},
+    };
+    if (sinks[1].fd != -1) {
+        unlink(path);
+        fcntl(sinks[1].fd, F_SETFL, O_APPEND);  // each row truncates it
+    }
+
+    bench_unpin();  // producers and the consumer need every CPU
+    for (size_t k = 0; k < sizeof(sinks) / sizeof(sinks[0]); k++) {
+        if (sinks[k].fd == -1) {
+            perror(sinks[k].name);
+            continue;
+        }
+        async_fd = sinks[k].fd;
+        async_file = fdopen(async_fd, "w");
+        for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+            for (int threads = 1; threads <= max_threads; threads *= 2)
+                run_async_row(sinks[k].name, &methods[m], threads);
+        }
+        fclose(async_file);
+    }
+    bench_repin();
+    bench_report_print(stderr, "Async Logging");
+    fprintf(stderr, "\n*Sustained = records/s of all threads until the last record reached the fd; "
+            "percentiles are single producer calls. fwrite shares one FILE (and its lock), write one fd "
+            "(the syscall per record); async_log only copies into the ring.*\n\n");
+}
+
+// ============================================================================
+// Thread contention: the Benchmark rows from 1..N threads on one stdout
+// ============================================================================
+
+static console_sink contention_sink;
+
+typedef struct {
+    Benchmark bench;
+    benchmark_func flush;  // per thread, after its calls of a trial (NULL = none)
+    benchmark_func finish; // per thread, before it exits (NULL = none)
+} contention_row;
+
+typedef struct {
+    const contention_row *row;
+    pthread_barrier_t *start;
+    pthread_barrier_t *done;
+    bench_timer timer;
+} contender;
+
+static void* contender_main(void *arg) {
+    contender *c = arg;
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) c->row->bench.func();
+    if (c->row->flush) c->row->flush();
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        pthread_barrier_wait(c->start);
+        bench_trial_begin(&c->timer);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&c->timer, (size_t)i);
+            c->row->bench.func();
+            bench_op_end(&c->timer);
+        }
+        if (c->row->flush) c->row->flush();
+        bench_trial_end(&c->timer, ITERATIONS);
+        pthread_barrier_wait(c->done);
+    }
+    if (c->row->finish) c->row->finish();
+    return NULL;
+}
+
+// Splits the output into records equal to ref; anything else up to the
+// next newline counts as one torn line
+static uint64_t count_intact(const char *p, size_t n, const char *ref, size_t ref_len) {
+    uint64_t intact = 0;
+    size_t pos = 0;
+    while (pos < n) {
+        if (n - pos >= ref_len && memcmp(p + pos, ref, ref_len) == 0) {
+            intact++;
+            pos += ref_len;
+        } else {
+            const char *nl = memchr(p + pos, '\n', n - pos);
+            pos = nl ? (size_t)(nl - p) + 1 : n;
+        }
+    }
+    return intact;
+}
+
+static void run_contention_row(const contention_row *r, int threads) {
+    static contender contenders[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    pthread_barrier_t start, done;
+    int fd = contention_sink.fd;
+
+    // What one call writes when it runs alone
+    console_sink_rewind(&contention_sink);
+    r->bench.func();
+    if (r->flush) r->flush();
+    if (r->finish) r->finish();
+    fflush(stdout);
+    char ref[512];
+    ssize_t ref_len = pread(fd, ref, sizeof(ref), 0);
+    console_sink_rewind(&contention_sink);
+
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    pthread_barrier_init(&done, NULL, (unsigned)threads + 1);
+    for (int t = 0; t < threads; t++) {
+        contenders[t].row = r;
+        contenders[t].start = &start;
+        contenders[t].done = &done;
+        bench_timer_init(&contenders[t].timer);
+        pthread_create(&tids[t], NULL, contender_main, &contenders[t]);
+    }
+    bench_timer row;
+    bench_timer_init(&row);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        pthread_barrier_wait(&start);
+        bench_trial_begin(&row);
+        pthread_barrier_wait(&done);
+        fflush(stdout);
+        bench_trial_end(&row, (size_t)threads * ITERATIONS);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        bench_hist_merge(&row.hist, &contenders[t].timer.hist);
+    }
+    pthread_barrier_destroy(&start);
+    pthread_barrier_destroy(&done);
+
+    uint64_t expected = (uint64_t)threads * ((uint64_t)WARMUP_ITERATIONS + (uint64_t)bench_cfg.trials * ITERATIONS);
+    uint64_t intact = 0;
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (ref_len > 0 && size > 0) {
+        char *out = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+        if (out != MAP_FAILED) {
+            intact = count_intact(out, (size_t)size, ref, (size_t)ref_len);
+            munmap(out, (size_t)size);
+        }
+    }
+
+    bench_stats st = bench_timer_stats(&row);
+    fprintf(stderr, "| %s | %d | %.2fM/s | %.0f | %.0f | %.2f%% |\n", r->bench.name, threads,
+            st.median > 0 ? 1000.0 / st.median : 0.0, st.p50, st.p99, 100.0 * (double)intact / (double)expected);
+    char label[48];
+    snprintf(label, sizeof(label), "%s / %d thread%s", r->bench.name, threads, threads > 1 ? "s" : "");
+    bench_report_row(label, &row);
+}
+
+static void run_contention(const Benchmark *table, int n_table) {
+    static const contention_row extra[] = {
+        {{"fwrite 3 parts", bench_fwrite_parts, "", 0}, NULL, NULL},
+        {{"fwrite_unlocked 3 parts", bench_fwrite_unlocked_parts, "", 0}, NULL, NULL},
+        {{"putc_unlocked loop", bench_putc_unlocked_loop, "", 0}, NULL, NULL},
+        {{"writev per thread", bench_thread_writev, "", 0}, flush_thread_writev, NULL},
+        {{"write own fd", bench_own_fd_write, "", 0}, NULL, close_thread_fd},
+        {{"write own fd O_APPEND", bench_own_fd_append, "", 0}, NULL, close_thread_fd},
+    };
+    int max_threads = bench_env_int("BENCH_THREADS", 4);
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    // The output is read back to check it, so it goes to a file
+    if (!console_sink_open(&contention_sink, CONSOLE_SINK_TMPFS) &&
+        !console_sink_open(&contention_sink, CONSOLE_SINK_FILE)) {
+        perror("contention sink");
+        return;
+    }
+    snprintf(thread_fd_path, sizeof(thread_fd_path), "/proc/self/fd/%d", contention_sink.fd);
+
+    fprintf(stderr, "## Thread Contention (one stdout, 1-%d threads, %d lines per thread and trial, %ld CPUs)\n\n",
+            max_threads, ITERATIONS, sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(stderr, "| Method | Threads | Lines/sec | p50 (ns) | p99 (ns) | Intact lines |\n");
+    fprintf(stderr, "|--------|--------:|----------:|---------:|---------:|-------------:|\n");
+
+    fflush(stdout);
+    int stdout_copy = dup(STDOUT_FILENO);
+    dup2(contention_sink.fd, STDOUT_FILENO);
+    setvbuf(stdout, NULL, _IOFBF, BUFSIZ);  // as when stdout is a file or pipe
+    bench_unpin();  // the threads need every CPU
+    for (int i = 0; i < n_table + (int)(sizeof(extra) / sizeof(extra[0])); i++) {
+        contention_row row = i < n_table ? (contention_row){table[i], NULL, NULL} : extra[i - n_table];
+        for (int threads = 1; threads <= max_threads; threads *= 2) run_contention_row(&row, threads);
+    }
+    bench_repin();
+    dup2(stdout_copy, STDOUT_FILENO);
+    close(stdout_copy);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    console_sink_close(&contention_sink);
+
+    bench_report_print(stderr, "Thread Contention");
+    fprintf(stderr, "\n*Lines/sec = all threads' lines over wall time, the final flush included; percentiles are "
+            "single calls. Intact lines = output records identical to what one call writes alone; the write own fd rows "
+            "open the file once per thread, and without O_APPEND the threads overwrite each other.*\n\n");
+}
+
+// ============================================================================
+// Output engines x sinks (console_sink.h)
+// ============================================================================
+
+// Median ns/line of one engine on one sink; a trial ends once the lines
+// reached the fd and, for pipe and pty, the reader. -1 if unsupported
+static double run_sink_row(console_engine_kind engine, console_sink *sink, int lines) {
+    console_writer w;
+    if (!console_engine_supports(engine, sink) || !console_writer_open(&w, engine, sink)) return -1;
+    const size_t len = 63;
+    bool ok = true;
+
+    console_sink_rewind(sink);
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) console_writer_line(&w, test_string_medium, len);
+    ok = console_writer_flush(&w);
+    console_sink_drain(sink, (uint64_t)WARMUP_ITERATIONS * len);
+
+    bench_timer timer;
+    bench_timer_init(&timer);
+    for (int trial = 0; trial < bench_cfg.trials && ok; trial++) {
+        console_sink_rewind(sink);
+        console_writer_rewind(&w);
+        bench_trial_begin(&timer);
+        for (int i = 0; i < lines; i++) {
+            bench_op_begin(&timer, (size_t)i);
+            console_writer_line(&w, test_string_medium, len);
+            bench_op_end(&timer);
+        }
+        ok = console_writer_flush(&w);
+        console_sink_drain(sink, (uint64_t)lines * len);
+        bench_trial_end(&timer, (size_t)lines);
+    }
+    console_writer_close(&w);
+    if (!ok) return -1;
+
+    char label[48];
+    snprintf(label, sizeof(label), "%s / %s", console_engine_names[engine], console_sink_names[sink->kind]);
+    bench_report_row(label, &timer);
+    return bench_timer_stats(&timer).median;
+}
+
+static void run_sink_matrix(void) {
+    int lines = bench_env_int("BENCH_SINK_LINES", 50000);
+    if (lines < 1) lines = 1;
+    console_sink sinks[CONSOLE_SINK_COUNT];
+    bool open[CONSOLE_SINK_COUNT];
+    bench_unpin();  // the pipe / pty readers and io_uring workers need a CPU too
+    for (int k = 0; k < CONSOLE_SINK_COUNT; k++) {
+        open[k] = console_sink_open(&sinks[k], (console_sink_kind)k);
+        if (!open[k]) fprintf(stderr, "sink %s unavailable: %s\n", console_sink_names[k], strerror(errno));
+    }
+
+    fprintf(stderr, "## Output Engines x Sinks (%d lines of 63 bytes per trial)\n\n", lines);
+    fprintf(stderr, "| Engine |");
+    for (int k = 0; k < CONSOLE_SINK_COUNT; k++) fprintf(stderr, " %s |", console_sink_names[k]);
+    fprintf(stderr, "\n|--------|");
+    for (int k = 0; k < CONSOLE_SINK_COUNT; k++) fprintf(stderr, "------:|");
+    fprintf(stderr, "\n");
+
+    for (int e = 0; e < CONSOLE_ENGINE_COUNT; e++) {
+        fprintf(stderr, "| %s |", console_engine_names[e]);
+        for (int k = 0; k < CONSOLE_SINK_COUNT; k++) {
+            double ns = open[k] ? run_sink_row((console_engine_kind)e, &sinks[k], lines) : -1;
+            if (ns > 0) fprintf(stderr, " %.1f ns, %.0f MB/s |", ns, 63.0 / ns * 1000.0);
+            else fprintf(stderr, " n/a |");
+        }
+        fprintf(stderr, "\n");
+    }
+    bench_repin();
+    for (int k = 0; k < CONSOLE_SINK_COUNT; k++) {
+        if (open[k]) console_sink_close(&sinks[k]);
+    }
+    bench_report_print(stderr, "Output Engines x Sinks");
+    fprintf(stderr, "\n*Cells: median ns per line and MB/s, the final flush (and the reader, for pipe and pty) "
+            "included. file and direct live in BENCH_SINK_DIR (default /var/tmp), tmpfs in /dev/shm.*\n\n");
 }
 
 int main(void) {
     // Use stderr for all output to avoid conflicts with benchmark redirections
+    bench_init(5);
+    perf_counters_open(&perf);
     fprintf(stderr, "# Console Output Benchmark Results\n\n");
     fprintf(stderr, "Benchmarking various methods of writing to console in C.\n");
-    fprintf(stderr, "Output redirected to /dev/null during benchmarks to measure pure overhead.\n\n");
-    fprintf(stderr, "Iterations: %d\n\n", ITERATIONS);
+    // O_DIRECT cannot take the unaligned stdio writes of the method rows
+    const char *sink_name = getenv("BENCH_SINK");
+    console_sink_kind sink_kind = sink_name ? console_sink_parse(sink_name) : CONSOLE_SINK_NULL;
+    if (sink_kind == CONSOLE_SINK_COUNT || sink_kind == CONSOLE_SINK_DIRECT) {
+        fprintf(stderr, "BENCH_SINK=%s: expected null, pipe, tmpfs, file or pty\n", sink_name);
+        return 1;
+    }
+    bench_unpin();  // a pipe / pty reader thread runs unpinned
+    bool sink_open = console_sink_open(&stdout_sink, sink_kind);
+    bench_repin();
+    if (!sink_open) {
+        perror(console_sink_names[sink_kind]);
+        return 1;
+    }
+    fprintf(stderr, "Output redirected to the %s sink during benchmarks (BENCH_SINK; default null = /dev/null, "
+            "pure overhead).\n\n", console_sink_names[sink_kind]);
+    fprintf(stderr, "Iterations: %d\n", ITERATIONS);
+    bench_print_config(stderr);
+    fprintf(stderr, "\n");
     
     // System info
     fprintf(stderr, "## System Info\n");
@@ -329,6 +840,8 @@ int main(void) {
         fprintf(stderr, "| %-16s | %9.2f | %10s | %s |\n", 
                basic_benchmarks[i].name, ns, throughput, basic_benchmarks[i].description);
     }
+    bench_report_print(stderr, "Basic Output Methods");
+    perf_counters_print(&perf, stderr, "Basic Output Methods");
     fprintf(stderr, "\n");
     
     // ========================================================================
@@ -373,6 +886,8 @@ int main(void) {
            run_benchmark(&write_short, 1),
            run_benchmark(&write_medium, 1),
            run_benchmark(&write_long, 1));
+    bench_report_print(stderr, "String Length Impact");
+    perf_counters_print(&perf, stderr, "String Length Impact");
     fprintf(stderr, "\n");
     
     // ========================================================================
@@ -399,6 +914,8 @@ int main(void) {
         fprintf(stderr, "| %-16s | %9.2f | %s |\n", 
                formatted_benchmarks[i].name, ns, formatted_benchmarks[i].description);
     }
+    bench_report_print(stderr, "Formatted Output Comparison");
+    perf_counters_print(&perf, stderr, "Formatted Output Comparison");
     fprintf(stderr, "\n");
     
     // ========================================================================
@@ -420,6 +937,8 @@ int main(void) {
         fprintf(stderr, "| %-13s | %9.2f | %s |\n", 
                buffer_benchmarks[i].name, ns, buffer_benchmarks[i].description);
     }
+    bench_report_print(stderr, "Buffer Mode Impact");
+    perf_counters_print(&perf, stderr, "Buffer Mode Impact");
     fprintf(stderr, "\n");
     
     // ========================================================================
@@ -440,7 +959,13 @@ int main(void) {
         fprintf(stderr, "| %-14s | %9.2f | %s |\n", 
                advanced_benchmarks[i].name, ns, advanced_benchmarks[i].description);
     }
+    bench_report_print(stderr, "Advanced Methods");
+    perf_counters_print(&perf, stderr, "Advanced Methods");
     fprintf(stderr, "\n");
+
+    run_contention(basic_benchmarks, n_basic);
+    run_async_logging();
+    run_sink_matrix();
     
     // ========================================================================
     // Summary
@@ -460,5 +985,7 @@ int main(void) {
     fprintf(stderr, "- `dprintf()` bypasses stdio buffer, directly writes to fd\n");
     fprintf(stderr, "- String length has minimal impact for buffered output\n");
     
+    console_sink_close(&stdout_sink);
+    perf_counters_close(&perf);
     return 0;
 }
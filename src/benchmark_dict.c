@@ -5,20 +5,26 @@
 #include <time.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <unistd.h>
+#include "../include/dict.h"
+#include "../include/workload.h"
+#include "../include/bench.h"
+#include "../include/perf_counters.h"
 
 #define ITERATIONS 65535
 #define WARMUP_ITERATIONS 10000
 #define INITIAL_CAPACITY 16
 #define LOAD_FACTOR 0.75
 
-// ============================================================================
-// High-resolution timing
-// ============================================================================
-static inline uint64_t get_nanos(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
-}
+// Workload comparison: keys loaded before the run, and operations replayed
+#define WORKLOAD_RECORDS 100000
+#define WORKLOAD_OPS 1000000
+
+// Sweep mode: random lookups timed at every size / load point
+#define SWEEP_QUERIES 1000000
+
+// Hardware counters per row when BENCH_PERF is set (perf_counters.h)
+static perf_counters perf;
 
 // ============================================================================
 // Hash Table Implementation 1: Simple chaining with linked list
@@ -70,6 +76,12 @@ static uint32_t hash_murmur3_simple(const char *str) {
     return h;
 }
 
+// wyhash from dict.h: 16 bytes per step instead of one byte per iteration
+static uint32_t hash_wyhash(const char *str) {
+    uint64_t h = dict_wyhash(str, strlen(str), 0);
+    return (uint32_t)(h ^ (h >> 32));
+}
+
 // Chain hash table functions
 ChainHashTable* chain_create(size_t capacity) {
     ChainHashTable *ht = malloc(sizeof(ChainHashTable));
@@ -398,6 +410,307 @@ bool robin_remove(RobinHashTable *ht, const char *key) {
     return false;
 }
 
+// ============================================================================
+// Hash Table Implementation 4: Bucketized cuckoo hashing (4-way buckets)
+// ============================================================================
+#define CUCKOO_WAYS 4
+#define CUCKOO_MAX_KICKS 500
+
+typedef struct {
+    char *key;  // NULL = empty slot
+    int value;
+    uint32_t hash;
+} CuckooEntry;
+
+// Every key lives in one of two buckets, so a lookup reads at most 2 x 4 slots
+typedef struct {
+    CuckooEntry *slots;  // bucket b is slots[b * CUCKOO_WAYS] .. + CUCKOO_WAYS - 1
+    size_t buckets;
+    size_t size;
+    uint32_t (*hash_func)(const char*);
+    uint64_t rng;        // victim choice on kick-out
+} CuckooHashTable;
+
+CuckooHashTable* cuckoo_create(size_t capacity, uint32_t (*hash_func)(const char*)) {
+    CuckooHashTable *ht = malloc(sizeof(CuckooHashTable));
+    ht->buckets = (capacity + CUCKOO_WAYS - 1) / CUCKOO_WAYS;
+    if (ht->buckets == 0) ht->buckets = 1;
+    ht->slots = calloc(ht->buckets * CUCKOO_WAYS, sizeof(CuckooEntry));
+    ht->size = 0;
+    ht->hash_func = hash_func;
+    ht->rng = 0x2545F4914F6CDD1DULL;
+    return ht;
+}
+
+void cuckoo_destroy(CuckooHashTable *ht) {
+    for (size_t i = 0; i < ht->buckets * CUCKOO_WAYS; i++)
+        free(ht->slots[i].key);
+    free(ht->slots);
+    free(ht);
+}
+
+static size_t cuckoo_bucket1(const CuckooHashTable *ht, uint32_t hash) {
+    return hash % ht->buckets;
+}
+
+// Second bucket from a multiplicative remix of the same hash
+static size_t cuckoo_bucket2(const CuckooHashTable *ht, uint32_t hash) {
+    size_t b1 = hash % ht->buckets;
+    size_t b2 = (size_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> 32) % ht->buckets;
+    return b2 != b1 ? b2 : (b1 + 1) % ht->buckets;
+}
+
+static CuckooEntry* cuckoo_find(CuckooHashTable *ht, const char *key, uint32_t hash) {
+    size_t b[2] = {cuckoo_bucket1(ht, hash), cuckoo_bucket2(ht, hash)};
+    for (int k = 0; k < 2; k++) {
+        CuckooEntry *bucket = &ht->slots[b[k] * CUCKOO_WAYS];
+        for (int w = 0; w < CUCKOO_WAYS; w++) {
+            if (bucket[w].key && bucket[w].hash == hash && strcmp(bucket[w].key, key) == 0)
+                return &bucket[w];
+        }
+    }
+    return NULL;
+}
+
+static bool cuckoo_try_bucket(CuckooHashTable *ht, size_t b, const CuckooEntry *entry) {
+    CuckooEntry *bucket = &ht->slots[b * CUCKOO_WAYS];
+    for (int w = 0; w < CUCKOO_WAYS; w++) {
+        if (!bucket[w].key) {
+            bucket[w] = *entry;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stores *entry, evicting residents to their other bucket (random walk).
+// On failure *entry holds the one item left without a slot.
+static bool cuckoo_place(CuckooHashTable *ht, CuckooEntry *entry) {
+    size_t b = cuckoo_bucket1(ht, entry->hash);
+    if (cuckoo_try_bucket(ht, b, entry)) return true;
+    if (cuckoo_try_bucket(ht, cuckoo_bucket2(ht, entry->hash), entry)) return true;
+    
+    for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++) {
+        ht->rng ^= ht->rng << 13;
+        ht->rng ^= ht->rng >> 7;
+        ht->rng ^= ht->rng << 17;
+        CuckooEntry *victim = &ht->slots[b * CUCKOO_WAYS + ht->rng % CUCKOO_WAYS];
+        CuckooEntry tmp = *victim;
+        *victim = *entry;
+        *entry = tmp;
+        
+        size_t b1 = cuckoo_bucket1(ht, entry->hash);
+        b = b == b1 ? cuckoo_bucket2(ht, entry->hash) : b1;
+        if (cuckoo_try_bucket(ht, b, entry)) return true;
+    }
+    return false;
+}
+
+// Doubles the bucket count until every item (plus pending) fits
+static void cuckoo_rehash(CuckooHashTable *ht, CuckooEntry pending) {
+    CuckooEntry *items = malloc(ht->size * sizeof(CuckooEntry));
+    size_t count = 0;
+    for (size_t i = 0; i < ht->buckets * CUCKOO_WAYS; i++) {
+        if (ht->slots[i].key) items[count++] = ht->slots[i];
+    }
+    items[count++] = pending;
+    free(ht->slots);
+    
+    bool placed = false;
+    while (!placed) {
+        ht->buckets *= 2;
+        ht->slots = calloc(ht->buckets * CUCKOO_WAYS, sizeof(CuckooEntry));
+        placed = true;
+        for (size_t i = 0; i < count && placed; i++) {
+            CuckooEntry entry = items[i];
+            placed = cuckoo_place(ht, &entry);
+        }
+        if (!placed) free(ht->slots);
+    }
+    free(items);
+}
+
+void cuckoo_insert(CuckooHashTable *ht, const char *key, int value) {
+    uint32_t hash = ht->hash_func(key);
+    CuckooEntry *found = cuckoo_find(ht, key, hash);
+    if (found) {
+        found->value = value;
+        return;
+    }
+    
+    CuckooEntry entry = {strdup(key), value, hash};
+    ht->size++;
+    if (!cuckoo_place(ht, &entry))
+        cuckoo_rehash(ht, entry);
+}
+
+bool cuckoo_contains(CuckooHashTable *ht, const char *key) {
+    return cuckoo_find(ht, key, ht->hash_func(key)) != NULL;
+}
+
+int cuckoo_get(CuckooHashTable *ht, const char *key, int default_val) {
+    CuckooEntry *found = cuckoo_find(ht, key, ht->hash_func(key));
+    return found ? found->value : default_val;
+}
+
+bool cuckoo_remove(CuckooHashTable *ht, const char *key) {
+    CuckooEntry *found = cuckoo_find(ht, key, ht->hash_func(key));
+    if (!found) return false;
+    free(found->key);
+    found->key = NULL;
+    ht->size--;
+    return true;
+}
+
+// ============================================================================
+// Hash Table Implementation 5: Hopscotch hashing
+// ============================================================================
+#define HOP_RANGE 32       // neighbourhood: the home slot and the 31 after it
+#define HOP_ADD_RANGE 512  // free-slot search distance before the table grows
+
+typedef struct {
+    char *key;      // NULL = empty slot
+    int value;
+    uint32_t hash;
+    uint32_t hop;   // bit d: slot (this + d) holds a key whose home is this slot
+} HopEntry;
+
+// Every key lives within HOP_RANGE slots of its home, found via the home's bitmap
+typedef struct {
+    HopEntry *entries;
+    size_t capacity;
+    size_t size;
+    uint32_t (*hash_func)(const char*);
+} HopHashTable;
+
+HopHashTable* hop_create(size_t capacity, uint32_t (*hash_func)(const char*)) {
+    HopHashTable *ht = malloc(sizeof(HopHashTable));
+    if (capacity < HOP_RANGE) capacity = HOP_RANGE;
+    ht->entries = calloc(capacity, sizeof(HopEntry));
+    ht->capacity = capacity;
+    ht->size = 0;
+    ht->hash_func = hash_func;
+    return ht;
+}
+
+void hop_destroy(HopHashTable *ht) {
+    for (size_t i = 0; i < ht->capacity; i++)
+        free(ht->entries[i].key);
+    free(ht->entries);
+    free(ht);
+}
+
+static HopEntry* hop_find(HopHashTable *ht, const char *key, uint32_t hash) {
+    size_t home = hash % ht->capacity;
+    uint32_t hop = ht->entries[home].hop;
+    while (hop) {
+        HopEntry *e = &ht->entries[(home + (size_t)dict_ctz32(hop)) % ht->capacity];
+        if (e->hash == hash && strcmp(e->key, key) == 0)
+            return e;
+        hop &= hop - 1;
+    }
+    return NULL;
+}
+
+// Finds a free slot by linear probing, then hops it back towards home by
+// moving entries that may legally occupy it. False if the table must grow.
+static bool hop_place(HopHashTable *ht, const HopEntry *entry) {
+    size_t cap = ht->capacity;
+    size_t home = entry->hash % cap;
+    size_t dist = 0;
+    while (dist < HOP_ADD_RANGE && dist < cap && ht->entries[(home + dist) % cap].key)
+        dist++;
+    if (dist == HOP_ADD_RANGE || dist == cap)
+        return false;
+    
+    while (dist >= HOP_RANGE) {
+        size_t free_idx = (home + dist) % cap;
+        bool moved = false;
+        // Farthest candidate home first, so each move covers the most distance
+        for (size_t back = HOP_RANGE - 1; back > 0 && !moved; back--) {
+            size_t cand = (free_idx + cap - back) % cap;
+            uint32_t before = ht->entries[cand].hop & ((1u << back) - 1);
+            if (!before) continue;
+            size_t d = (size_t)dict_ctz32(before);
+            HopEntry *from = &ht->entries[(cand + d) % cap];
+            HopEntry *to = &ht->entries[free_idx];
+            to->key = from->key;
+            to->value = from->value;
+            to->hash = from->hash;
+            from->key = NULL;
+            ht->entries[cand].hop = (ht->entries[cand].hop & ~(1u << d)) | (1u << back);
+            dist -= back - d;
+            moved = true;
+        }
+        if (!moved) return false;
+    }
+    
+    HopEntry *slot = &ht->entries[(home + dist) % cap];
+    slot->key = entry->key;
+    slot->value = entry->value;
+    slot->hash = entry->hash;
+    ht->entries[home].hop |= 1u << dist;
+    return true;
+}
+
+// Doubles the capacity until every item (plus pending) fits
+static void hop_rehash(HopHashTable *ht, HopEntry pending) {
+    HopEntry *items = malloc(ht->size * sizeof(HopEntry));
+    size_t count = 0;
+    for (size_t i = 0; i < ht->capacity; i++) {
+        if (ht->entries[i].key) items[count++] = ht->entries[i];
+    }
+    items[count++] = pending;
+    free(ht->entries);
+    
+    bool placed = false;
+    while (!placed) {
+        ht->capacity *= 2;
+        ht->entries = calloc(ht->capacity, sizeof(HopEntry));
+        placed = true;
+        for (size_t i = 0; i < count && placed; i++)
+            placed = hop_place(ht, &items[i]);
+        if (!placed) free(ht->entries);
+    }
+    free(items);
+}
+
+void hop_insert(HopHashTable *ht, const char *key, int value) {
+    uint32_t hash = ht->hash_func(key);
+    HopEntry *found = hop_find(ht, key, hash);
+    if (found) {
+        found->value = value;
+        return;
+    }
+    
+    HopEntry entry = {strdup(key), value, hash, 0};
+    ht->size++;
+    if (!hop_place(ht, &entry))
+        hop_rehash(ht, entry);
+}
+
+bool hop_contains(HopHashTable *ht, const char *key) {
+    return hop_find(ht, key, ht->hash_func(key)) != NULL;
+}
+
+int hop_get(HopHashTable *ht, const char *key, int default_val) {
+    HopEntry *found = hop_find(ht, key, ht->hash_func(key));
+    return found ? found->value : default_val;
+}
+
+bool hop_remove(HopHashTable *ht, const char *key) {
+    uint32_t hash = ht->hash_func(key);
+    HopEntry *found = hop_find(ht, key, hash);
+    if (!found) return false;
+    size_t home = hash % ht->capacity;
+    size_t d = ((size_t)(found - ht->entries) + ht->capacity - home) % ht->capacity;
+    ht->entries[home].hop &= ~(1u << d);
+    free(found->key);
+    found->key = NULL;
+    ht->size--;
+    return true;
+}
+
 // ============================================================================
 // Hash function comparison table using chain hash table
 // ============================================================================
@@ -501,6 +814,12 @@ bool chain_remove_with_func(ChainHashTableWithFunc *ht, const char *key) {
     return false;
 }
 
+// ============================================================================
+// dict.h tables driven through the same interface
+// ============================================================================
+DICT_DEFINE_STR_INT(StrIntDict)
+DICT_DEFINE_SWISS_STR_INT(SwissStrIntDict)
+
 // ============================================================================
 // Test data generation
 // ============================================================================
@@ -542,12 +861,39 @@ typedef struct {
     double remove_ns;
 } BenchmarkResult;
 
-// Benchmark chain hash table
-BenchmarkResult bench_chain(size_t capacity, int iterations) {
-    BenchmarkResult result = {"chain_linked_list", "Chaining with linked lists (DJB2)", 0, 0, 0, 0, 0, 0};
+// Timed loops of a bench_* run, in BenchmarkResult column order
+enum {
+    PHASE_INSERT,
+    PHASE_CONTAINS_HIT,
+    PHASE_CONTAINS_MISS,
+    PHASE_GET_HIT,
+    PHASE_GET_MISS,
+    PHASE_REMOVE,
+    PHASE_COUNT
+};
+
+static const char *phase_names[PHASE_COUNT] = {
+    "insert", "contains hit", "contains miss", "get hit", "get miss", "remove"
+};
+
+// Fills the columns with the median of each phase and records the full
+// trial / latency stats for the next bench_report_print
+static void finish_result(BenchmarkResult *r, const bench_timer t[PHASE_COUNT]) {
+    double *cols[PHASE_COUNT] = {&r->insert_ns, &r->contains_hit_ns, &r->contains_miss_ns,
+                                 &r->get_hit_ns, &r->get_miss_ns, &r->remove_ns};
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        char label[48];
+        snprintf(label, sizeof(label), "%s / %s", r->name, phase_names[p]);
+        bench_report_row(label, &t[p]);
+        *cols[p] = bench_timer_stats(&t[p]).median;
+    }
+}
+
+// Benchmark chain hash table; name labels its rows
+BenchmarkResult bench_chain(const char *name, size_t capacity, int iterations) {
+    BenchmarkResult result = {name, "Chaining with linked lists (DJB2)", 0, 0, 0, 0, 0, 0};
     char **keys = generate_keys(iterations);
     char **miss_keys = generate_random_keys(iterations);
-    uint64_t start, end;
     
     // Warmup
     ChainHashTable *ht = chain_create(capacity);
@@ -555,50 +901,72 @@ BenchmarkResult bench_chain(size_t capacity, int iterations) {
         chain_insert(ht, keys[i], i);
     chain_destroy(ht);
     
-    // Insert benchmark
-    ht = chain_create(capacity);
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_insert(ht, keys[i], i);
-    end = get_nanos();
-    result.insert_ns = (double)(end - start) / iterations;
-    
-    // Contains hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_contains(ht, keys[i]);
-    end = get_nanos();
-    result.contains_hit_ns = (double)(end - start) / iterations;
-    
-    // Contains miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_contains(ht, miss_keys[i]);
-    end = get_nanos();
-    result.contains_miss_ns = (double)(end - start) / iterations;
-    
-    // Get hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_get(ht, keys[i], -1);
-    end = get_nanos();
-    result.get_hit_ns = (double)(end - start) / iterations;
-    
-    // Get miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_get(ht, miss_keys[i], -1);
-    end = get_nanos();
-    result.get_miss_ns = (double)(end - start) / iterations;
-    
-    // Remove benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_remove(ht, keys[i]);
-    end = get_nanos();
-    result.remove_ns = (double)(end - start) / iterations;
+    bench_timer t[PHASE_COUNT];
+    bench_timers_init(t, PHASE_COUNT);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert benchmark
+        ht = chain_create(capacity);
+        bench_trial_begin(&t[PHASE_INSERT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_INSERT], i);
+            chain_insert(ht, keys[i], i);
+            bench_op_end(&t[PHASE_INSERT]);
+        }
+        bench_trial_end(&t[PHASE_INSERT], iterations);
+        
+        // Contains hit benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_HIT], i);
+            chain_contains(ht, keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_HIT]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_HIT], iterations);
+        
+        // Contains miss benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_MISS], i);
+            chain_contains(ht, miss_keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_MISS]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_MISS], iterations);
+        
+        // Get hit benchmark
+        bench_trial_begin(&t[PHASE_GET_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_HIT], i);
+            chain_get(ht, keys[i], -1);
+            bench_op_end(&t[PHASE_GET_HIT]);
+        }
+        bench_trial_end(&t[PHASE_GET_HIT], iterations);
+        
+        // Get miss benchmark
+        bench_trial_begin(&t[PHASE_GET_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_MISS], i);
+            chain_get(ht, miss_keys[i], -1);
+            bench_op_end(&t[PHASE_GET_MISS]);
+        }
+        bench_trial_end(&t[PHASE_GET_MISS], iterations);
+        
+        // Remove benchmark
+        bench_trial_begin(&t[PHASE_REMOVE]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_REMOVE], i);
+            chain_remove(ht, keys[i]);
+            bench_op_end(&t[PHASE_REMOVE]);
+        }
+        bench_trial_end(&t[PHASE_REMOVE], iterations);
+        
+        chain_destroy(ht);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, result.name, 6.0 * iterations * bench_cfg.trials);
+    finish_result(&result, t);
     
-    chain_destroy(ht);
     free_keys(keys, iterations);
     free_keys(miss_keys, iterations);
     
@@ -610,7 +978,6 @@ BenchmarkResult bench_open(size_t capacity, int iterations) {
     BenchmarkResult result = {"open_linear_probe", "Open addressing with linear probing", 0, 0, 0, 0, 0, 0};
     char **keys = generate_keys(iterations);
     char **miss_keys = generate_random_keys(iterations);
-    uint64_t start, end;
     
     // Warmup
     OpenHashTable *ht = open_create(capacity);
@@ -618,50 +985,72 @@ BenchmarkResult bench_open(size_t capacity, int iterations) {
         open_insert(ht, keys[i], i);
     open_destroy(ht);
     
-    // Insert benchmark
-    ht = open_create(capacity);
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        open_insert(ht, keys[i], i);
-    end = get_nanos();
-    result.insert_ns = (double)(end - start) / iterations;
-    
-    // Contains hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        open_contains(ht, keys[i]);
-    end = get_nanos();
-    result.contains_hit_ns = (double)(end - start) / iterations;
-    
-    // Contains miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        open_contains(ht, miss_keys[i]);
-    end = get_nanos();
-    result.contains_miss_ns = (double)(end - start) / iterations;
-    
-    // Get hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        open_get(ht, keys[i], -1);
-    end = get_nanos();
-    result.get_hit_ns = (double)(end - start) / iterations;
-    
-    // Get miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        open_get(ht, miss_keys[i], -1);
-    end = get_nanos();
-    result.get_miss_ns = (double)(end - start) / iterations;
-    
-    // Remove benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        open_remove(ht, keys[i]);
-    end = get_nanos();
-    result.remove_ns = (double)(end - start) / iterations;
+    bench_timer t[PHASE_COUNT];
+    bench_timers_init(t, PHASE_COUNT);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert benchmark
+        ht = open_create(capacity);
+        bench_trial_begin(&t[PHASE_INSERT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_INSERT], i);
+            open_insert(ht, keys[i], i);
+            bench_op_end(&t[PHASE_INSERT]);
+        }
+        bench_trial_end(&t[PHASE_INSERT], iterations);
+        
+        // Contains hit benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_HIT], i);
+            open_contains(ht, keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_HIT]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_HIT], iterations);
+        
+        // Contains miss benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_MISS], i);
+            open_contains(ht, miss_keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_MISS]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_MISS], iterations);
+        
+        // Get hit benchmark
+        bench_trial_begin(&t[PHASE_GET_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_HIT], i);
+            open_get(ht, keys[i], -1);
+            bench_op_end(&t[PHASE_GET_HIT]);
+        }
+        bench_trial_end(&t[PHASE_GET_HIT], iterations);
+        
+        // Get miss benchmark
+        bench_trial_begin(&t[PHASE_GET_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_MISS], i);
+            open_get(ht, miss_keys[i], -1);
+            bench_op_end(&t[PHASE_GET_MISS]);
+        }
+        bench_trial_end(&t[PHASE_GET_MISS], iterations);
+        
+        // Remove benchmark
+        bench_trial_begin(&t[PHASE_REMOVE]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_REMOVE], i);
+            open_remove(ht, keys[i]);
+            bench_op_end(&t[PHASE_REMOVE]);
+        }
+        bench_trial_end(&t[PHASE_REMOVE], iterations);
+        
+        open_destroy(ht);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, result.name, 6.0 * iterations * bench_cfg.trials);
+    finish_result(&result, t);
     
-    open_destroy(ht);
     free_keys(keys, iterations);
     free_keys(miss_keys, iterations);
     
@@ -673,7 +1062,6 @@ BenchmarkResult bench_robin(size_t capacity, int iterations) {
     BenchmarkResult result = {"robin_hood", "Robin Hood hashing", 0, 0, 0, 0, 0, 0};
     char **keys = generate_keys(iterations);
     char **miss_keys = generate_random_keys(iterations);
-    uint64_t start, end;
     
     // Warmup
     RobinHashTable *ht = robin_create(capacity);
@@ -681,50 +1069,244 @@ BenchmarkResult bench_robin(size_t capacity, int iterations) {
         robin_insert(ht, keys[i], i);
     robin_destroy(ht);
     
-    // Insert benchmark
-    ht = robin_create(capacity);
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        robin_insert(ht, keys[i], i);
-    end = get_nanos();
-    result.insert_ns = (double)(end - start) / iterations;
-    
-    // Contains hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        robin_contains(ht, keys[i]);
-    end = get_nanos();
-    result.contains_hit_ns = (double)(end - start) / iterations;
-    
-    // Contains miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        robin_contains(ht, miss_keys[i]);
-    end = get_nanos();
-    result.contains_miss_ns = (double)(end - start) / iterations;
-    
-    // Get hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        robin_get(ht, keys[i], -1);
-    end = get_nanos();
-    result.get_hit_ns = (double)(end - start) / iterations;
-    
-    // Get miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        robin_get(ht, miss_keys[i], -1);
-    end = get_nanos();
-    result.get_miss_ns = (double)(end - start) / iterations;
-    
-    // Remove benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        robin_remove(ht, keys[i]);
-    end = get_nanos();
-    result.remove_ns = (double)(end - start) / iterations;
+    bench_timer t[PHASE_COUNT];
+    bench_timers_init(t, PHASE_COUNT);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert benchmark
+        ht = robin_create(capacity);
+        bench_trial_begin(&t[PHASE_INSERT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_INSERT], i);
+            robin_insert(ht, keys[i], i);
+            bench_op_end(&t[PHASE_INSERT]);
+        }
+        bench_trial_end(&t[PHASE_INSERT], iterations);
+        
+        // Contains hit benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_HIT], i);
+            robin_contains(ht, keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_HIT]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_HIT], iterations);
+        
+        // Contains miss benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_MISS], i);
+            robin_contains(ht, miss_keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_MISS]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_MISS], iterations);
+        
+        // Get hit benchmark
+        bench_trial_begin(&t[PHASE_GET_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_HIT], i);
+            robin_get(ht, keys[i], -1);
+            bench_op_end(&t[PHASE_GET_HIT]);
+        }
+        bench_trial_end(&t[PHASE_GET_HIT], iterations);
+        
+        // Get miss benchmark
+        bench_trial_begin(&t[PHASE_GET_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_MISS], i);
+            robin_get(ht, miss_keys[i], -1);
+            bench_op_end(&t[PHASE_GET_MISS]);
+        }
+        bench_trial_end(&t[PHASE_GET_MISS], iterations);
+        
+        // Remove benchmark
+        bench_trial_begin(&t[PHASE_REMOVE]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_REMOVE], i);
+            robin_remove(ht, keys[i]);
+            bench_op_end(&t[PHASE_REMOVE]);
+        }
+        bench_trial_end(&t[PHASE_REMOVE], iterations);
+        
+        robin_destroy(ht);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, result.name, 6.0 * iterations * bench_cfg.trials);
+    finish_result(&result, t);
+    
+    free_keys(keys, iterations);
+    free_keys(miss_keys, iterations);
+    
+    return result;
+}
+
+// Benchmark bucketized cuckoo hash table
+BenchmarkResult bench_cuckoo(const char *name, const char *desc,
+                             uint32_t (*hash_func)(const char*),
+                             size_t capacity, int iterations) {
+    BenchmarkResult result = {name, desc, 0, 0, 0, 0, 0, 0};
+    char **keys = generate_keys(iterations);
+    char **miss_keys = generate_random_keys(iterations);
+    
+    // Warmup
+    CuckooHashTable *ht = cuckoo_create(capacity, hash_func);
+    for (int i = 0; i < WARMUP_ITERATIONS && i < iterations; i++)
+        cuckoo_insert(ht, keys[i], i);
+    cuckoo_destroy(ht);
+    
+    bench_timer t[PHASE_COUNT];
+    bench_timers_init(t, PHASE_COUNT);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert benchmark
+        ht = cuckoo_create(capacity, hash_func);
+        bench_trial_begin(&t[PHASE_INSERT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_INSERT], i);
+            cuckoo_insert(ht, keys[i], i);
+            bench_op_end(&t[PHASE_INSERT]);
+        }
+        bench_trial_end(&t[PHASE_INSERT], iterations);
+        
+        // Contains hit benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_HIT], i);
+            cuckoo_contains(ht, keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_HIT]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_HIT], iterations);
+        
+        // Contains miss benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_MISS], i);
+            cuckoo_contains(ht, miss_keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_MISS]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_MISS], iterations);
+        
+        // Get hit benchmark
+        bench_trial_begin(&t[PHASE_GET_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_HIT], i);
+            cuckoo_get(ht, keys[i], -1);
+            bench_op_end(&t[PHASE_GET_HIT]);
+        }
+        bench_trial_end(&t[PHASE_GET_HIT], iterations);
+        
+        // Get miss benchmark
+        bench_trial_begin(&t[PHASE_GET_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_MISS], i);
+            cuckoo_get(ht, miss_keys[i], -1);
+            bench_op_end(&t[PHASE_GET_MISS]);
+        }
+        bench_trial_end(&t[PHASE_GET_MISS], iterations);
+        
+        // Remove benchmark
+        bench_trial_begin(&t[PHASE_REMOVE]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_REMOVE], i);
+            cuckoo_remove(ht, keys[i]);
+            bench_op_end(&t[PHASE_REMOVE]);
+        }
+        bench_trial_end(&t[PHASE_REMOVE], iterations);
+        
+        cuckoo_destroy(ht);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, result.name, 6.0 * iterations * bench_cfg.trials);
+    finish_result(&result, t);
+    
+    free_keys(keys, iterations);
+    free_keys(miss_keys, iterations);
+    
+    return result;
+}
+
+// Benchmark hopscotch hash table
+BenchmarkResult bench_hop(const char *name, const char *desc,
+                          uint32_t (*hash_func)(const char*),
+                          size_t capacity, int iterations) {
+    BenchmarkResult result = {name, desc, 0, 0, 0, 0, 0, 0};
+    char **keys = generate_keys(iterations);
+    char **miss_keys = generate_random_keys(iterations);
+    
+    // Warmup
+    HopHashTable *ht = hop_create(capacity, hash_func);
+    for (int i = 0; i < WARMUP_ITERATIONS && i < iterations; i++)
+        hop_insert(ht, keys[i], i);
+    hop_destroy(ht);
+    
+    bench_timer t[PHASE_COUNT];
+    bench_timers_init(t, PHASE_COUNT);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert benchmark
+        ht = hop_create(capacity, hash_func);
+        bench_trial_begin(&t[PHASE_INSERT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_INSERT], i);
+            hop_insert(ht, keys[i], i);
+            bench_op_end(&t[PHASE_INSERT]);
+        }
+        bench_trial_end(&t[PHASE_INSERT], iterations);
+        
+        // Contains hit benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_HIT], i);
+            hop_contains(ht, keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_HIT]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_HIT], iterations);
+        
+        // Contains miss benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_MISS], i);
+            hop_contains(ht, miss_keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_MISS]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_MISS], iterations);
+        
+        // Get hit benchmark
+        bench_trial_begin(&t[PHASE_GET_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_HIT], i);
+            hop_get(ht, keys[i], -1);
+            bench_op_end(&t[PHASE_GET_HIT]);
+        }
+        bench_trial_end(&t[PHASE_GET_HIT], iterations);
+        
+        // Get miss benchmark
+        bench_trial_begin(&t[PHASE_GET_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_MISS], i);
+            hop_get(ht, miss_keys[i], -1);
+            bench_op_end(&t[PHASE_GET_MISS]);
+        }
+        bench_trial_end(&t[PHASE_GET_MISS], iterations);
+        
+        // Remove benchmark
+        bench_trial_begin(&t[PHASE_REMOVE]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_REMOVE], i);
+            hop_remove(ht, keys[i]);
+            bench_op_end(&t[PHASE_REMOVE]);
+        }
+        bench_trial_end(&t[PHASE_REMOVE], iterations);
+        
+        hop_destroy(ht);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, result.name, 6.0 * iterations * bench_cfg.trials);
+    finish_result(&result, t);
     
-    robin_destroy(ht);
     free_keys(keys, iterations);
     free_keys(miss_keys, iterations);
     
@@ -738,53 +1320,75 @@ BenchmarkResult bench_hash_func(const char *name, const char *desc,
     BenchmarkResult result = {name, desc, 0, 0, 0, 0, 0, 0};
     char **keys = generate_keys(iterations);
     char **miss_keys = generate_random_keys(iterations);
-    uint64_t start, end;
-    
-    ChainHashTableWithFunc *ht = chain_create_with_func(capacity, hash_func);
-    
-    // Insert benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_insert_with_func(ht, keys[i], i);
-    end = get_nanos();
-    result.insert_ns = (double)(end - start) / iterations;
-    
-    // Contains hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_contains_with_func(ht, keys[i]);
-    end = get_nanos();
-    result.contains_hit_ns = (double)(end - start) / iterations;
-    
-    // Contains miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_contains_with_func(ht, miss_keys[i]);
-    end = get_nanos();
-    result.contains_miss_ns = (double)(end - start) / iterations;
-    
-    // Get hit benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_get_with_func(ht, keys[i], -1);
-    end = get_nanos();
-    result.get_hit_ns = (double)(end - start) / iterations;
-    
-    // Get miss benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_get_with_func(ht, miss_keys[i], -1);
-    end = get_nanos();
-    result.get_miss_ns = (double)(end - start) / iterations;
-    
-    // Remove benchmark
-    start = get_nanos();
-    for (int i = 0; i < iterations; i++)
-        chain_remove_with_func(ht, keys[i]);
-    end = get_nanos();
-    result.remove_ns = (double)(end - start) / iterations;
-    
-    chain_destroy_with_func(ht);
+    
+    ChainHashTableWithFunc *ht = NULL;
+    
+    bench_timer t[PHASE_COUNT];
+    bench_timers_init(t, PHASE_COUNT);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert benchmark
+        ht = chain_create_with_func(capacity, hash_func);
+        bench_trial_begin(&t[PHASE_INSERT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_INSERT], i);
+            chain_insert_with_func(ht, keys[i], i);
+            bench_op_end(&t[PHASE_INSERT]);
+        }
+        bench_trial_end(&t[PHASE_INSERT], iterations);
+        
+        // Contains hit benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_HIT], i);
+            chain_contains_with_func(ht, keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_HIT]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_HIT], iterations);
+        
+        // Contains miss benchmark
+        bench_trial_begin(&t[PHASE_CONTAINS_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_CONTAINS_MISS], i);
+            chain_contains_with_func(ht, miss_keys[i]);
+            bench_op_end(&t[PHASE_CONTAINS_MISS]);
+        }
+        bench_trial_end(&t[PHASE_CONTAINS_MISS], iterations);
+        
+        // Get hit benchmark
+        bench_trial_begin(&t[PHASE_GET_HIT]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_HIT], i);
+            chain_get_with_func(ht, keys[i], -1);
+            bench_op_end(&t[PHASE_GET_HIT]);
+        }
+        bench_trial_end(&t[PHASE_GET_HIT], iterations);
+        
+        // Get miss benchmark
+        bench_trial_begin(&t[PHASE_GET_MISS]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_GET_MISS], i);
+            chain_get_with_func(ht, miss_keys[i], -1);
+            bench_op_end(&t[PHASE_GET_MISS]);
+        }
+        bench_trial_end(&t[PHASE_GET_MISS], iterations);
+        
+        // Remove benchmark
+        bench_trial_begin(&t[PHASE_REMOVE]);
+        for (int i = 0; i < iterations; i++) {
+            bench_op_begin(&t[PHASE_REMOVE], i);
+            chain_remove_with_func(ht, keys[i]);
+            bench_op_end(&t[PHASE_REMOVE]);
+        }
+        bench_trial_end(&t[PHASE_REMOVE], iterations);
+        
+        chain_destroy_with_func(ht);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, result.name, 6.0 * iterations * bench_cfg.trials);
+    finish_result(&result, t);
+    
     free_keys(keys, iterations);
     free_keys(miss_keys, iterations);
     
@@ -797,8 +1401,494 @@ void print_result(BenchmarkResult *r) {
            r->get_hit_ns, r->get_miss_ns, r->remove_ns);
 }
 
-int main(void) {
+// ============================================================================
+// Workload-driven comparison (workload.h)
+// ============================================================================
+
+// Probe length of the stored keys: extra slots (or chain nodes, or Swiss
+// groups) visited past the home position by a successful lookup
+typedef struct {
+    double mean;
+    size_t max;
+} ProbeStats;
+
+// Common interface so one replay loop drives every implementation
+typedef struct {
+    const char *name;
+    void* (*create)(size_t capacity);
+    void (*destroy)(void *table);
+    void (*set)(void *table, const char *key, int value);
+    int (*get)(void *table, const char *key, int default_val);
+    bool (*remove)(void *table, const char *key);
+    size_t (*capacity)(void *table);
+    size_t (*memory)(void *table);  // table + nodes + owned key bytes
+    ProbeStats (*probes)(void *table);
+} TableOps;
+
+static void probe_add(ProbeStats *st, size_t *count, size_t psl) {
+    st->mean += (double)psl;
+    if (psl > st->max) st->max = psl;
+    (*count)++;
+}
+
+static ProbeStats probe_done(ProbeStats st, size_t count) {
+    if (count) st.mean /= (double)count;
+    return st;
+}
+
+static void* chain_create_op(size_t capacity) { return chain_create(capacity); }
+static void chain_destroy_op(void *t) { chain_destroy(t); }
+static void chain_set_op(void *t, const char *key, int value) { chain_insert(t, key, value); }
+static int chain_get_op(void *t, const char *key, int def) { return chain_get(t, key, def); }
+static bool chain_remove_op(void *t, const char *key) { return chain_remove(t, key); }
+static size_t chain_capacity_op(void *t) { return ((ChainHashTable*)t)->capacity; }
+static size_t chain_memory_op(void *t) {
+    ChainHashTable *ht = t;
+    size_t bytes = sizeof(*ht) + ht->capacity * sizeof(ChainNode*);
+    for (size_t i = 0; i < ht->capacity; i++) {
+        for (ChainNode *node = ht->buckets[i]; node; node = node->next)
+            bytes += sizeof(ChainNode) + strlen(node->key) + 1;
+    }
+    return bytes;
+}
+static ProbeStats chain_probes_op(void *t) {
+    ChainHashTable *ht = t;
+    ProbeStats st = {0, 0};
+    size_t count = 0;
+    for (size_t i = 0; i < ht->capacity; i++) {
+        size_t pos = 0;
+        for (ChainNode *node = ht->buckets[i]; node; node = node->next)
+            probe_add(&st, &count, pos++);
+    }
+    return probe_done(st, count);
+}
+
+static void* open_create_op(size_t capacity) { return open_create(capacity); }
+static void open_destroy_op(void *t) { open_destroy(t); }
+static void open_set_op(void *t, const char *key, int value) { open_insert(t, key, value); }
+static int open_get_op(void *t, const char *key, int def) { return open_get(t, key, def); }
+static bool open_remove_op(void *t, const char *key) { return open_remove(t, key); }
+static size_t open_capacity_op(void *t) { return ((OpenHashTable*)t)->capacity; }
+static size_t open_memory_op(void *t) {
+    OpenHashTable *ht = t;
+    size_t bytes = sizeof(*ht) + ht->capacity * sizeof(OpenEntry);
+    for (size_t i = 0; i < ht->capacity; i++) {
+        if (ht->entries[i].key) bytes += strlen(ht->entries[i].key) + 1;
+    }
+    return bytes;
+}
+static ProbeStats open_probes_op(void *t) {
+    OpenHashTable *ht = t;
+    ProbeStats st = {0, 0};
+    size_t count = 0;
+    for (size_t i = 0; i < ht->capacity; i++) {
+        const OpenEntry *e = &ht->entries[i];
+        if (!e->occupied || e->deleted) continue;
+        size_t home = hash_djb2(e->key) % ht->capacity;
+        probe_add(&st, &count, (i + ht->capacity - home) % ht->capacity);
+    }
+    return probe_done(st, count);
+}
+
+static void* robin_create_op(size_t capacity) { return robin_create(capacity); }
+static void robin_destroy_op(void *t) { robin_destroy(t); }
+static void robin_set_op(void *t, const char *key, int value) { robin_insert(t, key, value); }
+static int robin_get_op(void *t, const char *key, int def) { return robin_get(t, key, def); }
+static bool robin_remove_op(void *t, const char *key) { return robin_remove(t, key); }
+static size_t robin_capacity_op(void *t) { return ((RobinHashTable*)t)->capacity; }
+static size_t robin_memory_op(void *t) {
+    RobinHashTable *ht = t;
+    size_t bytes = sizeof(*ht) + ht->capacity * sizeof(RobinEntry);
+    for (size_t i = 0; i < ht->capacity; i++) {
+        if (ht->entries[i].psl >= 0) bytes += strlen(ht->entries[i].key) + 1;
+    }
+    return bytes;
+}
+static ProbeStats robin_probes_op(void *t) {
+    RobinHashTable *ht = t;
+    ProbeStats st = {0, 0};
+    size_t count = 0;
+    for (size_t i = 0; i < ht->capacity; i++) {
+        if (ht->entries[i].psl >= 0) probe_add(&st, &count, (size_t)ht->entries[i].psl);
+    }
+    return probe_done(st, count);
+}
+
+static void* cuckoo_create_op(size_t capacity) { return cuckoo_create(capacity, hash_djb2); }
+static void cuckoo_destroy_op(void *t) { cuckoo_destroy(t); }
+static void cuckoo_set_op(void *t, const char *key, int value) { cuckoo_insert(t, key, value); }
+static int cuckoo_get_op(void *t, const char *key, int def) { return cuckoo_get(t, key, def); }
+static bool cuckoo_remove_op(void *t, const char *key) { return cuckoo_remove(t, key); }
+static size_t cuckoo_capacity_op(void *t) { return ((CuckooHashTable*)t)->buckets * CUCKOO_WAYS; }
+static size_t cuckoo_memory_op(void *t) {
+    CuckooHashTable *ht = t;
+    size_t bytes = sizeof(*ht) + ht->buckets * CUCKOO_WAYS * sizeof(CuckooEntry);
+    for (size_t i = 0; i < ht->buckets * CUCKOO_WAYS; i++) {
+        if (ht->slots[i].key) bytes += strlen(ht->slots[i].key) + 1;
+    }
+    return bytes;
+}
+// 0 in the first bucket, 1 in the alternate one
+static ProbeStats cuckoo_probes_op(void *t) {
+    CuckooHashTable *ht = t;
+    ProbeStats st = {0, 0};
+    size_t count = 0;
+    for (size_t i = 0; i < ht->buckets * CUCKOO_WAYS; i++) {
+        if (ht->slots[i].key)
+            probe_add(&st, &count, i / CUCKOO_WAYS != cuckoo_bucket1(ht, ht->slots[i].hash));
+    }
+    return probe_done(st, count);
+}
+
+static void* hop_create_op(size_t capacity) { return hop_create(capacity, hash_djb2); }
+static void hop_destroy_op(void *t) { hop_destroy(t); }
+static void hop_set_op(void *t, const char *key, int value) { hop_insert(t, key, value); }
+static int hop_get_op(void *t, const char *key, int def) { return hop_get(t, key, def); }
+static bool hop_remove_op(void *t, const char *key) { return hop_remove(t, key); }
+static size_t hop_capacity_op(void *t) { return ((HopHashTable*)t)->capacity; }
+static size_t hop_memory_op(void *t) {
+    HopHashTable *ht = t;
+    size_t bytes = sizeof(*ht) + ht->capacity * sizeof(HopEntry);
+    for (size_t i = 0; i < ht->capacity; i++) {
+        if (ht->entries[i].key) bytes += strlen(ht->entries[i].key) + 1;
+    }
+    return bytes;
+}
+static ProbeStats hop_probes_op(void *t) {
+    HopHashTable *ht = t;
+    ProbeStats st = {0, 0};
+    size_t count = 0;
+    for (size_t i = 0; i < ht->capacity; i++) {
+        if (!ht->entries[i].key) continue;
+        size_t home = ht->entries[i].hash % ht->capacity;
+        probe_add(&st, &count, (i + ht->capacity - home) % ht->capacity);
+    }
+    return probe_done(st, count);
+}
+
+static void* dict_create_op(size_t capacity) { return StrIntDict_create_with_capacity(capacity); }
+static void dict_destroy_op(void *t) { StrIntDict_destroy(t); }
+static void dict_set_op(void *t, const char *key, int value) { StrIntDict_set(t, (char*)key, value); }
+static int dict_get_op(void *t, const char *key, int def) { return StrIntDict_get(t, (char*)key, def); }
+static bool dict_remove_op(void *t, const char *key) { return StrIntDict_remove(t, (char*)key); }
+static size_t dict_capacity_op(void *t) { return StrIntDict_capacity(t); }
+static size_t dict_memory_op(void *t) { return StrIntDict_memory_usage(t); }
+static ProbeStats dict_probes_op(void *t) {
+    StrIntDict *d = t;
+    ProbeStats st = {0, 0};
+    size_t count = 0;
+    for (size_t i = 0; i < d->capacity; i++) {
+        if (d->entries[i].dist) probe_add(&st, &count, (size_t)d->entries[i].dist - 1);
+    }
+    return probe_done(st, count);
+}
+
+static void* swiss_create_op(size_t capacity) { return SwissStrIntDict_create_with_capacity(capacity); }
+static void swiss_destroy_op(void *t) { SwissStrIntDict_destroy(t); }
+static void swiss_set_op(void *t, const char *key, int value) { SwissStrIntDict_set(t, (char*)key, value); }
+static int swiss_get_op(void *t, const char *key, int def) { return SwissStrIntDict_get(t, (char*)key, def); }
+static bool swiss_remove_op(void *t, const char *key) { return SwissStrIntDict_remove(t, (char*)key); }
+static size_t swiss_capacity_op(void *t) { return SwissStrIntDict_capacity(t); }
+static size_t swiss_memory_op(void *t) {
+    SwissStrIntDict *d = t;
+    size_t bytes = sizeof(*d) + d->capacity * (1 + sizeof(SwissStrIntDict_Entry));
+    for (size_t i = 0; i < d->capacity; i++) {
+        if (d->ctrl[i] >= 0) bytes += strlen(d->entries[i].key) + 1;
+    }
+    return bytes;
+}
+// Groups past the home group on the triangular probe sequence
+static ProbeStats swiss_probes_op(void *t) {
+    SwissStrIntDict *d = t;
+    ProbeStats st = {0, 0};
+    size_t count = 0;
+    size_t group_mask = d->capacity / DICT_SWISS_GROUP_WIDTH - 1;
+    for (size_t i = 0; i < d->capacity; i++) {
+        if (d->ctrl[i] < 0) continue;
+        uint32_t h = dict_swiss_mix(dict_hash_str(d->entries[i].key));
+        size_t group = (h >> 7) & group_mask;
+        size_t steps = 0;
+        while (group != i / DICT_SWISS_GROUP_WIDTH && steps <= group_mask)
+            group = (group + ++steps) & group_mask;
+        probe_add(&st, &count, steps);
+    }
+    return probe_done(st, count);
+}
+
+static const TableOps table_ops[] = {
+    {"chain_linked_list", chain_create_op, chain_destroy_op, chain_set_op, chain_get_op, chain_remove_op,
+     chain_capacity_op, chain_memory_op, chain_probes_op},
+    {"open_linear_probe", open_create_op, open_destroy_op, open_set_op, open_get_op, open_remove_op,
+     open_capacity_op, open_memory_op, open_probes_op},
+    {"robin_hood", robin_create_op, robin_destroy_op, robin_set_op, robin_get_op, robin_remove_op,
+     robin_capacity_op, robin_memory_op, robin_probes_op},
+    {"cuckoo_4way", cuckoo_create_op, cuckoo_destroy_op, cuckoo_set_op, cuckoo_get_op, cuckoo_remove_op,
+     cuckoo_capacity_op, cuckoo_memory_op, cuckoo_probes_op},
+    {"hopscotch", hop_create_op, hop_destroy_op, hop_set_op, hop_get_op, hop_remove_op,
+     hop_capacity_op, hop_memory_op, hop_probes_op},
+    {"dict.h StrIntDict", dict_create_op, dict_destroy_op, dict_set_op, dict_get_op, dict_remove_op,
+     dict_capacity_op, dict_memory_op, dict_probes_op},
+    {"dict.h SwissStrIntDict", swiss_create_op, swiss_destroy_op, swiss_set_op, swiss_get_op, swiss_remove_op,
+     swiss_capacity_op, swiss_memory_op, swiss_probes_op},
+};
+
+#define TABLE_OPS_COUNT (sizeof(table_ops) / sizeof(table_ops[0]))
+
+// Loads the records, then replays the op stream, once per trial into timer;
+// returns the median ns per operation. The fixed-size tables get room for
+// every key the stream can insert.
+static double run_workload(const TableOps *ops, const workload *w, bench_timer *timer) {
+    volatile long sink = 0;
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        void *t = ops->create(w->key_count * 2);
+        for (size_t i = 0; i < w->records; i++)
+            ops->set(t, w->keys[i], (int)i);
+        
+        bench_trial_begin(timer);
+        for (size_t i = 0; i < w->op_count; i++) {
+            bench_op_begin(timer, i);
+            const workload_op *op = &w->ops[i];
+            const char *key = w->keys[op->key];
+            switch (op->kind) {
+            case WORKLOAD_OP_READ:
+                sink += ops->get(t, key, -1);
+                break;
+            case WORKLOAD_OP_UPDATE:
+            case WORKLOAD_OP_INSERT:
+                ops->set(t, key, (int)i);
+                break;
+            case WORKLOAD_OP_REMOVE:
+                sink += ops->remove(t, key);
+                break;
+            case WORKLOAD_OP_SCAN:
+                for (size_t j = 0; j < op->count; j++)
+                    sink += ops->get(t, w->keys[(op->key + j) % w->key_count], -1);
+                break;
+            case WORKLOAD_OP_RMW:
+                ops->set(t, key, ops->get(t, key, 0) + 1);
+                break;
+            }
+            bench_op_end(timer);
+        }
+        bench_trial_end(timer, w->op_count);
+        
+        ops->destroy(t);
+    }
+    perf_counters_stop(&perf);
+    return bench_timer_stats(timer).median;
+}
+
+static void print_workload_header(const char *first) {
+    printf("| %-28s |", first);
+    for (size_t i = 0; i < TABLE_OPS_COUNT; i++) printf(" %s |", table_ops[i].name);
+    printf("\n|%s|", "------------------------------");
+    for (size_t i = 0; i < TABLE_OPS_COUNT; i++) printf("%s:|", "-------------------");
+    printf("\n");
+}
+
+static void print_workload_row(const char *label, const workload_spec *spec, workload_key_len len, uint64_t seed) {
+    workload *w = workload_create(spec, WORKLOAD_RECORDS, WORKLOAD_OPS, len, seed);
+    if (!w) return;
+    printf("| %-28s |", label);
+    for (size_t i = 0; i < TABLE_OPS_COUNT; i++) {
+        bench_timer t;
+        bench_timer_init(&t);
+        printf(" %.2f |", run_workload(&table_ops[i], w, &t));
+        char row[48];
+        snprintf(row, sizeof(row), "%.16s / %s", label, table_ops[i].name);
+        bench_report_row(row, &t);
+        perf_counters_row(&perf, row, (double)w->op_count * bench_cfg.trials);
+    }
+    printf("\n");
+    workload_destroy(w);
+}
+
+void bench_workloads(void) {
+    const workload_key_len len16 = {WORKLOAD_LEN_FIXED, 16, 16, 0};
+    char label[64];
+    
+    printf("\n## YCSB-Style Workloads (%d records, %d interleaved ops, 16-byte keys)\n\n",
+           WORKLOAD_RECORDS, WORKLOAD_OPS);
+    print_workload_header("Workload");
+    for (size_t i = 0; i < WORKLOAD_YCSB_COUNT; i++) {
+        const workload_spec *spec = &workload_ycsb[i];
+        snprintf(label, sizeof(label), "%s (%d/%d/%d/%d/%d/%d, %s)", spec->name,
+                 spec->read_pct, spec->update_pct, spec->insert_pct,
+                 spec->remove_pct, spec->scan_pct, spec->rmw_pct,
+                 spec->dist == WORKLOAD_LATEST ? "latest" : "zipf");
+        print_workload_row(label, spec, len16, 42 + i);
+    }
+    printf("\n*Median ns per operation over %d trials; mix is read/update/insert/remove/scan/rmw %%, scans read "
+           "1-10 consecutive keys*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Workload: YCSB");
+    perf_counters_print(&perf, stdout, "YCSB-Style Workloads");
+    
+    printf("\n## Key Popularity (read 90%% / update 5%% / remove 5%%, 16-byte keys)\n\n");
+    print_workload_header("Distribution");
+    const workload_spec churn[] = {
+        {"uniform", 90, 5, 0, 5, 0, 0, WORKLOAD_UNIFORM, 0, 0, 0, 0},
+        {"zipfian 0.99", 90, 5, 0, 5, 0, 0, WORKLOAD_ZIPFIAN, 0.99, 0, 0, 0},
+        {"zipfian 0.5", 90, 5, 0, 5, 0, 0, WORKLOAD_ZIPFIAN, 0.5, 0, 0, 0},
+        {"hotspot 1% keys / 90% ops", 90, 5, 0, 5, 0, 0, WORKLOAD_HOTSPOT, 0, 0.01, 0.90, 0},
+    };
+    for (size_t i = 0; i < sizeof(churn) / sizeof(churn[0]); i++)
+        print_workload_row(churn[i].name, &churn[i], len16, 7 + i);
+    printf("\n*Median ns per operation over %d trials*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Workload: Key Popularity");
+    perf_counters_print(&perf, stdout, "Key Popularity");
+    
+    printf("\n## Key Length Distribution (YCSB B)\n\n");
+    print_workload_header("Key lengths");
+    const workload_key_len lens[] = {
+        {WORKLOAD_LEN_FIXED, 8, 8, 0},
+        {WORKLOAD_LEN_FIXED, 64, 64, 0},
+        {WORKLOAD_LEN_UNIFORM, 8, 64, 0},
+        {WORKLOAD_LEN_BIMODAL, 12, 200, 10},
+    };
+    const char *len_names[] = {"fixed 8", "fixed 64", "uniform 8-64", "bimodal 12 / 10% 200"};
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++)
+        print_workload_row(len_names[i], &workload_ycsb[1], lens[i], 99 + i);
+    printf("\n*Median ns per operation over %d trials*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Workload: Key Length Distribution");
+    perf_counters_print(&perf, stdout, "Key Length Distribution");
+}
+
+// ============================================================================
+// Sweep mode: element count x load factor
+// ============================================================================
+
+static size_t available_bytes(void) {
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    return pages > 0 && page_size > 0 ? (size_t)pages * (size_t)page_size : SIZE_MAX;
+}
+
+// One size / load point: build, random hits and misses once per trial, then
+// the last trial's table stats. The dict.h tables are presized like the
+// fixed-size ones; their own load limit is raised just above the target so
+// they do not grow.
+static void sweep_point(const TableOps *ops, char **keys, char **miss_keys, size_t n,
+                        double load, const uint32_t *queries) {
+    size_t capacity = (size_t)((double)n / load) + 1;
+    bench_timer timers[3];
+    bench_timers_init(timers, 3);
+    void *t = NULL;
+    volatile long sink = 0;
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        if (t) ops->destroy(t);
+        t = ops->create(capacity);
+        if (ops->create == dict_create_op)
+            StrIntDict_set_max_load(t, load + 0.01 < 0.99 ? load + 0.01 : 0.99);
+        
+        bench_trial_begin(&timers[0]);
+        for (size_t i = 0; i < n; i++) {
+            bench_op_begin(&timers[0], i);
+            ops->set(t, keys[i], (int)i);
+            bench_op_end(&timers[0]);
+        }
+        bench_trial_end(&timers[0], n);
+        
+        bench_trial_begin(&timers[1]);
+        for (int i = 0; i < SWEEP_QUERIES; i++) {
+            bench_op_begin(&timers[1], i);
+            sink += ops->get(t, keys[queries[i]], -1);
+            bench_op_end(&timers[1]);
+        }
+        bench_trial_end(&timers[1], SWEEP_QUERIES);
+        
+        bench_trial_begin(&timers[2]);
+        for (int i = 0; i < SWEEP_QUERIES; i++) {
+            bench_op_begin(&timers[2], i);
+            sink += ops->get(t, miss_keys[queries[i]], -1);
+            bench_op_end(&timers[2]);
+        }
+        bench_trial_end(&timers[2], SWEEP_QUERIES);
+    }
+    perf_counters_stop(&perf);
+    char label[48];
+    snprintf(label, sizeof(label), "%zu %.2f %s", n, load, ops->name);
+    perf_counters_row(&perf, label, ((double)n + 2.0 * SWEEP_QUERIES) * bench_cfg.trials);
+    
+    // Straight to BENCH_OUTPUT: a latency table would split the sweep table
+    static const char *phases[3] = {"insert", "get hit", "get miss"};
+    for (int p = 0; p < 3; p++) {
+        char row[96];
+        snprintf(row, sizeof(row), "%s / %s", label, phases[p]);
+        bench_stats s = bench_timer_stats(&timers[p]);
+        bench_emit(row, &s);
+    }
+    
+    ProbeStats st = ops->probes(t);
+    printf("| %10zu | %.2f | %-24s | %6.3f | %8.2f | %8.2f | %8.2f | %6.2f | %5zu | %7.1f |\n",
+           n, load, ops->name, (double)n / ops->capacity(t), bench_timer_stats(&timers[0]).median,
+           bench_timer_stats(&timers[1]).median, bench_timer_stats(&timers[2]).median,
+           st.mean, st.max, (double)ops->memory(t) / n);
+    fflush(stdout);
+    ops->destroy(t);
+}
+
+void run_sweep(size_t max_elements) {
+    const double loads[] = {0.25, 0.50, 0.75, 0.90, 0.95};
+    
+    printf("# Dictionary Size / Load Factor Sweep\n\n");
+    printf("Elements 1K to %zu (x10), %d random lookups per point, 16-byte keys\n\n",
+           max_elements, SWEEP_QUERIES);
+    printf("| %10s | %4s | %-24s | %6s | %8s | %8s | %8s | %6s | %5s | %7s |\n",
+           "Elements", "Load", "Implementation", "Actual", "Insert", "Get Hit", "Get Miss",
+           "PSL", "Max", "B/entry");
+    printf("|-----------:|-----:|--------------------------|-------:|---------:|---------:|---------:|"
+           "-------:|------:|--------:|\n");
+    
+    perf_counters_open(&perf);
+    bench_section("Sweep");
+    uint32_t *queries = malloc(SWEEP_QUERIES * sizeof(uint32_t));
+    uint64_t rng = 0x5DEECE66DULL;
+    for (size_t n = 1000; n <= max_elements; n *= 10) {
+        // Query keys, two key copies in the table, entries at the lowest load
+        size_t need = n * 2 * 48 + (size_t)((double)n / loads[0]) * sizeof(OpenEntry);
+        if (need > available_bytes() / 10 * 8) {
+            printf("| %10zu | | skipped: needs ~%.1f GB | | | | | | | |\n", n, (double)need / 1e9);
+            continue;
+        }
+        char **keys = malloc(n * sizeof(char*));
+        char **miss_keys = malloc(n * sizeof(char*));
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = workload_make_key(i, 16);
+            miss_keys[i] = workload_make_key(n + i, 16);
+        }
+        for (int i = 0; i < SWEEP_QUERIES; i++) queries[i] = (uint32_t)(workload_next(&rng) % n);
+        
+        for (size_t l = 0; l < sizeof(loads) / sizeof(loads[0]); l++) {
+            for (size_t i = 0; i < TABLE_OPS_COUNT; i++)
+                sweep_point(&table_ops[i], keys, miss_keys, n, loads[l], queries);
+        }
+        free_keys(keys, (int)n);
+        free_keys(miss_keys, (int)n);
+    }
+    free(queries);
+    
+    printf("\n*Median ns per operation over %d trials. Actual = size / capacity (Swiss rounds up to a power of two and grows"
+           " past 7/8). PSL = mean probe length of stored keys: extra slots, chain nodes, Swiss groups,"
+           " or 1 for a cuckoo key in its alternate bucket*\n", bench_cfg.trials);
+    perf_counters_print(&perf, stdout, "Size / Load Factor Sweep");
+    perf_counters_close(&perf);
+}
+
+// Usage: benchmark_dict           standard tables
+//        benchmark_dict sweep [max_elements]
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "sweep") == 0) {
+        bench_init(1);  // each sweep point is one long run; BENCH_TRIALS adds more
+        run_sweep(argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 100000000);
+        return 0;
+    }
+    
     srand(42);
+    bench_init(5);
+    perf_counters_open(&perf);
     
     int iterations = ITERATIONS;
     size_t capacity = iterations * 2; // ~50% load factor
@@ -806,7 +1896,9 @@ int main(void) {
     printf("# Dictionary<string, int> Benchmark Results\n\n");
     printf("Operations: Insert, Contains (hit/miss), Get (hit/miss), Remove\n");
     printf("Iterations: %d\n", iterations);
-    printf("Capacity: %zu (load factor ~50%%)\n\n", capacity);
+    printf("Capacity: %zu (load factor ~50%%)\n", capacity);
+    bench_print_config(stdout);
+    printf("\n");
     
     // System info
     printf("## System Info\n");
@@ -832,7 +1924,7 @@ int main(void) {
     
     BenchmarkResult r;
     
-    r = bench_chain(capacity, iterations);
+    r = bench_chain("chain_linked_list", capacity, iterations);
     print_result(&r);
     
     r = bench_open(capacity, iterations);
@@ -841,7 +1933,15 @@ int main(void) {
     r = bench_robin(capacity, iterations);
     print_result(&r);
     
-    printf("\n*All times in nanoseconds per operation*\n");
+    r = bench_cuckoo("cuckoo_4way", "Bucketized cuckoo hashing, 4-way buckets", hash_djb2, capacity, iterations);
+    print_result(&r);
+    
+    r = bench_hop("hopscotch", "Hopscotch hashing, 32-slot neighbourhood", hash_djb2, capacity, iterations);
+    print_result(&r);
+    
+    printf("\n*All times in nanoseconds per operation, median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Hash Table Implementation Comparison");
+    perf_counters_print(&perf, stdout, "Hash Table Implementation Comparison");
     
     printf("\n## Hash Function Comparison (using chaining)\n\n");
     printf("| %-25s | %8s | %12s | %13s | %8s | %9s | %8s |\n",
@@ -862,7 +1962,40 @@ int main(void) {
     r = bench_hash_func("hash_murmur3_simple", "Simplified MurmurHash3", hash_murmur3_simple, capacity, iterations);
     print_result(&r);
     
-    printf("\n*All times in nanoseconds per operation*\n");
+    r = bench_hash_func("hash_wyhash", "wyhash (word-at-a-time)", hash_wyhash, capacity, iterations);
+    print_result(&r);
+    
+    printf("\n*All times in nanoseconds per operation, median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Hash Function Comparison (using chaining)");
+    perf_counters_print(&perf, stdout, "Hash Function Comparison (using chaining)");
+    
+    // Bounded-probe tables with every hash function
+    printf("\n## Hash Function Comparison (cuckoo and hopscotch)\n\n");
+    printf("| %-25s | %8s | %12s | %13s | %8s | %9s | %8s |\n",
+           "Table / Hash Function", "Insert", "Contains Hit", "Contains Miss", "Get Hit", "Get Miss", "Remove");
+    printf("|%-27s|%10s|%14s|%15s|%10s|%11s|%10s|\n",
+           "---------------------------", "----------", "--------------", "---------------", 
+           "----------", "-----------", "----------");
+    
+    const struct { const char *name; uint32_t (*fn)(const char*); } hash_funcs[] = {
+        {"djb2", hash_djb2}, {"fnv1a", hash_fnv1a}, {"sdbm", hash_sdbm},
+        {"murmur3", hash_murmur3_simple}, {"wyhash", hash_wyhash},
+    };
+    char label[64];
+    for (size_t i = 0; i < sizeof(hash_funcs) / sizeof(hash_funcs[0]); i++) {
+        snprintf(label, sizeof(label), "cuckoo_4way/%s", hash_funcs[i].name);
+        r = bench_cuckoo(label, "Bucketized cuckoo hashing", hash_funcs[i].fn, capacity, iterations);
+        print_result(&r);
+    }
+    for (size_t i = 0; i < sizeof(hash_funcs) / sizeof(hash_funcs[0]); i++) {
+        snprintf(label, sizeof(label), "hopscotch/%s", hash_funcs[i].name);
+        r = bench_hop(label, "Hopscotch hashing", hash_funcs[i].fn, capacity, iterations);
+        print_result(&r);
+    }
+    
+    printf("\n*All times in nanoseconds per operation, median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Hash Function Comparison (cuckoo and hopscotch)");
+    perf_counters_print(&perf, stdout, "Hash Function Comparison (cuckoo and hopscotch)");
     
     // Different capacity tests
     printf("\n## Load Factor Impact (Chain with DJB2)\n\n");
@@ -878,58 +2011,15 @@ int main(void) {
     const char *load_names[] = {"~10%", "~25%", "~50%", "~75%", "~90%"};
     
     for (int i = 0; i < 5; i++) {
-        char **keys = generate_keys(test_iters);
-        char **miss_keys = generate_random_keys(test_iters);
-        uint64_t start, end;
-        
-        ChainHashTable *ht = chain_create(capacities[i]);
-        
-        start = get_nanos();
-        for (int j = 0; j < test_iters; j++)
-            chain_insert(ht, keys[j], j);
-        end = get_nanos();
-        double insert_ns = (double)(end - start) / test_iters;
-        
-        start = get_nanos();
-        for (int j = 0; j < test_iters; j++)
-            chain_contains(ht, keys[j]);
-        end = get_nanos();
-        double contains_hit_ns = (double)(end - start) / test_iters;
-        
-        start = get_nanos();
-        for (int j = 0; j < test_iters; j++)
-            chain_contains(ht, miss_keys[j]);
-        end = get_nanos();
-        double contains_miss_ns = (double)(end - start) / test_iters;
-        
-        start = get_nanos();
-        for (int j = 0; j < test_iters; j++)
-            chain_get(ht, keys[j], -1);
-        end = get_nanos();
-        double get_hit_ns = (double)(end - start) / test_iters;
-        
-        start = get_nanos();
-        for (int j = 0; j < test_iters; j++)
-            chain_get(ht, miss_keys[j], -1);
-        end = get_nanos();
-        double get_miss_ns = (double)(end - start) / test_iters;
-        
-        start = get_nanos();
-        for (int j = 0; j < test_iters; j++)
-            chain_remove(ht, keys[j]);
-        end = get_nanos();
-        double remove_ns = (double)(end - start) / test_iters;
-        
+        r = bench_chain(load_names[i], capacities[i], test_iters);
         printf("| %-15s | %8.2f | %12.2f | %13.2f | %8.2f | %9.2f | %8.2f |\n",
-               load_names[i], insert_ns, contains_hit_ns, contains_miss_ns,
-               get_hit_ns, get_miss_ns, remove_ns);
-        
-        chain_destroy(ht);
-        free_keys(keys, test_iters);
-        free_keys(miss_keys, test_iters);
+               load_names[i], r.insert_ns, r.contains_hit_ns, r.contains_miss_ns,
+               r.get_hit_ns, r.get_miss_ns, r.remove_ns);
     }
     
-    printf("\n*All times in nanoseconds per operation*\n");
+    printf("\n*All times in nanoseconds per operation, median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Load Factor Impact");
+    perf_counters_print(&perf, stdout, "Load Factor Impact");
     
     // Key length impact
     printf("\n## Key Length Impact (Chain with DJB2, 50%% load)\n\n");
@@ -949,47 +2039,81 @@ int main(void) {
             snprintf(keys[i], key_len + 16, "key_%0*d", key_len - 5, i);
         }
         
-        ChainHashTable *ht = chain_create(test_iters * 2);
-        uint64_t start, end;
-        
-        start = get_nanos();
-        for (int i = 0; i < test_iters; i++)
-            chain_insert(ht, keys[i], i);
-        end = get_nanos();
-        double insert_ns = (double)(end - start) / test_iters;
-        
-        start = get_nanos();
-        for (int i = 0; i < test_iters; i++)
-            chain_contains(ht, keys[i]);
-        end = get_nanos();
-        double contains_ns = (double)(end - start) / test_iters;
+        bench_timer t[3];
+        bench_timers_init(t, 3);
         
-        start = get_nanos();
-        for (int i = 0; i < test_iters; i++)
-            chain_get(ht, keys[i], -1);
-        end = get_nanos();
-        double get_ns = (double)(end - start) / test_iters;
+        perf_counters_start(&perf);
+        for (int trial = 0; trial < bench_cfg.trials; trial++) {
+            ChainHashTable *ht = chain_create(test_iters * 2);
+            
+            bench_trial_begin(&t[0]);
+            for (int i = 0; i < test_iters; i++) {
+                bench_op_begin(&t[0], i);
+                chain_insert(ht, keys[i], i);
+                bench_op_end(&t[0]);
+            }
+            bench_trial_end(&t[0], test_iters);
+            
+            bench_trial_begin(&t[1]);
+            for (int i = 0; i < test_iters; i++) {
+                bench_op_begin(&t[1], i);
+                chain_contains(ht, keys[i]);
+                bench_op_end(&t[1]);
+            }
+            bench_trial_end(&t[1], test_iters);
+            
+            bench_trial_begin(&t[2]);
+            for (int i = 0; i < test_iters; i++) {
+                bench_op_begin(&t[2], i);
+                chain_get(ht, keys[i], -1);
+                bench_op_end(&t[2]);
+            }
+            bench_trial_end(&t[2], test_iters);
+            
+            chain_destroy(ht);
+        }
+        perf_counters_stop(&perf);
+        char label[32];
+        snprintf(label, sizeof(label), "%d chars", key_len);
+        perf_counters_row(&perf, label, 3.0 * test_iters * bench_cfg.trials);
         
-        printf("| %3d chars       | %8.2f | %12.2f | %8.2f |\n",
-               key_len, insert_ns, contains_ns, get_ns);
+        const char *ops[3] = {"insert", "contains hit", "get hit"};
+        for (int p = 0; p < 3; p++) {
+            char row[48];
+            snprintf(row, sizeof(row), "%s / %s", label, ops[p]);
+            bench_report_row(row, &t[p]);
+        }
+        printf("| %3d chars       | %8.2f | %12.2f | %8.2f |\n", key_len, bench_timer_stats(&t[0]).median,
+               bench_timer_stats(&t[1]).median, bench_timer_stats(&t[2]).median);
         
-        chain_destroy(ht);
         for (int i = 0; i < test_iters; i++)
             free(keys[i]);
         free(keys);
     }
     
-    printf("\n*All times in nanoseconds per operation*\n");
+    printf("\n*All times in nanoseconds per operation, median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stdout, "Key Length Impact");
+    perf_counters_print(&perf, stdout, "Key Length Impact");
+    
+    bench_workloads();
     
     printf("\n## Implementation Descriptions\n\n");
     printf("1. **chain_linked_list**: Separate chaining using linked lists. Simple and reliable.\n");
     printf("2. **open_linear_probe**: Open addressing with linear probing. Better cache locality.\n");
     printf("3. **robin_hood**: Robin Hood hashing with backward shift deletion. Lower variance.\n");
+    printf("4. **cuckoo_4way**: Bucketized cuckoo hashing. A key is in one of two 4-slot buckets,\n"
+           "   so lookups read at most 8 slots; inserts evict residents and grow after %d kicks.\n",
+           CUCKOO_MAX_KICKS);
+    printf("5. **hopscotch**: Hopscotch hashing. A key is within %d slots of its home, located\n"
+           "   through the home slot's bitmap; inserts hop free slots back and grow if they cannot.\n",
+           HOP_RANGE);
     printf("\n## Hash Function Descriptions\n\n");
     printf("1. **DJB2**: Dan Bernstein's hash. Simple and fast.\n");
     printf("2. **FNV-1a**: Fowler-Noll-Vo hash. Good distribution.\n");
     printf("3. **SDBM**: From SDBM database. Similar to DJB2.\n");
     printf("4. **MurmurHash3 (simplified)**: Simplified version of MurmurHash3.\n");
+    printf("5. **wyhash**: Multiply-mix hash reading 8/16 bytes per step.\n");
     
+    perf_counters_close(&perf);
     return 0;
 }
@@ -0,0 +1,471 @@
+/*
+ * benchmark_dict_concurrent.c - Multi-threaded contention benchmark
+ *
+ * Compares one global mutex around a DICT_DEFINE table with the striped,
+ * seqlock-read DICT_DEFINE_CONCURRENT table for 1..N threads and several
+ * read/write mixes, then runs a word count over a generated corpus with one
+ * table versus per-thread shards merged in parallel (DICT_DEFINE_SHARDED).
+ *
+ * Usage: benchmark_dict_concurrent [max_threads] [read_pct,read_pct,...]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "../include/dict_concurrent.h"
+#include "../include/bench.h"
+#include "../include/perf_counters.h"
+
+// Keys prefilled before each run; operations pick from twice this range
+#define PREFILL_KEYS 262144
+#define KEY_RANGE (PREFILL_KEYS * 2)
+
+// Wall-clock length of each measurement
+#define RUN_MILLIS 300
+
+#define MAX_THREADS 256
+
+// Generated corpus for the sharded word-count comparison
+#define CORPUS_BYTES (64 << 20)
+#define VOCAB_SIZE 200000
+
+// Hardware counters per row when BENCH_PERF is set (perf_counters.h); the
+// workers are created after perf_counters_open, so their counts are included
+static perf_counters perf;
+
+DICT_DEFINE_INT_INT(IntInt)
+DICT_DEFINE_CONCURRENT_INT_INT(ConcIntInt)
+
+// ============================================================================
+// Tables under test
+// ============================================================================
+
+typedef struct {
+    const char *name;
+    void *(*create)(void);
+    void (*destroy)(void *table);
+    int (*get)(void *table, int key);
+    void (*set)(void *table, int key, int value);
+    void (*remove)(void *table, int key);
+} TableOps;
+
+// One mutex around the single-threaded table (the baseline being replaced)
+typedef struct {
+    pthread_mutex_t lock;
+    IntInt *dict;
+} LockedIntInt;
+
+static void *locked_create(void) {
+    LockedIntInt *t = malloc(sizeof(LockedIntInt));
+    pthread_mutex_init(&t->lock, NULL);
+    t->dict = IntInt_create_with_capacity(KEY_RANGE * 2);
+    return t;
+}
+
+static void locked_destroy(void *table) {
+    LockedIntInt *t = table;
+    IntInt_destroy(t->dict);
+    pthread_mutex_destroy(&t->lock);
+    free(t);
+}
+
+static int locked_get(void *table, int key) {
+    LockedIntInt *t = table;
+    pthread_mutex_lock(&t->lock);
+    int v = IntInt_get(t->dict, key, 0);
+    pthread_mutex_unlock(&t->lock);
+    return v;
+}
+
+static void locked_set(void *table, int key, int value) {
+    LockedIntInt *t = table;
+    pthread_mutex_lock(&t->lock);
+    IntInt_set(t->dict, key, value);
+    pthread_mutex_unlock(&t->lock);
+}
+
+static void locked_remove(void *table, int key) {
+    LockedIntInt *t = table;
+    pthread_mutex_lock(&t->lock);
+    IntInt_remove(t->dict, key);
+    pthread_mutex_unlock(&t->lock);
+}
+
+static void *conc_create(void) {
+    return ConcIntInt_create_with_capacity(KEY_RANGE);
+}
+
+static void conc_destroy(void *table) {
+    ConcIntInt_destroy(table);
+}
+
+static int conc_get(void *table, int key) {
+    return ConcIntInt_get(table, key, 0);
+}
+
+static void conc_set(void *table, int key, int value) {
+    ConcIntInt_set(table, key, value);
+}
+
+static void conc_remove(void *table, int key) {
+    ConcIntInt_remove(table, key);
+}
+
+static const TableOps tables[] = {
+    {"global mutex", locked_create, locked_destroy, locked_get, locked_set, locked_remove},
+    {"striped + seqlock", conc_create, conc_destroy, conc_get, conc_set, conc_remove},
+};
+
+#define NUM_TABLES (sizeof(tables) / sizeof(tables[0]))
+
+// ============================================================================
+// Worker threads
+// ============================================================================
+
+typedef struct {
+    const TableOps *ops;
+    void *table;
+    int read_pct;
+    uint64_t seed;
+    uint64_t ops_done;
+    pthread_barrier_t *start;
+    atomic_int *stop;
+    bench_timer timer;      // sampled op latencies, merged into the row
+} Worker;
+
+static inline uint64_t xorshift64(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    uint64_t rng = w->seed;
+    uint64_t n = 0;
+    volatile int sink = 0;
+    pthread_barrier_wait(w->start);
+    while (!atomic_load_explicit(w->stop, memory_order_relaxed)) {
+        // Check the stop flag every 256 operations
+        for (int i = 0; i < 256; i++) {
+            uint64_t r = xorshift64(&rng);
+            int key = (int)((r >> 16) % KEY_RANGE);
+            bench_op_begin(&w->timer, n + i);
+            if ((int)(r % 100) < w->read_pct) {
+                sink += w->ops->get(w->table, key);
+            } else if (r & 0x100) {
+                w->ops->set(w->table, key, (int)n);
+            } else {
+                w->ops->remove(w->table, key);
+            }
+            bench_op_end(&w->timer);
+        }
+        n += 256;
+    }
+    (void)sink;
+    w->ops_done = n;
+    return NULL;
+}
+
+// One fresh table and set of workers per trial; row gets the wall-clock ns
+// per operation of all threads together and every worker's latency samples,
+// and is reported as label. Returns the median throughput in operations per
+// second.
+static double run_config(const TableOps *ops, int threads, int read_pct, const char *label) {
+    static Worker workers[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    bench_timer row;
+    bench_timer_init(&row);
+    double ops_done = 0;
+
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        void *table = ops->create();
+        for (int i = 0; i < PREFILL_KEYS; i++) ops->set(table, i * 2, i);
+
+        pthread_barrier_t start;
+        atomic_int stop;
+        atomic_init(&stop, 0);
+        pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+
+        for (int t = 0; t < threads; t++) {
+            workers[t] = (Worker){ops, table, read_pct, 0x9E3779B97F4A7C15ULL * (uint64_t)(t + 1) + (uint64_t)trial,
+                                  0, &start, &stop, .timer = {.trial_count = 0}};
+            bench_timer_init(&workers[t].timer);
+            pthread_create(&tids[t], NULL, worker_main, &workers[t]);
+        }
+
+        perf_counters_start(&perf);
+        pthread_barrier_wait(&start);
+        bench_trial_begin(&row);
+        struct timespec run = {RUN_MILLIS / 1000, (RUN_MILLIS % 1000) * 1000000L};
+        nanosleep(&run, NULL);
+        atomic_store(&stop, 1);
+
+        uint64_t total = 0;
+        for (int t = 0; t < threads; t++) {
+            pthread_join(tids[t], NULL);
+            total += workers[t].ops_done;
+        }
+        bench_trial_end(&row, total);
+        perf_counters_stop(&perf);
+        ops_done += (double)total;
+        for (int t = 0; t < threads; t++) bench_hist_merge(&row.hist, &workers[t].timer.hist);
+
+        pthread_barrier_destroy(&start);
+        ops->destroy(table);
+    }
+    bench_report_row(label, &row);
+    perf_counters_row(&perf, label, ops_done);
+    double median = bench_timer_stats(&row).median;
+    return median > 0 ? 1e9 / median : 0;
+}
+
+// ============================================================================
+// Word count: single table vs per-thread shards + parallel merge
+// ============================================================================
+
+// DJB2 values of short lowercase words fall into narrow ranges and form long
+// Robin Hood clusters under hash % capacity, so spread them before use
+static inline uint32_t word_hash(const char *word) {
+    return dict_swiss_mix(dict_hash_str(word));
+}
+
+DICT_DEFINE(WordDict, char*, int, word_hash, dict_eq_str, dict_copy_str, dict_free_str)
+DICT_DEFINE_SHARDED(WordShards, WordDict)
+
+// Skewed draw over the vocabulary: a few words dominate, like real logs
+static char *generate_corpus(size_t bytes, size_t *words_out) {
+    char (*vocab)[16] = malloc((size_t)VOCAB_SIZE * sizeof(*vocab));
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    for (int i = 0; i < VOCAB_SIZE; i++) {
+        int len = 2 + (int)(xorshift64(&rng) % 11);
+        for (int c = 0; c < len; c++) vocab[i][c] = (char)('a' + xorshift64(&rng) % 26);
+        vocab[i][len] = '\0';
+    }
+
+    char *corpus = malloc(bytes + 16);
+    size_t pos = 0, words = 0;
+    while (pos + 16 < bytes) {
+        double x = (double)(xorshift64(&rng) >> 11) / (double)(1ULL << 53);
+        const char *w = vocab[(size_t)(x * x * x * VOCAB_SIZE)];
+        size_t len = strlen(w);
+        memcpy(corpus + pos, w, len);
+        pos += len;
+        corpus[pos++] = (words % 16 == 15) ? '\n' : ' ';
+        words++;
+    }
+    corpus[pos] = '\0';
+    free(vocab);
+    *words_out = words;
+    return corpus;
+}
+
+typedef struct {
+    WordShards *shards;
+    size_t tid;
+    char *begin;
+    char *end;
+    bench_timer timer;      // sampled update latencies, merged into the row
+} CountTask;
+
+static inline bool is_sep(char c) {
+    return c == ' ' || c == '\n';
+}
+
+static void *count_words(void *arg) {
+    CountTask *task = arg;
+    char *p = task->begin;
+    size_t n = 0;
+    while (p < task->end) {
+        while (p < task->end && is_sep(*p)) p++;
+        char *word = p;
+        while (p < task->end && !is_sep(*p)) p++;
+        if (p == word) break;
+        *p++ = '\0';
+        bench_op_begin(&task->timer, n++);
+        WordShards_update(task->shards, task->tid, word, 1);
+        bench_op_end(&task->timer);
+    }
+    return NULL;
+}
+
+static void bench_word_count(int max_threads) {
+    size_t words;
+    char *corpus = generate_corpus(CORPUS_BYTES, &words);
+    size_t len = strlen(corpus);
+    char *buf = malloc(len + 1);
+
+    printf("## Word Count (%d MB corpus, %zu words, %d-word vocabulary)\n\n",
+           CORPUS_BYTES >> 20, words, VOCAB_SIZE);
+    printf("| Method | Threads | Count (ms) | Merge (ms) | Total (ms) | Mwords/s | Speedup |\n");
+    printf("|--------|--------:|-----------:|-----------:|-----------:|---------:|--------:|\n");
+
+    // Baseline: the dict_example.c approach (strtok + get + set)
+    bench_timer base;
+    bench_timer_init(&base);
+    size_t distinct = 0;
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        memcpy(buf, corpus, len + 1);
+        size_t i = 0;
+        perf_counters_start(&perf);
+        bench_trial_begin(&base);
+        WordDict *single = WordDict_create();
+        for (char *tok = strtok(buf, " \n"); tok; tok = strtok(NULL, " \n"), i++) {
+            bench_op_begin(&base, i);
+            WordDict_set(single, tok, WordDict_get(single, tok, 0) + 1);
+            bench_op_end(&base);
+        }
+        bench_trial_end(&base, words);
+        perf_counters_stop(&perf);
+        distinct = WordDict_size(single);
+        WordDict_destroy(single);
+    }
+    double base_ms = bench_timer_stats(&base).median * (double)words / 1e6;
+    bench_report_row("strtok + get + set / 1 thread", &base);
+    perf_counters_row(&perf, "strtok + get + set / 1 thread", (double)words * bench_cfg.trials);
+    printf("| strtok + get + set | 1 | %.1f | - | %.1f | %.2f | 1.00x |\n",
+           base_ms, base_ms, (double)words / base_ms / 1e3);
+
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        static CountTask tasks[MAX_THREADS];
+        pthread_t tids[MAX_THREADS];
+        bench_timer count, merge;
+        bench_timer_init(&count);
+        bench_timer_init(&merge);
+
+        for (int trial = 0; trial < bench_cfg.trials; trial++) {
+            memcpy(buf, corpus, len + 1);
+            WordShards *shards = WordShards_create((size_t)threads, dict_combine_sum_int);
+
+            // Split at separators so no word straddles two threads
+            char *p = buf;
+            for (int t = 0; t < threads; t++) {
+                char *end = t == threads - 1 ? buf + len : buf + len * (size_t)(t + 1) / (size_t)threads;
+                while (end < buf + len && !is_sep(*end)) end++;
+                tasks[t] = (CountTask){shards, (size_t)t, p, end, .timer = {.trial_count = 0}};
+                bench_timer_init(&tasks[t].timer);
+                p = end;
+            }
+
+            perf_counters_start(&perf);
+            bench_trial_begin(&count);
+            for (int t = 0; t < threads; t++) pthread_create(&tids[t], NULL, count_words, &tasks[t]);
+            for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+            bench_trial_end(&count, words);
+            for (int t = 0; t < threads; t++) bench_hist_merge(&count.hist, &tasks[t].timer.hist);
+
+            bench_trial_begin(&merge);
+            bench_op_begin(&merge, 0);
+            WordShards_merge(shards, (size_t)threads);
+            bench_op_end(&merge);
+            bench_trial_end(&merge, 1);
+            perf_counters_stop(&perf);
+
+            if (WordShards_size(shards) != distinct)
+                fprintf(stderr, "word count mismatch: %zu vs %zu distinct\n", WordShards_size(shards), distinct);
+            WordShards_destroy(shards);
+        }
+
+        char label[48];
+        snprintf(label, sizeof(label), "sharded count / %d thread%s", threads, threads > 1 ? "s" : "");
+        bench_report_row(label, &count);
+        snprintf(label, sizeof(label), "sharded merge / %d thread%s", threads, threads > 1 ? "s" : "");
+        bench_report_row(label, &merge);
+        // Count and merge alternate in every trial, so they share a counter row per word
+        snprintf(label, sizeof(label), "sharded count + merge / %d thread%s", threads, threads > 1 ? "s" : "");
+        perf_counters_row(&perf, label, (double)words * bench_cfg.trials);
+
+        double count_ms = bench_timer_stats(&count).median * (double)words / 1e6;
+        double merge_ms = bench_timer_stats(&merge).median / 1e6;
+        double total_ms = count_ms + merge_ms;
+        printf("| sharded + merge | %d | %.1f | %.1f | %.1f | %.2f | %.2fx |\n",
+               threads, count_ms, merge_ms, total_ms, (double)words / total_ms / 1e3, base_ms / total_ms);
+        fflush(stdout);
+        if (threads == max_threads) break;
+    }
+
+    printf("\n*Median of %d trials; speedup is relative to the single-threaded strtok baseline*\n",
+           bench_cfg.trials);
+    bench_report_print(stdout, "Word Count");
+    perf_counters_print(&perf, stdout, "Word Count");
+    free(buf);
+    free(corpus);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char *argv[]) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cpus > 4 ? (int)cpus : 4;
+    int read_pcts[16] = {100, 95, 50};
+    int num_ratios = 3;
+
+    if (argc > 1) max_threads = atoi(argv[1]);
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+    if (argc > 2) {
+        num_ratios = 0;
+        for (char *tok = strtok(argv[2], ","); tok && num_ratios < 16; tok = strtok(NULL, ",")) {
+            int pct = atoi(tok);
+            read_pcts[num_ratios++] = pct < 0 ? 0 : pct > 100 ? 100 : pct;
+        }
+    }
+
+    bench_init(3);
+    bench_unpin();  // every section runs threads across all CPUs
+    perf_counters_open(&perf);
+
+    printf("# Concurrent Dict Benchmark Results\n\n");
+    printf("**Online CPUs:** %ld\n", cpus);
+    printf("**Keys:** %d prefilled, %d key range\n", PREFILL_KEYS, KEY_RANGE);
+    printf("**Segments:** %d\n", DICT_CONCURRENT_SEGMENTS);
+    printf("**Run length:** %d ms per configuration and trial\n", RUN_MILLIS);
+    printf("**Trials:** %d (median reported)\n\n", bench_cfg.trials);
+
+    for (int r = 0; r < num_ratios; r++) {
+        printf("## %d%% reads / %d%% writes\n\n", read_pcts[r], 100 - read_pcts[r]);
+        printf("| Threads |");
+        for (size_t t = 0; t < NUM_TABLES; t++) printf(" %s (Mops/s) |", tables[t].name);
+        printf(" Speedup |\n");
+        printf("|--------:|");
+        for (size_t t = 0; t < NUM_TABLES; t++) printf("------:|");
+        printf("--------:|\n");
+
+        // 1, 2, 4, ... and finally max_threads itself
+        for (int threads = 1; ; threads *= 2) {
+            if (threads > max_threads) threads = max_threads;
+            double mops[NUM_TABLES];
+            printf("| %d |", threads);
+            for (size_t t = 0; t < NUM_TABLES; t++) {
+                char label[48];
+                snprintf(label, sizeof(label), "%s / %d thread%s", tables[t].name, threads, threads > 1 ? "s" : "");
+                mops[t] = run_config(&tables[t], threads, read_pcts[r], label) / 1e6;
+                printf(" %.2f |", mops[t]);
+            }
+            printf(" %.2fx |\n", mops[NUM_TABLES - 1] / mops[0]);
+            fflush(stdout);
+            if (threads == max_threads) break;
+        }
+        static char title[48];  // BENCH_OUTPUT keeps the section pointer
+        snprintf(title, sizeof(title), "Contention: %d%% reads", read_pcts[r]);
+        bench_report_print(stdout, title);
+        perf_counters_print(&perf, stdout, title);
+        printf("\n");
+    }
+
+    printf("*Writes are split evenly between set and remove; speedup is striped vs global mutex*\n\n");
+
+    bench_word_count(max_threads);
+    perf_counters_close(&perf);
+    return 0;
+}
@@ -10,11 +10,64 @@
 #include <string.h>
 #include <time.h>
 #include <stdint.h>
+#include <unistd.h>
+#include <malloc.h>
+
 #include "../include/dict.h"
+#include "../include/bench.h"
+#include "../include/perf_counters.h"
 
 #define ITERATIONS 100000
 #define WARMUP 10000
 
+// Capacity used for the Robin Hood vs Swiss load comparison (power of two)
+#define LOAD_CAPACITY 131072
+
+// Per-table max load for Robin Hood tables filled past DICT_LOAD_FACTOR
+// (87.5% in the load comparison, 85% in the iteration comparison)
+#define HIGH_MAX_LOAD 0.9
+
+// Key count for the strdup vs arena key storage comparison
+#define ARENA_KEYS 1000000
+
+// Key count for the insert latency comparison (table grows from the default)
+#define LATENCY_KEYS 4000000
+
+// Upper bound on the entry array used by the batched vs scalar comparison
+#define BATCH_MAX_TABLE_BYTES ((size_t)1 << 30)
+
+// Snapshot load comparison: table size and random lookups after loading
+#define SNAPSHOT_KEYS 8000000
+#define SNAPSHOT_QUERIES 1000000
+
+// Key count for the char* vs inline small-string key comparison
+#define SSO_KEYS 1000000
+
+// Update-heavy comparison: counter updates spread over a fixed key set
+#define UPSERT_KEYS 100000
+#define UPSERT_UPDATES 4000000
+
+// Iteration comparison: table capacity and passes per measurement
+#define ITER_CAPACITY (1 << 20)
+#define ITER_PASSES 10
+
+// Large-table comparison of 4 KB vs 2 MB pages (table is ~2x keys entries)
+#define HUGE_KEYS 16000000
+#define HUGE_QUERIES 4000000
+
+// Set comparison: IDs drawn (with repeats) from a range, and the two sets intersected
+#define SET_IDS 4000000
+#define SET_RANGE 2000000
+#define SET_SMALL 500000
+
+// Bulk construction comparison: integer and string row counts
+#define BUILD_KEYS 16000000
+#define BUILD_STR_KEYS 2000000
+
+// Entry layout comparison: keys per type and table capacity (just under 75% load)
+#define LAYOUT_KEYS 1000000
+#define LAYOUT_CAPACITY ((LAYOUT_KEYS + 2) / 3 * 4)
+
 // ============================================================================
 // Define all dictionary types for benchmarking
 // ============================================================================
@@ -26,17 +79,134 @@ DICT_DEFINE_INT_INT(IntInt)
 DICT_DEFINE_INT_DOUBLE(IntDouble)
 DICT_DEFINE_INT_PTR(IntPtr)
 DICT_DEFINE_UINT32_INT(U32Int)
-DICT_DEFINE_UINT64_INT(U64Int)
+DICT_DEFINE_SNAPSHOT(U64Int, uint64_t, int, dict_hash_uint64, dict_eq_uint64)
 DICT_DEFINE_PTR_INT(PtrInt)
+DICT_DEFINE_STRLEN_INT(StrLenInt)
+DICT_DEFINE_SSO_INT(SsoInt)
+DICT_DEFINE_ARENA_STR_INT(ArenaStrInt)
+DICT_DEFINE_SWISS_STR_INT(SwissStrInt)
+DICT_DEFINE_SWISS_INT_INT(SwissIntInt)
+DICT_DEFINE_STATIC(StaticStrInt, int)
+DICT_DEFINE_ORDERED_INT_INT(OrderedIntInt)
+DICT_DEFINE_SET_UINT64(U64Set)
+
+// Packed meta word and split array layouts of the per-type dicts above
+DICT_DEFINE_PACKED_STR_INT(PackedStrInt)
+DICT_DEFINE_SPLIT_STR_INT(SplitStrInt)
+DICT_DEFINE_LAYOUT(PackedStrDouble, PACKED, char*, double, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+DICT_DEFINE_LAYOUT(SplitStrDouble, SPLIT, char*, double, dict_hash_str, dict_eq_str, dict_copy_str, dict_free_str)
+DICT_DEFINE_PACKED_INT_INT(PackedIntInt)
+DICT_DEFINE_SPLIT_INT_INT(SplitIntInt)
+DICT_DEFINE_LAYOUT(PackedIntDouble, PACKED, int, double, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+DICT_DEFINE_LAYOUT(SplitIntDouble, SPLIT, int, double, dict_hash_int, dict_eq_int, dict_copy_val, dict_free_val)
+DICT_DEFINE_LAYOUT(PackedU32Int, PACKED, uint32_t, int, dict_hash_uint32, dict_eq_uint32, dict_copy_val, dict_free_val)
+DICT_DEFINE_LAYOUT(SplitU32Int, SPLIT, uint32_t, int, dict_hash_uint32, dict_eq_uint32, dict_copy_val, dict_free_val)
+DICT_DEFINE_PACKED_UINT64_INT(PackedU64Int)
+DICT_DEFINE_SPLIT_UINT64_INT(SplitU64Int)
+DICT_DEFINE_LAYOUT(PackedPtrInt, PACKED, void*, int, dict_hash_ptr, dict_eq_ptr, dict_copy_val, dict_free_val)
+DICT_DEFINE_LAYOUT(SplitPtrInt, SPLIT, void*, int, dict_hash_ptr, dict_eq_ptr, dict_copy_val, dict_free_val)
 
 // ============================================================================
 // Timing
 // ============================================================================
 
-static inline uint64_t get_nanos(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+// Hardware counters per row when BENCH_PERF is set (perf_counters.h)
+static perf_counters perf;
+
+// Ops counted by the TIMED_ macros since the last perf row
+static double perf_ops;
+
+// Closes the hardware counter row for every timed trial since the last one
+static void perf_row(const char *label) {
+    perf_counters_row(&perf, label, perf_ops);
+    perf_ops = 0;
+}
+
+// Timed loops over bench_timer (bench.h). TIMED_TRIAL runs one trial of N ops
+// with the op index in size_t i; TIMED_BATCH_TRIAL steps i by BATCH with the
+// batch length in m and reports ns per key; TIMED_CALL times its body as one
+// op spread over N keys, for bulk calls and whole builds. Each trial also
+// runs under the hardware counters and adds its N ops to perf_ops.
+#define TIMED_TRIAL(T, N, ...) do { \
+    perf_counters_start(&perf); \
+    bench_trial_begin(T); \
+    for (size_t i = 0; i < (size_t)(N); i++) { \
+        bench_op_begin(T, i); \
+        __VA_ARGS__; \
+        bench_op_end(T); \
+    } \
+    bench_trial_end(T, (size_t)(N)); \
+    perf_counters_stop(&perf); \
+    perf_ops += (double)(N); \
+} while (0)
+
+#define TIMED_BATCH_TRIAL(T, N, BATCH, ...) do { \
+    perf_counters_start(&perf); \
+    bench_trial_begin(T); \
+    for (size_t i = 0, op_ = 0; i < (size_t)(N); i += (BATCH), op_++) { \
+        size_t m = (size_t)(N) - i < (size_t)(BATCH) ? (size_t)(N) - i : (size_t)(BATCH); \
+        bench_op_begin(T, op_); \
+        __VA_ARGS__; \
+        bench_op_end(T); \
+    } \
+    bench_trial_end(T, (size_t)(N)); \
+    perf_counters_stop(&perf); \
+    perf_ops += (double)(N); \
+} while (0)
+
+#define TIMED_CALL(T, N, ...) do { \
+    perf_counters_start(&perf); \
+    bench_trial_begin(T); \
+    bench_op_begin(T, 0); \
+    __VA_ARGS__; \
+    bench_op_end(T); \
+    bench_trial_end(T, (size_t)(N)); \
+    perf_counters_stop(&perf); \
+    perf_ops += (double)(N); \
+} while (0)
+
+// ============================================================================
+// Memory
+// ============================================================================
+
+// Bytes currently handed out by malloc (including per-block overhead)
+static size_t heap_in_use(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+// Return freed heap pages to the OS so RSS deltas start from a clean baseline
+static void trim_heap(void) {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
+
+// Anonymous memory currently backed by transparent huge pages
+static size_t anon_huge_bytes(void) {
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f) return 0;
+    char line[256];
+    unsigned long kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "AnonHugePages: %lu kB", &kb) == 1) break;
+    }
+    fclose(f);
+    return (size_t)kb * 1024;
+}
+
+// Resident set size of the process
+static size_t rss_bytes(void) {
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long pages = 0, resident = 0;
+    if (fscanf(f, "%lu %lu", &pages, &resident) != 2) resident = 0;
+    fclose(f);
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
 }
 
 // ============================================================================
@@ -45,6 +215,7 @@ static inline uint64_t get_nanos(void) {
 
 void bench_str_int(void) {
     fprintf(stderr, "### Dict<string, int>\n\n");
+    bench_section("Dict<string, int>");
     
     char **keys = malloc(ITERATIONS * sizeof(char*));
     for (int i = 0; i < ITERATIONS; i++) {
@@ -60,58 +231,72 @@ void bench_str_int(void) {
     }
     StrInt_clear(dict);
     
-    // Insert
-    uint64_t start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        StrInt_set(dict, keys[i], i);
-    }
-    uint64_t end = get_nanos();
-    double insert_ns = (double)(end - start) / ITERATIONS;
-    
-    // Get (hit)
-    start = get_nanos();
+    bench_timer t[5];
+    bench_timers_init(t, 5);
     volatile int sum = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        sum += StrInt_get(dict, keys[i], 0);
-    }
-    end = get_nanos();
-    double get_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (hit)
-    start = get_nanos();
     volatile int found = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        if (StrInt_contains(dict, keys[i])) found++;
-    }
-    end = get_nanos();
-    double contains_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (miss)
     char miss_key[32];
-    start = get_nanos();
-    found = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        snprintf(miss_key, 32, "miss_%d", i);
-        if (StrInt_contains(dict, miss_key)) found++;
-    }
-    end = get_nanos();
-    double contains_miss_ns = (double)(end - start) / ITERATIONS;
     
-    // Remove
-    start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        StrInt_remove(dict, keys[i]);
-    }
-    end = get_nanos();
-    double remove_ns = (double)(end - start) / ITERATIONS;
-    
-    fprintf(stderr, "| Operation | Time (ns) |\n");
-    fprintf(stderr, "|-----------|----------:|\n");
-    fprintf(stderr, "| Insert | %.2f |\n", insert_ns);
-    fprintf(stderr, "| Get (hit) | %.2f |\n", get_hit_ns);
-    fprintf(stderr, "| Contains (hit) | %.2f |\n", contains_hit_ns);
-    fprintf(stderr, "| Contains (miss) | %.2f |\n", contains_miss_ns);
-    fprintf(stderr, "| Remove | %.2f |\n", remove_ns);
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert
+        bench_trial_begin(&t[0]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[0], i);
+            StrInt_set(dict, keys[i], i);
+            bench_op_end(&t[0]);
+        }
+        bench_trial_end(&t[0], ITERATIONS);
+        
+        // Get (hit)
+        bench_trial_begin(&t[1]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[1], i);
+            sum += StrInt_get(dict, keys[i], 0);
+            bench_op_end(&t[1]);
+        }
+        bench_trial_end(&t[1], ITERATIONS);
+        
+        // Contains (hit)
+        bench_trial_begin(&t[2]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[2], i);
+            if (StrInt_contains(dict, keys[i])) found++;
+            bench_op_end(&t[2]);
+        }
+        bench_trial_end(&t[2], ITERATIONS);
+        
+        // Contains (miss)
+        found = 0;
+        bench_trial_begin(&t[3]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[3], i);
+            snprintf(miss_key, 32, "miss_%d", i);
+            if (StrInt_contains(dict, miss_key)) found++;
+            bench_op_end(&t[3]);
+        }
+        bench_trial_end(&t[3], ITERATIONS);
+        
+        // Remove
+        bench_trial_begin(&t[4]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[4], i);
+            StrInt_remove(dict, keys[i]);
+            bench_op_end(&t[4]);
+        }
+        bench_trial_end(&t[4], ITERATIONS);
+        
+        StrInt_clear(dict);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Dict<string, int>", 5.0 * ITERATIONS * bench_cfg.trials);
+    
+    bench_stats_header(stderr, "Operation");
+    bench_timer_print_row(stderr, "Insert", &t[0]);
+    bench_timer_print_row(stderr, "Get (hit)", &t[1]);
+    bench_timer_print_row(stderr, "Contains (hit)", &t[2]);
+    bench_timer_print_row(stderr, "Contains (miss)", &t[3]);
+    bench_timer_print_row(stderr, "Remove", &t[4]);
     fprintf(stderr, "\n");
     
     StrInt_destroy(dict);
@@ -125,6 +310,7 @@ void bench_str_int(void) {
 
 void bench_str_double(void) {
     fprintf(stderr, "### Dict<string, double>\n\n");
+    bench_section("Dict<string, double>");
     
     char **keys = malloc(ITERATIONS * sizeof(char*));
     for (int i = 0; i < ITERATIONS; i++) {
@@ -140,37 +326,49 @@ void bench_str_double(void) {
     }
     StrDouble_clear(dict);
     
-    // Insert
-    uint64_t start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        StrDouble_set(dict, keys[i], (double)i * 1.5);
-    }
-    uint64_t end = get_nanos();
-    double insert_ns = (double)(end - start) / ITERATIONS;
-    
-    // Get (hit)
-    start = get_nanos();
+    bench_timer t[3];
+    bench_timers_init(t, 3);
     volatile double sum = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        sum += StrDouble_get(dict, keys[i], 0.0);
-    }
-    end = get_nanos();
-    double get_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (hit)
-    start = get_nanos();
     volatile int found = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        if (StrDouble_contains(dict, keys[i])) found++;
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert
+        bench_trial_begin(&t[0]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[0], i);
+            StrDouble_set(dict, keys[i], (double)i * 1.5);
+            bench_op_end(&t[0]);
+        }
+        bench_trial_end(&t[0], ITERATIONS);
+        
+        // Get (hit)
+        bench_trial_begin(&t[1]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[1], i);
+            sum += StrDouble_get(dict, keys[i], 0.0);
+            bench_op_end(&t[1]);
+        }
+        bench_trial_end(&t[1], ITERATIONS);
+        
+        // Contains (hit)
+        bench_trial_begin(&t[2]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[2], i);
+            if (StrDouble_contains(dict, keys[i])) found++;
+            bench_op_end(&t[2]);
+        }
+        bench_trial_end(&t[2], ITERATIONS);
+        
+        StrDouble_clear(dict);
     }
-    end = get_nanos();
-    double contains_hit_ns = (double)(end - start) / ITERATIONS;
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Dict<string, double>", 3.0 * ITERATIONS * bench_cfg.trials);
     
-    fprintf(stderr, "| Operation | Time (ns) |\n");
-    fprintf(stderr, "|-----------|----------:|\n");
-    fprintf(stderr, "| Insert | %.2f |\n", insert_ns);
-    fprintf(stderr, "| Get (hit) | %.2f |\n", get_hit_ns);
-    fprintf(stderr, "| Contains (hit) | %.2f |\n", contains_hit_ns);
+    bench_stats_header(stderr, "Operation");
+    bench_timer_print_row(stderr, "Insert", &t[0]);
+    bench_timer_print_row(stderr, "Get (hit)", &t[1]);
+    bench_timer_print_row(stderr, "Contains (hit)", &t[2]);
     fprintf(stderr, "\n");
     
     StrDouble_destroy(dict);
@@ -184,6 +382,7 @@ void bench_str_double(void) {
 
 void bench_int_int(void) {
     fprintf(stderr, "### Dict<int, int>\n\n");
+    bench_section("Dict<int, int>");
     
     IntInt *dict = IntInt_create_with_capacity(ITERATIONS * 2);
     
@@ -193,56 +392,70 @@ void bench_int_int(void) {
     }
     IntInt_clear(dict);
     
-    // Insert
-    uint64_t start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        IntInt_set(dict, i, i * i);
-    }
-    uint64_t end = get_nanos();
-    double insert_ns = (double)(end - start) / ITERATIONS;
-    
-    // Get (hit)
-    start = get_nanos();
+    bench_timer t[5];
+    bench_timers_init(t, 5);
     volatile int sum = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        sum += IntInt_get(dict, i, 0);
-    }
-    end = get_nanos();
-    double get_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (hit)
-    start = get_nanos();
     volatile int found = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        if (IntInt_contains(dict, i)) found++;
-    }
-    end = get_nanos();
-    double contains_hit_ns = (double)(end - start) / ITERATIONS;
     
-    // Contains (miss)
-    start = get_nanos();
-    found = 0;
-    for (int i = ITERATIONS; i < ITERATIONS * 2; i++) {
-        if (IntInt_contains(dict, i)) found++;
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert
+        bench_trial_begin(&t[0]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[0], i);
+            IntInt_set(dict, i, i * i);
+            bench_op_end(&t[0]);
+        }
+        bench_trial_end(&t[0], ITERATIONS);
+        
+        // Get (hit)
+        bench_trial_begin(&t[1]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[1], i);
+            sum += IntInt_get(dict, i, 0);
+            bench_op_end(&t[1]);
+        }
+        bench_trial_end(&t[1], ITERATIONS);
+        
+        // Contains (hit)
+        bench_trial_begin(&t[2]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[2], i);
+            if (IntInt_contains(dict, i)) found++;
+            bench_op_end(&t[2]);
+        }
+        bench_trial_end(&t[2], ITERATIONS);
+        
+        // Contains (miss)
+        found = 0;
+        bench_trial_begin(&t[3]);
+        for (int i = ITERATIONS; i < ITERATIONS * 2; i++) {
+            bench_op_begin(&t[3], i);
+            if (IntInt_contains(dict, i)) found++;
+            bench_op_end(&t[3]);
+        }
+        bench_trial_end(&t[3], ITERATIONS);
+        
+        // Remove
+        bench_trial_begin(&t[4]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[4], i);
+            IntInt_remove(dict, i);
+            bench_op_end(&t[4]);
+        }
+        bench_trial_end(&t[4], ITERATIONS);
+        
+        IntInt_clear(dict);
     }
-    end = get_nanos();
-    double contains_miss_ns = (double)(end - start) / ITERATIONS;
-    
-    // Remove
-    start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        IntInt_remove(dict, i);
-    }
-    end = get_nanos();
-    double remove_ns = (double)(end - start) / ITERATIONS;
-    
-    fprintf(stderr, "| Operation | Time (ns) |\n");
-    fprintf(stderr, "|-----------|----------:|\n");
-    fprintf(stderr, "| Insert | %.2f |\n", insert_ns);
-    fprintf(stderr, "| Get (hit) | %.2f |\n", get_hit_ns);
-    fprintf(stderr, "| Contains (hit) | %.2f |\n", contains_hit_ns);
-    fprintf(stderr, "| Contains (miss) | %.2f |\n", contains_miss_ns);
-    fprintf(stderr, "| Remove | %.2f |\n", remove_ns);
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Dict<int, int>", 5.0 * ITERATIONS * bench_cfg.trials);
+    
+    bench_stats_header(stderr, "Operation");
+    bench_timer_print_row(stderr, "Insert", &t[0]);
+    bench_timer_print_row(stderr, "Get (hit)", &t[1]);
+    bench_timer_print_row(stderr, "Contains (hit)", &t[2]);
+    bench_timer_print_row(stderr, "Contains (miss)", &t[3]);
+    bench_timer_print_row(stderr, "Remove", &t[4]);
     fprintf(stderr, "\n");
     
     IntInt_destroy(dict);
@@ -254,6 +467,7 @@ void bench_int_int(void) {
 
 void bench_int_double(void) {
     fprintf(stderr, "### Dict<int, double>\n\n");
+    bench_section("Dict<int, double>");
     
     IntDouble *dict = IntDouble_create_with_capacity(ITERATIONS * 2);
     
@@ -263,37 +477,49 @@ void bench_int_double(void) {
     }
     IntDouble_clear(dict);
     
-    // Insert
-    uint64_t start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        IntDouble_set(dict, i, (double)i * 3.14);
-    }
-    uint64_t end = get_nanos();
-    double insert_ns = (double)(end - start) / ITERATIONS;
-    
-    // Get (hit)
-    start = get_nanos();
+    bench_timer t[3];
+    bench_timers_init(t, 3);
     volatile double sum = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        sum += IntDouble_get(dict, i, 0.0);
-    }
-    end = get_nanos();
-    double get_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (hit)
-    start = get_nanos();
     volatile int found = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        if (IntDouble_contains(dict, i)) found++;
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert
+        bench_trial_begin(&t[0]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[0], i);
+            IntDouble_set(dict, i, (double)i * 3.14);
+            bench_op_end(&t[0]);
+        }
+        bench_trial_end(&t[0], ITERATIONS);
+        
+        // Get (hit)
+        bench_trial_begin(&t[1]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[1], i);
+            sum += IntDouble_get(dict, i, 0.0);
+            bench_op_end(&t[1]);
+        }
+        bench_trial_end(&t[1], ITERATIONS);
+        
+        // Contains (hit)
+        bench_trial_begin(&t[2]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[2], i);
+            if (IntDouble_contains(dict, i)) found++;
+            bench_op_end(&t[2]);
+        }
+        bench_trial_end(&t[2], ITERATIONS);
+        
+        IntDouble_clear(dict);
     }
-    end = get_nanos();
-    double contains_hit_ns = (double)(end - start) / ITERATIONS;
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Dict<int, double>", 3.0 * ITERATIONS * bench_cfg.trials);
     
-    fprintf(stderr, "| Operation | Time (ns) |\n");
-    fprintf(stderr, "|-----------|----------:|\n");
-    fprintf(stderr, "| Insert | %.2f |\n", insert_ns);
-    fprintf(stderr, "| Get (hit) | %.2f |\n", get_hit_ns);
-    fprintf(stderr, "| Contains (hit) | %.2f |\n", contains_hit_ns);
+    bench_stats_header(stderr, "Operation");
+    bench_timer_print_row(stderr, "Insert", &t[0]);
+    bench_timer_print_row(stderr, "Get (hit)", &t[1]);
+    bench_timer_print_row(stderr, "Contains (hit)", &t[2]);
     fprintf(stderr, "\n");
     
     IntDouble_destroy(dict);
@@ -305,6 +531,7 @@ void bench_int_double(void) {
 
 void bench_u32_int(void) {
     fprintf(stderr, "### Dict<uint32_t, int>\n\n");
+    bench_section("Dict<uint32_t, int>");
     
     U32Int *dict = U32Int_create_with_capacity(ITERATIONS * 2);
     
@@ -314,47 +541,60 @@ void bench_u32_int(void) {
     }
     U32Int_clear(dict);
     
-    // Insert
-    uint64_t start = get_nanos();
-    for (uint32_t i = 0; i < ITERATIONS; i++) {
-        U32Int_set(dict, i * 7919, (int)i);
-    }
-    uint64_t end = get_nanos();
-    double insert_ns = (double)(end - start) / ITERATIONS;
-    
-    // Get (hit)
-    start = get_nanos();
+    bench_timer t[4];
+    bench_timers_init(t, 4);
     volatile int sum = 0;
-    for (uint32_t i = 0; i < ITERATIONS; i++) {
-        sum += U32Int_get(dict, i * 7919, 0);
-    }
-    end = get_nanos();
-    double get_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (hit)
-    start = get_nanos();
     volatile int found = 0;
-    for (uint32_t i = 0; i < ITERATIONS; i++) {
-        if (U32Int_contains(dict, i * 7919)) found++;
-    }
-    end = get_nanos();
-    double contains_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (miss)
-    start = get_nanos();
-    found = 0;
-    for (uint32_t i = 0; i < ITERATIONS; i++) {
-        if (U32Int_contains(dict, i * 7919 + 1)) found++;
-    }
-    end = get_nanos();
-    double contains_miss_ns = (double)(end - start) / ITERATIONS;
-    
-    fprintf(stderr, "| Operation | Time (ns) |\n");
-    fprintf(stderr, "|-----------|----------:|\n");
-    fprintf(stderr, "| Insert | %.2f |\n", insert_ns);
-    fprintf(stderr, "| Get (hit) | %.2f |\n", get_hit_ns);
-    fprintf(stderr, "| Contains (hit) | %.2f |\n", contains_hit_ns);
-    fprintf(stderr, "| Contains (miss) | %.2f |\n", contains_miss_ns);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert
+        bench_trial_begin(&t[0]);
+        for (uint32_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[0], i);
+            U32Int_set(dict, i * 7919, (int)i);
+            bench_op_end(&t[0]);
+        }
+        bench_trial_end(&t[0], ITERATIONS);
+        
+        // Get (hit)
+        bench_trial_begin(&t[1]);
+        for (uint32_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[1], i);
+            sum += U32Int_get(dict, i * 7919, 0);
+            bench_op_end(&t[1]);
+        }
+        bench_trial_end(&t[1], ITERATIONS);
+        
+        // Contains (hit)
+        bench_trial_begin(&t[2]);
+        for (uint32_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[2], i);
+            if (U32Int_contains(dict, i * 7919)) found++;
+            bench_op_end(&t[2]);
+        }
+        bench_trial_end(&t[2], ITERATIONS);
+        
+        // Contains (miss)
+        found = 0;
+        bench_trial_begin(&t[3]);
+        for (uint32_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[3], i);
+            if (U32Int_contains(dict, i * 7919 + 1)) found++;
+            bench_op_end(&t[3]);
+        }
+        bench_trial_end(&t[3], ITERATIONS);
+        
+        U32Int_clear(dict);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Dict<uint32_t, int>", 4.0 * ITERATIONS * bench_cfg.trials);
+    
+    bench_stats_header(stderr, "Operation");
+    bench_timer_print_row(stderr, "Insert", &t[0]);
+    bench_timer_print_row(stderr, "Get (hit)", &t[1]);
+    bench_timer_print_row(stderr, "Contains (hit)", &t[2]);
+    bench_timer_print_row(stderr, "Contains (miss)", &t[3]);
     fprintf(stderr, "\n");
     
     U32Int_destroy(dict);
@@ -366,6 +606,7 @@ void bench_u32_int(void) {
 
 void bench_u64_int(void) {
     fprintf(stderr, "### Dict<uint64_t, int>\n\n");
+    bench_section("Dict<uint64_t, int>");
     
     U64Int *dict = U64Int_create_with_capacity(ITERATIONS * 2);
     
@@ -375,47 +616,60 @@ void bench_u64_int(void) {
     }
     U64Int_clear(dict);
     
-    // Insert
-    uint64_t start = get_nanos();
-    for (uint64_t i = 0; i < ITERATIONS; i++) {
-        U64Int_set(dict, i * 1000000007ULL, (int)i);
-    }
-    uint64_t end = get_nanos();
-    double insert_ns = (double)(end - start) / ITERATIONS;
-    
-    // Get (hit)
-    start = get_nanos();
+    bench_timer t[4];
+    bench_timers_init(t, 4);
     volatile int sum = 0;
-    for (uint64_t i = 0; i < ITERATIONS; i++) {
-        sum += U64Int_get(dict, i * 1000000007ULL, 0);
-    }
-    end = get_nanos();
-    double get_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (hit)
-    start = get_nanos();
     volatile int found = 0;
-    for (uint64_t i = 0; i < ITERATIONS; i++) {
-        if (U64Int_contains(dict, i * 1000000007ULL)) found++;
-    }
-    end = get_nanos();
-    double contains_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (miss)
-    start = get_nanos();
-    found = 0;
-    for (uint64_t i = 0; i < ITERATIONS; i++) {
-        if (U64Int_contains(dict, i * 1000000007ULL + 1)) found++;
-    }
-    end = get_nanos();
-    double contains_miss_ns = (double)(end - start) / ITERATIONS;
-    
-    fprintf(stderr, "| Operation | Time (ns) |\n");
-    fprintf(stderr, "|-----------|----------:|\n");
-    fprintf(stderr, "| Insert | %.2f |\n", insert_ns);
-    fprintf(stderr, "| Get (hit) | %.2f |\n", get_hit_ns);
-    fprintf(stderr, "| Contains (hit) | %.2f |\n", contains_hit_ns);
-    fprintf(stderr, "| Contains (miss) | %.2f |\n", contains_miss_ns);
+    
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert
+        bench_trial_begin(&t[0]);
+        for (uint64_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[0], i);
+            U64Int_set(dict, i * 1000000007ULL, (int)i);
+            bench_op_end(&t[0]);
+        }
+        bench_trial_end(&t[0], ITERATIONS);
+        
+        // Get (hit)
+        bench_trial_begin(&t[1]);
+        for (uint64_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[1], i);
+            sum += U64Int_get(dict, i * 1000000007ULL, 0);
+            bench_op_end(&t[1]);
+        }
+        bench_trial_end(&t[1], ITERATIONS);
+        
+        // Contains (hit)
+        bench_trial_begin(&t[2]);
+        for (uint64_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[2], i);
+            if (U64Int_contains(dict, i * 1000000007ULL)) found++;
+            bench_op_end(&t[2]);
+        }
+        bench_trial_end(&t[2], ITERATIONS);
+        
+        // Contains (miss)
+        found = 0;
+        bench_trial_begin(&t[3]);
+        for (uint64_t i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[3], i);
+            if (U64Int_contains(dict, i * 1000000007ULL + 1)) found++;
+            bench_op_end(&t[3]);
+        }
+        bench_trial_end(&t[3], ITERATIONS);
+        
+        U64Int_clear(dict);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Dict<uint64_t, int>", 4.0 * ITERATIONS * bench_cfg.trials);
+    
+    bench_stats_header(stderr, "Operation");
+    bench_timer_print_row(stderr, "Insert", &t[0]);
+    bench_timer_print_row(stderr, "Get (hit)", &t[1]);
+    bench_timer_print_row(stderr, "Contains (hit)", &t[2]);
+    bench_timer_print_row(stderr, "Contains (miss)", &t[3]);
     fprintf(stderr, "\n");
     
     U64Int_destroy(dict);
@@ -427,6 +681,7 @@ void bench_u64_int(void) {
 
 void bench_ptr_int(void) {
     fprintf(stderr, "### Dict<void*, int>\n\n");
+    bench_section("Dict<void*, int>");
     
     // Create array of fake pointers
     void **ptrs = malloc(ITERATIONS * sizeof(void*));
@@ -442,54 +697,1341 @@ void bench_ptr_int(void) {
     }
     PtrInt_clear(dict);
     
-    // Insert
-    uint64_t start = get_nanos();
-    for (int i = 0; i < ITERATIONS; i++) {
-        PtrInt_set(dict, ptrs[i], i);
-    }
-    uint64_t end = get_nanos();
-    double insert_ns = (double)(end - start) / ITERATIONS;
-    
-    // Get (hit)
-    start = get_nanos();
+    bench_timer t[4];
+    bench_timers_init(t, 4);
     volatile int sum = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        sum += PtrInt_get(dict, ptrs[i], 0);
-    }
-    end = get_nanos();
-    double get_hit_ns = (double)(end - start) / ITERATIONS;
-    
-    // Contains (hit)
-    start = get_nanos();
     volatile int found = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        if (PtrInt_contains(dict, ptrs[i])) found++;
-    }
-    end = get_nanos();
-    double contains_hit_ns = (double)(end - start) / ITERATIONS;
     
-    // Contains (miss)
-    start = get_nanos();
-    found = 0;
-    for (int i = 0; i < ITERATIONS; i++) {
-        void *miss = (void*)(uintptr_t)(0x90000000 + i);
-        if (PtrInt_contains(dict, miss)) found++;
-    }
-    end = get_nanos();
-    double contains_miss_ns = (double)(end - start) / ITERATIONS;
-    
-    fprintf(stderr, "| Operation | Time (ns) |\n");
-    fprintf(stderr, "|-----------|----------:|\n");
-    fprintf(stderr, "| Insert | %.2f |\n", insert_ns);
-    fprintf(stderr, "| Get (hit) | %.2f |\n", get_hit_ns);
-    fprintf(stderr, "| Contains (hit) | %.2f |\n", contains_hit_ns);
-    fprintf(stderr, "| Contains (miss) | %.2f |\n", contains_miss_ns);
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Insert
+        bench_trial_begin(&t[0]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[0], i);
+            PtrInt_set(dict, ptrs[i], i);
+            bench_op_end(&t[0]);
+        }
+        bench_trial_end(&t[0], ITERATIONS);
+        
+        // Get (hit)
+        bench_trial_begin(&t[1]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[1], i);
+            sum += PtrInt_get(dict, ptrs[i], 0);
+            bench_op_end(&t[1]);
+        }
+        bench_trial_end(&t[1], ITERATIONS);
+        
+        // Contains (hit)
+        bench_trial_begin(&t[2]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[2], i);
+            if (PtrInt_contains(dict, ptrs[i])) found++;
+            bench_op_end(&t[2]);
+        }
+        bench_trial_end(&t[2], ITERATIONS);
+        
+        // Contains (miss)
+        found = 0;
+        bench_trial_begin(&t[3]);
+        for (int i = 0; i < ITERATIONS; i++) {
+            bench_op_begin(&t[3], i);
+            void *miss = (void*)(uintptr_t)(0x90000000 + i);
+            if (PtrInt_contains(dict, miss)) found++;
+            bench_op_end(&t[3]);
+        }
+        bench_trial_end(&t[3], ITERATIONS);
+        
+        PtrInt_clear(dict);
+    }
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Dict<void*, int>", 4.0 * ITERATIONS * bench_cfg.trials);
+    
+    bench_stats_header(stderr, "Operation");
+    bench_timer_print_row(stderr, "Insert", &t[0]);
+    bench_timer_print_row(stderr, "Get (hit)", &t[1]);
+    bench_timer_print_row(stderr, "Contains (hit)", &t[2]);
+    bench_timer_print_row(stderr, "Contains (miss)", &t[3]);
     fprintf(stderr, "\n");
     
     PtrInt_destroy(dict);
     free(ptrs);
 }
 
+// ============================================================================
+// Benchmark: Robin Hood vs Swiss table at 50% and 87.5% load
+// ============================================================================
+
+typedef struct {
+    double insert;
+    double get_hit;
+    double get_miss;
+} OpResult;
+
+// Adds "label / op" rows to the latency table, one per timer
+static void report_rows(const char *label, const char *const *ops, const bench_timer *t, int count) {
+    for (int k = 0; k < count; k++) {
+        char row[64];  // bench_report_row keeps the first 47 bytes
+        snprintf(row, sizeof(row), "%s / %s", label, ops[k]);
+        bench_report_row(row, &t[k]);
+    }
+}
+
+// Medians into the result; trials and latency samples go to the latency table
+static OpResult op_result(const char *label, const bench_timer t[3]) {
+    static const char *ops[3] = {"insert", "get hit", "get miss"};
+    report_rows(label, ops, t, 3);
+    return (OpResult){bench_timer_stats(&t[0]).median, bench_timer_stats(&t[1]).median,
+                      bench_timer_stats(&t[2]).median};
+}
+
+// Robin Hood tables grow past DICT_LOAD_FACTOR, Swiss tables hold 7/8
+#define LOAD_SETUP_ROBIN(T, d) T##_set_max_load(d, HIGH_MAX_LOAD)
+#define LOAD_SETUP_SWISS(T, d) ((void)(d))
+
+// n inserts into a fresh table, then n hits and n misses, once per trial
+#define LOAD_BENCH(TIMERS, T, SETUP, SET_KEY, HIT_KEY, MISS_KEY) do { \
+    bench_timers_init(TIMERS, 3); \
+    volatile int sum = 0; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        T *d = T##_create_with_capacity(LOAD_CAPACITY); \
+        SETUP(T, d); \
+        perf_counters_start(&perf); \
+        bench_trial_begin(&TIMERS[0]); \
+        for (int i = 0; i < n; i++) { \
+            bench_op_begin(&TIMERS[0], i); \
+            T##_set(d, SET_KEY, i); \
+            bench_op_end(&TIMERS[0]); \
+        } \
+        bench_trial_end(&TIMERS[0], n); \
+        bench_trial_begin(&TIMERS[1]); \
+        for (int i = 0; i < n; i++) { \
+            bench_op_begin(&TIMERS[1], i); \
+            sum += T##_get(d, HIT_KEY, 0); \
+            bench_op_end(&TIMERS[1]); \
+        } \
+        bench_trial_end(&TIMERS[1], n); \
+        bench_trial_begin(&TIMERS[2]); \
+        for (int i = 0; i < n; i++) { \
+            bench_op_begin(&TIMERS[2], i); \
+            sum += T##_get(d, MISS_KEY, 0); \
+            bench_op_end(&TIMERS[2]); \
+        } \
+        bench_trial_end(&TIMERS[2], n); \
+        perf_counters_stop(&perf); \
+        perf_ops += 3.0 * n; \
+        T##_destroy(d); \
+    } \
+} while (0)
+
+static OpResult bench_load_robin_str(const char *label, char **keys, char **miss_keys, int n) {
+    bench_timer t[3];
+    LOAD_BENCH(t, StrInt, LOAD_SETUP_ROBIN, keys[i], keys[i], miss_keys[i]);
+    return op_result(label, t);
+}
+
+static OpResult bench_load_swiss_str(const char *label, char **keys, char **miss_keys, int n) {
+    bench_timer t[3];
+    LOAD_BENCH(t, SwissStrInt, LOAD_SETUP_SWISS, keys[i], keys[i], miss_keys[i]);
+    return op_result(label, t);
+}
+
+static OpResult bench_load_robin_int(const char *label, int n) {
+    bench_timer t[3];
+    LOAD_BENCH(t, IntInt, LOAD_SETUP_ROBIN, i, i * 7919, i * 7919 + 1);
+    return op_result(label, t);
+}
+
+static OpResult bench_load_swiss_int(const char *label, int n) {
+    bench_timer t[3];
+    LOAD_BENCH(t, SwissIntInt, LOAD_SETUP_SWISS, i, i * 7919, i * 7919 + 1);
+    return op_result(label, t);
+}
+
+void bench_swiss_vs_robin(void) {
+    fprintf(stderr, "\n## Robin Hood vs Swiss Table (capacity %d, group width %d)\n\n",
+            LOAD_CAPACITY, DICT_SWISS_GROUP_WIDTH);
+    fprintf(stderr, "| Type | Load | Implementation | Insert | Get (hit) | Get (miss) |\n");
+    fprintf(stderr, "|------|-----:|----------------|-------:|----------:|-----------:|\n");
+    
+    const double loads[] = {0.5, 0.875};
+    int max_n = (int)(LOAD_CAPACITY * 0.875);
+    
+    char **keys = malloc(max_n * sizeof(char*));
+    char **miss_keys = malloc(max_n * sizeof(char*));
+    for (int i = 0; i < max_n; i++) {
+        keys[i] = malloc(32);
+        snprintf(keys[i], 32, "key_%d", i);
+        miss_keys[i] = malloc(32);
+        snprintf(miss_keys[i], 32, "miss_%d", i);
+    }
+    
+    for (int l = 0; l < 2; l++) {
+        int n = (int)(LOAD_CAPACITY * loads[l]);
+        char label[48];
+        snprintf(label, sizeof(label), "string → int %.1f%% Robin Hood", loads[l] * 100);
+        OpResult robin = bench_load_robin_str(label, keys, miss_keys, n);
+        perf_row(label);
+        snprintf(label, sizeof(label), "string → int %.1f%% Swiss", loads[l] * 100);
+        OpResult swiss = bench_load_swiss_str(label, keys, miss_keys, n);
+        perf_row(label);
+        fprintf(stderr, "| string → int | %.1f%% | Robin Hood | %.2f | %.2f | %.2f |\n",
+                loads[l] * 100, robin.insert, robin.get_hit, robin.get_miss);
+        fprintf(stderr, "| string → int | %.1f%% | Swiss | %.2f | %.2f | %.2f |\n",
+                loads[l] * 100, swiss.insert, swiss.get_hit, swiss.get_miss);
+    }
+    for (int l = 0; l < 2; l++) {
+        int n = (int)(LOAD_CAPACITY * loads[l]);
+        char label[48];
+        snprintf(label, sizeof(label), "int → int %.1f%% Robin Hood", loads[l] * 100);
+        OpResult robin = bench_load_robin_int(label, n);
+        perf_row(label);
+        snprintf(label, sizeof(label), "int → int %.1f%% Swiss", loads[l] * 100);
+        OpResult swiss = bench_load_swiss_int(label, n);
+        perf_row(label);
+        fprintf(stderr, "| int → int | %.1f%% | Robin Hood | %.2f | %.2f | %.2f |\n",
+                loads[l] * 100, robin.insert, robin.get_hit, robin.get_miss);
+        fprintf(stderr, "| int → int | %.1f%% | Swiss | %.2f | %.2f | %.2f |\n",
+                loads[l] * 100, swiss.insert, swiss.get_hit, swiss.get_miss);
+    }
+    
+    fprintf(stderr, "\n*All times in nanoseconds per operation, median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Robin Hood vs Swiss Table");
+    perf_counters_print(&perf, stderr, "Robin Hood vs Swiss Table");
+    
+    for (int i = 0; i < max_n; i++) {
+        free(keys[i]);
+        free(miss_keys[i]);
+    }
+    free(keys);
+    free(miss_keys);
+}
+
+// ============================================================================
+// Benchmark: char* keys (DJB2 + strcmp) vs length-carrying keys (wyhash)
+// ============================================================================
+
+void bench_strlen_keys(void) {
+    fprintf(stderr, "\n## String Keys: DJB2 + strcmp vs Length-Carrying wyhash\n\n");
+    fprintf(stderr, "| Key Length | Type | Insert | Get (hit) | Get (miss) |\n");
+    fprintf(stderr, "|-----------:|------|-------:|----------:|-----------:|\n");
+    
+    const int key_lengths[] = {24, 64, 120};
+    
+    for (int k = 0; k < 3; k++) {
+        int key_len = key_lengths[k];
+        char **keys = malloc(ITERATIONS * sizeof(char*));
+        char **miss_keys = malloc(ITERATIONS * sizeof(char*));
+        size_t *lens = malloc(ITERATIONS * sizeof(size_t));
+        for (int i = 0; i < ITERATIONS; i++) {
+            keys[i] = malloc(key_len + 16);
+            snprintf(keys[i], key_len + 16, "tag_%0*d", key_len - 4, i);
+            miss_keys[i] = malloc(key_len + 16);
+            snprintf(miss_keys[i], key_len + 16, "mis_%0*d", key_len - 4, i);
+            lens[i] = strlen(keys[i]);
+        }
+    
+        bench_timer t[2][3];
+        bench_timers_init(t[0], 3);
+        bench_timers_init(t[1], 3);
+        volatile int sum = 0;
+        for (int trial = 0; trial < bench_cfg.trials; trial++) {
+            // char* keys
+            StrInt *d = StrInt_create_with_capacity(ITERATIONS * 2);
+            TIMED_TRIAL(&t[0][0], ITERATIONS, StrInt_set(d, keys[i], (int)i));
+            TIMED_TRIAL(&t[0][1], ITERATIONS, sum += StrInt_get(d, keys[i], 0));
+            TIMED_TRIAL(&t[0][2], ITERATIONS, sum += StrInt_get(d, miss_keys[i], 0));
+            StrInt_destroy(d);
+    
+            // Length-carrying keys: the hash is computed per call from (ptr, len)
+            StrLenInt *ld = StrLenInt_create_with_capacity(ITERATIONS * 2);
+            TIMED_TRIAL(&t[1][0], ITERATIONS, StrLenInt_set(ld, dict_strn(keys[i], lens[i]), (int)i));
+            TIMED_TRIAL(&t[1][1], ITERATIONS, sum += StrLenInt_get(ld, dict_strn(keys[i], lens[i]), 0));
+            TIMED_TRIAL(&t[1][2], ITERATIONS, sum += StrLenInt_get(ld, dict_strn(miss_keys[i], lens[i]), 0));
+            StrLenInt_destroy(ld);
+        }
+    
+        char label[48];
+        snprintf(label, sizeof(label), "%d B char* (DJB2)", key_len);
+        OpResult r = op_result(label, t[0]);
+        fprintf(stderr, "| %d | char* (DJB2) | %.2f | %.2f | %.2f |\n",
+                key_len, r.insert, r.get_hit, r.get_miss);
+        snprintf(label, sizeof(label), "%d B strlen_t (wyhash)", key_len);
+        r = op_result(label, t[1]);
+        fprintf(stderr, "| %d | strlen_t (wyhash) | %.2f | %.2f | %.2f |\n",
+                key_len, r.insert, r.get_hit, r.get_miss);
+        // Both key types run in every trial, so they share one counter row
+        snprintf(label, sizeof(label), "%d B char* + strlen_t", key_len);
+        perf_row(label);
+    
+        for (int i = 0; i < ITERATIONS; i++) {
+            free(keys[i]);
+            free(miss_keys[i]);
+        }
+        free(keys);
+        free(miss_keys);
+        free(lens);
+    }
+    
+    fprintf(stderr, "\n*All times in nanoseconds per operation, median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stderr, "String Keys: DJB2 vs Length-Carrying wyhash");
+    perf_counters_print(&perf, stderr, "String Keys: DJB2 vs Length-Carrying wyhash");
+}
+
+// ============================================================================
+// Benchmark: strdup-owned keys vs arena-owned keys
+// ============================================================================
+
+// Heap and RSS growth are taken after the first trial's inserts; teardown is
+// one timed _destroy per trial
+#define ARENA_ROW(TYPE, LABEL, KEYS) do { \
+    bench_timer t[3]; \
+    bench_timers_init(t, 3); \
+    double heap_mb = 0, rss_mb = 0; \
+    volatile int sum = 0; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        trim_heap(); \
+        size_t heap0 = heap_in_use(), rss0 = rss_bytes(); \
+        TYPE *d = TYPE##_create_with_capacity((size_t)ARENA_KEYS * 2); \
+        TIMED_TRIAL(&t[0], ARENA_KEYS, TYPE##_set(d, (KEYS)[i], (int)i)); \
+        TIMED_TRIAL(&t[1], ARENA_KEYS, sum += TYPE##_get(d, (KEYS)[i], 0)); \
+        if (trial == 0) { \
+            heap_mb = (double)(heap_in_use() - heap0) / (1024 * 1024); \
+            rss_mb = (double)(rss_bytes() - rss0) / (1024 * 1024); \
+        } \
+        TIMED_TRIAL(&t[2], 1, TYPE##_destroy(d)); \
+    } \
+    bench_report_row(LABEL " / insert", &t[0]); \
+    bench_report_row(LABEL " / get hit", &t[1]); \
+    bench_report_row(LABEL " / teardown", &t[2]); \
+    perf_row(LABEL); \
+    fprintf(stderr, "| %s | %.2f | %.2f | %.2f | %.1f | %.1f |\n", LABEL, \
+            bench_timer_stats(&t[0]).median, bench_timer_stats(&t[1]).median, \
+            bench_timer_stats(&t[2]).median / 1000000.0, heap_mb, rss_mb); \
+} while (0)
+
+void bench_arena_keys(void) {
+    fprintf(stderr, "\n## Key Storage: strdup vs Arena (%d string keys)\n\n", ARENA_KEYS);
+    fprintf(stderr, "| Key storage | Insert (ns) | Get hit (ns) | Teardown (ms) | Heap (MB) | RSS (MB) |\n");
+    fprintf(stderr, "|-------------|------------:|-------------:|--------------:|----------:|---------:|\n");
+    
+    char (*keys)[32] = malloc((size_t)ARENA_KEYS * sizeof(*keys));
+    for (int i = 0; i < ARENA_KEYS; i++)
+        snprintf(keys[i], sizeof(keys[i]), "session_%08d", i);
+    
+    ARENA_ROW(StrInt, "strdup", keys);
+    ARENA_ROW(ArenaStrInt, "arena", keys);
+    
+    fprintf(stderr, "\n*Median of %d trials; Heap = bytes in use by malloc after inserting; RSS = resident "
+                    "growth of the process*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Key Storage: strdup vs Arena");
+    perf_counters_print(&perf, stderr, "Key Storage: strdup vs Arena");
+    free(keys);
+}
+
+// ============================================================================
+// Benchmark: insert latency tail, stop-the-world vs incremental resize
+// ============================================================================
+
+// Inserts n keys while overwriting an earlier key after each one, so
+// overwrites land on entries that a resize has just moved to old_entries;
+// returns false if any key ends up counted twice or with a stale value
+static bool check_overwrites(size_t step, int n) {
+    IntInt *d = IntInt_create();
+    IntInt_set_rehash_step(d, step);
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        ok &= IntInt_set(d, i, i);
+        ok &= !IntInt_set(d, i / 2, -(i / 2));
+    }
+    ok &= IntInt_size(d) == (size_t)n;
+    for (int i = 0; i < n; i++) ok &= IntInt_get(d, i, 0) == (i <= (n - 1) / 2 ? -i : i);
+    IntInt_destroy(d);
+    return ok;
+}
+
+void bench_insert_latency(void) {
+    fprintf(stderr, "\n## Insert Latency: Stop-the-World vs Incremental Resize (%d int keys, growing from %d)\n\n",
+            LATENCY_KEYS, DICT_INITIAL_CAPACITY);
+    fprintf(stderr, "| Resize mode | Mean (ns) | p50 (ns) | p99 (ns) | p99.9 (ns) | Max (ns) | Total (ms) |\n");
+    fprintf(stderr, "|-------------|----------:|---------:|---------:|-----------:|---------:|-----------:|\n");
+    
+    size_t modes[] = {0, DICT_REHASH_STEP};
+    const char *names[] = {"stop-the-world", "incremental"};
+    
+    // The resize spikes are what this table shows, so every insert is sampled
+    size_t sample_mask = bench_cfg.sample_mask;
+    bench_cfg.sample_mask = 0;
+    for (int m = 0; m < 2; m++) {
+        bench_timer t;
+        bench_timer_init(&t);
+        for (int trial = 0; trial < bench_cfg.trials; trial++) {
+            IntInt *d = IntInt_create();
+            IntInt_set_rehash_step(d, modes[m]);
+            TIMED_TRIAL(&t, LATENCY_KEYS, IntInt_set(d, (int)i, (int)i));
+            IntInt_destroy(d);
+        }
+        bench_stats s = bench_timer_stats(&t);
+        fprintf(stderr, "| %s | %.1f | %.0f | %.0f | %.0f | %.0f | %.1f |\n",
+                names[m], s.median, s.p50, s.p99, s.p999, s.max, s.median * LATENCY_KEYS / 1000000.0);
+        bench_report_row(names[m], &t);
+        perf_row(names[m]);
+    }
+    bench_cfg.sample_mask = sample_mask;
+    
+    fprintf(stderr, "\n*Mean is the median over %d trials; percentiles are over every insert of all trials; "
+                    "incremental mode moves %d slots per operation*\n", bench_cfg.trials, DICT_REHASH_STEP);
+    bench_report_print(stderr, "Insert Latency: Stop-the-World vs Incremental Resize");
+    perf_counters_print(&perf, stderr, "Insert Latency: Stop-the-World vs Incremental Resize");
+    
+    const size_t check_steps[] = {0, 1, 2, 3, 8, DICT_REHASH_STEP};
+    fprintf(stderr, "\n*Overwrites across resizes (rehash step 0, 1, 2, 3, 8, %d):", DICT_REHASH_STEP);
+    for (int i = 0; i < 6; i++)
+        fprintf(stderr, " %s", check_overwrites(check_steps[i], LATENCY_KEYS / 16) ? "ok" : "FAILED");
+    fprintf(stderr, "*\n");
+}
+
+// ============================================================================
+// Benchmark: batched (prefetching) vs scalar lookups on tables larger than LLC
+// ============================================================================
+
+static size_t llc_bytes(void) {
+    long llc = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+    return llc > 0 ? (size_t)llc : (size_t)32 << 20;
+}
+
+// Shuffled copy of the inserted keys so consecutive lookups hit unrelated lines
+static int *shuffled_int_keys(size_t n) {
+    int *keys = malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) keys[i] = (int)i;
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = n - 1; i > 0; i--) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        size_t j = x % (i + 1);
+        int tmp = keys[i]; keys[i] = keys[j]; keys[j] = tmp;
+    }
+    return keys;
+}
+
+#define BATCH_ROW(TYPE, LABEL, DICT, KEYS, N, BATCH, OUT, VALS) do { \
+    bench_timer t[4]; \
+    bench_timers_init(t, 4); \
+    volatile int sum = 0; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        TIMED_TRIAL(&t[0], N, sum += TYPE##_get(DICT, (KEYS)[i], 0)); \
+        TIMED_BATCH_TRIAL(&t[1], N, BATCH, TYPE##_get_many(DICT, (KEYS) + i, m, (OUT) + i, 0)); \
+        TIMED_TRIAL(&t[2], N, TYPE##_set(DICT, (KEYS)[i], (VALS)[i])); \
+        TIMED_BATCH_TRIAL(&t[3], N, BATCH, TYPE##_set_many(DICT, (KEYS) + i, (VALS) + i, m)); \
+    } \
+    static const char *ops[4] = {"get", "get_many", "set", "set_many"}; \
+    double ns[4]; \
+    char row[48]; \
+    for (int k = 0; k < 4; k++) { \
+        snprintf(row, sizeof(row), "%s batch %zu / %s", LABEL, (size_t)(BATCH), ops[k]); \
+        bench_report_row(row, &t[k]); \
+        ns[k] = bench_timer_stats(&t[k]).median; \
+    } \
+    snprintf(row, sizeof(row), "%s batch %zu", LABEL, (size_t)(BATCH)); \
+    perf_row(row); \
+    fprintf(stderr, "| %s | %zu | %.2f | %.2f | %.2fx | %.2f | %.2f | %.2fx |\n", \
+            LABEL, (size_t)(BATCH), ns[0], ns[1], ns[0] / ns[1], ns[2], ns[3], ns[2] / ns[3]); \
+} while (0)
+
+void bench_batched_lookup(void) {
+    // Entry arrays several times the LLC, capped so the run fits in modest RAM
+    size_t target = llc_bytes() * 4;
+    if (target > BATCH_MAX_TABLE_BYTES) target = BATCH_MAX_TABLE_BYTES;
+    size_t capacity = 1;
+    while (capacity * 2 * sizeof(IntInt_Entry) <= target) capacity *= 2;
+    size_t n = capacity / 2;
+    
+    fprintf(stderr, "\n## Batched vs Scalar Operations (%zu int keys, %zu MB entry array, LLC %zu MB)\n\n",
+            n, capacity * sizeof(IntInt_Entry) >> 20, llc_bytes() >> 20);
+    fprintf(stderr, "| Table | Batch | get (ns) | get_many (ns) | Speedup | set (ns) | set_many (ns) | Speedup |\n");
+    fprintf(stderr, "|-------|------:|---------:|--------------:|--------:|---------:|--------------:|--------:|\n");
+    
+    int *keys = shuffled_int_keys(n);
+    int *vals = malloc(n * sizeof(int));
+    int *out = malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) vals[i] = keys[i] + 1;
+    size_t batches[] = {32, 256};
+    
+    {
+        IntInt *d = IntInt_create_with_capacity(capacity);
+        for (size_t i = 0; i < n; i++) IntInt_set(d, (int)i, (int)i);
+        for (int b = 0; b < 2; b++)
+            BATCH_ROW(IntInt, "Robin Hood", d, keys, n, batches[b], out, vals);
+        IntInt_destroy(d);
+    }
+    {
+        SwissIntInt *d = SwissIntInt_create_with_capacity(capacity);
+        for (size_t i = 0; i < n; i++) SwissIntInt_set(d, (int)i, (int)i);
+        for (int b = 0; b < 2; b++)
+            BATCH_ROW(SwissIntInt, "Swiss", d, keys, n, batches[b], out, vals);
+        SwissIntInt_destroy(d);
+    }
+    
+    fprintf(stderr, "\n*Median ns per key over %d trials; keys looked up in shuffled order; set/set_many update "
+                    "existing keys; get_many/set_many latency samples are whole batches; DICT_BATCH_SIZE = %d*\n",
+            bench_cfg.trials, DICT_BATCH_SIZE);
+    bench_report_print(stderr, "Batched vs Scalar Operations");
+    perf_counters_print(&perf, stderr, "Batched vs Scalar Operations");
+    free(keys);
+    free(vals);
+    free(out);
+}
+
+// ============================================================================
+// Benchmark: startup load - rebuild vs read() + copy vs mmap snapshot
+// ============================================================================
+
+void bench_snapshot_load(void) {
+    char path[] = "/tmp/dict_snapshot_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "\n*Snapshot benchmark skipped: cannot create temp file*\n");
+        return;
+    }
+    close(fd);
+    
+    U64Int *src = U64Int_create_with_capacity((size_t)SNAPSHOT_KEYS * 2);
+    for (int i = 0; i < SNAPSHOT_KEYS; i++) U64Int_set(src, (uint64_t)i * 2654435761ULL, i);
+    if (!U64Int_save(src, path)) {
+        fprintf(stderr, "\n*Snapshot benchmark skipped: save failed*\n");
+        U64Int_destroy(src);
+        unlink(path);
+        return;
+    }
+    
+    fprintf(stderr, "\n## Startup Load: Rebuild vs read() vs mmap (%d uint64 keys, %.0f MB snapshot)\n\n",
+            SNAPSHOT_KEYS, (double)(src->capacity * sizeof(U64Int_Entry)) / (1024 * 1024));
+    fprintf(stderr, "| Method | Load (ms) | First %d gets (ms) | Total (ms) |\n", SNAPSHOT_QUERIES);
+    fprintf(stderr, "|--------|----------:|-------------------:|-----------:|\n");
+    U64Int_destroy(src);
+    
+    uint64_t *queries = malloc((size_t)SNAPSHOT_QUERIES * sizeof(uint64_t));
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < SNAPSHOT_QUERIES; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        queries[i] = (x % SNAPSHOT_KEYS) * 2654435761ULL;
+    }
+    
+    const char *names[] = {"rebuild (_set per row)", "_load (read + copy)", "_open_mapped (mmap)"};
+    for (int m = 0; m < 3; m++) {
+        bench_timer t[2];
+        bench_timers_init(t, 2);
+        volatile int sum = 0;
+        bool failed = false;
+        for (int trial = 0; trial < bench_cfg.trials && !failed; trial++) {
+            trim_heap();
+            U64Int *d = NULL;
+            if (m == 0) {
+                TIMED_CALL(&t[0], 1,
+                    d = U64Int_create_with_capacity((size_t)SNAPSHOT_KEYS * 2);
+                    for (int i = 0; i < SNAPSHOT_KEYS; i++) U64Int_set(d, (uint64_t)i * 2654435761ULL, i));
+            } else if (m == 1) {
+                TIMED_CALL(&t[0], 1, d = U64Int_load(path));
+            } else {
+                TIMED_CALL(&t[0], 1, d = U64Int_open_mapped(path));
+            }
+            failed = !d;
+            if (failed) break;
+            TIMED_TRIAL(&t[1], SNAPSHOT_QUERIES, sum += U64Int_get(d, queries[i], 0));
+            U64Int_destroy(d);
+        }
+        perf_row(names[m]);
+        if (failed) {
+            fprintf(stderr, "| %s | failed | - | - |\n", names[m]);
+            continue;
+        }
+    
+        double load_ms = bench_timer_stats(&t[0]).median / 1000000.0;
+        double query_ms = bench_timer_stats(&t[1]).median * SNAPSHOT_QUERIES / 1000000.0;
+        fprintf(stderr, "| %s | %.1f | %.1f | %.1f |\n", names[m], load_ms, query_ms, load_ms + query_ms);
+        char row[48];
+        snprintf(row, sizeof(row), "%s / load", names[m]);
+        bench_report_row(row, &t[0]);
+        snprintf(row, sizeof(row), "%s / get", names[m]);
+        bench_report_row(row, &t[1]);
+    }
+    
+    fprintf(stderr, "\n*Median of %d trials; the snapshot file is in the page cache; mmap pages fault in on "
+                    "first use in every trial*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Startup Load: Rebuild vs read() vs mmap");
+    perf_counters_print(&perf, stderr, "Startup Load: Rebuild vs read() vs mmap");
+    free(queries);
+    unlink(path);
+}
+
+// ============================================================================
+// Benchmark: char* keys vs inline small-string keys
+// ============================================================================
+
+// Unique key of a length drawn from the distribution: 6 hex digits of the
+// index followed by random identifier characters
+static char *sso_make_key(int index, int min_len, int max_len, int long_pct, uint64_t *rng) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_:/";
+    uint64_t x = *rng;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    int len;
+    if ((int)(x % 100) < long_pct) len = 24 + (int)((x >> 8) % 57);
+    else len = min_len + (int)((x >> 8) % (uint64_t)(max_len - min_len + 1));
+    char *key = malloc(len + 1);
+    snprintf(key, 7, "%06x", index);
+    for (int i = 6; i < len; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        key[i] = alphabet[x % (sizeof(alphabet) - 1)];
+    }
+    key[len] = '\0';
+    *rng = x;
+    return key;
+}
+
+void bench_sso_keys(void) {
+    fprintf(stderr, "\n## String Keys: char* vs Inline Small-String (%d keys, random lookups)\n\n", SSO_KEYS);
+    fprintf(stderr, "| Key lengths | Type | Insert | Get (hit) | Get (miss) | Bytes/entry |\n");
+    fprintf(stderr, "|-------------|------|-------:|----------:|-----------:|------------:|\n");
+    
+    // tag names the distribution in the latency table
+    const struct { const char *label, *tag; int min_len, max_len, long_pct; } dists[] = {
+        {"ids, 8-15 B", "ids 8-15", 8, 15, 0},
+        {"ids, 16-23 B", "ids 16-23", 16, DICT_SSO_MAX, 0},
+        {"mixed, 80% <= 23 B", "mixed", 8, DICT_SSO_MAX, 20},
+        {"paths, 24-80 B", "paths", 8, 8, 100},
+    };
+    static const char *lookup_ops[2] = {"get hit", "get miss"};
+    
+    int *order = shuffled_int_keys(SSO_KEYS);
+    for (size_t d = 0; d < sizeof(dists) / sizeof(dists[0]); d++) {
+        uint64_t rng = 0x9E3779B97F4A7C15ULL + (uint64_t)d;
+        char **keys = malloc(SSO_KEYS * sizeof(char*));
+        char **miss_keys = malloc(SSO_KEYS * sizeof(char*));
+        for (int i = 0; i < SSO_KEYS; i++) {
+            keys[i] = sso_make_key(i, dists[d].min_len, dists[d].max_len, dists[d].long_pct, &rng);
+            miss_keys[i] = sso_make_key(i + SSO_KEYS, dists[d].min_len, dists[d].max_len, dists[d].long_pct, &rng);
+        }
+    
+        // Query streams are packed in lookup order, like keys parsed from a
+        // request buffer, so only the table side of the lookup misses cache
+        char **hits = malloc(SSO_KEYS * sizeof(char*));
+        char **misses = malloc(SSO_KEYS * sizeof(char*));
+        size_t hit_bytes = 0, miss_bytes = 0;
+        for (int i = 0; i < SSO_KEYS; i++) {
+            hit_bytes += strlen(keys[i]) + 1;
+            miss_bytes += strlen(miss_keys[i]) + 1;
+        }
+        char *hit_buf = malloc(hit_bytes), *miss_buf = malloc(miss_bytes);
+        char *hp = hit_buf, *mp = miss_buf;
+        for (int i = 0; i < SSO_KEYS; i++) {
+            size_t n = strlen(keys[order[i]]) + 1;
+            hits[i] = memcpy(hp, keys[order[i]], n);
+            hp += n;
+            n = strlen(miss_keys[order[i]]) + 1;
+            misses[i] = memcpy(mp, miss_keys[order[i]], n);
+            mp += n;
+        }
+    
+        // Callers that keep their keys as dict_sso_t skip the copy and scan
+        dict_sso_t *sso_hits = malloc(SSO_KEYS * sizeof(dict_sso_t));
+        dict_sso_t *sso_misses = malloc(SSO_KEYS * sizeof(dict_sso_t));
+        for (int i = 0; i < SSO_KEYS; i++) {
+            sso_hits[i] = dict_sso(hits[i]);
+            sso_misses[i] = dict_sso(misses[i]);
+        }
+    
+        bench_timer st[3], ot[3], pt[2];
+        bench_timers_init(st, 3);
+        bench_timers_init(ot, 3);
+        bench_timers_init(pt, 2);
+        double str_bytes = 0, sso_bytes = 0;
+        volatile int sum = 0;
+        for (int trial = 0; trial < bench_cfg.trials; trial++) {
+            // char* keys: every probe dereferences the strdup'ed key
+            StrInt *sd = StrInt_create_with_capacity(SSO_KEYS * 2);
+            TIMED_TRIAL(&st[0], SSO_KEYS, StrInt_set(sd, keys[i], (int)i));
+            TIMED_TRIAL(&st[1], SSO_KEYS, sum += StrInt_get(sd, hits[i], 0));
+            TIMED_TRIAL(&st[2], SSO_KEYS, sum += StrInt_get(sd, misses[i], 0));
+            str_bytes = (double)StrInt_memory_usage(sd) / StrInt_size(sd);
+            StrInt_destroy(sd);
+    
+            // Inline keys: the lookup key is built per call, as a caller would
+            SsoInt *od = SsoInt_create_with_capacity(SSO_KEYS * 2);
+            TIMED_TRIAL(&ot[0], SSO_KEYS, SsoInt_set(od, dict_sso(keys[i]), (int)i));
+            TIMED_TRIAL(&ot[1], SSO_KEYS, sum += SsoInt_get(od, dict_sso(hits[i]), 0));
+            TIMED_TRIAL(&ot[2], SSO_KEYS, sum += SsoInt_get(od, dict_sso(misses[i]), 0));
+            TIMED_TRIAL(&pt[0], SSO_KEYS, sum += SsoInt_get(od, sso_hits[i], 0));
+            TIMED_TRIAL(&pt[1], SSO_KEYS, sum += SsoInt_get(od, sso_misses[i], 0));
+            sso_bytes = (double)SsoInt_memory_usage(od) / SsoInt_size(od);
+            SsoInt_destroy(od);
+        }
+    
+        char label[48];
+        snprintf(label, sizeof(label), "%s char*", dists[d].tag);
+        OpResult r = op_result(label, st);
+        fprintf(stderr, "| %s | char* (strdup) | %.2f | %.2f | %.2f | %.1f |\n", dists[d].label,
+                r.insert, r.get_hit, r.get_miss, str_bytes);
+        snprintf(label, sizeof(label), "%s sso built", dists[d].tag);
+        r = op_result(label, ot);
+        fprintf(stderr, "| %s | dict_sso_t (built per call) | %.2f | %.2f | %.2f | %.1f |\n", dists[d].label,
+                r.insert, r.get_hit, r.get_miss, sso_bytes);
+        snprintf(label, sizeof(label), "%s sso prebuilt", dists[d].tag);
+        report_rows(label, lookup_ops, pt, 2);
+        fprintf(stderr, "| %s | dict_sso_t (prebuilt keys) | - | %.2f | %.2f | - |\n", dists[d].label,
+                bench_timer_stats(&pt[0]).median, bench_timer_stats(&pt[1]).median);
+        snprintf(label, sizeof(label), "%s char* + sso", dists[d].tag);
+        perf_row(label);
+    
+        free(sso_hits);
+        free(sso_misses);
+        for (int i = 0; i < SSO_KEYS; i++) {
+            free(keys[i]);
+            free(miss_keys[i]);
+        }
+        free(keys);
+        free(miss_keys);
+        free(hits);
+        free(misses);
+        free(hit_buf);
+        free(miss_buf);
+    }
+    free(order);
+    
+    fprintf(stderr, "\n*Lookups in shuffled order; median ns per operation over %d trials, bytes/entry includes "
+                    "owned key copies*\n", bench_cfg.trials);
+    bench_report_print(stderr, "String Keys: char* vs Inline Small-String");
+    perf_counters_print(&perf, stderr, "String Keys: char* vs Inline Small-String");
+}
+
+// ============================================================================
+// Benchmark: update-heavy counting - get + set vs single-probe upsert
+// ============================================================================
+
+static void upsert_incr(int *value, bool inserted, void *ctx) {
+    (void)inserted;
+    *value += *(const int*)ctx;
+}
+
+#define UPSERT_ROW(TYPE, LABEL, KEYS, UPDATE) do { \
+    bench_timer t; \
+    bench_timer_init(&t); \
+    size_t size = 0; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        TYPE *d = TYPE##_create(); \
+        TIMED_TRIAL(&t, UPSERT_UPDATES, TYPE##_Key key = (KEYS)[order[i]]; UPDATE); \
+        size = TYPE##_size(d); \
+        TYPE##_destroy(d); \
+    } \
+    bench_report_row(#TYPE " / " LABEL, &t); \
+    perf_row(#TYPE " / " LABEL); \
+    fprintf(stderr, "| %s | %s | %.2f | %zu |\n", #TYPE, LABEL, bench_timer_stats(&t).median, size); \
+} while (0)
+
+void bench_upsert(void) {
+    fprintf(stderr, "\n## Update-Heavy Counting: get + set vs get_or_insert vs upsert (%d updates, %d keys)\n\n",
+            UPSERT_UPDATES, UPSERT_KEYS);
+    fprintf(stderr, "| Type | Path | ns/update | Keys |\n");
+    fprintf(stderr, "|------|------|----------:|-----:|\n");
+    
+    char **str_keys = malloc(UPSERT_KEYS * sizeof(char*));
+    int *int_keys = malloc(UPSERT_KEYS * sizeof(int));
+    for (int i = 0; i < UPSERT_KEYS; i++) {
+        str_keys[i] = malloc(32);
+        snprintf(str_keys[i], 32, "word_%d", i);
+        int_keys[i] = i * 7919;
+    }
+    int *order = malloc(UPSERT_UPDATES * sizeof(int));
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < UPSERT_UPDATES; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        order[i] = (int)(x % UPSERT_KEYS);
+    }
+    int one = 1;
+    
+    UPSERT_ROW(StrInt, "_get + _set", str_keys, StrInt_set(d, key, StrInt_get(d, key, 0) + 1));
+    UPSERT_ROW(StrInt, "_get_ptr, _set if absent", str_keys, {
+        int *v = StrInt_get_ptr(d, key);
+        if (v) (*v)++; else StrInt_set(d, key, 1);
+    });
+    UPSERT_ROW(StrInt, "_get_or_insert", str_keys, (*StrInt_get_or_insert(d, key, 0))++);
+    UPSERT_ROW(StrInt, "_upsert", str_keys, StrInt_upsert(d, key, upsert_incr, &one));
+    
+    UPSERT_ROW(IntInt, "_get + _set", int_keys, IntInt_set(d, key, IntInt_get(d, key, 0) + 1));
+    UPSERT_ROW(IntInt, "_get_or_insert", int_keys, (*IntInt_get_or_insert(d, key, 0))++);
+    UPSERT_ROW(IntInt, "_upsert", int_keys, IntInt_upsert(d, key, upsert_incr, &one));
+    
+    UPSERT_ROW(SwissStrInt, "_get + _set", str_keys, SwissStrInt_set(d, key, SwissStrInt_get(d, key, 0) + 1));
+    UPSERT_ROW(SwissStrInt, "_get_or_insert", str_keys, (*SwissStrInt_get_or_insert(d, key, 0))++);
+    
+    fprintf(stderr, "\n*Median of %d trials; tables start at the default capacity; updates pick keys uniformly "
+                    "at random*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Update-Heavy Counting");
+    perf_counters_print(&perf, stderr, "Update-Heavy Counting");
+    for (int i = 0; i < UPSERT_KEYS; i++) free(str_keys[i]);
+    free(str_keys);
+    free(int_keys);
+    free(order);
+}
+
+// ============================================================================
+// Benchmark: fixed key sets - Robin Hood StrInt vs perfect hash
+// ============================================================================
+
+void bench_static_keys(void) {
+    fprintf(stderr, "\n## Fixed Key Sets: StrInt vs Perfect Hash (%d random lookups)\n\n", ITERATIONS);
+    fprintf(stderr, "| Keys | Type | Build (us) | Get (hit) | Get (miss) | Bytes/entry |\n");
+    fprintf(stderr, "|-----:|------|-----------:|----------:|-----------:|------------:|\n");
+    
+    // Config/protocol style names: dotted section prefix, field name, index
+    static const char *sections[] = {"server", "db.pool", "log", "cache", "http.header", "metrics"};
+    static const char *fields[] = {"timeout", "max_size", "enabled", "path", "retries", "level", "port"};
+    static const char *ops[3] = {"build", "get hit", "get miss"};
+    const int set_sizes[] = {64, 512, 4096};
+    
+    for (int k = 0; k < 3; k++) {
+        int n = set_sizes[k];
+        char **keys = malloc(n * sizeof(char*));
+        char **miss_keys = malloc(n * sizeof(char*));
+        int *values = malloc(n * sizeof(int));
+        for (int i = 0; i < n; i++) {
+            keys[i] = malloc(48);
+            snprintf(keys[i], 48, "%s.%s_%d", sections[i % 6], fields[i % 7], i);
+            miss_keys[i] = malloc(48);
+            snprintf(miss_keys[i], 48, "%s.%s_%d", sections[i % 6], fields[(i + 1) % 7], i + n);
+            values[i] = i;
+        }
+        int *order = malloc(ITERATIONS * sizeof(int));
+        uint64_t x = 0x9E3779B97F4A7C15ULL;
+        for (int i = 0; i < ITERATIONS; i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            order[i] = (int)(x % (uint64_t)n);
+        }
+    
+        // Builds are timed per key; the table shows the whole build
+        bench_timer rt[3], pt[3];
+        bench_timers_init(rt, 3);
+        bench_timers_init(pt, 3);
+        double str_bytes = 0, static_bytes = 0;
+        bool failed = false;
+        volatile int sum = 0;
+        for (int trial = 0; trial < bench_cfg.trials; trial++) {
+            StrInt *d;
+            TIMED_CALL(&rt[0], n,
+                d = StrInt_create();
+                for (int i = 0; i < n; i++) StrInt_set(d, keys[i], values[i]));
+            TIMED_TRIAL(&rt[1], ITERATIONS, sum += StrInt_get(d, keys[order[i]], 0));
+            TIMED_TRIAL(&rt[2], ITERATIONS, sum += StrInt_get(d, miss_keys[order[i]], 0));
+            str_bytes = (double)StrInt_memory_usage(d) / n;
+            StrInt_destroy(d);
+    
+            if (failed) continue;
+            StaticStrInt *p;
+            TIMED_CALL(&pt[0], n, p = StaticStrInt_create((const char *const*)keys, values, n));
+            failed = !p;
+            if (failed) continue;
+            TIMED_TRIAL(&pt[1], ITERATIONS, sum += StaticStrInt_get(p, keys[order[i]], 0));
+            TIMED_TRIAL(&pt[2], ITERATIONS, sum += StaticStrInt_get(p, miss_keys[order[i]], 0));
+            static_bytes = (double)StaticStrInt_memory_usage(p) / n;
+            StaticStrInt_destroy(p);
+        }
+    
+        char label[48];
+        snprintf(label, sizeof(label), "%d keys StrInt", n);
+        report_rows(label, ops, rt, 3);
+        fprintf(stderr, "| %d | StrInt (Robin Hood) | %.1f | %.2f | %.2f | %.1f |\n", n,
+                bench_timer_stats(&rt[0]).median * n / 1000.0, bench_timer_stats(&rt[1]).median,
+                bench_timer_stats(&rt[2]).median, str_bytes);
+        if (failed) {
+            fprintf(stderr, "| %d | DICT_DEFINE_STATIC | failed | - | - | - |\n", n);
+        } else {
+            snprintf(label, sizeof(label), "%d keys static", n);
+            report_rows(label, ops, pt, 3);
+            fprintf(stderr, "| %d | DICT_DEFINE_STATIC (perfect) | %.1f | %.2f | %.2f | %.1f |\n", n,
+                    bench_timer_stats(&pt[0]).median * n / 1000.0, bench_timer_stats(&pt[1]).median,
+                    bench_timer_stats(&pt[2]).median, static_bytes);
+        }
+        snprintf(label, sizeof(label), "%d keys StrInt + static", n);
+        perf_row(label);
+    
+        for (int i = 0; i < n; i++) {
+            free(keys[i]);
+            free(miss_keys[i]);
+        }
+        free(keys);
+        free(miss_keys);
+        free(values);
+        free(order);
+    }
+    
+    fprintf(stderr, "\n*Median of %d trials; the latency table gives build as ns per key. Perfect hash keys are "
+                    "borrowed, so its bytes/entry excludes key strings; StrInt's includes its copies*\n",
+            bench_cfg.trials);
+    bench_report_print(stderr, "Fixed Key Sets: StrInt vs Perfect Hash");
+    perf_counters_print(&perf, stderr, "Fixed Key Sets: StrInt vs Perfect Hash");
+}
+
+// ============================================================================
+// Benchmark: full-table iteration - Robin Hood vs compact ordered dict
+// ============================================================================
+
+// One op is a full pass over the table
+#define ITER_ROW(TYPE, LABEL, D, FILL, SCENARIO) do { \
+    bench_timer t; \
+    bench_timer_init(&t); \
+    volatile long sum = 0; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        TIMED_TRIAL(&t, ITER_PASSES, \
+            TYPE##_Iterator it = TYPE##_iter(D); \
+            int k, v; \
+            while (TYPE##_next(&it, &k, &v)) sum += v); \
+    } \
+    char row[48]; \
+    snprintf(row, sizeof(row), "%s %.0f%% / %s", SCENARIO, (FILL) * 100, LABEL); \
+    bench_report_row(row, &t); \
+    perf_row(row); \
+    double pass_ns = bench_timer_stats(&t).median; \
+    fprintf(stderr, "| %s | %.0f%% | %s | %.2f | %.2f | %.1f |\n", SCENARIO, (FILL) * 100, LABEL, \
+            pass_ns / 1000000.0, pass_ns / TYPE##_size(D), (double)TYPE##_memory_usage(D) / TYPE##_size(D)); \
+} while (0)
+
+void bench_iteration(void) {
+    fprintf(stderr, "\n## Iteration: Robin Hood vs Compact Ordered (capacity %d, %d passes)\n\n",
+            ITER_CAPACITY, ITER_PASSES);
+    fprintf(stderr, "| Scenario | Fill | Type | ms/pass | ns/entry | Bytes/entry |\n");
+    fprintf(stderr, "|----------|-----:|------|--------:|---------:|------------:|\n");
+    
+    const double fills[] = {0.01, 0.10, 0.50, 0.85};
+    int *keys = shuffled_int_keys(ITER_CAPACITY);
+    
+    for (int scenario = 0; scenario < 2; scenario++) {
+        const char *label = scenario == 0 ? "presized" : "after removes";
+        for (int f = 0; f < 4; f++) {
+            int live = (int)(fills[f] * ITER_CAPACITY);
+            // presized: insert the live keys; after removes: fill to 85%, then remove down
+            int inserted = scenario == 0 ? live : (int)(0.85 * ITER_CAPACITY);
+    
+            IntInt *rh = IntInt_create_with_capacity(ITER_CAPACITY);
+            IntInt_set_max_load(rh, HIGH_MAX_LOAD);
+            OrderedIntInt *od = OrderedIntInt_create_with_capacity(ITER_CAPACITY);
+            for (int i = 0; i < inserted; i++) {
+                IntInt_set(rh, keys[i], i);
+                OrderedIntInt_set(od, keys[i], i);
+            }
+            for (int i = live; i < inserted; i++) {
+                IntInt_remove(rh, keys[i]);
+                OrderedIntInt_remove(od, keys[i]);
+            }
+    
+            ITER_ROW(IntInt, "IntInt (Robin Hood)", rh, fills[f], label);
+            ITER_ROW(OrderedIntInt, "OrderedIntInt (compact)", od, fills[f], label);
+            IntInt_destroy(rh);
+            OrderedIntInt_destroy(od);
+        }
+    }
+    free(keys);
+    
+    fprintf(stderr, "\n*Median pass of %d trials of %d passes; ns/entry is per live entry; both tables are "
+                    "created with the same capacity*\n", bench_cfg.trials, ITER_PASSES);
+    bench_report_print(stderr, "Iteration: Robin Hood vs Compact Ordered");
+    perf_counters_print(&perf, stderr, "Iteration: Robin Hood vs Compact Ordered");
+}
+
+// ============================================================================
+// Benchmark: large tables - 4 KB pages vs 2 MB pages
+// ============================================================================
+
+void bench_huge_pages(void) {
+    fprintf(stderr, "\n## Large Table: 4 KB vs 2 MB Pages (%d uint64 keys, %d random lookups)\n\n",
+            HUGE_KEYS, HUGE_QUERIES);
+    fprintf(stderr, "| Pages | Table (MB) | Reserve (ms) | Insert (ns) | Get hit (ns) | Get miss (ns) | Huge-page backed (MB) |\n");
+    fprintf(stderr, "|-------|-----------:|-------------:|------------:|-------------:|--------------:|----------------------:|\n");
+    
+    uint64_t *queries = malloc((size_t)HUGE_QUERIES * sizeof(uint64_t));
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < HUGE_QUERIES; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        queries[i] = x % HUGE_KEYS;
+    }
+    
+    static const char *ops[4] = {"reserve", "insert", "get hit", "get miss"};
+    for (int huge = 0; huge < 2; huge++) {
+        bench_timer t[4];
+        bench_timers_init(t, 4);
+        double table_mb = 0, huge_mb = 0;
+        volatile int sum = 0;
+        for (int trial = 0; trial < bench_cfg.trials; trial++) {
+            trim_heap();
+            size_t huge_before = anon_huge_bytes();
+            U64Int *d;
+            TIMED_CALL(&t[0], 1,
+                d = U64Int_create();
+                U64Int_set_huge_pages(d, huge);
+                U64Int_reserve(d, HUGE_KEYS));
+            TIMED_TRIAL(&t[1], HUGE_KEYS, U64Int_set(d, (uint64_t)i * 2654435761ULL, (int)i));
+            TIMED_TRIAL(&t[2], HUGE_QUERIES, sum += U64Int_get(d, queries[i] * 2654435761ULL, 0));
+            TIMED_TRIAL(&t[3], HUGE_QUERIES, sum += U64Int_get(d, queries[i] * 2654435761ULL + 1, 0));
+            table_mb = (double)(U64Int_capacity(d) * sizeof(U64Int_Entry)) / (1024 * 1024);
+            huge_mb = (double)(anon_huge_bytes() - huge_before) / (1024 * 1024);
+            U64Int_destroy(d);
+        }
+    
+        const char *label = huge ? "2 MB (madvise)" : "4 KB (calloc)";
+        report_rows(label, ops, t, 4);
+        perf_row(label);
+        fprintf(stderr, "| %s | %.0f | %.1f | %.2f | %.2f | %.2f | %.0f |\n", label, table_mb,
+                bench_timer_stats(&t[0]).median / 1000000.0, bench_timer_stats(&t[1]).median,
+                bench_timer_stats(&t[2]).median, bench_timer_stats(&t[3]).median, huge_mb);
+    }
+    free(queries);
+    
+    fprintf(stderr, "\n*Median of %d trials; the 2 MB row depends on transparent huge pages being enabled "
+                    "(always or madvise)*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Large Table: 4 KB vs 2 MB Pages");
+    perf_counters_print(&perf, stderr, "Large Table: 4 KB vs 2 MB Pages");
+}
+
+// ============================================================================
+// Benchmark: ID sets - dict with dummy values vs key-only DICT_DEFINE_SET
+// ============================================================================
+
+#define SET_OPS 11
+
+// Each op is timed as one call per trial and normalised per key walked or
+// queried (N); the row keeps N and the result table's memory and size
+#define SET_RESULT(K, N, TYPE, D) do { \
+    walked[K] = (N); \
+    mem[K] = TYPE##_memory_usage(D); \
+    size[K] = TYPE##_size(D); \
+} while (0)
+
+void bench_sets(void) {
+    fprintf(stderr, "\n## ID Sets: Dict-as-Set vs DICT_DEFINE_SET (%d ids from %d, %d-id probe set)\n\n",
+            SET_IDS, SET_RANGE, SET_SMALL);
+    fprintf(stderr, "| Operation | Type | ms | ns/key | Result size | Bytes/entry |\n");
+    fprintf(stderr, "|-----------|------|---:|-------:|------------:|------------:|\n");
+    
+    static const struct { const char *op, *type; } rows[SET_OPS] = {
+        {"dedup (loop)", "U64Int (dummy value)"},
+        {"dedup (loop)", "U64Set"},
+        {"dedup (add_many)", "U64Set"},
+        {"intersect", "U64Int (iterate + contains)"},
+        {"intersect", "U64Set_intersect"},
+        {"difference", "U64Int (iterate + contains)"},
+        {"difference", "U64Set_difference"},
+        {"union into", "U64Int (iterate + set)"},
+        {"union into", "U64Set_union_into"},
+        {"contains", "U64Int (loop)"},
+        {"contains", "U64Set_contains_many"},
+    };
+    
+    // Scattered 64-bit IDs: the same id values show up in both streams
+    uint64_t *ids = malloc((size_t)SET_IDS * sizeof(uint64_t));
+    uint64_t *small = malloc((size_t)SET_SMALL * sizeof(uint64_t));
+    uint64_t x = 0x2545F4914F6CDD1DULL;
+    for (int i = 0; i < SET_IDS; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        ids[i] = (x % SET_RANGE) * 0x9E3779B97F4A7C15ULL;
+    }
+    for (int i = 0; i < SET_SMALL; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        small[i] = (x % (SET_RANGE * 2)) * 0x9E3779B97F4A7C15ULL;
+    }
+    
+    bench_timer t[SET_OPS];
+    bench_timers_init(t, SET_OPS);
+    size_t walked[SET_OPS], mem[SET_OPS], size[SET_OPS];
+    bool mismatch = false;
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        // Deduplicate: grow from the default size, as for an unknown distinct count
+        U64Int *da;
+        TIMED_CALL(&t[0], SET_IDS,
+            da = U64Int_create();
+            for (int i = 0; i < SET_IDS; i++) U64Int_set(da, ids[i], 1));
+        SET_RESULT(0, SET_IDS, U64Int, da);
+    
+        U64Set *sa;
+        TIMED_CALL(&t[1], SET_IDS,
+            sa = U64Set_create();
+            for (int i = 0; i < SET_IDS; i++) U64Set_add(sa, ids[i]));
+        SET_RESULT(1, SET_IDS, U64Set, sa);
+        U64Set_destroy(sa);
+    
+        TIMED_CALL(&t[2], SET_IDS,
+            sa = U64Set_create();
+            U64Set_add_many(sa, ids, SET_IDS));
+        SET_RESULT(2, SET_IDS, U64Set, sa);
+    
+        U64Int *db = U64Int_create();
+        U64Set *sb = U64Set_create();
+        for (int i = 0; i < SET_SMALL; i++) {
+            U64Int_set(db, small[i], 1);
+            U64Set_add(sb, small[i]);
+        }
+    
+        // Intersect: walk the smaller set, probe the larger one
+        U64Int *di;
+        uint64_t key;
+        TIMED_CALL(&t[3], U64Int_size(db),
+            di = U64Int_create_with_capacity(U64Int_capacity_for(db, U64Int_size(db)));
+            U64Int_Iterator it = U64Int_iter(db);
+            while (U64Int_next(&it, &key, NULL)) {
+                if (U64Int_contains(da, key)) U64Int_set(di, key, 1);
+            });
+        SET_RESULT(3, U64Int_size(db), U64Int, di);
+    
+        U64Set *si;
+        TIMED_CALL(&t[4], U64Set_size(sb), si = U64Set_intersect(sa, sb));
+        SET_RESULT(4, U64Set_size(sb), U64Set, si);
+    
+        // Difference: walk the large set, probe the small one
+        U64Int *dd;
+        TIMED_CALL(&t[5], U64Int_size(da),
+            dd = U64Int_create_with_capacity(U64Int_capacity_for(da, U64Int_size(da)));
+            U64Int_Iterator it = U64Int_iter(da);
+            while (U64Int_next(&it, &key, NULL)) {
+                if (!U64Int_contains(db, key)) U64Int_set(dd, key, 1);
+            });
+        SET_RESULT(5, U64Int_size(da), U64Int, dd);
+    
+        U64Set *sd;
+        TIMED_CALL(&t[6], U64Set_size(sa), sd = U64Set_difference(sa, sb));
+        SET_RESULT(6, U64Set_size(sa), U64Set, sd);
+    
+        // Union of the small set into the large one
+        TIMED_CALL(&t[7], U64Int_size(db),
+            U64Int_Iterator it = U64Int_iter(db);
+            while (U64Int_next(&it, &key, NULL)) U64Int_set(da, key, 1));
+        SET_RESULT(7, U64Int_size(db), U64Int, da);
+    
+        TIMED_CALL(&t[8], U64Set_size(sb), U64Set_union_into(sa, sb));
+        SET_RESULT(8, U64Set_size(sb), U64Set, sa);
+    
+        // Membership of both streams' ids in the large set
+        size_t found = 0, found_many = 0;
+        TIMED_CALL(&t[9], SET_SMALL, for (int i = 0; i < SET_SMALL; i++) found += U64Int_contains(da, small[i]));
+        SET_RESULT(9, SET_SMALL, U64Int, da);
+    
+        TIMED_CALL(&t[10], SET_SMALL, found_many = U64Set_contains_many(sa, small, SET_SMALL, NULL));
+        SET_RESULT(10, SET_SMALL, U64Set, sa);
+        mismatch |= found != found_many;
+    
+        U64Int_destroy(da);
+        U64Int_destroy(db);
+        U64Int_destroy(di);
+        U64Int_destroy(dd);
+        U64Set_destroy(sa);
+        U64Set_destroy(sb);
+        U64Set_destroy(si);
+        U64Set_destroy(sd);
+    }
+    
+    for (int k = 0; k < SET_OPS; k++) {
+        double ns = bench_timer_stats(&t[k]).median;
+        fprintf(stderr, "| %s | %s | %.1f | %.1f | %zu | %.1f |\n", rows[k].op, rows[k].type,
+                ns * walked[k] / 1000000.0, ns, size[k], (double)mem[k] / size[k]);
+        char row[48];
+        snprintf(row, sizeof(row), "%s / %s", rows[k].op, rows[k].type);
+        bench_report_row(row, &t[k]);
+    }
+    perf_row("every operation, both types");
+    if (mismatch) fprintf(stderr, "\n**Mismatch between the contains loop and contains_many hits**\n");
+    free(ids);
+    free(small);
+    
+    fprintf(stderr, "\n*Median of %d trials; ns/key is per key walked or queried; Bytes/entry is the result "
+                    "(or probed) table; latency percentiles are whole calls*\n", bench_cfg.trials);
+    bench_report_print(stderr, "ID Sets: Dict-as-Set vs DICT_DEFINE_SET");
+    perf_counters_print(&perf, stderr, "ID Sets: Dict-as-Set vs DICT_DEFINE_SET");
+}
+
+// ============================================================================
+// Benchmark: bulk construction - _set loop vs partitioned build_from
+// ============================================================================
+
+// Rows: _set loop, presized _set loop, then build_from at 1, 2, 4, 8 threads
+#define BUILD_ROWS 6
+
+#define BUILD_COMPARE(TYPE, KEYS, VALUES, N, MAX_THREADS) do { \
+    static const char *methods[BUILD_ROWS] = { \
+        "_set loop", "create_with_capacity + _set", "build_from", "build_from", "build_from", "build_from" \
+    }; \
+    bench_timer t[BUILD_ROWS]; \
+    bench_timers_init(t, BUILD_ROWS); \
+    size_t sizes[BUILD_ROWS] = {0}; \
+    int rows = 2; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        TYPE *d; \
+        trim_heap(); \
+        TIMED_CALL(&t[0], N, \
+            d = TYPE##_create(); \
+            for (size_t i = 0; i < (N); i++) TYPE##_set(d, (KEYS)[i], (VALUES)[i])); \
+        sizes[0] = TYPE##_size(d); \
+        TYPE##_destroy(d); \
+        trim_heap(); \
+        TIMED_CALL(&t[1], N, \
+            d = TYPE##_create_with_capacity((size_t)((double)(N) / DICT_LOAD_FACTOR) + 1); \
+            for (size_t i = 0; i < (N); i++) TYPE##_set(d, (KEYS)[i], (VALUES)[i])); \
+        sizes[1] = TYPE##_size(d); \
+        TYPE##_destroy(d); \
+        rows = 2; \
+        for (int threads = 1; threads <= (MAX_THREADS) && rows < BUILD_ROWS; threads *= 2, rows++) { \
+            trim_heap(); \
+            TIMED_CALL(&t[rows], N, d = TYPE##_build_from(KEYS, VALUES, N, threads)); \
+            sizes[rows] = TYPE##_size(d); \
+            TYPE##_destroy(d); \
+        } \
+    } \
+    for (int r = 0; r < rows; r++) { \
+        int threads = r < 2 ? 1 : 1 << (r - 2); \
+        double ns = bench_timer_stats(&t[r]).median; \
+        fprintf(stderr, "| %s | %s | %d | %.1f | %.1f | %zu |\n", #TYPE, methods[r], threads, \
+                ns * (N) / 1000000.0, ns, sizes[r]); \
+        char row[48]; \
+        snprintf(row, sizeof(row), "%s %s x%d", #TYPE, methods[r], threads); \
+        bench_report_row(row, &t[r]); \
+    } \
+    perf_row(#TYPE " every method"); \
+} while (0)
+
+void bench_build_from(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cpus > 8 ? 8 : cpus < 4 ? 4 : (int)cpus;
+    fprintf(stderr, "\n## Bulk Construction: _set Loop vs build_from (%d uint64 / %d string rows, %ld CPUs)\n\n",
+            BUILD_KEYS, BUILD_STR_KEYS, cpus);
+    fprintf(stderr, "| Type | Method | Threads | ms | ns/row | Size |\n");
+    fprintf(stderr, "|------|--------|--------:|---:|-------:|-----:|\n");
+    
+    uint64_t *keys = malloc((size_t)BUILD_KEYS * sizeof(uint64_t));
+    int *values = malloc((size_t)BUILD_KEYS * sizeof(int));
+    uint64_t x = 0x853C49E6748FEA9BULL;
+    for (int i = 0; i < BUILD_KEYS; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        keys[i] = x;
+        values[i] = i;
+    }
+    BUILD_COMPARE(U64Int, keys, values, (size_t)BUILD_KEYS, max_threads);
+    free(keys);
+    
+    char **str_keys = malloc((size_t)BUILD_STR_KEYS * sizeof(char*));
+    for (int i = 0; i < BUILD_STR_KEYS; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "user:%llu", (unsigned long long)(x % 100000000));
+        str_keys[i] = strdup(buf);
+    }
+    BUILD_COMPARE(StrInt, str_keys, values, (size_t)BUILD_STR_KEYS, max_threads);
+    for (int i = 0; i < BUILD_STR_KEYS; i++) free(str_keys[i]);
+    free(str_keys);
+    free(values);
+    
+    fprintf(stderr, "\n*Median of %d trials; build_from sizes the table once and inserts partition by partition; "
+                    "threads beyond the CPU count only add overhead*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Bulk Construction: _set Loop vs build_from");
+    perf_counters_print(&perf, stderr, "Bulk Construction: _set Loop vs build_from");
+}
+
+// ============================================================================
+// Benchmark: entry layouts - Robin Hood entry vs packed meta vs split arrays
+// ============================================================================
+
+// Slot bytes: table bytes per slot; Load: size / capacity after the inserts;
+// Bytes/entry: _memory_usage / _size.
+// Lookups go in shuffled order; each time is the median over the trials.
+#define LAYOUT_ROW(TYPE, TYPE_LABEL, LAYOUT, SLOT_BYTES, KEYS, MISSES, ORDER) do { \
+    static const char *ops[3] = {"get hit", "contains miss", "value scan"}; \
+    TYPE *d = TYPE##_create_with_capacity(LAYOUT_CAPACITY); \
+    for (size_t i = 0; i < LAYOUT_KEYS; i++) TYPE##_set(d, (KEYS)[i], (TYPE##_Value)i); \
+    bench_timer t[3]; \
+    bench_timers_init(t, 3); \
+    volatile double sum = 0; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        TIMED_TRIAL(&t[0], LAYOUT_KEYS, sum += TYPE##_get(d, (KEYS)[(ORDER)[i]], 0)); \
+        TIMED_TRIAL(&t[1], LAYOUT_KEYS, sum += TYPE##_contains(d, (MISSES)[(ORDER)[i]])); \
+        TIMED_CALL(&t[2], TYPE##_size(d), \
+            TYPE##_Iterator it = TYPE##_iter(d); \
+            TYPE##_Value v; \
+            while (TYPE##_next(&it, NULL, &v)) sum += v); \
+    } \
+    report_rows(#TYPE, ops, t, 3); \
+    perf_row(#TYPE); \
+    fprintf(stderr, "| %s | %s | %zu | %.2f | %.1f | %.2f | %.2f | %.2f |\n", TYPE_LABEL, LAYOUT, (size_t)(SLOT_BYTES), \
+            (double)TYPE##_size(d) / TYPE##_capacity(d), (double)TYPE##_memory_usage(d) / TYPE##_size(d), \
+            bench_timer_stats(&t[0]).median, bench_timer_stats(&t[1]).median, bench_timer_stats(&t[2]).median); \
+    TYPE##_destroy(d); \
+} while (0)
+
+#define LAYOUT_COMPARE(TYPE_LABEL, AOS, PACKED, SPLIT, KEYS, MISSES, ORDER) do { \
+    LAYOUT_ROW(AOS, TYPE_LABEL, "Robin Hood entry", sizeof(AOS##_Entry), KEYS, MISSES, ORDER); \
+    LAYOUT_ROW(PACKED, TYPE_LABEL, "packed meta", PACKED##_slot_bytes(), KEYS, MISSES, ORDER); \
+    LAYOUT_ROW(SPLIT, TYPE_LABEL, "split arrays", SPLIT##_slot_bytes(), KEYS, MISSES, ORDER); \
+} while (0)
+
+void bench_layouts(void) {
+    fprintf(stderr, "\n## Entry Layouts: Robin Hood Entry vs Packed Meta vs Split Arrays "
+                    "(%d keys, capacity %d)\n\n", LAYOUT_KEYS, LAYOUT_CAPACITY);
+    fprintf(stderr, "| Type | Layout | Slot bytes | Load | Bytes/entry | Get hit (ns) | Contains miss (ns) | Value scan (ns/entry) |\n");
+    fprintf(stderr, "|------|--------|-----------:|-----:|------------:|-------------:|-------------------:|----------------------:|\n");
+    
+    int *order = shuffled_int_keys(LAYOUT_KEYS);
+    char **str_keys = malloc(LAYOUT_KEYS * sizeof(char*));
+    char **str_misses = malloc(LAYOUT_KEYS * sizeof(char*));
+    int *int_keys = malloc(LAYOUT_KEYS * sizeof(int));
+    int *int_misses = malloc(LAYOUT_KEYS * sizeof(int));
+    uint32_t *u32_keys = malloc(LAYOUT_KEYS * sizeof(uint32_t));
+    uint32_t *u32_misses = malloc(LAYOUT_KEYS * sizeof(uint32_t));
+    uint64_t *u64_keys = malloc(LAYOUT_KEYS * sizeof(uint64_t));
+    uint64_t *u64_misses = malloc(LAYOUT_KEYS * sizeof(uint64_t));
+    void **ptr_keys = malloc(LAYOUT_KEYS * sizeof(void*));
+    void **ptr_misses = malloc(LAYOUT_KEYS * sizeof(void*));
+    for (int i = 0; i < LAYOUT_KEYS; i++) {
+        str_keys[i] = malloc(32);
+        snprintf(str_keys[i], 32, "key_%d", i);
+        str_misses[i] = malloc(32);
+        snprintf(str_misses[i], 32, "m_%d", i);
+        int_keys[i] = i;
+        int_misses[i] = LAYOUT_KEYS + i;
+        u32_keys[i] = (uint32_t)i * 7919;
+        u32_misses[i] = (uint32_t)i * 7919 + 1;
+        u64_keys[i] = (uint64_t)i * 1000000007ULL;
+        u64_misses[i] = (uint64_t)i * 1000000007ULL + 1;
+        ptr_keys[i] = (void*)(uintptr_t)(0x10000 + (uintptr_t)i * 64);
+        ptr_misses[i] = (void*)(uintptr_t)(0x10000 + (uintptr_t)i * 64 + 8);
+    }
+    
+    LAYOUT_COMPARE("string → int", StrInt, PackedStrInt, SplitStrInt, str_keys, str_misses, order);
+    LAYOUT_COMPARE("string → double", StrDouble, PackedStrDouble, SplitStrDouble, str_keys, str_misses, order);
+    LAYOUT_COMPARE("int → int", IntInt, PackedIntInt, SplitIntInt, int_keys, int_misses, order);
+    LAYOUT_COMPARE("int → double", IntDouble, PackedIntDouble, SplitIntDouble, int_keys, int_misses, order);
+    LAYOUT_COMPARE("uint32 → int", U32Int, PackedU32Int, SplitU32Int, u32_keys, u32_misses, order);
+    LAYOUT_COMPARE("uint64 → int", U64Int, PackedU64Int, SplitU64Int, u64_keys, u64_misses, order);
+    LAYOUT_COMPARE("void* → int", PtrInt, PackedPtrInt, SplitPtrInt, ptr_keys, ptr_misses, order);
+    
+    for (int i = 0; i < LAYOUT_KEYS; i++) {
+        free(str_keys[i]);
+        free(str_misses[i]);
+    }
+    free(str_keys);
+    free(str_misses);
+    free(int_keys);
+    free(int_misses);
+    free(u32_keys);
+    free(u32_misses);
+    free(u64_keys);
+    free(u64_misses);
+    free(ptr_keys);
+    free(ptr_misses);
+    free(order);
+    
+    fprintf(stderr, "\n*Same probing in all three; packed and split keep an 8-bit distance and a 24-bit hash tag "
+                    "per slot instead of a 32-bit hash and an int distance. Value scan is _next(&it, NULL, &v) "
+                    "over the whole table; a load below 0.75 means a probe passed the 8-bit distance cap and the table "
+                    "doubled; median of %d trials*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Entry Layouts");
+    perf_counters_print(&perf, stderr, "Entry Layouts");
+}
+
 // ============================================================================
 // Summary table
 // ============================================================================
@@ -500,12 +2042,41 @@ typedef struct {
     double get_hit;
     double contains_hit;
     double contains_miss;
+    double bytes_per_entry;
 } BenchResult;
 
+// Insert, get and contains hit/miss over ITERATIONS keys into results[R];
+// KEY, VAL and MISS are expressions of the op index i
+#define SUMMARY_ROW(R, NAME, TYPE, KEY, VAL, MISS) do { \
+    static const char *ops[4] = {"insert", "get hit", "contains hit", "contains miss"}; \
+    bench_timer t[4]; \
+    bench_timers_init(t, 4); \
+    volatile double sum = 0; \
+    volatile int found = 0; \
+    for (int trial = 0; trial < bench_cfg.trials; trial++) { \
+        TYPE *d = TYPE##_create_with_capacity(ITERATIONS * 2); \
+        TIMED_TRIAL(&t[0], ITERATIONS, TYPE##_set(d, KEY, VAL)); \
+        TIMED_TRIAL(&t[1], ITERATIONS, sum += TYPE##_get(d, KEY, 0)); \
+        TIMED_TRIAL(&t[2], ITERATIONS, found += TYPE##_contains(d, KEY)); \
+        TIMED_TRIAL(&t[3], ITERATIONS, found += TYPE##_contains(d, MISS)); \
+        results[R].bytes_per_entry = (double)TYPE##_memory_usage(d) / TYPE##_size(d); \
+        TYPE##_destroy(d); \
+    } \
+    report_rows(NAME, ops, t, 4); \
+    perf_row(NAME); \
+    results[R].name = NAME; \
+    results[R].insert = bench_timer_stats(&t[0]).median; \
+    results[R].get_hit = bench_timer_stats(&t[1]).median; \
+    results[R].contains_hit = bench_timer_stats(&t[2]).median; \
+    results[R].contains_miss = bench_timer_stats(&t[3]).median; \
+} while (0)
+
 void run_all_and_summary(void) {
     fprintf(stderr, "# Generic Dict Benchmark Results\n\n");
     fprintf(stderr, "**Iterations:** %d\n", ITERATIONS);
     fprintf(stderr, "**Algorithm:** Robin Hood hashing + DJB2/integer hash\n\n");
+    bench_print_config(stderr);
+    fprintf(stderr, "\n");
     
     // Get CPU info
     FILE *f = fopen("/proc/cpuinfo", "r");
@@ -531,11 +2102,14 @@ void run_all_and_summary(void) {
     bench_u32_int();
     bench_u64_int();
     bench_ptr_int();
+    fprintf(stderr, "*Median (ns/op) and stddev over %d trials; p50 / p99 / p99.9 / Max (ns) are single sampled ops*\n",
+            bench_cfg.trials);
+    perf_counters_print(&perf, stderr, "Per-Type Operations");
     
     fprintf(stderr, "---\n\n");
     fprintf(stderr, "## Summary Table\n\n");
-    fprintf(stderr, "| Type | Insert | Get | Contains (hit) | Contains (miss) |\n");
-    fprintf(stderr, "|------|-------:|----:|---------------:|----------------:|\n");
+    fprintf(stderr, "| Type | Insert | Get | Contains (hit) | Contains (miss) | Bytes/entry |\n");
+    fprintf(stderr, "|------|-------:|----:|---------------:|----------------:|------------:|\n");
 }
 
 // ============================================================================
@@ -543,240 +2117,74 @@ void run_all_and_summary(void) {
 // ============================================================================
 
 int main(void) {
+    bench_init(3);
+    perf_counters_open(&perf);
     run_all_and_summary();
     
     // Run quick benchmarks again for summary table
     BenchResult results[7];
     
-    // Str->Int
-    {
-        char **keys = malloc(ITERATIONS * sizeof(char*));
-        for (int i = 0; i < ITERATIONS; i++) {
-            keys[i] = malloc(32);
-            snprintf(keys[i], 32, "key_%d", i);
-        }
-        StrInt *d = StrInt_create_with_capacity(ITERATIONS * 2);
-        
-        uint64_t s = get_nanos();
-        for (int i = 0; i < ITERATIONS; i++) StrInt_set(d, keys[i], i);
-        results[0].insert = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int sum = 0;
-        for (int i = 0; i < ITERATIONS; i++) sum += StrInt_get(d, keys[i], 0);
-        results[0].get_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int f = 0;
-        for (int i = 0; i < ITERATIONS; i++) if (StrInt_contains(d, keys[i])) f++;
-        results[0].contains_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        char miss[32];
-        s = get_nanos();
-        f = 0;
-        for (int i = 0; i < ITERATIONS; i++) {
-            snprintf(miss, 32, "m_%d", i);
-            if (StrInt_contains(d, miss)) f++;
-        }
-        results[0].contains_miss = (double)(get_nanos() - s) / ITERATIONS;
-        results[0].name = "string → int";
-        
-        StrInt_destroy(d);
-        for (int i = 0; i < ITERATIONS; i++) free(keys[i]);
-        free(keys);
-    }
-    
-    // Str->Double
-    {
-        char **keys = malloc(ITERATIONS * sizeof(char*));
-        for (int i = 0; i < ITERATIONS; i++) {
-            keys[i] = malloc(32);
-            snprintf(keys[i], 32, "key_%d", i);
-        }
-        StrDouble *d = StrDouble_create_with_capacity(ITERATIONS * 2);
-        
-        uint64_t s = get_nanos();
-        for (int i = 0; i < ITERATIONS; i++) StrDouble_set(d, keys[i], i * 1.5);
-        results[1].insert = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile double sum = 0;
-        for (int i = 0; i < ITERATIONS; i++) sum += StrDouble_get(d, keys[i], 0);
-        results[1].get_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int f = 0;
-        for (int i = 0; i < ITERATIONS; i++) if (StrDouble_contains(d, keys[i])) f++;
-        results[1].contains_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        char miss[32];
-        s = get_nanos();
-        f = 0;
-        for (int i = 0; i < ITERATIONS; i++) {
-            snprintf(miss, 32, "m_%d", i);
-            if (StrDouble_contains(d, miss)) f++;
-        }
-        results[1].contains_miss = (double)(get_nanos() - s) / ITERATIONS;
-        results[1].name = "string → double";
-        
-        StrDouble_destroy(d);
-        for (int i = 0; i < ITERATIONS; i++) free(keys[i]);
-        free(keys);
-    }
-    
-    // Int->Int
-    {
-        IntInt *d = IntInt_create_with_capacity(ITERATIONS * 2);
-        
-        uint64_t s = get_nanos();
-        for (int i = 0; i < ITERATIONS; i++) IntInt_set(d, i, i * i);
-        results[2].insert = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int sum = 0;
-        for (int i = 0; i < ITERATIONS; i++) sum += IntInt_get(d, i, 0);
-        results[2].get_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int f = 0;
-        for (int i = 0; i < ITERATIONS; i++) if (IntInt_contains(d, i)) f++;
-        results[2].contains_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        f = 0;
-        for (int i = ITERATIONS; i < ITERATIONS*2; i++) if (IntInt_contains(d, i)) f++;
-        results[2].contains_miss = (double)(get_nanos() - s) / ITERATIONS;
-        results[2].name = "int → int";
-        
-        IntInt_destroy(d);
-    }
-    
-    // Int->Double
-    {
-        IntDouble *d = IntDouble_create_with_capacity(ITERATIONS * 2);
-        
-        uint64_t s = get_nanos();
-        for (int i = 0; i < ITERATIONS; i++) IntDouble_set(d, i, i * 3.14);
-        results[3].insert = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile double sum = 0;
-        for (int i = 0; i < ITERATIONS; i++) sum += IntDouble_get(d, i, 0);
-        results[3].get_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int f = 0;
-        for (int i = 0; i < ITERATIONS; i++) if (IntDouble_contains(d, i)) f++;
-        results[3].contains_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        f = 0;
-        for (int i = ITERATIONS; i < ITERATIONS*2; i++) if (IntDouble_contains(d, i)) f++;
-        results[3].contains_miss = (double)(get_nanos() - s) / ITERATIONS;
-        results[3].name = "int → double";
-        
-        IntDouble_destroy(d);
-    }
-    
-    // U32->Int
-    {
-        U32Int *d = U32Int_create_with_capacity(ITERATIONS * 2);
-        
-        uint64_t s = get_nanos();
-        for (uint32_t i = 0; i < ITERATIONS; i++) U32Int_set(d, i * 7919, (int)i);
-        results[4].insert = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int sum = 0;
-        for (uint32_t i = 0; i < ITERATIONS; i++) sum += U32Int_get(d, i * 7919, 0);
-        results[4].get_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int f = 0;
-        for (uint32_t i = 0; i < ITERATIONS; i++) if (U32Int_contains(d, i * 7919)) f++;
-        results[4].contains_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        f = 0;
-        for (uint32_t i = 0; i < ITERATIONS; i++) if (U32Int_contains(d, i * 7919 + 1)) f++;
-        results[4].contains_miss = (double)(get_nanos() - s) / ITERATIONS;
-        results[4].name = "uint32 → int";
-        
-        U32Int_destroy(d);
+    // String keys and misses are built up front so only the table is timed
+    char **keys = malloc(ITERATIONS * sizeof(char*));
+    char **miss_keys = malloc(ITERATIONS * sizeof(char*));
+    void **ptrs = malloc(ITERATIONS * sizeof(void*));
+    for (int i = 0; i < ITERATIONS; i++) {
+        keys[i] = malloc(32);
+        snprintf(keys[i], 32, "key_%d", i);
+        miss_keys[i] = malloc(32);
+        snprintf(miss_keys[i], 32, "m_%d", i);
+        ptrs[i] = (void*)(uintptr_t)(0x10000 + i * 64);
     }
     
-    // U64->Int
-    {
-        U64Int *d = U64Int_create_with_capacity(ITERATIONS * 2);
-        
-        uint64_t s = get_nanos();
-        for (uint64_t i = 0; i < ITERATIONS; i++) U64Int_set(d, i * 1000000007ULL, (int)i);
-        results[5].insert = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int sum = 0;
-        for (uint64_t i = 0; i < ITERATIONS; i++) sum += U64Int_get(d, i * 1000000007ULL, 0);
-        results[5].get_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int f = 0;
-        for (uint64_t i = 0; i < ITERATIONS; i++) if (U64Int_contains(d, i * 1000000007ULL)) f++;
-        results[5].contains_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        f = 0;
-        for (uint64_t i = 0; i < ITERATIONS; i++) if (U64Int_contains(d, i * 1000000007ULL + 1)) f++;
-        results[5].contains_miss = (double)(get_nanos() - s) / ITERATIONS;
-        results[5].name = "uint64 → int";
-        
-        U64Int_destroy(d);
-    }
+    SUMMARY_ROW(0, "string → int", StrInt, keys[i], (int)i, miss_keys[i]);
+    SUMMARY_ROW(1, "string → double", StrDouble, keys[i], i * 1.5, miss_keys[i]);
+    SUMMARY_ROW(2, "int → int", IntInt, (int)i, (int)(i * i), (int)(i + ITERATIONS));
+    SUMMARY_ROW(3, "int → double", IntDouble, (int)i, i * 3.14, (int)(i + ITERATIONS));
+    SUMMARY_ROW(4, "uint32 → int", U32Int, (uint32_t)i * 7919, (int)i, (uint32_t)i * 7919 + 1);
+    SUMMARY_ROW(5, "uint64 → int", U64Int, (uint64_t)i * 1000000007ULL, (int)i, (uint64_t)i * 1000000007ULL + 1);
+    SUMMARY_ROW(6, "void* → int", PtrInt, ptrs[i], (int)i, (void*)(uintptr_t)(0x90000000 + i));
     
-    // Ptr->Int
-    {
-        void **ptrs = malloc(ITERATIONS * sizeof(void*));
-        for (int i = 0; i < ITERATIONS; i++) ptrs[i] = (void*)(uintptr_t)(0x10000 + i * 64);
-        
-        PtrInt *d = PtrInt_create_with_capacity(ITERATIONS * 2);
-        
-        uint64_t s = get_nanos();
-        for (int i = 0; i < ITERATIONS; i++) PtrInt_set(d, ptrs[i], i);
-        results[6].insert = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int sum = 0;
-        for (int i = 0; i < ITERATIONS; i++) sum += PtrInt_get(d, ptrs[i], 0);
-        results[6].get_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        volatile int f = 0;
-        for (int i = 0; i < ITERATIONS; i++) if (PtrInt_contains(d, ptrs[i])) f++;
-        results[6].contains_hit = (double)(get_nanos() - s) / ITERATIONS;
-        
-        s = get_nanos();
-        f = 0;
-        for (int i = 0; i < ITERATIONS; i++) {
-            void *m = (void*)(uintptr_t)(0x90000000 + i);
-            if (PtrInt_contains(d, m)) f++;
-        }
-        results[6].contains_miss = (double)(get_nanos() - s) / ITERATIONS;
-        results[6].name = "void* → int";
-        
-        PtrInt_destroy(d);
-        free(ptrs);
+    for (int i = 0; i < ITERATIONS; i++) {
+        free(keys[i]);
+        free(miss_keys[i]);
     }
+    free(keys);
+    free(miss_keys);
+    free(ptrs);
     
     // Print summary
     for (int i = 0; i < 7; i++) {
-        fprintf(stderr, "| %s | %.2f | %.2f | %.2f | %.2f |\n",
+        fprintf(stderr, "| %s | %.2f | %.2f | %.2f | %.2f | %.1f |\n",
                 results[i].name,
                 results[i].insert,
                 results[i].get_hit,
                 results[i].contains_hit,
-                results[i].contains_miss);
+                results[i].contains_miss,
+                results[i].bytes_per_entry);
     }
     
-    fprintf(stderr, "\n*All times in nanoseconds per operation*\n");
-    
+    fprintf(stderr, "\n*Median ns per operation over %d trials; Bytes/entry = _memory_usage / _size "
+                    "(tables presized to 2x the keys, plus owned key bytes)*\n", bench_cfg.trials);
+    bench_report_print(stderr, "Summary Table");
+    perf_counters_print(&perf, stderr, "Summary Table");
+    
+    bench_swiss_vs_robin();
+    bench_strlen_keys();
+    bench_arena_keys();
+    bench_insert_latency();
+    bench_batched_lookup();
+    bench_snapshot_load();
+    bench_sso_keys();
+    bench_upsert();
+    bench_static_keys();
+    bench_iteration();
+    bench_layouts();
+    bench_huge_pages();
+    bench_sets();
+    bench_unpin();  // build_from's worker threads need every CPU
+    bench_build_from();
+    bench_repin();
+    
+    perf_counters_close(&perf);
     return 0;
 }
@@ -10,6 +10,8 @@
 #include <time.h>
 #include <string.h>
 #include "../include/dict.h"
+#include "../include/bench.h"
+#include "../include/perf_counters.h"
 
 // ============================================================================
 // Define dictionary types
@@ -34,11 +36,8 @@ DICT_DEFINE_STR_PTR(StrPtrDict)
 // Helper
 // ============================================================================
 
-static inline uint64_t get_nanos(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
-}
+// Hardware counters per row when BENCH_PERF is set (perf_counters.h)
+static perf_counters perf;
 
 // ============================================================================
 // Examples
@@ -191,43 +190,76 @@ void example_str_ptr(void) {
 
 void example_performance(void) {
     printf("=== Performance (Dict<string, int>) ===\n\n");
+    bench_print_config(stdout);
+    printf("\n");
     
     const int N = 100000;
     char key[32];
-    
-    StrIntDict *dict = StrIntDict_create_with_capacity(N * 2);
-    
-    // Insert
-    uint64_t start = get_nanos();
-    for (int i = 0; i < N; i++) {
-        snprintf(key, sizeof(key), "key_%d", i);
-        StrIntDict_set(dict, key, i);
+    bench_timer insert, get_hit, contains_miss;
+    bench_timer_init(&insert);
+    bench_timer_init(&get_hit);
+    bench_timer_init(&contains_miss);
+    
+    // Insert (a fresh table per trial; the last one is kept for the lookups)
+    StrIntDict *dict = NULL;
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        if (dict) StrIntDict_destroy(dict);
+        dict = StrIntDict_create_with_capacity(N * 2);
+        perf_counters_start(&perf);
+        bench_trial_begin(&insert);
+        for (int i = 0; i < N; i++) {
+            bench_op_begin(&insert, i);
+            snprintf(key, sizeof(key), "key_%d", i);
+            StrIntDict_set(dict, key, i);
+            bench_op_end(&insert);
+        }
+        bench_trial_end(&insert, N);
+        perf_counters_stop(&perf);
     }
-    uint64_t end = get_nanos();
-    printf("Insert %d: %.2f ns/op\n", N, (double)(end - start) / N);
+    perf_counters_row(&perf, "Insert", (double)N * bench_cfg.trials);
+    bench_report_row("Insert", &insert);
+    printf("Insert %d: %.2f ns/op\n", N, bench_timer_stats(&insert).median);
     
     // Get (hit)
-    start = get_nanos();
     volatile int sum = 0;
-    for (int i = 0; i < N; i++) {
-        snprintf(key, sizeof(key), "key_%d", i);
-        sum += StrIntDict_get(dict, key, 0);
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        bench_trial_begin(&get_hit);
+        for (int i = 0; i < N; i++) {
+            bench_op_begin(&get_hit, i);
+            snprintf(key, sizeof(key), "key_%d", i);
+            sum += StrIntDict_get(dict, key, 0);
+            bench_op_end(&get_hit);
+        }
+        bench_trial_end(&get_hit, N);
     }
-    end = get_nanos();
-    printf("Get (hit) %d: %.2f ns/op\n", N, (double)(end - start) / N);
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Get (hit)", (double)N * bench_cfg.trials);
+    bench_report_row("Get (hit)", &get_hit);
+    printf("Get (hit) %d: %.2f ns/op\n", N, bench_timer_stats(&get_hit).median);
     
     // Contains (miss)
-    start = get_nanos();
     volatile int found = 0;
-    for (int i = 0; i < N; i++) {
-        snprintf(key, sizeof(key), "miss_%d", i);
-        if (StrIntDict_contains(dict, key)) found++;
+    perf_counters_start(&perf);
+    for (int trial = 0; trial < bench_cfg.trials; trial++) {
+        bench_trial_begin(&contains_miss);
+        for (int i = 0; i < N; i++) {
+            bench_op_begin(&contains_miss, i);
+            snprintf(key, sizeof(key), "miss_%d", i);
+            if (StrIntDict_contains(dict, key)) found++;
+            bench_op_end(&contains_miss);
+        }
+        bench_trial_end(&contains_miss, N);
     }
-    end = get_nanos();
-    printf("Contains (miss) %d: %.2f ns/op\n", N, (double)(end - start) / N);
+    perf_counters_stop(&perf);
+    perf_counters_row(&perf, "Contains (miss)", (double)N * bench_cfg.trials);
+    bench_report_row("Contains (miss)", &contains_miss);
+    printf("Contains (miss) %d: %.2f ns/op\n", N, bench_timer_stats(&contains_miss).median);
     
     printf("\nSize: %zu, Capacity: %zu\n", 
            StrIntDict_size(dict), StrIntDict_capacity(dict));
+    bench_report_print(stdout, "Performance Test");
+    perf_counters_print(&perf, stdout, "Performance Test");
     
     StrIntDict_destroy(dict);
     printf("\n");
@@ -244,8 +276,7 @@ void example_word_count(void) {
     char *copy = strdup(text);
     char *word = strtok(copy, " ");
     while (word) {
-        int count = StrIntDict_get(wc, word, 0);
-        StrIntDict_set(wc, word, count + 1);
+        (*StrIntDict_get_or_insert(wc, word, 0))++;
         word = strtok(NULL, " ");
     }
     free(copy);
@@ -276,7 +307,10 @@ int main(void) {
     example_int_str();
     example_str_ptr();
     example_word_count();
+    bench_init(5);
+    perf_counters_open(&perf);
     example_performance();
+    perf_counters_close(&perf);
     
     printf("All examples completed!\n");
     return 0;